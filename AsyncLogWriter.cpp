@@ -0,0 +1,292 @@
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+AsyncLogWriter::AsyncLogWriter(size_t requestedCapacity)
+    : capacity(RoundUpToPowerOfTwo(requestedCapacity)),
+    mask(capacity - 1),
+    slots(new Slot[capacity]),
+    enqueuePosition(0),
+    dequeuePosition(0),
+    wakeWord(0),
+    stopping(false),
+    drainRequested(false),
+    flushWaiters(0),
+    writtenPosition(0),
+    running(false),
+    postedCount(0),
+    droppedCount(0),
+    writtenCount(0),
+    batchCount(0),
+    reportedDroppedCount(0)
+{
+    for (size_t index = 0; index < capacity; ++index)
+    {
+        slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    Stop();
+}
+
+bool AsyncLogWriter::Start(RecordHandler recordHandlerValue, BatchHandler batchHandlerValue)
+{
+    std::lock_guard<std::mutex> guard(flushMutex);
+    if (running || !recordHandlerValue)
+    {
+        return false;
+    }
+
+    recordHandler = std::move(recordHandlerValue);
+    batchHandler = std::move(batchHandlerValue);
+    stopping = false;
+
+    try
+    {
+        writer = std::thread(&AsyncLogWriter::WriterLoop, this);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void AsyncLogWriter::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(flushMutex);
+        if (!running)
+        {
+            return;
+        }
+    }
+
+    stopping = true;
+    Wake();
+    {
+        std::lock_guard<std::mutex> guard(flushMutex);
+        batchWake.notify_all();
+    }
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+
+    std::lock_guard<std::mutex> guard(flushMutex);
+    running = false;
+    flushed.notify_all();
+}
+
+bool AsyncLogWriter::IsRunning() const
+{
+    std::lock_guard<std::mutex> guard(flushMutex);
+    return running;
+}
+
+uint64_t AsyncLogWriter::Post(uint32_t site, uint32_t threadId, uint64_t timestamp, const void* data, size_t length)
+{
+    return PostEncoded(site, threadId, timestamp,
+        [data, length](uint8_t* buffer, size_t capacity)
+        {
+            size_t copied = (std::min)(length, capacity);
+            std::memcpy(buffer, data, copied);
+            return copied;
+        });
+}
+
+AsyncLogWriter::Slot* AsyncLogWriter::Claim(uint64_t& position)
+{
+    position = enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Slot* slot = &slots[position & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+        if (difference == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                return slot;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Full: drop the newest entry rather than wait for the writer.
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t AsyncLogWriter::Publish(Slot* slot, uint64_t position)
+{
+    slot->sequence.store(position + 1, std::memory_order_release);
+    postedCount.fetch_add(1, std::memory_order_relaxed);
+    Wake();
+
+    // A burst that fills half the ring should not wait out the batch delay.
+    // The notification is sent without the lock and can be missed in a narrow
+    // window, which only costs the delay.
+    if (((position + 1) & (capacity / 2 - 1)) == 0)
+    {
+        RequestDrain();
+    }
+    return position + 1;
+}
+
+void AsyncLogWriter::RequestDrain()
+{
+    drainRequested.store(true);
+    Wake();
+    batchWake.notify_one();
+}
+
+bool AsyncLogWriter::Flush(uint64_t ticket, std::chrono::milliseconds timeout)
+{
+    if (ticket == 0)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(flushMutex);
+    ++flushWaiters;
+    batchWake.notify_all();
+    bool written = flushed.wait_for(lock, timeout,
+        [this, ticket]() { return writtenPosition >= ticket || !running; })
+        && writtenPosition >= ticket;
+    --flushWaiters;
+    return written;
+}
+
+uint64_t AsyncLogWriter::GetPostedCount() const
+{
+    return postedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogWriter::GetDroppedCount() const
+{
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogWriter::GetWrittenCount() const
+{
+    return writtenCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogWriter::GetBatchCount() const
+{
+    return batchCount.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogWriter::TryPop(LogRecord& record)
+{
+    Slot& slot = slots[dequeuePosition & mask];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != dequeuePosition + 1)
+    {
+        return false;
+    }
+
+    record.timestamp = slot.record.timestamp;
+    record.site = slot.record.site;
+    record.threadId = slot.record.threadId;
+    record.length = slot.record.length;
+    std::memcpy(record.data, slot.record.data, record.length);
+
+    slot.sequence.store(dequeuePosition + capacity, std::memory_order_release);
+    ++dequeuePosition;
+    return true;
+}
+
+void AsyncLogWriter::Wake()
+{
+    if (wakeWord.exchange(1, std::memory_order_acq_rel) == 0)
+    {
+        wakeWord.notify_one();
+    }
+}
+
+void AsyncLogWriter::WriterLoop()
+{
+    std::unique_ptr<LogRecord> record(new LogRecord());
+
+    for (;;)
+    {
+        uint64_t written = 0;
+        while (TryPop(*record))
+        {
+            recordHandler(*record);
+            ++written;
+        }
+
+        uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+        if (written > 0 || dropped != reportedDroppedCount)
+        {
+            if (batchHandler)
+            {
+                batchHandler(dropped - reportedDroppedCount);
+            }
+            reportedDroppedCount = dropped;
+
+            writtenCount.fetch_add(written, std::memory_order_relaxed);
+            batchCount.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard(flushMutex);
+            writtenPosition = dequeuePosition;
+            flushed.notify_all();
+            continue;
+        }
+
+        if (stopping.load())
+        {
+            // An entry whose slot was claimed but not yet filled would show up
+            // in enqueuePosition; wait for it rather than lose it.
+            if (enqueuePosition.load() == dequeuePosition)
+            {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Announce that we are about to sleep, then look once more so an entry
+        // published in between is not missed.
+        wakeWord.store(0, std::memory_order_seq_cst);
+        Slot& next = slots[dequeuePosition & mask];
+        if (next.sequence.load(std::memory_order_acquire) == dequeuePosition + 1 || stopping.load())
+        {
+            continue;
+        }
+        wakeWord.wait(0);
+
+        std::unique_lock<std::mutex> lock(flushMutex);
+        batchWake.wait_for(lock, BatchDelay,
+            [this]() { return flushWaiters > 0 || drainRequested.load() || stopping.load(); });
+        drainRequested.store(false);
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// One queued log entry: a site ID plus the site's encoded arguments. The
+// timestamp and contents are opaque to the queue.
+struct LogRecord
+{
+    static constexpr size_t MaxDataLength = 2048;
+
+    uint64_t timestamp;
+    uint32_t site;
+    uint32_t threadId;
+    uint32_t length;
+    uint8_t data[MaxDataLength];
+};
+
+// Hands log entries from any thread to a background writer thread.
+//
+// Producers encode their entry directly into a bounded ring of preallocated
+// slots and never take a lock; a slot is claimed with one compare-exchange and
+// published with a release store (Vyukov's bounded queue). When the ring is
+// full the new entry is dropped and counted, so a slow disk can never stall a
+// hook or the TV worker; the writer reports the number of dropped entries once
+// it catches up.
+//
+// The writer drains everything that is available, hands each entry to the
+// record handler and then calls the batch handler once, so the sink can write
+// and flush per batch rather than per entry. Only the first entry after the
+// writer goes idle wakes it; it then lets a burst gather for BatchDelay, so the
+// rest of the burst costs producers no system call. RequestDrain and Flush cut
+// the delay short.
+class AsyncLogWriter
+{
+public:
+    using RecordHandler = std::function<void(const LogRecord& record)>;
+    using BatchHandler = std::function<void(uint64_t droppedSinceLastBatch)>;
+
+    static constexpr std::chrono::milliseconds BatchDelay{ 10 };
+
+    // capacity is rounded up to a power of two.
+    explicit AsyncLogWriter(size_t capacity);
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    bool Start(RecordHandler recordHandler, BatchHandler batchHandler);
+
+    // Writes out everything still queued and stops the writer thread.
+    void Stop();
+
+    bool IsRunning() const;
+
+    // Queues an entry; data longer than LogRecord::MaxDataLength is
+    // truncated. Returns 0 when the entry was dropped, otherwise a ticket for
+    // Flush.
+    uint64_t Post(uint32_t site, uint32_t threadId, uint64_t timestamp, const void* data, size_t length);
+
+    // Like Post, but lets encode write the data straight into the claimed
+    // slot: encode(uint8_t* data, size_t capacity) returns the length used.
+    template <typename Encoder>
+    uint64_t PostEncoded(uint32_t site, uint32_t threadId, uint64_t timestamp, Encoder&& encode)
+    {
+        uint64_t position = 0;
+        Slot* slot = Claim(position);
+        if (slot == nullptr)
+        {
+            return 0;
+        }
+
+        size_t length = encode(slot->record.data, LogRecord::MaxDataLength);
+        slot->record.timestamp = timestamp;
+        slot->record.site = site;
+        slot->record.threadId = threadId;
+        slot->record.length = static_cast<uint32_t>(length < LogRecord::MaxDataLength ? length : LogRecord::MaxDataLength);
+        return Publish(slot, position);
+    }
+
+    // Asks the writer to skip the batch delay and write out what is queued.
+    // Never blocks, so it is safe from a hook; the request can be missed in a
+    // narrow window, which only costs the delay.
+    void RequestDrain();
+
+    // Waits until the entry with the given ticket, and every entry queued
+    // before it, has been handed to the batch handler. Returns false on
+    // timeout or when the writer is not running.
+    bool Flush(uint64_t ticket, std::chrono::milliseconds timeout);
+
+    uint64_t GetPostedCount() const;
+    uint64_t GetDroppedCount() const;
+    uint64_t GetWrittenCount() const;
+    uint64_t GetBatchCount() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    // Claims the next free slot, or counts a drop and returns nullptr.
+    Slot* Claim(uint64_t& position);
+    uint64_t Publish(Slot* slot, uint64_t position);
+    bool TryPop(LogRecord& record);
+    void Wake();
+    void WriterLoop();
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    std::atomic<uint64_t> enqueuePosition;
+    uint64_t dequeuePosition;
+
+    // Set by producers after publishing an entry; cleared by the writer before
+    // it goes to sleep so only the first producer pays for a wake-up.
+    std::atomic<uint32_t> wakeWord;
+    std::atomic<bool> stopping;
+    std::atomic<bool> drainRequested;
+
+    std::thread writer;
+    RecordHandler recordHandler;
+    BatchHandler batchHandler;
+
+    // Flush waiters are rare (errors, shutdown), so they use a plain lock.
+    mutable std::mutex flushMutex;
+    std::condition_variable flushed;
+    std::condition_variable batchWake;
+    uint32_t flushWaiters;
+    uint64_t writtenPosition;
+    bool running;
+
+    std::atomic<uint64_t> postedCount;
+    std::atomic<uint64_t> droppedCount;
+    std::atomic<uint64_t> writtenCount;
+    std::atomic<uint64_t> batchCount;
+    uint64_t reportedDroppedCount;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "EndpointCapabilityCache.h"
+
+#include <string>
+
+// Receives endpoint notifications from a backend. Calls arrive on whatever
+// thread the backend delivers them on and must return quickly.
+class IAudioEndpointEvents
+{
+public:
+    virtual ~IAudioEndpointEvents() = default;
+
+    // The default render endpoint changed.
+    virtual void OnDefaultEndpointChanged() = 0;
+
+    // An endpoint was added to the system.
+    virtual void OnEndpointAdded(const std::wstring& endpointId) = 0;
+
+    // An endpoint was removed from the system.
+    virtual void OnEndpointRemoved(const std::wstring& endpointId) = 0;
+
+    // An endpoint was enabled, disabled, unplugged or plugged in.
+    virtual void OnEndpointStateChanged(const std::wstring& endpointId) = 0;
+
+    // A property of an endpoint changed.
+    virtual void OnEndpointPropertyChanged(
+        const std::wstring& endpointId,
+        EndpointPropertyChange change) = 0;
+
+    // The master volume of the selected endpoint changed. ownChange is true
+    // when the change was made through IAudioEndpointBackend::SetVolume.
+    virtual void OnEndpointVolumeChanged(float level, bool ownChange) = 0;
+};
+
+// Source of audio endpoint state and control over the endpoint volume.
+//
+// Everything except Start, Stop, GetVolume and SetVolume is called from the
+// routing worker thread, between AttachWorkerThread and DetachWorkerThread.
+// GetVolume and SetVolume may be called from any thread, concurrently with an
+// endpoint switch, and must not block on it.
+class IAudioEndpointBackend : public IEndpointCapabilityProbe
+{
+public:
+    virtual ~IAudioEndpointBackend() = default;
+
+    // Begins delivering notifications to the given sink.
+    virtual bool Start(IAudioEndpointEvents& events) = 0;
+
+    // Stops delivering notifications. No sink call is in flight afterwards.
+    virtual void Stop() = 0;
+
+    // Prepares the calling thread for backend calls.
+    virtual void AttachWorkerThread() = 0;
+
+    // Releases per-thread state set up by AttachWorkerThread.
+    virtual void DetachWorkerThread() = 0;
+
+    // Reads the ID of the current default render endpoint.
+    // Returns false when there is no default endpoint.
+    virtual bool GetDefaultEndpoint(std::wstring& endpointId) = 0;
+
+    // Selects the endpoint whose master volume GetVolume/SetVolume control
+    // and whose volume changes are reported. An empty ID releases the current
+    // selection.
+    virtual bool SelectVolumeEndpoint(const std::wstring& endpointId) = 0;
+
+    // Reads the master volume of the selected endpoint as a 0..1 scalar.
+    virtual bool GetVolume(float& level) = 0;
+
+    // Sets the master volume of the selected endpoint as a 0..1 scalar.
+    virtual bool SetVolume(float level) = 0;
+};
@@ -0,0 +1,341 @@
+#include "AudioRouter.h"
+
+#include "FlightRecorder.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+    // Work flags posted to the refresh queue.
+    constexpr uint32_t WorkRefreshDefaultEndpoint = 0x1;
+    constexpr uint32_t WorkUpdateRouting = 0x2;
+    constexpr uint32_t WorkRepinVolume = 0x4;
+
+    // Level the endpoint volume is held at while routing targets the TV.
+    constexpr float PinnedVolumeLevel = 1.0f;
+}
+
+AudioRouter::AudioRouter(IAudioEndpointBackend& backendValue)
+    : backend(backendValue),
+    capabilities(backendValue),
+    refreshQueue(),
+    isPaired(),
+    statusChanged(),
+    onlyWhenDolbyAtmos(true),
+    useTvVolume(false),
+    status(),
+    volumePin(),
+    routing(),
+    volumeEndpointId(),
+    volumeEndpointSelected(false),
+    endpointMatches(false),
+    endpointDolbyAtmos(false),
+    statusDirty(true),
+    previousVolumeSaved(false),
+    previousVolumeScalar(0.25f)
+{
+}
+
+AudioRouter::~AudioRouter()
+{
+    Stop();
+}
+
+bool AudioRouter::Start(
+    PairedQuery isPairedValue,
+    StatusCallback statusChangedValue,
+    CoalescingWorkQueue::Clock::duration debounceWindow,
+    CoalescingWorkQueue::Clock::duration maxDelay)
+{
+    isPaired = std::move(isPairedValue);
+    statusChanged = std::move(statusChangedValue);
+
+    bool started = refreshQueue.Start(
+        debounceWindow,
+        maxDelay,
+        [this](uint32_t workFlags) { ProcessWork(workFlags); },
+        [this]() { backend.AttachWorkerThread(); },
+        [this]()
+        {
+            backend.SelectVolumeEndpoint(std::wstring());
+            volumeEndpointId.clear();
+            volumeEndpointSelected = false;
+            backend.DetachWorkerThread();
+        });
+    if (!started)
+    {
+        return false;
+    }
+
+    if (!backend.Start(*this))
+    {
+        refreshQueue.Stop();
+        return false;
+    }
+
+    refreshQueue.PostImmediate(WorkRefreshDefaultEndpoint);
+    return true;
+}
+
+void AudioRouter::Stop()
+{
+    backend.Stop();
+    refreshQueue.Stop();
+}
+
+void AudioRouter::SetHintMatcher(EndpointCapabilityCache::HintMatcher matcher)
+{
+    capabilities.SetHintMatcher(std::move(matcher));
+    refreshQueue.PostImmediate(WorkRefreshDefaultEndpoint);
+}
+
+void AudioRouter::SetOnlyWhenDolbyAtmos(bool value)
+{
+    if (onlyWhenDolbyAtmos.exchange(value) != value)
+    {
+        refreshQueue.PostImmediate(WorkUpdateRouting);
+    }
+}
+
+void AudioRouter::RequestRoutingUpdate()
+{
+    refreshQueue.PostImmediate(WorkUpdateRouting);
+}
+
+bool AudioRouter::IsTvVolumeActive() const
+{
+    return useTvVolume.load(std::memory_order_acquire);
+}
+
+AudioRoutingStatus AudioRouter::GetStatus() const
+{
+    std::lock_guard<std::mutex> guard(statusMutex);
+    return status;
+}
+
+bool AudioRouter::SetEndpointVolume(float level)
+{
+    return backend.SetVolume(level);
+}
+
+const EndpointCapabilityCache& AudioRouter::GetCapabilityCache() const
+{
+    return capabilities;
+}
+
+const CoalescingWorkQueue& AudioRouter::GetRefreshQueue() const
+{
+    return refreshQueue;
+}
+
+void AudioRouter::GetVolumePinCounts(uint64_t& repins, uint64_t& suppressed) const
+{
+    std::lock_guard<std::mutex> guard(pinMutex);
+    repins = volumePin.GetRepinCount();
+    suppressed = volumePin.GetSuppressedCount();
+}
+
+void AudioRouter::OnDefaultEndpointChanged()
+{
+    refreshQueue.Post(WorkRefreshDefaultEndpoint);
+}
+
+void AudioRouter::OnEndpointAdded(const std::wstring&)
+{
+    // A new endpoint only matters once it becomes the default, which raises
+    // its own notification.
+}
+
+void AudioRouter::OnEndpointRemoved(const std::wstring& endpointId)
+{
+    if (capabilities.InvalidateEndpoint(endpointId))
+    {
+        refreshQueue.Post(WorkRefreshDefaultEndpoint);
+    }
+}
+
+void AudioRouter::OnEndpointStateChanged(const std::wstring& endpointId)
+{
+    // Refresh even when nothing was cached: an endpoint that comes back may
+    // be the default again, and an inactive default was never looked up.
+    capabilities.InvalidateEndpoint(endpointId);
+    refreshQueue.Post(WorkRefreshDefaultEndpoint);
+}
+
+void AudioRouter::OnEndpointPropertyChanged(
+    const std::wstring& endpointId,
+    EndpointPropertyChange change)
+{
+    if (capabilities.InvalidateProperty(endpointId, change))
+    {
+        refreshQueue.Post(WorkRefreshDefaultEndpoint);
+    }
+}
+
+void AudioRouter::OnEndpointVolumeChanged(float level, bool ownChange)
+{
+    bool repin = false;
+    {
+        std::lock_guard<std::mutex> guard(pinMutex);
+        repin = volumePin.OnVolumeChanged(level, ownChange, VolumePinPolicy::Clock::now());
+    }
+
+    if (repin)
+    {
+        refreshQueue.PostImmediate(WorkRepinVolume);
+    }
+}
+
+void AudioRouter::ProcessWork(uint32_t workFlags)
+{
+    if (workFlags & WorkRefreshDefaultEndpoint)
+    {
+        // A refresh always ends with a routing update, but it only re-pins
+        // when the endpoint changed, so a coalesced repin still runs below.
+        RefreshDefaultEndpoint();
+    }
+    else if (workFlags & WorkUpdateRouting)
+    {
+        UpdateRouting();
+    }
+
+    if (workFlags & WorkRepinVolume)
+    {
+        PinEndpointVolume();
+    }
+}
+
+void AudioRouter::PinEndpointVolume()
+{
+    float level = PinnedVolumeLevel;
+    {
+        std::lock_guard<std::mutex> guard(pinMutex);
+        if (!volumePin.IsPinned())
+        {
+            return;
+        }
+        level = volumePin.GetPinnedLevel();
+    }
+
+    if (volumeEndpointSelected)
+    {
+        backend.SetVolume(level);
+    }
+}
+
+void AudioRouter::RefreshDefaultEndpoint()
+{
+    TraceSpan span("Audio", "RefreshDefaultEndpoint");
+
+    std::wstring endpointId;
+    EndpointCapabilities endpoint;
+
+    if (backend.GetDefaultEndpoint(endpointId))
+    {
+        endpoint = capabilities.Lookup(endpointId);
+    }
+    else
+    {
+        endpointId.clear();
+    }
+
+    bool endpointChanged = false;
+    if (!volumeEndpointSelected || endpointId != volumeEndpointId)
+    {
+        volumeEndpointSelected = backend.SelectVolumeEndpoint(endpointId);
+        volumeEndpointId = endpointId;
+        endpointChanged = true;
+    }
+
+    endpointMatches = endpoint.matchesHint;
+    endpointDolbyAtmos = endpoint.dolbyAtmosAvailable;
+    RecordFlightEvent(FlightEventType::DefaultEndpoint, endpointMatches ? 1 : 0, endpointDolbyAtmos ? 1 : 0);
+
+    {
+        std::lock_guard<std::mutex> guard(statusMutex);
+        if (status.defaultDeviceId != endpointId || status.defaultDeviceName != endpoint.friendlyName)
+        {
+            status.defaultDeviceId = endpointId;
+            status.defaultDeviceName = endpoint.friendlyName;
+            statusDirty = true;
+        }
+    }
+
+    UpdateRouting();
+
+    // A device switch while routing stays on the TV must not leave the new
+    // endpoint at whatever level it had. This runs only after the routing
+    // update, which unpins first when the switch leaves the TV, so the pinned
+    // level never reaches the speakers.
+    if (endpointChanged)
+    {
+        PinEndpointVolume();
+    }
+}
+
+void AudioRouter::UpdateRouting()
+{
+    RoutingInputs inputs;
+    inputs.deviceMatches = endpointMatches;
+    inputs.dolbyAtmosAvailable = endpointDolbyAtmos;
+    inputs.onlyWhenDolbyAtmos = onlyWhenDolbyAtmos.load();
+    inputs.endpointVolumeAvailable = volumeEndpointSelected;
+
+    // Pairing only matters when the device qualifies, so skip the query
+    // otherwise; the table ignores the flag in that case anyway.
+    inputs.paired = inputs.deviceMatches && (!isPaired || isPaired());
+
+    RoutingTransition transition = routing.Advance(inputs);
+    useTvVolume.store(transition.useTvVolume, std::memory_order_release);
+    if (transition.commands != RoutingCommandNone)
+    {
+        RecordFlightEvent(FlightEventType::RoutingChanged, transition.useTvVolume ? 1 : 0, transition.commands);
+    }
+
+    if (transition.commands & RoutingCommandSaveEndpointVolume)
+    {
+        float current = previousVolumeScalar;
+        if (backend.GetVolume(current))
+        {
+            previousVolumeScalar = current;
+            previousVolumeSaved = true;
+        }
+    }
+    if (transition.commands & RoutingCommandPinEndpointVolume)
+    {
+        {
+            std::lock_guard<std::mutex> guard(pinMutex);
+            volumePin.Pin(PinnedVolumeLevel);
+        }
+        backend.SetVolume(PinnedVolumeLevel);
+    }
+    if (transition.commands & RoutingCommandRestoreEndpointVolume)
+    {
+        {
+            std::lock_guard<std::mutex> guard(pinMutex);
+            volumePin.Unpin();
+        }
+
+        // Only put back a level that was actually read.
+        if (previousVolumeSaved)
+        {
+            backend.SetVolume(previousVolumeScalar);
+            previousVolumeSaved = false;
+        }
+    }
+
+    if ((transition.commands & RoutingCommandPublishStatus) || statusDirty)
+    {
+        {
+            std::lock_guard<std::mutex> guard(statusMutex);
+            status.defaultDeviceMatches = inputs.deviceMatches;
+            status.dolbyAtmosAvailable = inputs.dolbyAtmosAvailable;
+            status.useTvVolume = transition.useTvVolume;
+        }
+        statusDirty = false;
+
+        if (statusChanged)
+        {
+            statusChanged();
+        }
+    }
+}
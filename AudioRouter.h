@@ -0,0 +1,133 @@
+#pragma once
+
+#include "AudioEndpointBackend.h"
+#include "CoalescingWorkQueue.h"
+#include "EndpointCapabilityCache.h"
+#include "RoutingStateMachine.h"
+#include "VolumePinPolicy.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Routing state as shown in the UI.
+struct AudioRoutingStatus
+{
+    std::wstring defaultDeviceId;
+    std::wstring defaultDeviceName;
+    bool defaultDeviceMatches = false;
+    bool dolbyAtmosAvailable = false;
+    bool useTvVolume = false;
+};
+
+// Feeds the default endpoint reported by a backend into the routing state
+// machine and executes the commands it emits: pinning or restoring the
+// endpoint volume and publishing the status.
+//
+// While routing targets the TV the endpoint volume is held at 100%. Volume
+// notifications from the backend go through a VolumePinPolicy, and drift
+// caused by other applications is corrected on the worker thread.
+//
+// All endpoint work runs on the router's own worker thread. Backend
+// notifications are debounced so a burst of them causes a single refresh.
+class AudioRouter : private IAudioEndpointEvents
+{
+public:
+    using PairedQuery = std::function<bool()>;
+    using StatusCallback = std::function<void()>;
+
+    static constexpr std::chrono::milliseconds DefaultDebounceWindow{ 150 };
+    static constexpr std::chrono::milliseconds DefaultMaxDelay{ 1000 };
+
+    explicit AudioRouter(IAudioEndpointBackend& backend);
+    ~AudioRouter();
+
+    AudioRouter(const AudioRouter&) = delete;
+    AudioRouter& operator=(const AudioRouter&) = delete;
+
+    // Starts the worker thread and the backend, then schedules the first refresh.
+    // isPaired is queried on the worker thread; statusChanged is invoked there
+    // whenever the routing status may have changed.
+    bool Start(
+        PairedQuery isPaired,
+        StatusCallback statusChanged,
+        CoalescingWorkQueue::Clock::duration debounceWindow = DefaultDebounceWindow,
+        CoalescingWorkQueue::Clock::duration maxDelay = DefaultMaxDelay);
+
+    // Stops the backend and the worker thread.
+    void Stop();
+
+    // Replaces the device name matcher and re-evaluates the default endpoint.
+    void SetHintMatcher(EndpointCapabilityCache::HintMatcher matcher);
+
+    // Sets whether the TV is only used while Dolby Atmos is available.
+    void SetOnlyWhenDolbyAtmos(bool value);
+
+    // Re-evaluates routing, e.g. after pairing state changed.
+    void RequestRoutingUpdate();
+
+    // Returns true while volume keys should be sent to the TV. Lock-free.
+    bool IsTvVolumeActive() const;
+
+    // Returns a copy of the current routing state.
+    AudioRoutingStatus GetStatus() const;
+
+    // Sets the master volume of the current default endpoint. Safe to call
+    // from any thread; it never waits for an endpoint switch.
+    bool SetEndpointVolume(float level);
+
+    // Returns the endpoint capability cache, mainly for statistics.
+    const EndpointCapabilityCache& GetCapabilityCache() const;
+
+    // Returns the notification queue, mainly for statistics.
+    const CoalescingWorkQueue& GetRefreshQueue() const;
+
+    // Returns the number of volume drifts corrected and suppressed so far.
+    void GetVolumePinCounts(uint64_t& repins, uint64_t& suppressed) const;
+
+private:
+    // IAudioEndpointEvents
+    void OnDefaultEndpointChanged() override;
+    void OnEndpointAdded(const std::wstring& endpointId) override;
+    void OnEndpointRemoved(const std::wstring& endpointId) override;
+    void OnEndpointStateChanged(const std::wstring& endpointId) override;
+    void OnEndpointPropertyChanged(
+        const std::wstring& endpointId,
+        EndpointPropertyChange change) override;
+    void OnEndpointVolumeChanged(float level, bool ownChange) override;
+
+    void ProcessWork(uint32_t workFlags);
+    void PinEndpointVolume();
+    void RefreshDefaultEndpoint();
+    void UpdateRouting();
+
+    IAudioEndpointBackend& backend;
+    EndpointCapabilityCache capabilities;
+    CoalescingWorkQueue refreshQueue;
+
+    PairedQuery isPaired;
+    StatusCallback statusChanged;
+
+    std::atomic<bool> onlyWhenDolbyAtmos;
+    std::atomic<bool> useTvVolume;
+
+    mutable std::mutex statusMutex;
+    AudioRoutingStatus status;
+
+    // Shared between the backend notification thread and the worker thread.
+    mutable std::mutex pinMutex;
+    VolumePinPolicy volumePin;
+
+    // Only touched on the worker thread.
+    RoutingStateMachine routing;
+    std::wstring volumeEndpointId;
+    bool volumeEndpointSelected;
+    bool endpointMatches;
+    bool endpointDolbyAtmos;
+    bool statusDirty;
+    // Level the endpoint had before it was pinned; restored once.
+    bool previousVolumeSaved;
+    float previousVolumeScalar;
+};
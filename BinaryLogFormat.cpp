@@ -0,0 +1,947 @@
+#include "BinaryLogFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+#ifdef _WIN32
+    // The MSVC wide printf functions read %s and %c as wide, %S and %C as narrow.
+    constexpr bool PlainStringIsWide = true;
+#else
+    constexpr bool PlainStringIsWide = false;
+#endif
+
+    constexpr size_t MaxEncodedStringLength = 0xFFFF;
+
+    size_t GetStoredSize(LogArgumentType type)
+    {
+        switch (type)
+        {
+        case LogArgumentType::Int32:
+        case LogArgumentType::UInt32:
+        case LogArgumentType::WideCharacter:
+            return 4;
+        case LogArgumentType::WideString:
+        case LogArgumentType::NarrowString:
+            return 2;
+        default:
+            return 8;
+        }
+    }
+
+    template <typename Value>
+    void Store(uint8_t* buffer, size_t& offset, Value value)
+    {
+        std::memcpy(buffer + offset, &value, sizeof(value));
+        offset += sizeof(value);
+    }
+
+    template <typename Value>
+    void Append(std::string& output, Value value)
+    {
+        output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename Value>
+    bool Load(const uint8_t* data, size_t size, size_t& offset, Value& value)
+    {
+        if (size - offset < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    template <typename Char>
+    bool IsFlag(Char character)
+    {
+        return character == '-' || character == '+' || character == ' ' || character == '#' || character == '0';
+    }
+
+    template <typename Char>
+    bool ParseFormat(const Char* format, size_t length, std::vector<LogConversion>& conversions)
+    {
+        conversions.clear();
+        size_t argumentCount = 0;
+
+        for (size_t index = 0; index < length; ++index)
+        {
+            if (format[index] != '%')
+            {
+                continue;
+            }
+
+            LogConversion conversion{};
+            conversion.start = index++;
+
+            while (index < length && IsFlag(format[index]))
+            {
+                conversion.options += static_cast<char>(format[index++]);
+            }
+
+            if (index < length && format[index] == '*')
+            {
+                conversion.widthArgument = true;
+                conversion.options += '*';
+                ++index;
+            }
+            while (index < length && format[index] >= '0' && format[index] <= '9')
+            {
+                conversion.options += static_cast<char>(format[index++]);
+            }
+
+            if (index < length && format[index] == '.')
+            {
+                conversion.options += '.';
+                ++index;
+                if (index < length && format[index] == '*')
+                {
+                    conversion.precisionArgument = true;
+                    conversion.options += '*';
+                    ++index;
+                }
+                while (index < length && format[index] >= '0' && format[index] <= '9')
+                {
+                    conversion.options += static_cast<char>(format[index++]);
+                }
+            }
+
+            // Length modifier.
+            std::string modifier;
+            auto matches = [&](const char* text)
+            {
+                size_t textLength = std::strlen(text);
+                if (length - index < textLength)
+                {
+                    return false;
+                }
+                for (size_t offset = 0; offset < textLength; ++offset)
+                {
+                    if (format[index + offset] != static_cast<Char>(text[offset]))
+                    {
+                        return false;
+                    }
+                }
+                modifier = text;
+                index += textLength;
+                return true;
+            };
+            matches("hh") || matches("h") || matches("ll") || matches("l") || matches("I64") ||
+                matches("I32") || matches("I") || matches("z") || matches("j") || matches("t") ||
+                matches("w") || matches("L");
+
+            if (index >= length || format[index] >= 0x80)
+            {
+                return false;
+            }
+
+            conversion.conversion = static_cast<char>(format[index]);
+            conversion.length = index + 1 - conversion.start;
+
+            bool isLong = (modifier == "l");
+            bool isLongLong = (modifier == "ll" || modifier == "I64" || modifier == "j");
+            bool isSize = (modifier == "z" || modifier == "I" || modifier == "t");
+            if (modifier == "h" || modifier == "hh")
+            {
+                conversion.shortModifier = modifier;
+            }
+
+            switch (conversion.conversion)
+            {
+            case '%':
+                if (!conversion.options.empty() || !modifier.empty())
+                {
+                    return false;
+                }
+                break;
+            case 'd':
+            case 'i':
+                conversion.type = isLongLong ? LogArgumentType::Int64
+                    : isLong ? LogArgumentType::Long
+                    : isSize ? LogArgumentType::Size
+                    : LogArgumentType::Int32;
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                conversion.type = isLongLong ? LogArgumentType::UInt64
+                    : isLong ? LogArgumentType::UnsignedLong
+                    : isSize ? LogArgumentType::Size
+                    : LogArgumentType::UInt32;
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (modifier == "L")
+                {
+                    return false;
+                }
+                conversion.type = LogArgumentType::Double;
+                break;
+            case 'p':
+                conversion.type = LogArgumentType::Pointer;
+                break;
+            case 's':
+            case 'S':
+            {
+                bool wide = (conversion.conversion == 's') ? PlainStringIsWide : !PlainStringIsWide;
+                if (modifier == "l" || modifier == "w")
+                {
+                    wide = true;
+                }
+                else if (modifier == "h")
+                {
+                    wide = false;
+                }
+                conversion.shortModifier.clear();
+                conversion.type = wide ? LogArgumentType::WideString : LogArgumentType::NarrowString;
+                break;
+            }
+            case 'c':
+            case 'C':
+                conversion.shortModifier.clear();
+                conversion.type = LogArgumentType::WideCharacter;
+                break;
+            default:
+                return false;
+            }
+
+            if (conversion.conversion != '%')
+            {
+                argumentCount += 1 + (conversion.widthArgument ? 1 : 0) + (conversion.precisionArgument ? 1 : 0);
+                if (argumentCount > MaxLogArguments)
+                {
+                    return false;
+                }
+            }
+
+            conversions.push_back(std::move(conversion));
+        }
+
+        return true;
+    }
+
+    void AppendUtf8(std::string& output, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            output += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            output += static_cast<char>(0xC0 | (codePoint >> 6));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            output += static_cast<char>(0xE0 | (codePoint >> 12));
+            output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            output += static_cast<char>(0xF0 | (codePoint >> 18));
+            output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    template <typename Value>
+    int FormatInto(char* buffer, size_t size, const std::string& specification, const int* starArguments, size_t starCount, Value value)
+    {
+        if (starCount == 2)
+        {
+            return std::snprintf(buffer, size, specification.c_str(), starArguments[0], starArguments[1], value);
+        }
+        if (starCount == 1)
+        {
+            return std::snprintf(buffer, size, specification.c_str(), starArguments[0], value);
+        }
+        return std::snprintf(buffer, size, specification.c_str(), value);
+    }
+
+    // Formats a single value with a rebuilt narrow conversion specification.
+    // Recorded strings can be longer than the stack buffer, so those are
+    // formatted a second time straight into the output.
+    template <typename Value>
+    void AppendFormatted(std::string& output, const std::string& specification, const int* starArguments, size_t starCount, Value value)
+    {
+        char buffer[512];
+        int written = FormatInto(buffer, sizeof(buffer), specification, starArguments, starCount, value);
+        if (written <= 0)
+        {
+            return;
+        }
+
+        if (static_cast<size_t>(written) < sizeof(buffer))
+        {
+            output.append(buffer, static_cast<size_t>(written));
+            return;
+        }
+
+        size_t start = output.size();
+        output.resize(start + static_cast<size_t>(written) + 1);
+        FormatInto(&output[start], static_cast<size_t>(written) + 1, specification, starArguments, starCount, value);
+        output.resize(start + static_cast<size_t>(written));
+    }
+
+    // Reads one stored argument; false when the data ends early.
+    struct StoredArgument
+    {
+        uint64_t integer;
+        double real;
+        std::string text;
+    };
+
+    bool ReadArgument(LogArgumentType type, const uint8_t* data, size_t size, size_t& offset, StoredArgument& argument)
+    {
+        switch (type)
+        {
+        case LogArgumentType::Int32:
+        {
+            int32_t value = 0;
+            if (!Load(data, size, offset, value))
+            {
+                return false;
+            }
+            argument.integer = static_cast<uint64_t>(static_cast<int64_t>(value));
+            return true;
+        }
+        case LogArgumentType::UInt32:
+        case LogArgumentType::WideCharacter:
+        {
+            uint32_t value = 0;
+            if (!Load(data, size, offset, value))
+            {
+                return false;
+            }
+            argument.integer = value;
+            return true;
+        }
+        case LogArgumentType::Double:
+            return Load(data, size, offset, argument.real);
+        case LogArgumentType::WideString:
+        case LogArgumentType::NarrowString:
+        {
+            uint16_t length = 0;
+            if (!Load(data, size, offset, length))
+            {
+                return false;
+            }
+
+            size_t bytes = (type == LogArgumentType::WideString) ? length * sizeof(char16_t) : length;
+            if (size - offset < bytes)
+            {
+                return false;
+            }
+
+            if (type == LogArgumentType::WideString)
+            {
+                std::u16string wide(length, u'\0');
+                std::memcpy(&wide[0], data + offset, bytes);
+                argument.text = ConvertUtf16ToUtf8(wide.data(), wide.size());
+            }
+            else
+            {
+                argument.text.assign(reinterpret_cast<const char*>(data + offset), bytes);
+            }
+            offset += bytes;
+            return true;
+        }
+        default:
+            return Load(data, size, offset, argument.integer);
+        }
+    }
+}
+
+const char* GetLogLevelName(uint32_t level)
+{
+    switch (level)
+    {
+    case LogLevelDebug:
+        return "DEBUG";
+    case LogLevelInfo:
+        return "INFO";
+    case LogLevelWarning:
+        return "WARNING";
+    default:
+        return "ERROR";
+    }
+}
+
+bool ParseLogFormat(const wchar_t* format, std::vector<LogConversion>& conversions)
+{
+    return format != nullptr && ParseFormat(format, std::char_traits<wchar_t>::length(format), conversions);
+}
+
+bool ParseLogFormat(const std::u16string& format, std::vector<LogConversion>& conversions)
+{
+    return ParseFormat(format.data(), format.size(), conversions);
+}
+
+size_t GetLogArgumentTypes(const std::vector<LogConversion>& conversions, LogArgumentType* types)
+{
+    size_t count = 0;
+    for (const LogConversion& conversion : conversions)
+    {
+        if (conversion.conversion == '%')
+        {
+            continue;
+        }
+        if (conversion.widthArgument && count < MaxLogArguments)
+        {
+            types[count++] = LogArgumentType::Int32;
+        }
+        if (conversion.precisionArgument && count < MaxLogArguments)
+        {
+            types[count++] = LogArgumentType::Int32;
+        }
+        if (count < MaxLogArguments)
+        {
+            types[count++] = conversion.type;
+        }
+    }
+    return count;
+}
+
+size_t EncodeLogArguments(
+    const LogArgumentType* types,
+    size_t count,
+    va_list arguments,
+    uint8_t* buffer,
+    size_t capacity)
+{
+    // Room still needed by the fixed-size arguments after the current one,
+    // so a long string cannot squeeze them out.
+    size_t reserved = 0;
+    for (size_t index = 0; index < count; ++index)
+    {
+        reserved += GetStoredSize(types[index]);
+    }
+    if (reserved > capacity)
+    {
+        return 0;
+    }
+
+    size_t offset = 0;
+    for (size_t index = 0; index < count; ++index)
+    {
+        LogArgumentType type = types[index];
+        reserved -= GetStoredSize(type);
+
+        switch (type)
+        {
+        case LogArgumentType::Int32:
+            Store(buffer, offset, static_cast<int32_t>(va_arg(arguments, int)));
+            break;
+        case LogArgumentType::UInt32:
+            Store(buffer, offset, static_cast<uint32_t>(va_arg(arguments, unsigned int)));
+            break;
+        case LogArgumentType::Int64:
+            Store(buffer, offset, static_cast<int64_t>(va_arg(arguments, long long)));
+            break;
+        case LogArgumentType::UInt64:
+            Store(buffer, offset, static_cast<uint64_t>(va_arg(arguments, unsigned long long)));
+            break;
+        case LogArgumentType::Long:
+            Store(buffer, offset, static_cast<int64_t>(va_arg(arguments, long)));
+            break;
+        case LogArgumentType::UnsignedLong:
+            Store(buffer, offset, static_cast<uint64_t>(va_arg(arguments, unsigned long)));
+            break;
+        case LogArgumentType::Size:
+            Store(buffer, offset, static_cast<uint64_t>(va_arg(arguments, size_t)));
+            break;
+        case LogArgumentType::Double:
+            Store(buffer, offset, va_arg(arguments, double));
+            break;
+        case LogArgumentType::Pointer:
+            Store(buffer, offset, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(va_arg(arguments, void*))));
+            break;
+        case LogArgumentType::WideCharacter:
+            Store(buffer, offset, static_cast<uint32_t>(va_arg(arguments, int)));
+            break;
+        case LogArgumentType::WideString:
+        {
+            const wchar_t* text = va_arg(arguments, const wchar_t*);
+            if (text == nullptr)
+            {
+                text = L"(null)";
+            }
+            offset += EncodeLogWideString(
+                text, std::char_traits<wchar_t>::length(text), buffer + offset, capacity - offset - reserved);
+            break;
+        }
+        case LogArgumentType::NarrowString:
+        {
+            const char* text = va_arg(arguments, const char*);
+            if (text == nullptr)
+            {
+                text = "(null)";
+            }
+            size_t length = (std::min)({ std::strlen(text), MaxEncodedStringLength, capacity - offset - reserved - 2 });
+            Store(buffer, offset, static_cast<uint16_t>(length));
+            std::memcpy(buffer + offset, text, length);
+            offset += length;
+            break;
+        }
+        }
+    }
+
+    return offset;
+}
+
+size_t EncodeLogWideString(const wchar_t* text, size_t length, uint8_t* buffer, size_t capacity)
+{
+    if (capacity < 2)
+    {
+        return 0;
+    }
+
+    length = (std::min)({ length, MaxEncodedStringLength, (capacity - 2) / sizeof(char16_t) });
+    size_t offset = 0;
+    Store(buffer, offset, static_cast<uint16_t>(length));
+
+    if constexpr (sizeof(wchar_t) == sizeof(char16_t))
+    {
+        std::memcpy(buffer + offset, text, length * sizeof(char16_t));
+        offset += length * sizeof(char16_t);
+    }
+    else
+    {
+        for (size_t index = 0; index < length; ++index)
+        {
+            uint32_t unit = static_cast<uint32_t>(text[index]);
+            Store(buffer, offset, static_cast<char16_t>(unit > 0xFFFF ? 0xFFFD : unit));
+        }
+    }
+    return offset;
+}
+
+std::string FormatLogMessage(
+    const std::u16string& format,
+    const LogArgumentType* types,
+    size_t count,
+    const uint8_t* data,
+    size_t length)
+{
+    std::vector<LogConversion> conversions;
+    if (!ParseLogFormat(format, conversions))
+    {
+        return ConvertUtf16ToUtf8(format.data(), format.size());
+    }
+
+    std::string output;
+    size_t position = 0;
+    size_t typeIndex = 0;
+    size_t offset = 0;
+    bool complete = true;
+
+    for (const LogConversion& conversion : conversions)
+    {
+        output += ConvertUtf16ToUtf8(format.data() + position, conversion.start - position);
+        position = conversion.start + conversion.length;
+
+        if (conversion.conversion == '%')
+        {
+            output += '%';
+            continue;
+        }
+
+        int starArguments[2]{};
+        size_t starCount = 0;
+        StoredArgument argument{};
+        size_t needed = 1 + (conversion.widthArgument ? 1 : 0) + (conversion.precisionArgument ? 1 : 0);
+        if (!complete || typeIndex + needed > count)
+        {
+            complete = false;
+            output += "<?>";
+            continue;
+        }
+
+        for (size_t star = 0; star + 1 < needed; ++star)
+        {
+            if (!ReadArgument(types[typeIndex++], data, length, offset, argument))
+            {
+                complete = false;
+                break;
+            }
+            starArguments[starCount++] = static_cast<int>(static_cast<int64_t>(argument.integer));
+        }
+
+        LogArgumentType type = types[typeIndex++];
+        if (!complete || !ReadArgument(type, data, length, offset, argument))
+        {
+            complete = false;
+            output += "<?>";
+            continue;
+        }
+
+        std::string specification = "%" + conversion.options;
+        switch (type)
+        {
+        case LogArgumentType::Double:
+            AppendFormatted(output, specification + conversion.conversion, starArguments, starCount, argument.real);
+            break;
+        case LogArgumentType::Pointer:
+            AppendFormatted(output, "%016llX", starArguments, 0, static_cast<unsigned long long>(argument.integer));
+            break;
+        case LogArgumentType::WideString:
+        case LogArgumentType::NarrowString:
+            AppendFormatted(output, specification + 's', starArguments, starCount, argument.text.c_str());
+            break;
+        case LogArgumentType::WideCharacter:
+        {
+            std::string character;
+            AppendUtf8(character, static_cast<uint32_t>(argument.integer));
+            AppendFormatted(output, specification + 's', starArguments, starCount, character.c_str());
+            break;
+        }
+        case LogArgumentType::Int32:
+        case LogArgumentType::UInt32:
+            if (conversion.conversion == 'd' || conversion.conversion == 'i')
+            {
+                AppendFormatted(output, specification + conversion.shortModifier + conversion.conversion,
+                    starArguments, starCount, static_cast<int>(static_cast<int64_t>(argument.integer)));
+            }
+            else
+            {
+                AppendFormatted(output, specification + conversion.shortModifier + conversion.conversion,
+                    starArguments, starCount, static_cast<unsigned int>(argument.integer));
+            }
+            break;
+        default:
+            if (conversion.conversion == 'd' || conversion.conversion == 'i')
+            {
+                AppendFormatted(output, specification + "ll" + conversion.conversion,
+                    starArguments, starCount, static_cast<long long>(argument.integer));
+            }
+            else
+            {
+                AppendFormatted(output, specification + "ll" + conversion.conversion,
+                    starArguments, starCount, static_cast<unsigned long long>(argument.integer));
+            }
+            break;
+        }
+    }
+
+    output += ConvertUtf16ToUtf8(format.data() + position, format.size() - position);
+    return output;
+}
+
+void AppendBinaryLogHeader(std::string& output)
+{
+    output.append(BinaryLogMagic, sizeof(BinaryLogMagic));
+    Append(output, BinaryLogVersion);
+    Append(output, static_cast<uint32_t>(0));
+}
+
+void AppendBinaryLogSession(std::string& output, uint64_t timestamp, uint32_t processId)
+{
+    Append(output, static_cast<uint8_t>(BinaryLogBlockSession));
+    Append(output, timestamp);
+    Append(output, processId);
+}
+
+void AppendBinaryLogSite(
+    std::string& output,
+    uint32_t siteId,
+    uint32_t level,
+    const LogArgumentType* types,
+    size_t count,
+    const wchar_t* format)
+{
+    Append(output, static_cast<uint8_t>(BinaryLogBlockSite));
+    Append(output, siteId);
+    Append(output, static_cast<uint8_t>(level));
+    Append(output, static_cast<uint8_t>(count));
+    for (size_t index = 0; index < count; ++index)
+    {
+        Append(output, static_cast<uint8_t>(types[index]));
+    }
+
+    size_t length = std::char_traits<wchar_t>::length(format);
+    Append(output, static_cast<uint32_t>(length));
+    for (size_t index = 0; index < length; ++index)
+    {
+        uint32_t unit = static_cast<uint32_t>(format[index]);
+        Append(output, static_cast<char16_t>(unit > 0xFFFF ? 0xFFFD : unit));
+    }
+}
+
+void AppendBinaryLogEntry(
+    std::string& output,
+    uint32_t siteId,
+    uint64_t timestamp,
+    uint32_t threadId,
+    const uint8_t* data,
+    size_t length)
+{
+    length = (std::min)(length, static_cast<size_t>(0xFFFF));
+    Append(output, static_cast<uint8_t>(BinaryLogBlockEntry));
+    Append(output, siteId);
+    Append(output, timestamp);
+    Append(output, threadId);
+    Append(output, static_cast<uint16_t>(length));
+    output.append(reinterpret_cast<const char*>(data), length);
+}
+
+void AppendBinaryLogDropped(std::string& output, uint64_t timestamp, uint64_t count)
+{
+    Append(output, static_cast<uint8_t>(BinaryLogBlockDropped));
+    Append(output, timestamp);
+    Append(output, count);
+}
+
+size_t GetBinaryLogBlockSize(const uint8_t* data, size_t available)
+{
+    if (available == 0)
+    {
+        return 0;
+    }
+
+    size_t size = 0;
+    switch (data[0])
+    {
+    case BinaryLogBlockSession:
+        size = 1 + sizeof(uint64_t) + sizeof(uint32_t);
+        break;
+    case BinaryLogBlockSite:
+    {
+        // kind, siteId, level, argumentCount, types, formatLength, format
+        size_t offset = 1 + sizeof(uint32_t) + 1;
+        if (available < offset + 1)
+        {
+            return 0;
+        }
+        offset += 1 + data[offset];
+
+        uint32_t length = 0;
+        if (!Load(data, available, offset, length))
+        {
+            return 0;
+        }
+        size = offset + static_cast<size_t>(length) * sizeof(char16_t);
+        break;
+    }
+    case BinaryLogBlockEntry:
+    {
+        size_t offset = 1 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+        uint16_t length = 0;
+        if (!Load(data, available, offset, length))
+        {
+            return 0;
+        }
+        size = offset + length;
+        break;
+    }
+    case BinaryLogBlockDropped:
+        size = 1 + sizeof(uint64_t) + sizeof(uint64_t);
+        break;
+    case BinaryLogBlockPadding:
+        return 1;
+    default:
+        return 0;
+    }
+
+    return (size <= available) ? size : 0;
+}
+
+std::string ConvertUtf16ToUtf8(const char16_t* text, size_t length)
+{
+    std::string output;
+    output.reserve(length);
+
+    for (size_t index = 0; index < length; ++index)
+    {
+        uint32_t unit = text[index];
+        if (unit >= 0xD800 && unit <= 0xDBFF && index + 1 < length &&
+            text[index + 1] >= 0xDC00 && text[index + 1] <= 0xDFFF)
+        {
+            unit = 0x10000 + ((unit - 0xD800) << 10) + (text[index + 1] - 0xDC00);
+            ++index;
+        }
+        else if (unit >= 0xD800 && unit <= 0xDFFF)
+        {
+            unit = 0xFFFD;
+        }
+        AppendUtf8(output, unit);
+    }
+    return output;
+}
+
+BinaryLogDecoder::BinaryLogDecoder()
+    : headerSeen(false),
+    entryCount(0),
+    droppedCount(0),
+    sessionCount(0),
+    unknownSiteCount(0)
+{
+}
+
+size_t BinaryLogDecoder::Decode(const uint8_t* data, size_t size, const LineHandler& onLine, bool& valid)
+{
+    valid = true;
+    size_t offset = 0;
+
+    if (!headerSeen)
+    {
+        if (size < BinaryLogHeaderSize)
+        {
+            return 0;
+        }
+
+        uint32_t version = 0;
+        std::memcpy(&version, data + sizeof(BinaryLogMagic), sizeof(version));
+        if (std::memcmp(data, BinaryLogMagic, sizeof(BinaryLogMagic)) != 0 || version != BinaryLogVersion)
+        {
+            valid = false;
+            return 0;
+        }
+
+        headerSeen = true;
+        offset = BinaryLogHeaderSize;
+    }
+
+    while (offset < size)
+    {
+        size_t blockStart = offset;
+        uint8_t kind = data[offset++];
+        bool complete = false;
+
+        switch (kind)
+        {
+        case BinaryLogBlockSession:
+        {
+            uint64_t timestamp = 0;
+            uint32_t processId = 0;
+            complete = Load(data, size, offset, timestamp) && Load(data, size, offset, processId);
+            if (complete)
+            {
+                sites.clear();
+                ++sessionCount;
+                onLine(Line{ timestamp, 0, LogLevelInfo,
+                    "[Logging] Session started (process " + std::to_string(processId) + ")" });
+            }
+            break;
+        }
+        case BinaryLogBlockSite:
+        {
+            uint32_t siteId = 0;
+            uint8_t level = 0;
+            uint8_t count = 0;
+            complete = Load(data, size, offset, siteId) && Load(data, size, offset, level) &&
+                Load(data, size, offset, count) && size - offset >= count;
+            if (!complete)
+            {
+                break;
+            }
+
+            Site site{};
+            site.level = level;
+            for (uint8_t index = 0; index < count; ++index)
+            {
+                site.types.push_back(static_cast<LogArgumentType>(data[offset++]));
+            }
+
+            uint32_t length = 0;
+            complete = Load(data, size, offset, length) && (size - offset) / sizeof(char16_t) >= length;
+            if (!complete)
+            {
+                break;
+            }
+
+            site.format.resize(length);
+            std::memcpy(&site.format[0], data + offset, length * sizeof(char16_t));
+            offset += length * sizeof(char16_t);
+            sites[siteId] = std::move(site);
+            break;
+        }
+        case BinaryLogBlockEntry:
+        {
+            uint32_t siteId = 0;
+            uint64_t timestamp = 0;
+            uint32_t threadId = 0;
+            uint16_t length = 0;
+            complete = Load(data, size, offset, siteId) && Load(data, size, offset, timestamp) &&
+                Load(data, size, offset, threadId) && Load(data, size, offset, length) &&
+                size - offset >= length;
+            if (!complete)
+            {
+                break;
+            }
+
+            ++entryCount;
+            auto site = sites.find(siteId);
+            if (site == sites.end())
+            {
+                ++unknownSiteCount;
+                onLine(Line{ timestamp, threadId, LogLevelWarning,
+                    "[Logging] Entry for unknown site " + std::to_string(siteId) });
+            }
+            else
+            {
+                onLine(Line{ timestamp, threadId, site->second.level,
+                    FormatLogMessage(site->second.format, site->second.types.data(), site->second.types.size(),
+                        data + offset, length) });
+            }
+            offset += length;
+            break;
+        }
+        case BinaryLogBlockDropped:
+        {
+            uint64_t timestamp = 0;
+            uint64_t count = 0;
+            complete = Load(data, size, offset, timestamp) && Load(data, size, offset, count);
+            if (complete)
+            {
+                droppedCount += count;
+                onLine(Line{ timestamp, 0, LogLevelWarning,
+                    "[Logging] Log queue full; dropped " + std::to_string(count) + " line(s)" });
+            }
+            break;
+        }
+        default:
+            valid = false;
+            return blockStart;
+        }
+
+        if (!complete)
+        {
+            return blockStart;
+        }
+    }
+
+    return offset;
+}
+
+uint64_t BinaryLogDecoder::GetEntryCount() const
+{
+    return entryCount;
+}
+
+uint64_t BinaryLogDecoder::GetDroppedCount() const
+{
+    return droppedCount;
+}
+
+uint64_t BinaryLogDecoder::GetSessionCount() const
+{
+    return sessionCount;
+}
+
+uint64_t BinaryLogDecoder::GetUnknownSiteCount() const
+{
+    return unknownSiteCount;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binary log file layout shared by the application and the log decoder.
+//
+// Log calls do not format text. Each distinct format string is registered
+// once as a site; a log entry then carries only the site ID and the raw bytes
+// of its arguments, and the decoder rebuilds the text offline.
+//
+// A file starts with a header and is followed by blocks. Every block begins
+// with a one-byte BinaryLogBlock kind. All integers are little-endian.
+//   Header  "LGTVBLOG", uint32 version, uint32 reserved
+//   Session uint64 timestamp, uint32 processId
+//   Site    uint32 siteId, uint8 level, uint8 argumentCount,
+//           argumentCount x uint8 LogArgumentType,
+//           uint32 formatLength, formatLength x UTF-16 code unit
+//   Entry   uint32 siteId, uint64 timestamp, uint32 threadId,
+//           uint16 dataLength, dataLength bytes of arguments
+//   Dropped uint64 timestamp, uint64 count
+//   Padding the rest of a LogRing's ring area is unused (ring files only)
+// Site IDs are only valid within the session that defined them. Timestamps
+// are FILETIME values (100 ns units since 1601-01-01 UTC).
+//
+// Argument encoding: 32-bit integers use 4 bytes; 64-bit integers, longs,
+// sizes, pointers and doubles use 8; characters use 4; strings use a uint16
+// length followed by UTF-16 code units (wide) or bytes (narrow).
+
+constexpr char BinaryLogMagic[8] = { 'L', 'G', 'T', 'V', 'B', 'L', 'O', 'G' };
+constexpr uint32_t BinaryLogVersion = 1;
+constexpr size_t BinaryLogHeaderSize = 16;
+
+// Most arguments a recordable format string may consume.
+constexpr size_t MaxLogArguments = 16;
+
+enum BinaryLogBlock : uint8_t
+{
+    BinaryLogBlockSession = 1,
+    BinaryLogBlockSite = 2,
+    BinaryLogBlockEntry = 3,
+    BinaryLogBlockDropped = 4,
+    BinaryLogBlockPadding = 5
+};
+
+enum LogLevel : uint8_t
+{
+    LogLevelDebug,
+    LogLevelInfo,
+    LogLevelWarning,
+    LogLevelError
+};
+
+// How one argument is read from the va_list and stored.
+enum class LogArgumentType : uint8_t
+{
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Long,
+    UnsignedLong,
+    Size,
+    Double,
+    Pointer,
+    WideString,
+    NarrowString,
+    WideCharacter
+};
+
+// One conversion specification in a format string.
+struct LogConversion
+{
+    size_t start;
+    size_t length;
+    // Flags, width and precision as written, e.g. "-08" or ".2".
+    std::string options;
+    // h or hh when present; the decoder keeps them for integer conversions.
+    std::string shortModifier;
+    char conversion;
+    bool widthArgument;
+    bool precisionArgument;
+    LogArgumentType type;
+};
+
+const char* GetLogLevelName(uint32_t level);
+
+// Parses the conversions of a wide printf format string, reading %s and %c
+// the way the platform's wide printf functions do. Returns false when the
+// format uses something the binary log cannot record (%n, unknown
+// conversions or more than MaxLogArguments arguments).
+bool ParseLogFormat(const wchar_t* format, std::vector<LogConversion>& conversions);
+bool ParseLogFormat(const std::u16string& format, std::vector<LogConversion>& conversions);
+
+// Flattens conversions into the argument types they consume in order.
+// Returns the number of types written to types (at most MaxLogArguments).
+size_t GetLogArgumentTypes(const std::vector<LogConversion>& conversions, LogArgumentType* types);
+
+// Copies the arguments described by types from the va_list into buffer.
+// Strings are truncated so that every argument still fits. Returns the number
+// of bytes written.
+size_t EncodeLogArguments(
+    const LogArgumentType* types,
+    size_t count,
+    va_list arguments,
+    uint8_t* buffer,
+    size_t capacity);
+
+// Encodes one wide string argument; used for lines that are formatted eagerly.
+size_t EncodeLogWideString(const wchar_t* text, size_t length, uint8_t* buffer, size_t capacity);
+
+// Rebuilds a message from its format string and encoded arguments.
+std::string FormatLogMessage(
+    const std::u16string& format,
+    const LogArgumentType* types,
+    size_t count,
+    const uint8_t* data,
+    size_t length);
+
+// Block writers. Each appends one complete block to output.
+void AppendBinaryLogHeader(std::string& output);
+void AppendBinaryLogSession(std::string& output, uint64_t timestamp, uint32_t processId);
+void AppendBinaryLogSite(
+    std::string& output,
+    uint32_t siteId,
+    uint32_t level,
+    const LogArgumentType* types,
+    size_t count,
+    const wchar_t* format);
+void AppendBinaryLogEntry(
+    std::string& output,
+    uint32_t siteId,
+    uint64_t timestamp,
+    uint32_t threadId,
+    const uint8_t* data,
+    size_t length);
+void AppendBinaryLogDropped(std::string& output, uint64_t timestamp, uint64_t count);
+
+// Returns the size of the block starting at data, or 0 when available is too
+// short to tell or the block kind is unknown. A padding block reports 1.
+size_t GetBinaryLogBlockSize(const uint8_t* data, size_t available);
+
+// Converts UTF-16 text to UTF-8.
+std::string ConvertUtf16ToUtf8(const char16_t* text, size_t length);
+
+// Reads blocks from a binary log and turns entries back into text.
+class BinaryLogDecoder
+{
+public:
+    struct Line
+    {
+        uint64_t timestamp;
+        uint32_t threadId;
+        uint32_t level;
+        // UTF-8.
+        std::string message;
+    };
+
+    using LineHandler = std::function<void(const Line& line)>;
+
+    BinaryLogDecoder();
+
+    // Decodes the header, if not yet seen, and as many complete blocks as
+    // data holds. Returns the number of bytes consumed; a block cut short at
+    // the end is left for the next call. Returns false in valid when the
+    // data is not a binary log or a block is malformed.
+    size_t Decode(const uint8_t* data, size_t size, const LineHandler& onLine, bool& valid);
+
+    uint64_t GetEntryCount() const;
+    uint64_t GetDroppedCount() const;
+    uint64_t GetSessionCount() const;
+    // Entries whose site was never defined in their session.
+    uint64_t GetUnknownSiteCount() const;
+
+private:
+    struct Site
+    {
+        uint32_t level;
+        std::vector<LogArgumentType> types;
+        std::u16string format;
+    };
+
+    bool headerSeen;
+    std::unordered_map<uint32_t, Site> sites;
+    uint64_t entryCount;
+    uint64_t droppedCount;
+    uint64_t sessionCount;
+    uint64_t unknownSiteCount;
+};
@@ -0,0 +1,56 @@
+#include "CallbackLatencyMonitor.h"
+
+CallbackLatencyMonitor::CallbackLatencyMonitor(Clock::duration warningThresholdValue)
+    : warningThreshold(warningThresholdValue),
+    callbackCount(0),
+    slowCount(0),
+    totalTicks(0),
+    maxTicks(0)
+{
+}
+
+bool CallbackLatencyMonitor::Record(Clock::duration elapsed)
+{
+    int64_t ticks = static_cast<int64_t>(elapsed.count());
+
+    callbackCount.fetch_add(1, std::memory_order_relaxed);
+    totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+
+    // Only the callback thread writes, so a plain compare is enough.
+    if (ticks > maxTicks.load(std::memory_order_relaxed))
+    {
+        maxTicks.store(ticks, std::memory_order_relaxed);
+    }
+
+    if (elapsed > warningThreshold)
+    {
+        slowCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+CallbackLatencyMonitor::Clock::duration CallbackLatencyMonitor::GetWarningThreshold() const
+{
+    return warningThreshold;
+}
+
+uint64_t CallbackLatencyMonitor::GetCallbackCount() const
+{
+    return callbackCount.load(std::memory_order_relaxed);
+}
+
+uint64_t CallbackLatencyMonitor::GetSlowCount() const
+{
+    return slowCount.load(std::memory_order_relaxed);
+}
+
+CallbackLatencyMonitor::Clock::duration CallbackLatencyMonitor::GetTotalTime() const
+{
+    return Clock::duration(totalTicks.load(std::memory_order_relaxed));
+}
+
+CallbackLatencyMonitor::Clock::duration CallbackLatencyMonitor::GetMaxTime() const
+{
+    return Clock::duration(maxTicks.load(std::memory_order_relaxed));
+}
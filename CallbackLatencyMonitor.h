@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Tracks how long a latency-critical callback takes. Record is called on the
+// callback's thread; the counters can be read from any thread.
+class CallbackLatencyMonitor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Callbacks that take longer than warningThreshold are counted as slow.
+    explicit CallbackLatencyMonitor(Clock::duration warningThreshold);
+
+    // Records one callback. Returns true when it exceeded the threshold.
+    bool Record(Clock::duration elapsed);
+
+    Clock::duration GetWarningThreshold() const;
+    uint64_t GetCallbackCount() const;
+    uint64_t GetSlowCount() const;
+    Clock::duration GetTotalTime() const;
+    Clock::duration GetMaxTime() const;
+
+private:
+    const Clock::duration warningThreshold;
+
+    std::atomic<uint64_t> callbackCount;
+    std::atomic<uint64_t> slowCount;
+    std::atomic<int64_t> totalTicks;
+    std::atomic<int64_t> maxTicks;
+};
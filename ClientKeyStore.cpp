@@ -0,0 +1,186 @@
+#include "ClientKeyStore.h"
+
+#include "Configuration.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    ClientKeyStore g_clientKeyStore;
+}
+
+ClientKeyStore::ClientKeyStore()
+    : path(),
+    writeMutex(),
+    loaded(false),
+    keys()
+{
+    keys.Publish(std::make_shared<const KeyMap>());
+}
+
+void ClientKeyStore::Open(const std::wstring& filePath)
+{
+    std::lock_guard<std::mutex> guard(writeMutex);
+    path = filePath;
+    loaded = false;
+    Read();
+}
+
+bool ClientKeyStore::Reload()
+{
+    std::lock_guard<std::mutex> guard(writeMutex);
+    return Read();
+}
+
+bool ClientKeyStore::Read()
+{
+    std::ifstream input{ std::filesystem::path(path) };
+    if (!input)
+    {
+        // Only a missing file means there are no keys. A file that exists
+        // but cannot be opened right now, e.g. because an editor holds it,
+        // must not replace the keys, or the next Store would drop them.
+        std::error_code error;
+        if (std::filesystem::exists(std::filesystem::path(path), error) || error)
+        {
+            return false;
+        }
+
+        keys.Publish(std::make_shared<const KeyMap>());
+        loaded = true;
+        return true;
+    }
+
+    auto read = std::make_shared<KeyMap>();
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        size_t separator = line.find('=');
+        if (separator == 0 || separator == std::string::npos || separator + 1 == line.size())
+        {
+            continue;
+        }
+        (*read)[line.substr(0, separator)] = line.substr(separator + 1);
+    }
+
+    if (input.bad())
+    {
+        return false;
+    }
+
+    keys.Publish(std::move(read));
+    loaded = true;
+    return true;
+}
+
+const std::wstring& ClientKeyStore::GetPath() const
+{
+    return path;
+}
+
+std::string ClientKeyStore::Find(const std::string& identity) const
+{
+    std::shared_ptr<const KeyMap> current = keys.Acquire();
+    auto found = current->find(identity);
+    return (found != current->end()) ? found->second : std::string();
+}
+
+bool ClientKeyStore::Contains(const std::string& identity) const
+{
+    return !identity.empty() && keys.Acquire()->count(identity) != 0;
+}
+
+bool ClientKeyStore::Store(const std::string& identity, const std::string& key)
+{
+    if (identity.empty() || key.empty() || key.find_first_of("\r\n") != std::string::npos)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(writeMutex);
+    if (!loaded && !Read())
+    {
+        return false;
+    }
+
+    KeyMap updated = *keys.Acquire();
+    updated[identity] = key;
+    return Write(updated);
+}
+
+bool ClientKeyStore::Remove(const std::string& identity)
+{
+    std::lock_guard<std::mutex> guard(writeMutex);
+    if (!loaded && !Read())
+    {
+        return false;
+    }
+
+    KeyMap updated = *keys.Acquire();
+    if (updated.erase(identity) == 0)
+    {
+        return false;
+    }
+    return Write(updated);
+}
+
+std::string ClientKeyStore::GetIdentity(const std::wstring& macAddress, const std::wstring& ipAddress)
+{
+    std::string identity;
+    for (wchar_t character : macAddress)
+    {
+        if ((character >= L'0' && character <= L'9') || (character >= L'A' && character <= L'F'))
+        {
+            identity.push_back(static_cast<char>(character));
+        }
+        else if (character >= L'a' && character <= L'f')
+        {
+            identity.push_back(static_cast<char>(character - L'a' + L'A'));
+        }
+    }
+    if (identity.size() == 12)
+    {
+        return identity;
+    }
+
+    identity = "ip:";
+    for (wchar_t character : ipAddress)
+    {
+        if (character > L' ' && character < 0x7F && character != L'=')
+        {
+            identity.push_back(static_cast<char>(character));
+        }
+    }
+    return (identity.size() > 3) ? identity : std::string();
+}
+
+bool ClientKeyStore::Write(const KeyMap& updated)
+{
+    std::string contents;
+    for (const auto& entry : updated)
+    {
+        contents += entry.first;
+        contents += '=';
+        contents += entry.second;
+        contents += '\n';
+    }
+
+    if (!WriteFileAtomically(path, contents))
+    {
+        return false;
+    }
+
+    keys.Publish(std::make_shared<const KeyMap>(updated));
+    return true;
+}
+
+ClientKeyStore& GetClientKeyStore()
+{
+    return g_clientKeyStore;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "PublishedHandle.h"
+
+// Client keys of every paired TV, kept in one file next to the executable
+// (LGTVVolumeProxy_client_keys.txt) as "<identity>=<key>" lines.
+//
+// A TV is identified by its normalized MAC address (12 upper-case hex digits)
+// or, for profiles without a MAC, by "ip:<address>". The file is read once
+// into an immutable map that Find and Contains read without locking; Store
+// and Remove write the whole file atomically and publish a new map. Reload
+// re-reads the file, e.g. when a change notification reports that it was
+// replaced, so keys copied in from another machine are picked up.
+//
+// A file that exists but cannot be read keeps the current map, and Store and
+// Remove refuse to write until it has been read once, so a transient open
+// failure never rewrites the file without the other TVs' keys.
+class ClientKeyStore
+{
+public:
+    ClientKeyStore();
+
+    ClientKeyStore(const ClientKeyStore&) = delete;
+    ClientKeyStore& operator=(const ClientKeyStore&) = delete;
+
+    // Sets the file and loads it.
+    void Open(const std::wstring& filePath);
+
+    // Re-reads the file. Safe to call from any thread. Returns false and
+    // keeps the current keys when the file exists but could not be read.
+    bool Reload();
+
+    const std::wstring& GetPath() const;
+
+    // Returns the key for a TV, or an empty string. Lock-free.
+    std::string Find(const std::string& identity) const;
+    bool Contains(const std::string& identity) const;
+
+    // Saves or removes the key for a TV. Returns false when the file could
+    // not be written; the in-memory map is then left unchanged.
+    bool Store(const std::string& identity, const std::string& key);
+    bool Remove(const std::string& identity);
+
+    // Returns the identity for a TV's MAC and IP address, or an empty string
+    // when neither is usable.
+    static std::string GetIdentity(const std::wstring& macAddress, const std::wstring& ipAddress);
+
+private:
+    using KeyMap = std::map<std::string, std::string>;
+
+    // Both require writeMutex.
+    bool Read();
+    bool Write(const KeyMap& updated);
+
+    std::wstring path;
+    std::mutex writeMutex;
+    // The file has been read, or was found missing, since Open.
+    bool loaded;
+    PublishedHandle<const KeyMap> keys;
+};
+
+// Returns the app's key store.
+ClientKeyStore& GetClientKeyStore();
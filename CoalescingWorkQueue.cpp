@@ -0,0 +1,200 @@
+#include "CoalescingWorkQueue.h"
+
+#include <algorithm>
+
+CoalescingWorkQueue::CoalescingWorkQueue()
+    : debounceWindow(Clock::duration::zero()),
+    maxDelay(Clock::duration::zero()),
+    running(false),
+    stopping(false),
+    immediatePending(false),
+    pendingFlags(0),
+    pendingPostCount(0),
+    postedCount(0),
+    processedCount(0),
+    coalescedCount(0)
+{
+}
+
+CoalescingWorkQueue::~CoalescingWorkQueue()
+{
+    Stop();
+}
+
+bool CoalescingWorkQueue::Start(
+    Clock::duration debounceWindowValue,
+    Clock::duration maxDelayValue,
+    WorkHandler handlerValue,
+    ThreadCallback threadStartValue,
+    ThreadCallback threadStopValue)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    if (running || !handlerValue)
+    {
+        return false;
+    }
+
+    handler = std::move(handlerValue);
+    threadStart = std::move(threadStartValue);
+    threadStop = std::move(threadStopValue);
+    debounceWindow = debounceWindowValue;
+    maxDelay = (std::max)(maxDelayValue, debounceWindowValue);
+
+    stopping = false;
+    immediatePending = false;
+    pendingFlags = 0;
+    pendingPostCount = 0;
+
+    try
+    {
+        worker = std::thread(&CoalescingWorkQueue::WorkerLoop, this);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void CoalescingWorkQueue::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!running)
+        {
+            return;
+        }
+        stopping = true;
+    }
+
+    wakeup.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    running = false;
+    stopping = false;
+    immediatePending = false;
+    pendingFlags = 0;
+    pendingPostCount = 0;
+}
+
+void CoalescingWorkQueue::Post(uint32_t workFlags)
+{
+    PostInternal(workFlags, false);
+}
+
+void CoalescingWorkQueue::PostImmediate(uint32_t workFlags)
+{
+    PostInternal(workFlags, true);
+}
+
+uint64_t CoalescingWorkQueue::GetPostedCount() const
+{
+    return postedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t CoalescingWorkQueue::GetProcessedCount() const
+{
+    return processedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t CoalescingWorkQueue::GetCoalescedCount() const
+{
+    return coalescedCount.load(std::memory_order_relaxed);
+}
+
+void CoalescingWorkQueue::PostInternal(uint32_t workFlags, bool immediate)
+{
+    if (workFlags == 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!running || stopping)
+        {
+            return;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (pendingPostCount == 0)
+        {
+            firstPostTime = now;
+        }
+        lastPostTime = now;
+
+        pendingFlags |= workFlags;
+        ++pendingPostCount;
+        immediatePending = immediatePending || immediate;
+    }
+
+    postedCount.fetch_add(1, std::memory_order_relaxed);
+    wakeup.notify_one();
+}
+
+void CoalescingWorkQueue::WorkerLoop()
+{
+    if (threadStart)
+    {
+        threadStart();
+    }
+
+    std::unique_lock<std::mutex> guard(mutex);
+    for (;;)
+    {
+        if (stopping)
+        {
+            break;
+        }
+
+        if (pendingFlags == 0)
+        {
+            wakeup.wait(guard);
+            continue;
+        }
+
+        if (!immediatePending)
+        {
+            // Each new post pushes the deadline out, but never beyond maxDelay
+            // from the start of the burst so a storm cannot starve the handler.
+            Clock::time_point due = (std::min)(
+                lastPostTime + debounceWindow,
+                firstPostTime + maxDelay);
+            if (Clock::now() < due)
+            {
+                wakeup.wait_until(guard, due);
+                continue;
+            }
+        }
+
+        uint32_t flags = pendingFlags;
+        uint64_t batchPosts = pendingPostCount;
+        pendingFlags = 0;
+        pendingPostCount = 0;
+        immediatePending = false;
+
+        guard.unlock();
+
+        handler(flags);
+
+        processedCount.fetch_add(1, std::memory_order_relaxed);
+        if (batchPosts > 1)
+        {
+            coalescedCount.fetch_add(batchPosts - 1, std::memory_order_relaxed);
+        }
+
+        guard.lock();
+    }
+    guard.unlock();
+
+    if (threadStop)
+    {
+        threadStop();
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Collapses bursts of posted work into a single handler call on a dedicated
+// thread. Work is identified by caller-defined flag bits that are OR-ed
+// together while the burst is still arriving.
+class CoalescingWorkQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using WorkHandler = std::function<void(uint32_t workFlags)>;
+    using ThreadCallback = std::function<void()>;
+
+    CoalescingWorkQueue();
+    ~CoalescingWorkQueue();
+
+    CoalescingWorkQueue(const CoalescingWorkQueue&) = delete;
+    CoalescingWorkQueue& operator=(const CoalescingWorkQueue&) = delete;
+
+    // Starts the worker thread. The handler runs once the queue has been quiet
+    // for debounceWindow, and at the latest maxDelay after the first post of a
+    // burst. threadStart and threadStop run on the worker thread itself.
+    bool Start(
+        Clock::duration debounceWindow,
+        Clock::duration maxDelay,
+        WorkHandler handler,
+        ThreadCallback threadStart = {},
+        ThreadCallback threadStop = {});
+
+    // Stops the worker thread and discards any work that has not run yet.
+    void Stop();
+
+    // Posts work that is processed after the debounce window.
+    void Post(uint32_t workFlags);
+
+    // Posts work that is processed as soon as the worker is free.
+    void PostImmediate(uint32_t workFlags);
+
+    // Returns the number of Post/PostImmediate calls accepted so far.
+    uint64_t GetPostedCount() const;
+
+    // Returns the number of times the handler has run.
+    uint64_t GetProcessedCount() const;
+
+    // Returns the number of posts that were folded into an earlier pending batch.
+    uint64_t GetCoalescedCount() const;
+
+private:
+    void PostInternal(uint32_t workFlags, bool immediate);
+    void WorkerLoop();
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+
+    WorkHandler handler;
+    ThreadCallback threadStart;
+    ThreadCallback threadStop;
+    Clock::duration debounceWindow;
+    Clock::duration maxDelay;
+
+    bool running;
+    bool stopping;
+    bool immediatePending;
+    uint32_t pendingFlags;
+    uint64_t pendingPostCount;
+    Clock::time_point firstPostTime;
+    Clock::time_point lastPostTime;
+
+    std::atomic<uint64_t> postedCount;
+    std::atomic<uint64_t> processedCount;
+    std::atomic<uint64_t> coalescedCount;
+};
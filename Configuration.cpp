@@ -1,25 +1,12 @@
 #include "Configuration.h"
 
 #include "framework.h"
+#include "ConfigurationSchema.h"
 #include "Logging.h"
 
-#include <cwctype>
 #include <fstream>
 #include <string>
-
-AppConfiguration::AppConfiguration()
-    : tvIpAddress(L""),
-    tvMacAddress(L""),
-    deviceNameHint(L"LG"),
-    onlyWhenDolbyAtmos(true),
-    useSecureWebSocket(true),
-    tvPort(3001),
-    showCloseToTrayMessage(true),
-    windowLeft(-1),
-    windowTop(-1),
-    hasWindowPosition(false)
-{
-}
+#include <string_view>
 
 std::wstring GetConfigurationFilePath()
 {
@@ -40,73 +27,44 @@ std::wstring GetConfigurationFilePath()
     return directory + L"LGTVVolumeProxy.ini";
 }
 
-namespace
+bool WriteFileAtomically(const std::wstring& path, const std::string& contents)
 {
-    std::string WideToUtf8(const std::wstring& value)
+    std::wstring temporaryPath = path + L".tmp";
+    HANDLE file = CreateFileW(
+        temporaryPath.c_str(),
+        GENERIC_WRITE,
+        0,
+        nullptr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE)
     {
-        if (value.empty())
-        {
-            return {};
-        }
-
-        int requiredLength = WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            value.c_str(),
-            static_cast<int>(value.size()),
-            nullptr,
-            0,
-            nullptr,
-            nullptr);
-        if (requiredLength <= 0)
-        {
-            return {};
-        }
+        LGTV_LOG_ERROR(Configuration, L"Failed to create %s: %lu", temporaryPath.c_str(), GetLastError());
+        return false;
+    }
 
-        std::string result(static_cast<size_t>(requiredLength), '\0');
-        int written = WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            value.c_str(),
-            static_cast<int>(value.size()),
-            result.data(),
-            requiredLength,
-            nullptr,
-            nullptr);
-        if (written != requiredLength)
-        {
-            result.clear();
-        }
+    DWORD written = 0;
+    bool saved =
+        WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr) &&
+        written == contents.size() &&
+        FlushFileBuffers(file);
+    DWORD error = saved ? ERROR_SUCCESS : GetLastError();
+    CloseHandle(file);
 
-        return result;
+    if (saved &&
+        !MoveFileExW(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        saved = false;
+        error = GetLastError();
     }
 
-    void Trim(std::string& value)
+    if (!saved)
     {
-        while (!value.empty()
-            && (value.back() == '\r'
-                || value.back() == '\n'
-                || std::isspace(static_cast<unsigned char>(value.back()))))
-        {
-            value.pop_back();
-        }
-
-        size_t index = 0;
-        while (index < value.size()
-            && std::isspace(static_cast<unsigned char>(value[index])))
-        {
-            ++index;
-        }
-
-        if (index > 0 && index < value.size())
-        {
-            value = value.substr(index);
-        }
-        else if (index >= value.size())
-        {
-            value.clear();
-        }
+        LGTV_LOG_ERROR(Configuration, L"Failed to replace %s: %lu", path.c_str(), error);
+        DeleteFileW(temporaryPath.c_str());
     }
+    return saved;
 }
 
 void LoadConfiguration(AppConfiguration& configuration)
@@ -115,114 +73,29 @@ void LoadConfiguration(AppConfiguration& configuration)
     std::ifstream input(path);
     if (!input)
     {
-        InfoLog(L"[Configuration] No configuration file found, using defaults");
+        LGTV_LOG_INFO(Configuration, L"No configuration file found, using defaults");
         return;
     }
 
     std::string line;
     while (std::getline(input, line))
     {
-        auto separator = line.find('=');
-        if (separator == std::string::npos)
-        {
-            continue;
-        }
-
-        std::string key = line.substr(0, separator);
-        std::string value = line.substr(separator + 1);
-
-        Trim(key);
-        Trim(value);
-
-        if (key == "tv_ip")
-        {
-            configuration.tvIpAddress.assign(value.begin(), value.end());
-        }
-        else if (key == "tv_mac")
-        {
-            configuration.tvMacAddress.assign(value.begin(), value.end());
-        }
-        else if (key == "device_hint")
-        {
-            configuration.deviceNameHint.assign(value.begin(), value.end());
-        }
-        else if (key == "only_when_atmos")
-        {
-            configuration.onlyWhenDolbyAtmos = (value == "1"
-                || value == "true"
-                || value == "True");
-        }
-        else if (key == "use_secure_websocket")
+        std::string_view key;
+        ConfigurationLineResult result = ApplyConfigurationLine(line, configuration, key);
+        if (result == ConfigurationLineResult::InvalidValue)
         {
-            configuration.useSecureWebSocket = (value == "1"
-                || value == "true"
-                || value == "True");
+            std::wstring wideKey(key.begin(), key.end());
+            LGTV_LOG_WARNING(Configuration, L"Ignoring invalid value for %s", wideKey.c_str());
         }
-        else if (key == "tv_port")
+        else if (result == ConfigurationLineResult::UnknownKey)
         {
-            try
-            {
-                int port = std::stoi(value);
-                if (port > 0 && port <= 65535)
-                {
-                    configuration.tvPort = static_cast<unsigned short>(port);
-                }
-            }
-            catch (...)
-            {
-                WarningLog(L"[Configuration] Failed to parse tv_port");
-            }
-        }
-        else if (key == "show_close_to_tray_message")
-        {
-            configuration.showCloseToTrayMessage = !(value == "0"
-                || value == "false"
-                || value == "False");
-        }
-        else if (key == "window_left")
-        {
-            try
-            {
-                configuration.windowLeft = std::stoi(value);
-                configuration.hasWindowPosition = true;
-            }
-            catch (...)
-            {
-                WarningLog(L"[Configuration] Failed to parse window_left");
-            }
-        }
-        else if (key == "window_top")
-        {
-            try
-            {
-                configuration.windowTop = std::stoi(value);
-                configuration.hasWindowPosition = true;
-            }
-            catch (...)
-            {
-                WarningLog(L"[Configuration] Failed to parse window_top");
-            }
+            std::wstring wideKey(key.begin(), key.end());
+            LGTV_LOG_DEBUG(Configuration, L"Ignoring unknown configuration key %s", wideKey.c_str());
         }
     }
 }
 
-void SaveConfiguration(const AppConfiguration& configuration)
+bool SaveConfiguration(const AppConfiguration& configuration)
 {
-    std::wstring path = GetConfigurationFilePath();
-    std::ofstream output(path, std::ios::trunc);
-    if (!output)
-    {
-        ErrorLog(L"[Configuration] Failed to open configuration file for writing");
-        return;
-    }
-
-    output << "tv_ip=" << WideToUtf8(configuration.tvIpAddress) << "\n";
-    output << "tv_mac=" << WideToUtf8(configuration.tvMacAddress) << "\n";
-    output << "device_hint=" << WideToUtf8(configuration.deviceNameHint) << "\n";
-    output << "only_when_atmos=" << (configuration.onlyWhenDolbyAtmos ? "1" : "0") << "\n";
-    output << "use_secure_websocket=" << (configuration.useSecureWebSocket ? "1" : "0") << "\n";
-    output << "tv_port=" << configuration.tvPort << "\n";
-    output << "show_close_to_tray_message=" << (configuration.showCloseToTrayMessage ? "1" : "0") << "\n";
-    output << "window_left=" << configuration.windowLeft << "\n";
-    output << "window_top=" << configuration.windowTop << "\n";
+    return WriteFileAtomically(GetConfigurationFilePath(), FormatConfiguration(configuration));
 }
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // Represents application configuration persisted on disk.
 struct AppConfiguration
 {
     std::wstring tvIpAddress;
     std::wstring tvMacAddress;
+    // ';'-separated name patterns, '!' exclusions and 'id:' pins (see DeviceNameMatcher).
     std::wstring deviceNameHint;
     bool onlyWhenDolbyAtmos;
     bool useSecureWebSocket;
@@ -15,15 +18,58 @@ struct AppConfiguration
     int windowLeft;
     int windowTop;
     bool hasWindowPosition;
+    // Extra "<chord>:<action>" key bindings on top of the volume keys (see HotkeyMap).
+    std::vector<std::wstring> hotkeyBindings;
+    // Runtime log levels, e.g. "info;Key=debug" (see ApplyLogLevels).
+    std::wstring logLevels;
+    // Named TV profiles besides the one formed by the fields above (see TvProfile).
+    std::vector<std::wstring> tvProfiles;
+    // Set by ConfigurationStore when the snapshot is published; not saved.
+    uint64_t version;
 
     AppConfiguration();
 };
 
+// Fields that differ between two configurations.
+enum ConfigurationChange : uint32_t
+{
+    ConfigurationChangeNone = 0,
+    ConfigurationChangeTvIpAddress = 0x1,
+    ConfigurationChangeTvMacAddress = 0x2,
+    ConfigurationChangeDeviceNameHint = 0x4,
+    ConfigurationChangeOnlyWhenDolbyAtmos = 0x8,
+    ConfigurationChangeUseSecureWebSocket = 0x10,
+    ConfigurationChangeTvPort = 0x20,
+    ConfigurationChangeShowCloseToTrayMessage = 0x40,
+    ConfigurationChangeWindowPosition = 0x80,
+    ConfigurationChangeHotkeyBindings = 0x100,
+    ConfigurationChangeLogLevels = 0x200,
+    ConfigurationChangeTvProfiles = 0x400,
+
+    // Changes that require a new connection to the TV.
+    ConfigurationChangeTvTransport =
+        ConfigurationChangeTvIpAddress | ConfigurationChangeTvPort | ConfigurationChangeUseSecureWebSocket,
+    // Changes that invalidate the IP/MAC verification result.
+    ConfigurationChangeTvIdentity = ConfigurationChangeTvIpAddress | ConfigurationChangeTvMacAddress
+};
+
+// Returns the ConfigurationChange flags for every field that differs, using
+// the field table in ConfigurationSchema.h. The version is not a field and is
+// ignored.
+uint32_t CompareConfigurations(const AppConfiguration& previous, const AppConfiguration& current);
+
 // Returns the full path to the configuration file.
 std::wstring GetConfigurationFilePath();
 
 // Loads configuration from disk if present and leaves defaults otherwise.
 void LoadConfiguration(AppConfiguration& configuration);
 
-// Saves configuration to disk.
-void SaveConfiguration(const AppConfiguration& configuration);
+// Replaces a file with contents so that a crash at any point leaves either the
+// old file or the new one: the contents go to a temporary file next to it, are
+// flushed to disk and only then renamed over the original.
+bool WriteFileAtomically(const std::wstring& path, const std::string& contents);
+
+// Saves configuration to disk, replacing the file atomically so a crash never
+// leaves it truncated. Blocks until the data is flushed; the app saves
+// through ConfigurationPersister to keep this off the UI thread.
+bool SaveConfiguration(const AppConfiguration& configuration);
@@ -0,0 +1,159 @@
+#include "ConfigurationPersister.h"
+
+#include <algorithm>
+
+ConfigurationPersister::ConfigurationPersister(Writer writerValue)
+    : writer(std::move(writerValue)),
+    pending(),
+    firstScheduled(),
+    deadline(),
+    writing(false),
+    stopping(false),
+    running(false),
+    writeCount(0),
+    failureCount(0)
+{
+}
+
+ConfigurationPersister::~ConfigurationPersister()
+{
+    Stop();
+}
+
+bool ConfigurationPersister::Start()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    if (running || !writer)
+    {
+        return false;
+    }
+
+    stopping = false;
+    try
+    {
+        thread = std::thread(&ConfigurationPersister::WriterLoop, this);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void ConfigurationPersister::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!running)
+        {
+            return;
+        }
+        stopping = true;
+    }
+
+    wake.notify_all();
+    thread.join();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    running = false;
+}
+
+void ConfigurationPersister::Schedule(AppConfiguration configuration)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!running)
+    {
+        lock.unlock();
+        bool written = writer && writer(configuration);
+
+        lock.lock();
+        if (written)
+        {
+            ++writeCount;
+        }
+        else
+        {
+            ++failureCount;
+        }
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (!pending)
+    {
+        firstScheduled = now;
+    }
+    pending = std::move(configuration);
+    deadline = (std::min)(now + DebounceDelay, firstScheduled + MaxDelay);
+    lock.unlock();
+
+    wake.notify_one();
+}
+
+bool ConfigurationPersister::IsPending() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return pending.has_value() || writing;
+}
+
+uint64_t ConfigurationPersister::GetWriteCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return writeCount;
+}
+
+uint64_t ConfigurationPersister::GetFailureCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return failureCount;
+}
+
+void ConfigurationPersister::WriterLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        if (!pending)
+        {
+            if (stopping)
+            {
+                break;
+            }
+            wake.wait(lock);
+            continue;
+        }
+
+        if (!stopping && Clock::now() < deadline)
+        {
+            wake.wait_until(lock, deadline);
+            continue;
+        }
+
+        AppConfiguration snapshot = std::move(*pending);
+        pending.reset();
+        writing = true;
+
+        lock.unlock();
+        bool written = writer(snapshot);
+        lock.lock();
+
+        writing = false;
+        if (written)
+        {
+            ++writeCount;
+            continue;
+        }
+
+        ++failureCount;
+        if (!pending && !stopping)
+        {
+            Clock::time_point now = Clock::now();
+            pending = std::move(snapshot);
+            firstScheduled = now;
+            deadline = now + RetryDelay;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "Configuration.h"
+
+// Saves configuration snapshots on a background thread, coalescing bursts of
+// changes into one write.
+//
+// Schedule only records the snapshot; the writer thread saves the newest one
+// once no change arrived for DebounceDelay, or after MaxDelay of continuous
+// changes. A failed write is retried after RetryDelay unless a newer snapshot
+// replaced it. Stop writes whatever is still pending before it returns, so
+// the last change survives a normal exit. If the thread cannot be started,
+// Schedule writes synchronously instead.
+//
+// The writer is SaveConfiguration in the app; it is a parameter so the
+// coalescing and retry behaviour can be driven with a writer that fails.
+class ConfigurationPersister
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Writer = std::function<bool(const AppConfiguration&)>;
+
+    static constexpr std::chrono::milliseconds DebounceDelay{ 500 };
+    static constexpr std::chrono::milliseconds MaxDelay{ 2000 };
+    static constexpr std::chrono::milliseconds RetryDelay{ 5000 };
+
+    explicit ConfigurationPersister(Writer writer);
+    ~ConfigurationPersister();
+
+    ConfigurationPersister(const ConfigurationPersister&) = delete;
+    ConfigurationPersister& operator=(const ConfigurationPersister&) = delete;
+
+    bool Start();
+    void Stop();
+
+    // Queues configuration to be saved, replacing any snapshot not yet written.
+    void Schedule(AppConfiguration configuration);
+
+    // True while a snapshot is queued or being written; the file on disk may
+    // then be older than the configuration in memory.
+    bool IsPending() const;
+
+    uint64_t GetWriteCount() const;
+    uint64_t GetFailureCount() const;
+
+private:
+    void WriterLoop();
+
+    Writer writer;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::optional<AppConfiguration> pending;
+    Clock::time_point firstScheduled;
+    Clock::time_point deadline;
+    bool writing;
+    bool stopping;
+    bool running;
+    uint64_t writeCount;
+    uint64_t failureCount;
+    std::thread thread;
+};
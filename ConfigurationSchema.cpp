@@ -0,0 +1,505 @@
+#include "ConfigurationSchema.h"
+
+#include <charconv>
+#include <iterator>
+
+namespace
+{
+    constexpr ConfigurationField TextField(
+        std::string_view key, std::wstring AppConfiguration::* member, uint32_t change,
+        std::wstring_view defaultText, bool omitDefault = false)
+    {
+        return { key, ConfigurationFieldType::Text, change,
+            member, nullptr, nullptr, nullptr, nullptr,
+            defaultText, 0, 0, 0, nullptr, omitDefault };
+    }
+
+    constexpr ConfigurationField TextListField(
+        std::string_view key, std::vector<std::wstring> AppConfiguration::* member, uint32_t change)
+    {
+        return { key, ConfigurationFieldType::TextList, change,
+            nullptr, member, nullptr, nullptr, nullptr,
+            {}, 0, 0, 0, nullptr, false };
+    }
+
+    constexpr ConfigurationField BooleanField(
+        std::string_view key, bool AppConfiguration::* member, uint32_t change, bool defaultValue)
+    {
+        return { key, ConfigurationFieldType::Boolean, change,
+            nullptr, nullptr, member, nullptr, nullptr,
+            {}, defaultValue ? 1 : 0, 0, 1, nullptr, false };
+    }
+
+    constexpr ConfigurationField IntegerField(
+        std::string_view key, int AppConfiguration::* member, uint32_t change,
+        int defaultValue, int minimum, int maximum, bool AppConfiguration::* presence = nullptr)
+    {
+        return { key, ConfigurationFieldType::Integer, change,
+            nullptr, nullptr, nullptr, member, nullptr,
+            {}, defaultValue, minimum, maximum, presence, false };
+    }
+
+    constexpr ConfigurationField PortField(
+        std::string_view key, unsigned short AppConfiguration::* member, uint32_t change, int defaultValue)
+    {
+        return { key, ConfigurationFieldType::Port, change,
+            nullptr, nullptr, nullptr, nullptr, member,
+            {}, defaultValue, 1, 65535, nullptr, false };
+    }
+
+    constexpr int MinimumCoordinate = -1000000;
+    constexpr int MaximumCoordinate = 1000000;
+
+    constexpr ConfigurationField Fields[] =
+    {
+        TextField("tv_ip", &AppConfiguration::tvIpAddress, ConfigurationChangeTvIpAddress, L""),
+        TextField("tv_mac", &AppConfiguration::tvMacAddress, ConfigurationChangeTvMacAddress, L""),
+        TextField("device_hint", &AppConfiguration::deviceNameHint, ConfigurationChangeDeviceNameHint, L"LG"),
+        BooleanField("only_when_atmos", &AppConfiguration::onlyWhenDolbyAtmos, ConfigurationChangeOnlyWhenDolbyAtmos, true),
+        BooleanField("use_secure_websocket", &AppConfiguration::useSecureWebSocket, ConfigurationChangeUseSecureWebSocket, true),
+        PortField("tv_port", &AppConfiguration::tvPort, ConfigurationChangeTvPort, 3001),
+        BooleanField("show_close_to_tray_message", &AppConfiguration::showCloseToTrayMessage,
+            ConfigurationChangeShowCloseToTrayMessage, true),
+        IntegerField("window_left", &AppConfiguration::windowLeft, ConfigurationChangeWindowPosition,
+            -1, MinimumCoordinate, MaximumCoordinate, &AppConfiguration::hasWindowPosition),
+        IntegerField("window_top", &AppConfiguration::windowTop, ConfigurationChangeWindowPosition,
+            -1, MinimumCoordinate, MaximumCoordinate, &AppConfiguration::hasWindowPosition),
+        TextListField("hotkey", &AppConfiguration::hotkeyBindings, ConfigurationChangeHotkeyBindings),
+        TextField("log_levels", &AppConfiguration::logLevels, ConfigurationChangeLogLevels, L"", true),
+        TextListField("tv_profile", &AppConfiguration::tvProfiles, ConfigurationChangeTvProfiles)
+    };
+
+    constexpr size_t FieldCount = std::size(Fields);
+
+    // Keys are looked up through a table indexed by a seeded FNV-1a hash. The
+    // seed is searched at compile time so that no two keys share a slot; a
+    // lookup is then one hash, one table read and one key comparison.
+    constexpr size_t SlotCount = 32;
+    constexpr uint8_t EmptySlot = 0xFF;
+
+    static_assert(FieldCount < SlotCount && FieldCount < EmptySlot, "Too many configuration fields for the key table");
+
+    constexpr uint32_t HashKey(std::string_view key, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char character : key)
+        {
+            hash ^= static_cast<uint8_t>(character);
+            hash *= 16777619u;
+        }
+        return hash ^ (hash >> 15);
+    }
+
+    constexpr uint32_t NoSeed = UINT32_MAX;
+
+    constexpr uint32_t FindSeed()
+    {
+        for (uint32_t seed = 0; seed < 100000; ++seed)
+        {
+            bool used[SlotCount]{};
+            bool collision = false;
+            for (size_t index = 0; index < FieldCount && !collision; ++index)
+            {
+                size_t slot = HashKey(Fields[index].key, seed) % SlotCount;
+                collision = used[slot];
+                used[slot] = true;
+            }
+            if (!collision)
+            {
+                return seed;
+            }
+        }
+        return NoSeed;
+    }
+
+    constexpr uint32_t Seed = FindSeed();
+    static_assert(Seed != NoSeed, "No collision-free seed for the configuration keys");
+
+    struct SlotTable
+    {
+        uint8_t fieldIndex[SlotCount];
+    };
+
+    constexpr SlotTable BuildSlotTable()
+    {
+        SlotTable table{};
+        for (size_t slot = 0; slot < SlotCount; ++slot)
+        {
+            table.fieldIndex[slot] = EmptySlot;
+        }
+        for (size_t index = 0; index < FieldCount; ++index)
+        {
+            table.fieldIndex[HashKey(Fields[index].key, Seed) % SlotCount] = static_cast<uint8_t>(index);
+        }
+        return table;
+    }
+
+    constexpr SlotTable Slots = BuildSlotTable();
+
+    std::string_view Trim(std::string_view value)
+    {
+        size_t first = 0;
+        while (first < value.size() &&
+            (value[first] == ' ' || value[first] == '\t' || value[first] == '\r' || value[first] == '\n'))
+        {
+            ++first;
+        }
+
+        size_t last = value.size();
+        while (last > first &&
+            (value[last - 1] == ' ' || value[last - 1] == '\t' || value[last - 1] == '\r' || value[last - 1] == '\n'))
+        {
+            --last;
+        }
+        return value.substr(first, last - first);
+    }
+
+    void AppendUtf8(std::string& output, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            output.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800)
+        {
+            output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    void AppendWide(std::wstring& output, uint32_t codePoint)
+    {
+        if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            output.push_back(static_cast<wchar_t>(0xD800 | (codePoint >> 10)));
+            output.push_back(static_cast<wchar_t>(0xDC00 | (codePoint & 0x3FF)));
+        }
+        else
+        {
+            output.push_back(static_cast<wchar_t>(codePoint));
+        }
+    }
+
+    // Encodes UTF-16 (or UTF-32 where wchar_t is 32 bits); unpaired
+    // surrogates become U+FFFD.
+    void AppendWideAsUtf8(std::string& output, const std::wstring& value)
+    {
+        for (size_t index = 0; index < value.size(); ++index)
+        {
+            uint32_t codePoint = static_cast<uint32_t>(value[index]);
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && index + 1 < value.size() &&
+                static_cast<uint32_t>(value[index + 1]) >= 0xDC00 && static_cast<uint32_t>(value[index + 1]) <= 0xDFFF)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (static_cast<uint32_t>(value[index + 1]) - 0xDC00);
+                ++index;
+            }
+            else if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+            {
+                codePoint = 0xFFFD;
+            }
+            AppendUtf8(output, codePoint);
+        }
+    }
+
+    // Decodes UTF-8; malformed sequences become U+FFFD, one per bad byte.
+    std::wstring Utf8ToWide(std::string_view value)
+    {
+        std::wstring result;
+        result.reserve(value.size());
+
+        size_t index = 0;
+        while (index < value.size())
+        {
+            uint8_t lead = static_cast<uint8_t>(value[index]);
+            size_t length = (lead < 0x80) ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            uint32_t codePoint = (length == 1) ? lead : (length == 2) ? (lead & 0x1F) : (length == 3) ? (lead & 0x0F) : (lead & 0x07);
+
+            bool valid = length != 0 && index + length <= value.size();
+            for (size_t offset = 1; valid && offset < length; ++offset)
+            {
+                uint8_t continuation = static_cast<uint8_t>(value[index + offset]);
+                valid = (continuation & 0xC0) == 0x80;
+                codePoint = (codePoint << 6) | (continuation & 0x3F);
+            }
+
+            // Reject overlong forms, surrogates and values past U+10FFFF.
+            static constexpr uint32_t MinimumForLength[] = { 0, 0, 0x80, 0x800, 0x10000 };
+            valid = valid && codePoint >= MinimumForLength[length] && codePoint <= 0x10FFFF &&
+                !(codePoint >= 0xD800 && codePoint <= 0xDFFF);
+
+            if (valid)
+            {
+                AppendWide(result, codePoint);
+                index += length;
+            }
+            else
+            {
+                result.push_back(static_cast<wchar_t>(0xFFFD));
+                ++index;
+            }
+        }
+        return result;
+    }
+
+    bool ParseBoolean(std::string_view value, bool& result)
+    {
+        if (value == "1" || value == "true" || value == "True")
+        {
+            result = true;
+            return true;
+        }
+        if (value == "0" || value == "false" || value == "False")
+        {
+            result = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseNumber(std::string_view value, const ConfigurationField& field, int& result)
+    {
+        int parsed = 0;
+        std::from_chars_result parse = std::from_chars(value.data(), value.data() + value.size(), parsed);
+        if (parse.ec != std::errc() || parse.ptr != value.data() + value.size() ||
+            parsed < field.minimum || parsed > field.maximum)
+        {
+            return false;
+        }
+
+        result = parsed;
+        return true;
+    }
+
+    bool IsDefault(const ConfigurationField& field, const AppConfiguration& configuration)
+    {
+        switch (field.type)
+        {
+        case ConfigurationFieldType::Text:
+            return configuration.*field.text == field.defaultText;
+        case ConfigurationFieldType::TextList:
+            return (configuration.*field.textList).empty();
+        case ConfigurationFieldType::Boolean:
+            return (configuration.*field.boolean ? 1 : 0) == field.defaultNumber;
+        case ConfigurationFieldType::Integer:
+            return configuration.*field.integer == field.defaultNumber;
+        case ConfigurationFieldType::Port:
+            return configuration.*field.port == field.defaultNumber;
+        }
+        return false;
+    }
+
+    bool IsSameValue(const ConfigurationField& field, const AppConfiguration& left, const AppConfiguration& right)
+    {
+        if (field.presence != nullptr && left.*field.presence != right.*field.presence)
+        {
+            return false;
+        }
+
+        switch (field.type)
+        {
+        case ConfigurationFieldType::Text:
+            return left.*field.text == right.*field.text;
+        case ConfigurationFieldType::TextList:
+            return left.*field.textList == right.*field.textList;
+        case ConfigurationFieldType::Boolean:
+            return left.*field.boolean == right.*field.boolean;
+        case ConfigurationFieldType::Integer:
+            return left.*field.integer == right.*field.integer;
+        case ConfigurationFieldType::Port:
+            return left.*field.port == right.*field.port;
+        }
+        return false;
+    }
+
+    void AppendLine(std::string& output, std::string_view key, const std::wstring& value)
+    {
+        output.append(key);
+        output.push_back('=');
+        AppendWideAsUtf8(output, value);
+        output.push_back('\n');
+    }
+
+    void AppendLine(std::string& output, std::string_view key, int value)
+    {
+        char buffer[16];
+        std::to_chars_result formatted = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+        output.append(key);
+        output.push_back('=');
+        output.append(buffer, formatted.ptr);
+        output.push_back('\n');
+    }
+}
+
+AppConfiguration::AppConfiguration()
+    : hasWindowPosition(false),
+    version(0)
+{
+    ResetConfiguration(*this);
+}
+
+const ConfigurationField* GetConfigurationFields(size_t& count)
+{
+    count = FieldCount;
+    return Fields;
+}
+
+const ConfigurationField* FindConfigurationField(std::string_view key)
+{
+    uint8_t index = Slots.fieldIndex[HashKey(key, Seed) % SlotCount];
+    if (index == EmptySlot || Fields[index].key != key)
+    {
+        return nullptr;
+    }
+    return &Fields[index];
+}
+
+void ResetConfiguration(AppConfiguration& configuration)
+{
+    for (const ConfigurationField& field : Fields)
+    {
+        switch (field.type)
+        {
+        case ConfigurationFieldType::Text:
+            (configuration.*field.text).assign(field.defaultText);
+            break;
+        case ConfigurationFieldType::TextList:
+            (configuration.*field.textList).clear();
+            break;
+        case ConfigurationFieldType::Boolean:
+            configuration.*field.boolean = field.defaultNumber != 0;
+            break;
+        case ConfigurationFieldType::Integer:
+            configuration.*field.integer = field.defaultNumber;
+            break;
+        case ConfigurationFieldType::Port:
+            configuration.*field.port = static_cast<unsigned short>(field.defaultNumber);
+            break;
+        }
+
+        if (field.presence != nullptr)
+        {
+            configuration.*field.presence = false;
+        }
+    }
+}
+
+ConfigurationLineResult ApplyConfigurationLine(std::string_view line, AppConfiguration& configuration, std::string_view& key)
+{
+    size_t separator = line.find('=');
+    if (separator == std::string_view::npos)
+    {
+        key = {};
+        return ConfigurationLineResult::Skipped;
+    }
+
+    key = Trim(line.substr(0, separator));
+    std::string_view value = Trim(line.substr(separator + 1));
+
+    const ConfigurationField* field = FindConfigurationField(key);
+    if (field == nullptr)
+    {
+        return key.empty() ? ConfigurationLineResult::Skipped : ConfigurationLineResult::UnknownKey;
+    }
+
+    switch (field->type)
+    {
+    case ConfigurationFieldType::Text:
+        configuration.*field->text = Utf8ToWide(value);
+        break;
+    case ConfigurationFieldType::TextList:
+        (configuration.*field->textList).push_back(Utf8ToWide(value));
+        break;
+    case ConfigurationFieldType::Boolean:
+        if (!ParseBoolean(value, configuration.*field->boolean))
+        {
+            return ConfigurationLineResult::InvalidValue;
+        }
+        break;
+    case ConfigurationFieldType::Integer:
+        if (!ParseNumber(value, *field, configuration.*field->integer))
+        {
+            return ConfigurationLineResult::InvalidValue;
+        }
+        break;
+    case ConfigurationFieldType::Port:
+    {
+        int port = 0;
+        if (!ParseNumber(value, *field, port))
+        {
+            return ConfigurationLineResult::InvalidValue;
+        }
+        configuration.*field->port = static_cast<unsigned short>(port);
+        break;
+    }
+    }
+
+    if (field->presence != nullptr)
+    {
+        configuration.*field->presence = true;
+    }
+    return ConfigurationLineResult::Applied;
+}
+
+std::string FormatConfiguration(const AppConfiguration& configuration)
+{
+    std::string output;
+    for (const ConfigurationField& field : Fields)
+    {
+        if ((field.omitDefault && IsDefault(field, configuration)) ||
+            (field.presence != nullptr && !(configuration.*field.presence)))
+        {
+            continue;
+        }
+
+        switch (field.type)
+        {
+        case ConfigurationFieldType::Text:
+            AppendLine(output, field.key, configuration.*field.text);
+            break;
+        case ConfigurationFieldType::TextList:
+            for (const std::wstring& element : configuration.*field.textList)
+            {
+                AppendLine(output, field.key, element);
+            }
+            break;
+        case ConfigurationFieldType::Boolean:
+            AppendLine(output, field.key, configuration.*field.boolean ? 1 : 0);
+            break;
+        case ConfigurationFieldType::Integer:
+            AppendLine(output, field.key, configuration.*field.integer);
+            break;
+        case ConfigurationFieldType::Port:
+            AppendLine(output, field.key, configuration.*field.port);
+            break;
+        }
+    }
+    return output;
+}
+
+uint32_t CompareConfigurations(const AppConfiguration& previous, const AppConfiguration& current)
+{
+    uint32_t changes = ConfigurationChangeNone;
+    for (const ConfigurationField& field : Fields)
+    {
+        if (!IsSameValue(field, previous, current))
+        {
+            changes |= field.change;
+        }
+    }
+    return changes;
+}
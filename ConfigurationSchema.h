@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Configuration.h"
+
+// How a field's value is stored in the configuration file.
+enum class ConfigurationFieldType : uint8_t
+{
+    // std::wstring, written as UTF-8.
+    Text,
+    // std::vector<std::wstring>, one line per element with the same key.
+    TextList,
+    // bool, written as 1 or 0; true/True and false/False are accepted.
+    Boolean,
+    // int or unsigned short within [minimum, maximum].
+    Integer,
+    Port
+};
+
+// Describes one configuration file key. The table of these in
+// ConfigurationSchema.cpp is the single list of options: defaults, loading,
+// saving and CompareConfigurations all walk it, so adding an option means
+// adding the member, its ConfigurationChange flag and one table entry.
+//
+// Exactly one member pointer, the one matching type, is set.
+struct ConfigurationField
+{
+    std::string_view key;
+    ConfigurationFieldType type;
+    uint32_t change;
+
+    std::wstring AppConfiguration::* text;
+    std::vector<std::wstring> AppConfiguration::* textList;
+    bool AppConfiguration::* boolean;
+    int AppConfiguration::* integer;
+    unsigned short AppConfiguration::* port;
+
+    std::wstring_view defaultText;
+    int defaultNumber;
+    // Values outside the range are rejected and leave the field unchanged.
+    int minimum;
+    int maximum;
+
+    // Set to true when the key is read, e.g. hasWindowPosition; false by
+    // default. The key is only written while it is set, and it counts as part
+    // of the field when diffing.
+    bool AppConfiguration::* presence;
+    // Leaves the key out of the file while the field holds its default.
+    bool omitDefault;
+};
+
+enum class ConfigurationLineResult
+{
+    Applied,
+    // Blank line or no '='.
+    Skipped,
+    UnknownKey,
+    InvalidValue
+};
+
+// Returns every field in file order.
+const ConfigurationField* GetConfigurationFields(size_t& count);
+
+// Finds the field for a key with a perfect hash built at compile time, or
+// returns nullptr.
+const ConfigurationField* FindConfigurationField(std::string_view key);
+
+// Sets every field to its default.
+void ResetConfiguration(AppConfiguration& configuration);
+
+// Applies one "key=value" line. Whitespace around key and value is ignored.
+// key receives the trimmed key, pointing into line, for error reporting.
+ConfigurationLineResult ApplyConfigurationLine(std::string_view line, AppConfiguration& configuration, std::string_view& key);
+
+// Returns the file contents for a configuration, one "key=value" per line.
+std::string FormatConfiguration(const AppConfiguration& configuration);
@@ -0,0 +1,33 @@
+#include "ConfigurationStore.h"
+
+ConfigurationStore::ConfigurationStore()
+    : current(),
+    version(0),
+    publishMutex()
+{
+    current.Publish(std::make_shared<const AppConfiguration>());
+}
+
+std::shared_ptr<const AppConfiguration> ConfigurationStore::Acquire() const
+{
+    return current.Acquire();
+}
+
+uint64_t ConfigurationStore::GetVersion() const
+{
+    return version.load(std::memory_order_acquire);
+}
+
+uint64_t ConfigurationStore::Publish(AppConfiguration configuration)
+{
+    std::lock_guard<std::mutex> guard(publishMutex);
+
+    uint64_t nextVersion = version.load(std::memory_order_relaxed) + 1;
+    configuration.version = nextVersion;
+    current.Publish(std::make_shared<const AppConfiguration>(std::move(configuration)));
+
+    // Published after the snapshot, so a reader that sees the new version
+    // also finds the new snapshot.
+    version.store(nextVersion, std::memory_order_release);
+    return nextVersion;
+}
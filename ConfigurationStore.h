@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "Configuration.h"
+#include "PublishedHandle.h"
+
+// Holds the app's configuration as immutable, versioned snapshots.
+//
+// A change is made by copying the current snapshot, editing the copy and
+// publishing it; published snapshots are never modified, so any thread can
+// read one without locking while the UI thread publishes the next. Each
+// snapshot carries the version it was published as, so a component that keeps
+// state derived from the configuration can compare its snapshot's version
+// with GetVersion and only re-read (and diff) when they differ.
+class ConfigurationStore
+{
+public:
+    ConfigurationStore();
+
+    ConfigurationStore(const ConfigurationStore&) = delete;
+    ConfigurationStore& operator=(const ConfigurationStore&) = delete;
+
+    // Returns the current snapshot, or a default configuration before the
+    // first Publish.
+    std::shared_ptr<const AppConfiguration> Acquire() const;
+
+    // Returns the version of the current snapshot; 0 before the first Publish.
+    uint64_t GetVersion() const;
+
+    // Makes configuration the current snapshot and returns its version.
+    uint64_t Publish(AppConfiguration configuration);
+
+private:
+    PublishedHandle<const AppConfiguration> current;
+    std::atomic<uint64_t> version;
+    std::mutex publishMutex;
+};
@@ -0,0 +1,138 @@
+#include "ConfigurationWatcher.h"
+
+#include "Logging.h"
+#include "TraceRecorder.h"
+
+ConfigurationWatcher::ConfigurationWatcher()
+    : path(),
+    callback(),
+    stopEvent(nullptr),
+    watcher()
+{
+}
+
+ConfigurationWatcher::~ConfigurationWatcher()
+{
+    Stop();
+}
+
+bool ConfigurationWatcher::Start(const std::wstring& filePath, ChangeCallback onChanged)
+{
+    if (watcher.joinable() || !onChanged)
+    {
+        return false;
+    }
+
+    size_t lastSeparator = filePath.find_last_of(L"\\/");
+    std::wstring directory = (lastSeparator != std::wstring::npos)
+        ? filePath.substr(0, lastSeparator + 1)
+        : std::wstring(L".");
+
+    HANDLE notification = FindFirstChangeNotificationW(
+        directory.c_str(),
+        FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+    if (notification == INVALID_HANDLE_VALUE)
+    {
+        LGTV_LOG_WARNING(Configuration, L"Cannot watch %s for changes: %lu", directory.c_str(), GetLastError());
+        return false;
+    }
+
+    stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!stopEvent)
+    {
+        FindCloseChangeNotification(notification);
+        return false;
+    }
+
+    path = filePath;
+    callback = std::move(onChanged);
+
+    try
+    {
+        watcher = std::thread(&ConfigurationWatcher::WatchLoop, this, notification);
+    }
+    catch (...)
+    {
+        FindCloseChangeNotification(notification);
+        CloseHandle(stopEvent);
+        stopEvent = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+void ConfigurationWatcher::Stop()
+{
+    if (!watcher.joinable())
+    {
+        return;
+    }
+
+    SetEvent(stopEvent);
+    watcher.join();
+
+    CloseHandle(stopEvent);
+    stopEvent = nullptr;
+}
+
+ConfigurationWatcher::FileStamp ConfigurationWatcher::ReadStamp() const
+{
+    FileStamp stamp{};
+    WIN32_FILE_ATTRIBUTE_DATA attributes{};
+    if (GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes))
+    {
+        stamp.exists = true;
+        stamp.size = (static_cast<ULONGLONG>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        stamp.lastWrite = attributes.ftLastWriteTime;
+    }
+    return stamp;
+}
+
+bool ConfigurationWatcher::IsSameStamp(const FileStamp& left, const FileStamp& right)
+{
+    return left.exists == right.exists &&
+        left.size == right.size &&
+        CompareFileTime(&left.lastWrite, &right.lastWrite) == 0;
+}
+
+void ConfigurationWatcher::WatchLoop(HANDLE notification)
+{
+    TraceRecorder::SetThreadName("Configuration watcher");
+
+    FileStamp known = ReadStamp();
+    HANDLE handles[] = { stopEvent, notification };
+    DWORD timeout = INFINITE;
+
+    for (;;)
+    {
+        DWORD waitResult = WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, timeout);
+        if (waitResult == WAIT_OBJECT_0 + 1)
+        {
+            // Something in the directory changed; let the burst settle.
+            FindNextChangeNotification(notification);
+            timeout = SettleDelayMilliseconds;
+            continue;
+        }
+        if (waitResult != WAIT_TIMEOUT)
+        {
+            break;
+        }
+
+        timeout = INFINITE;
+        FileStamp current = ReadStamp();
+        if (IsSameStamp(current, known))
+        {
+            continue;
+        }
+
+        known = current;
+        if (current.exists)
+        {
+            callback();
+        }
+    }
+
+    FindCloseChangeNotification(notification);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "framework.h"
+
+#include <functional>
+#include <string>
+#include <thread>
+
+// Watches one file and calls back after it changed on disk, e.g. because the
+// configuration was edited by hand.
+//
+// The watcher thread waits on a change notification for the file's directory
+// and compares the file's size and last write time, so writes to other files
+// in the directory (such as the log) cost one attribute query. A burst of
+// writes is reported once after it has been quiet for SettleDelay. The
+// callback runs on the watcher thread; the app posts a message to the UI
+// thread from it. The app's own saves are reported as well, so the receiver
+// should compare the reloaded contents rather than assume a change.
+class ConfigurationWatcher
+{
+public:
+    using ChangeCallback = std::function<void()>;
+
+    static constexpr DWORD SettleDelayMilliseconds = 250;
+
+    ConfigurationWatcher();
+    ~ConfigurationWatcher();
+
+    ConfigurationWatcher(const ConfigurationWatcher&) = delete;
+    ConfigurationWatcher& operator=(const ConfigurationWatcher&) = delete;
+
+    bool Start(const std::wstring& filePath, ChangeCallback onChanged);
+    void Stop();
+
+private:
+    struct FileStamp
+    {
+        bool exists;
+        ULONGLONG size;
+        FILETIME lastWrite;
+    };
+
+    FileStamp ReadStamp() const;
+    static bool IsSameStamp(const FileStamp& left, const FileStamp& right);
+    void WatchLoop(HANDLE notification);
+
+    std::wstring path;
+    ChangeCallback callback;
+    HANDLE stopEvent;
+    std::thread watcher;
+};
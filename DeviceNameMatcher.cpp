@@ -0,0 +1,332 @@
+#include "DeviceNameMatcher.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <deque>
+#include <map>
+
+namespace
+{
+    constexpr uint32_t NoEdge = UINT32_MAX;
+
+    wchar_t FoldCase(wchar_t character)
+    {
+        // Endpoint names are mostly ASCII; only call into the CRT for the rest.
+        if (character < 0x80)
+        {
+            return (character >= L'A' && character <= L'Z')
+                ? static_cast<wchar_t>(character + (L'a' - L'A'))
+                : character;
+        }
+        return static_cast<wchar_t>(towlower(character));
+    }
+
+    std::wstring FoldCase(const std::wstring& value)
+    {
+        std::wstring result(value);
+        for (wchar_t& character : result)
+        {
+            character = FoldCase(character);
+        }
+        return result;
+    }
+
+    std::wstring TrimEntry(const std::wstring& value)
+    {
+        size_t first = 0;
+        while (first < value.size() && iswspace(value[first]))
+        {
+            ++first;
+        }
+
+        size_t last = value.size();
+        while (last > first && iswspace(value[last - 1]))
+        {
+            --last;
+        }
+
+        return value.substr(first, last - first);
+    }
+
+    bool StartsWithFolded(const std::wstring& value, const wchar_t* prefix)
+    {
+        size_t index = 0;
+        for (; prefix[index] != L'\0'; ++index)
+        {
+            if (index >= value.size() || FoldCase(value[index]) != prefix[index])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Compares an already folded ID against a raw one without allocating.
+    bool ContainsFoldedId(const std::vector<std::wstring>& foldedIds, const std::wstring& endpointId)
+    {
+        for (const std::wstring& foldedId : foldedIds)
+        {
+            if (foldedId.size() != endpointId.size())
+            {
+                continue;
+            }
+
+            size_t index = 0;
+            while (index < foldedId.size() && foldedId[index] == FoldCase(endpointId[index]))
+            {
+                ++index;
+            }
+
+            if (index == foldedId.size())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+DeviceNameMatcher::DeviceNameMatcher()
+    : states(1, State{ 0, 0, 0, 0 }),
+    edges(),
+    rootAscii(RootAsciiRange, 0),
+    includedIds(),
+    excludedIds(),
+    patternCount(0),
+    hasIncludes(false),
+    hasExclusions(false)
+{
+}
+
+DeviceNameMatcher DeviceNameMatcher::Compile(const std::wstring& specification)
+{
+    DeviceNameMatcher matcher;
+
+    std::vector<std::wstring> patterns;
+    std::vector<uint8_t> outputs;
+
+    size_t start = 0;
+    while (start <= specification.size())
+    {
+        size_t separator = specification.find(L';', start);
+        if (separator == std::wstring::npos)
+        {
+            separator = specification.size();
+        }
+
+        std::wstring entry = TrimEntry(specification.substr(start, separator - start));
+        start = separator + 1;
+
+        bool exclude = false;
+        if (!entry.empty() && entry[0] == L'!')
+        {
+            exclude = true;
+            entry = TrimEntry(entry.substr(1));
+        }
+
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        if (StartsWithFolded(entry, L"id:"))
+        {
+            std::wstring endpointId = FoldCase(TrimEntry(entry.substr(3)));
+            if (!endpointId.empty())
+            {
+                (exclude ? matcher.excludedIds : matcher.includedIds).push_back(endpointId);
+            }
+            continue;
+        }
+
+        patterns.push_back(FoldCase(entry));
+        outputs.push_back(exclude ? OutputExclude : OutputInclude);
+        matcher.hasIncludes = matcher.hasIncludes || !exclude;
+        matcher.hasExclusions = matcher.hasExclusions || exclude;
+    }
+
+    matcher.patternCount = patterns.size();
+    matcher.Build(patterns, outputs);
+    return matcher;
+}
+
+bool DeviceNameMatcher::Matches(const std::wstring& endpointId, const std::wstring& friendlyName) const
+{
+    if (!excludedIds.empty() && ContainsFoldedId(excludedIds, endpointId))
+    {
+        return false;
+    }
+
+    if (!includedIds.empty() && ContainsFoldedId(includedIds, endpointId))
+    {
+        return true;
+    }
+
+    if (!hasIncludes)
+    {
+        return false;
+    }
+
+    bool included = false;
+    uint32_t state = 0;
+    for (wchar_t character : friendlyName)
+    {
+        state = Step(state, FoldCase(character));
+
+        uint8_t output = states[state].output;
+        if (output & OutputExclude)
+        {
+            return false;
+        }
+
+        if (output & OutputInclude)
+        {
+            // Without exclusions the first hit decides; otherwise the rest of
+            // the name still has to be checked for an excluded pattern.
+            if (!hasExclusions)
+            {
+                return true;
+            }
+            included = true;
+        }
+    }
+
+    return included;
+}
+
+bool DeviceNameMatcher::IsEmpty() const
+{
+    return patternCount == 0 && includedIds.empty() && excludedIds.empty();
+}
+
+size_t DeviceNameMatcher::GetPatternCount() const
+{
+    return patternCount;
+}
+
+void DeviceNameMatcher::Build(
+    const std::vector<std::wstring>& patterns,
+    const std::vector<uint8_t>& outputs)
+{
+    // Build the trie with ordered children, then flatten it.
+    std::vector<std::map<wchar_t, uint32_t>> children(1);
+    std::vector<uint8_t> nodeOutputs(1, 0);
+
+    for (size_t index = 0; index < patterns.size(); ++index)
+    {
+        uint32_t node = 0;
+        for (wchar_t character : patterns[index])
+        {
+            auto found = children[node].find(character);
+            if (found != children[node].end())
+            {
+                node = found->second;
+                continue;
+            }
+
+            uint32_t created = static_cast<uint32_t>(children.size());
+            children[node].emplace(character, created);
+            children.emplace_back();
+            nodeOutputs.push_back(0);
+            node = created;
+        }
+        nodeOutputs[node] |= outputs[index];
+    }
+
+    // Failure links in breadth-first order; outputs of the failure target are
+    // merged in so a single lookup per character reports every hit.
+    std::vector<uint32_t> failure(children.size(), 0);
+    std::deque<uint32_t> pending;
+    for (const auto& child : children[0])
+    {
+        pending.push_back(child.second);
+    }
+
+    while (!pending.empty())
+    {
+        uint32_t node = pending.front();
+        pending.pop_front();
+
+        for (const auto& child : children[node])
+        {
+            uint32_t fallback = failure[node];
+            while (fallback != 0 && children[fallback].count(child.first) == 0)
+            {
+                fallback = failure[fallback];
+            }
+
+            auto found = children[fallback].find(child.first);
+            failure[child.second] =
+                (found != children[fallback].end() && found->second != child.second)
+                ? found->second
+                : 0;
+            nodeOutputs[child.second] |= nodeOutputs[failure[child.second]];
+
+            pending.push_back(child.second);
+        }
+    }
+
+    states.assign(children.size(), State{ 0, 0, 0, 0 });
+    edges.clear();
+    for (size_t node = 0; node < children.size(); ++node)
+    {
+        State& state = states[node];
+        state.firstEdge = static_cast<uint32_t>(edges.size());
+        state.edgeCount = static_cast<uint32_t>(children[node].size());
+        state.failure = failure[node];
+        state.output = nodeOutputs[node];
+
+        for (const auto& child : children[node])
+        {
+            edges.push_back(Edge{ child.first, child.second });
+        }
+    }
+
+    rootAscii.assign(RootAsciiRange, 0);
+    for (const auto& child : children[0])
+    {
+        if (static_cast<uint32_t>(child.first) < RootAsciiRange)
+        {
+            rootAscii[static_cast<uint32_t>(child.first)] = child.second;
+        }
+    }
+}
+
+uint32_t DeviceNameMatcher::FindEdge(uint32_t state, wchar_t character) const
+{
+    const State& current = states[state];
+    auto begin = edges.begin() + current.firstEdge;
+    auto end = begin + current.edgeCount;
+
+    auto found = std::lower_bound(begin, end, character,
+        [](const Edge& edge, wchar_t value) { return edge.character < value; });
+    if (found != end && found->character == character)
+    {
+        return found->target;
+    }
+    return NoEdge;
+}
+
+uint32_t DeviceNameMatcher::Step(uint32_t state, wchar_t character) const
+{
+    for (;;)
+    {
+        if (state == 0)
+        {
+            if (static_cast<uint32_t>(character) < RootAsciiRange)
+            {
+                return rootAscii[static_cast<uint32_t>(character)];
+            }
+
+            uint32_t target = FindEdge(0, character);
+            return (target != NoEdge) ? target : 0;
+        }
+
+        uint32_t target = FindEdge(state, character);
+        if (target != NoEdge)
+        {
+            return target;
+        }
+        state = states[state].failure;
+    }
+}
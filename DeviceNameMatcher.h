@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Decides whether an audio endpoint is the TV, based on the device name hint.
+//
+// The hint is a ';'-separated list of entries:
+//   LG            endpoint name contains "LG" (case-insensitive)
+//   !Monitor      endpoint name must not contain "Monitor"
+//   id:{0.0.0...} endpoint with exactly this ID always matches
+//   !id:{0.0.0...} endpoint with exactly this ID never matches
+//
+// All name patterns are case-folded once when the matcher is compiled and
+// searched in a single pass over the endpoint name (Aho-Corasick), so the
+// cost of a match does not grow with the number of patterns.
+class DeviceNameMatcher
+{
+public:
+    // Creates a matcher that matches nothing.
+    DeviceNameMatcher();
+
+    // Compiles a hint specification.
+    static DeviceNameMatcher Compile(const std::wstring& specification);
+
+    // Returns true when the endpoint matches the compiled hint.
+    bool Matches(const std::wstring& endpointId, const std::wstring& friendlyName) const;
+
+    // Returns true when the hint contains no usable entry.
+    bool IsEmpty() const;
+
+    // Returns the number of name patterns (included and excluded).
+    size_t GetPatternCount() const;
+
+private:
+    static constexpr uint8_t OutputInclude = 0x1;
+    static constexpr uint8_t OutputExclude = 0x2;
+    static constexpr uint32_t RootAsciiRange = 128;
+
+    struct Edge
+    {
+        wchar_t character;
+        uint32_t target;
+    };
+
+    struct State
+    {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        uint32_t failure;
+        uint8_t output;
+    };
+
+    void Build(const std::vector<std::wstring>& patterns, const std::vector<uint8_t>& outputs);
+    uint32_t FindEdge(uint32_t state, wchar_t character) const;
+    uint32_t Step(uint32_t state, wchar_t character) const;
+
+    std::vector<State> states;
+    std::vector<Edge> edges;
+    std::vector<uint32_t> rootAscii;
+    std::vector<std::wstring> includedIds;
+    std::vector<std::wstring> excludedIds;
+    size_t patternCount;
+    bool hasIncludes;
+    bool hasExclusions;
+};
@@ -0,0 +1,186 @@
+#include "EndpointCapabilityCache.h"
+
+EndpointCapabilityCache::EndpointCapabilityCache(IEndpointCapabilityProbe& probeValue)
+    : probe(probeValue),
+    hintMatcher(),
+    entries(),
+    nextGeneration(0),
+    matcherGeneration(0),
+    hitCount(0),
+    missCount(0),
+    invalidationCount(0)
+{
+}
+
+void EndpointCapabilityCache::SetHintMatcher(HintMatcher matcher)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    hintMatcher = std::move(matcher);
+    ++matcherGeneration;
+
+    for (auto& item : entries)
+    {
+        item.second.matchKnown = false;
+    }
+}
+
+EndpointCapabilities EndpointCapabilityCache::Lookup(const std::wstring& endpointId)
+{
+    Entry snapshot;
+    HintMatcher matcher;
+    uint64_t matcherGenerationAtStart = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        Entry& entry = entries[endpointId];
+        if (entry.generation == 0)
+        {
+            entry.generation = ++nextGeneration;
+        }
+
+        snapshot = entry;
+        matcher = hintMatcher;
+        matcherGenerationAtStart = matcherGeneration;
+    }
+
+    bool probed = false;
+
+    if (!snapshot.nameKnown)
+    {
+        snapshot.friendlyName.clear();
+        snapshot.hasFriendlyName = probe.ProbeFriendlyName(endpointId, snapshot.friendlyName);
+        if (!snapshot.hasFriendlyName)
+        {
+            snapshot.friendlyName.clear();
+        }
+        snapshot.nameKnown = true;
+        snapshot.matchKnown = false;
+        probed = true;
+    }
+
+    if (!snapshot.matchKnown)
+    {
+        snapshot.matchesHint =
+            snapshot.hasFriendlyName
+            && matcher
+            && matcher(endpointId, snapshot.friendlyName);
+        snapshot.matchKnown = true;
+    }
+
+    if (snapshot.matchesHint && !snapshot.atmosKnown)
+    {
+        snapshot.dolbyAtmosAvailable = probe.ProbeDolbyAtmos(endpointId);
+        snapshot.atmosKnown = true;
+        probed = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if (probed)
+        {
+            ++missCount;
+        }
+        else
+        {
+            ++hitCount;
+        }
+
+        auto found = entries.find(endpointId);
+        if (found != entries.end()
+            && found->second.generation == snapshot.generation
+            && matcherGeneration == matcherGenerationAtStart)
+        {
+            found->second = snapshot;
+        }
+    }
+
+    EndpointCapabilities result;
+    result.friendlyName = snapshot.friendlyName;
+    result.hasFriendlyName = snapshot.hasFriendlyName;
+    result.matchesHint = snapshot.matchesHint;
+    result.dolbyAtmosAvailable = snapshot.matchesHint && snapshot.dolbyAtmosAvailable;
+    return result;
+}
+
+bool EndpointCapabilityCache::InvalidateProperty(
+    const std::wstring& endpointId,
+    EndpointPropertyChange change)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto found = entries.find(endpointId);
+    if (found == entries.end())
+    {
+        return false;
+    }
+
+    Entry& entry = found->second;
+    bool dropped = false;
+
+    switch (change)
+    {
+    case EndpointPropertyChange::FriendlyName:
+        dropped = entry.nameKnown;
+        entry.nameKnown = false;
+        entry.matchKnown = false;
+        break;
+    case EndpointPropertyChange::Format:
+        dropped = entry.atmosKnown;
+        entry.atmosKnown = false;
+        break;
+    default:
+        break;
+    }
+
+    // A new generation makes any probe that is still running for the old
+    // state discard its result instead of caching it.
+    entry.generation = ++nextGeneration;
+
+    if (dropped)
+    {
+        ++invalidationCount;
+    }
+    return dropped;
+}
+
+bool EndpointCapabilityCache::InvalidateEndpoint(const std::wstring& endpointId)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (entries.erase(endpointId) == 0)
+    {
+        return false;
+    }
+
+    ++invalidationCount;
+    return true;
+}
+
+void EndpointCapabilityCache::Clear()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    invalidationCount += entries.size();
+    entries.clear();
+}
+
+uint64_t EndpointCapabilityCache::GetHitCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return hitCount;
+}
+
+uint64_t EndpointCapabilityCache::GetMissCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return missCount;
+}
+
+uint64_t EndpointCapabilityCache::GetInvalidationCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return invalidationCount;
+}
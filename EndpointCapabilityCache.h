@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Reads endpoint capabilities from the audio system. Every call is assumed to
+// be expensive (property store reads, interface activations).
+class IEndpointCapabilityProbe
+{
+public:
+    virtual ~IEndpointCapabilityProbe() = default;
+
+    // Reads the friendly name of the endpoint. Returns false when unavailable.
+    virtual bool ProbeFriendlyName(const std::wstring& endpointId, std::wstring& friendlyName) = 0;
+
+    // Returns true when the endpoint can currently open Dolby Atmos streams.
+    virtual bool ProbeDolbyAtmos(const std::wstring& endpointId) = 0;
+};
+
+// Capabilities of one endpoint as seen by the routing logic.
+struct EndpointCapabilities
+{
+    std::wstring friendlyName;
+    bool hasFriendlyName = false;
+    bool matchesHint = false;
+    bool dolbyAtmosAvailable = false;
+};
+
+// Which part of a cached entry a property change affects.
+enum class EndpointPropertyChange
+{
+    FriendlyName,
+    Format
+};
+
+// Caches endpoint capabilities keyed by endpoint ID so switching back to a
+// known device does not repeat any probe calls.
+//
+// Dolby Atmos is only probed for endpoints that match the hint, matching what
+// the routing logic needs. Probes run without the cache lock held; an entry
+// that is invalidated while a probe is in flight is not overwritten by the
+// stale result.
+class EndpointCapabilityCache
+{
+public:
+    using HintMatcher =
+        std::function<bool(const std::wstring& endpointId, const std::wstring& friendlyName)>;
+
+    explicit EndpointCapabilityCache(IEndpointCapabilityProbe& probe);
+
+    // Replaces the hint matcher and forgets every cached match result.
+    // Friendly names and Atmos results stay cached.
+    void SetHintMatcher(HintMatcher matcher);
+
+    // Returns the capabilities of the endpoint, probing only what is missing.
+    EndpointCapabilities Lookup(const std::wstring& endpointId);
+
+    // Forgets the part of the entry affected by a property change.
+    // Returns true when a cached value was actually dropped.
+    bool InvalidateProperty(const std::wstring& endpointId, EndpointPropertyChange change);
+
+    // Forgets everything known about the endpoint, e.g. after a state change.
+    // Returns true when an entry existed.
+    bool InvalidateEndpoint(const std::wstring& endpointId);
+
+    // Forgets all entries.
+    void Clear();
+
+    uint64_t GetHitCount() const;
+    uint64_t GetMissCount() const;
+    uint64_t GetInvalidationCount() const;
+
+private:
+    struct Entry
+    {
+        std::wstring friendlyName;
+        bool nameKnown = false;
+        bool hasFriendlyName = false;
+        bool matchKnown = false;
+        bool matchesHint = false;
+        bool atmosKnown = false;
+        bool dolbyAtmosAvailable = false;
+        uint64_t generation = 0;
+    };
+
+    IEndpointCapabilityProbe& probe;
+    HintMatcher hintMatcher;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::wstring, Entry> entries;
+    uint64_t nextGeneration;
+    uint64_t matcherGeneration;
+
+    uint64_t hitCount;
+    uint64_t missCount;
+    uint64_t invalidationCount;
+};
@@ -0,0 +1,371 @@
+#include "EvdevInputSource.h"
+
+#ifdef __linux__
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    constexpr size_t ReadBatch = 64;
+
+    bool TestBit(const unsigned long* bits, unsigned int bit)
+    {
+        constexpr unsigned int BitsPerWord = sizeof(unsigned long) * 8;
+        return (bits[bit / BitsPerWord] >> (bit % BitsPerWord)) & 1UL;
+    }
+
+    bool MapKeyCode(uint16_t code, TvVolumeAction& action)
+    {
+        switch (code)
+        {
+        case KEY_VOLUMEUP:
+            action = TvVolumeAction::VolumeUp;
+            return true;
+        case KEY_VOLUMEDOWN:
+            action = TvVolumeAction::VolumeDown;
+            return true;
+        case KEY_MUTE:
+            action = TvVolumeAction::ToggleMute;
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+EvdevInputSource::EvdevInputSource(IInputEventSink& sinkValue, CaptureQuery captureWantedValue)
+    : sink(sinkValue),
+    captureWanted(std::move(captureWantedValue)),
+    devices(),
+    epollFd(-1),
+    wakeFd(-1),
+    stopRequested(false),
+    captureUpdateRequested(false),
+    eventCount(0),
+    lostDeviceCount(0)
+{
+}
+
+EvdevInputSource::~EvdevInputSource()
+{
+    for (Device& device : devices)
+    {
+        CloseDevice(device);
+    }
+
+    if (wakeFd >= 0)
+    {
+        close(wakeFd);
+    }
+    if (epollFd >= 0)
+    {
+        close(epollFd);
+    }
+}
+
+bool EvdevInputSource::AddDevice(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    Device device;
+    device.path = path;
+    device.fd = fd;
+
+    unsigned long keyBits[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0)
+    {
+        device.evdev = true;
+        device.grabbable = !TestBit(keyBits, KEY_A);
+
+        // Report event times on the same clock as std::chrono::steady_clock.
+        int clockId = CLOCK_MONOTONIC;
+        device.monotonicTimestamps = ioctl(fd, EVIOCSCLOCKID, &clockId) == 0;
+    }
+
+    devices.push_back(std::move(device));
+    return true;
+}
+
+size_t EvdevInputSource::AddVolumeKeyDevices(const std::string& directory)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return 0;
+    }
+
+    size_t added = 0;
+    while (dirent* entry = readdir(dir))
+    {
+        if (std::strncmp(entry->d_name, "event", 5) != 0)
+        {
+            continue;
+        }
+
+        std::string path = directory + "/" + entry->d_name;
+        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        unsigned long keyBits[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+        bool hasVolumeKeys = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0 &&
+            (TestBit(keyBits, KEY_VOLUMEUP) || TestBit(keyBits, KEY_VOLUMEDOWN) || TestBit(keyBits, KEY_MUTE));
+        close(fd);
+
+        if (hasVolumeKeys && AddDevice(path))
+        {
+            ++added;
+        }
+    }
+
+    closedir(dir);
+    return added;
+}
+
+bool EvdevInputSource::Prepare()
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        return false;
+    }
+
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.u64 = UINT64_MAX;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent) != 0)
+    {
+        return false;
+    }
+
+    for (size_t index = 0; index < devices.size(); ++index)
+    {
+        epoll_event deviceEvent{};
+        deviceEvent.events = EPOLLIN;
+        deviceEvent.data.u64 = index;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, devices[index].fd, &deviceEvent) != 0)
+        {
+            CloseDevice(devices[index]);
+            lostDeviceCount.fetch_add(1);
+        }
+    }
+
+    stopRequested = false;
+    UpdateCapture();
+    return true;
+}
+
+void EvdevInputSource::Run()
+{
+    epoll_event ready[16];
+
+    while (!stopRequested.load())
+    {
+        int count = epoll_wait(epollFd, ready, 16, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (int index = 0; index < count; ++index)
+        {
+            if (ready[index].data.u64 == UINT64_MAX)
+            {
+                uint64_t ignored = 0;
+                ssize_t drained = read(wakeFd, &ignored, sizeof(ignored));
+                (void)drained;
+                continue;
+            }
+
+            Device& device = devices[ready[index].data.u64];
+            if (device.fd >= 0 && !ReadDevice(device))
+            {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, device.fd, nullptr);
+                CloseDevice(device);
+                lostDeviceCount.fetch_add(1);
+            }
+        }
+
+        if (captureUpdateRequested.exchange(false))
+        {
+            UpdateCapture();
+        }
+    }
+
+    for (Device& device : devices)
+    {
+        CloseDevice(device);
+    }
+}
+
+void EvdevInputSource::RequestStop()
+{
+    stopRequested = true;
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void EvdevInputSource::RequestCaptureUpdate()
+{
+    captureUpdateRequested = true;
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+uint64_t EvdevInputSource::GetEventCount() const
+{
+    return eventCount.load();
+}
+
+uint64_t EvdevInputSource::GetLostDeviceCount() const
+{
+    return lostDeviceCount.load();
+}
+
+size_t EvdevInputSource::GetDeviceCount() const
+{
+    return devices.size();
+}
+
+void EvdevInputSource::UpdateCapture()
+{
+    bool capture = captureWanted && captureWanted();
+
+    for (Device& device : devices)
+    {
+        if (device.fd < 0 || !device.evdev || !device.grabbable || device.grabbed == capture)
+        {
+            continue;
+        }
+
+        if (ioctl(device.fd, EVIOCGRAB, capture ? 1 : 0) == 0)
+        {
+            device.grabbed = capture;
+        }
+    }
+}
+
+bool EvdevInputSource::ReadDevice(Device& device)
+{
+    char buffer[ReadBatch * sizeof(input_event)];
+
+    for (;;)
+    {
+        // Carry over a partial record from the previous read; evdev nodes
+        // always return whole records, pipes do not.
+        size_t carried = device.partial.size();
+        if (carried > 0)
+        {
+            std::memcpy(buffer, device.partial.data(), carried);
+            device.partial.clear();
+        }
+
+        ssize_t bytesRead = read(device.fd, buffer + carried, sizeof(buffer) - carried);
+        if (bytesRead < 0)
+        {
+            device.partial.assign(buffer, buffer + carried);
+            return errno == EAGAIN || errno == EINTR;
+        }
+        if (bytesRead == 0)
+        {
+            // End of a raw stream.
+            return false;
+        }
+
+        size_t available = carried + static_cast<size_t>(bytesRead);
+        size_t records = available / sizeof(input_event);
+        for (size_t index = 0; index < records; ++index)
+        {
+            input_event event;
+            std::memcpy(&event, buffer + index * sizeof(input_event), sizeof(event));
+            if (event.type == EV_KEY)
+            {
+                DispatchKey(device, event.code, event.value,
+                    static_cast<long>(event.input_event_sec),
+                    static_cast<long>(event.input_event_usec));
+            }
+        }
+
+        device.partial.assign(buffer + records * sizeof(input_event), buffer + available);
+    }
+}
+
+void EvdevInputSource::DispatchKey(const Device& device, uint16_t code, int32_t value, long seconds, long microseconds)
+{
+    TvVolumeEvent event;
+    if (!MapKeyCode(code, event.action))
+    {
+        return;
+    }
+
+    // 1 is a press and 2 an autorepeat; a held mute key must not keep
+    // toggling.
+    if (value != 1 && !(value == 2 && event.action != TvVolumeAction::ToggleMute))
+    {
+        return;
+    }
+
+    if (device.monotonicTimestamps)
+    {
+        event.timestamp = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::seconds(seconds) + std::chrono::microseconds(microseconds)));
+    }
+    else
+    {
+        event.timestamp = std::chrono::steady_clock::now();
+    }
+
+    eventCount.fetch_add(1);
+
+    // Whether the key reaches anything else was already decided by the grab.
+    sink.OnTvVolumeEvent(event);
+}
+
+void EvdevInputSource::CloseDevice(Device& device)
+{
+    if (device.fd < 0)
+    {
+        return;
+    }
+
+    if (device.grabbed)
+    {
+        ioctl(device.fd, EVIOCGRAB, 0);
+        device.grabbed = false;
+    }
+
+    close(device.fd);
+    device.fd = -1;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "InputSource.h"
+
+// Input source that reads KEY_VOLUMEUP, KEY_VOLUMEDOWN and KEY_MUTE from
+// Linux evdev devices, multiplexed with epoll on its InputThread.
+//
+// Capturing volume keys means grabbing a device (EVIOCGRAB) so nothing else
+// sees its events. That would take a whole keyboard away from the system, so
+// only devices without letter keys (remotes, media key pads) are grabbed.
+//
+// A path that is not an evdev node, such as a FIFO, is read as a raw stream
+// of input_event records; that is how the source is driven in tests.
+class EvdevInputSource : public IInputSource
+{
+public:
+    using CaptureQuery = std::function<bool()>;
+
+    EvdevInputSource(IInputEventSink& sink, CaptureQuery captureWanted);
+    ~EvdevInputSource();
+
+    EvdevInputSource(const EvdevInputSource&) = delete;
+    EvdevInputSource& operator=(const EvdevInputSource&) = delete;
+
+    // Opens a device to read from. Call before the input thread starts.
+    bool AddDevice(const std::string& path);
+
+    // Opens every event device in the directory that reports volume keys.
+    // Returns the number of devices added.
+    size_t AddVolumeKeyDevices(const std::string& directory = "/dev/input");
+
+    // IInputEventLoop
+    bool Prepare() override;
+    void Run() override;
+    void RequestStop() override;
+
+    // IInputSource
+    void RequestCaptureUpdate() override;
+
+    uint64_t GetEventCount() const;
+    uint64_t GetLostDeviceCount() const;
+    size_t GetDeviceCount() const;
+
+private:
+    struct Device
+    {
+        std::string path;
+        int fd = -1;
+        bool evdev = false;
+        bool grabbable = false;
+        bool grabbed = false;
+        bool monotonicTimestamps = false;
+        std::vector<char> partial;
+    };
+
+    void UpdateCapture();
+    bool ReadDevice(Device& device);
+    void DispatchKey(const Device& device, uint16_t code, int32_t value, long seconds, long microseconds);
+    void CloseDevice(Device& device);
+
+    IInputEventSink& sink;
+    CaptureQuery captureWanted;
+    std::vector<Device> devices;
+
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> captureUpdateRequested;
+
+    std::atomic<uint64_t> eventCount;
+    std::atomic<uint64_t> lostDeviceCount;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "FlightRecorder.h"
+
+#include <cstdio>
+
+namespace
+{
+    struct FlightEventInfo
+    {
+        const char* name;
+        const char* firstName;
+        const char* secondName;
+    };
+
+    constexpr FlightEventInfo EventInfo[] =
+    {
+        { "KeyEvent", "action", "toTv" },
+        { "TvAction", "action", "value" },
+        { "TvActionResult", "action", "ok" },
+        { "TvConnect", "ok", nullptr },
+        { "TvDisconnect", nullptr, nullptr },
+        { "TvRegister", "ok", nullptr },
+        { "TvSend", "bytes", "ok" },
+        { "TvReceive", "bytes", "ok" },
+        { "RoutingChanged", "useTv", "commands" },
+        { "DefaultEndpoint", "matches", "atmos" },
+        { "Error", "site", nullptr }
+    };
+
+    static_assert(sizeof(EventInfo) / sizeof(EventInfo[0]) == static_cast<size_t>(FlightEventType::Count),
+        "Every flight event type needs an EventInfo entry.");
+
+    size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Small per-thread numbers are easier to follow in a dump than OS IDs.
+    uint32_t GetFlightThreadId()
+    {
+        static std::atomic<uint32_t> nextThreadId(1);
+        thread_local uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        return threadId;
+    }
+}
+
+FlightRecorder::FlightRecorder(size_t requestedCapacity)
+    : capacity(RoundUpToPowerOfTwo(requestedCapacity)),
+    mask(capacity - 1),
+    slots(new Slot[capacity]),
+    nextIndex(0)
+{
+    for (size_t index = 0; index < capacity; ++index)
+    {
+        slots[index].sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FlightRecorder::Record(FlightEventType type, int64_t first, int64_t second)
+{
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    uint64_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & mask];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    slot.typeAndThread.store(static_cast<uint32_t>(type) | (GetFlightThreadId() << 16), std::memory_order_relaxed);
+    slot.first.store(first, std::memory_order_relaxed);
+    slot.second.store(second, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<FlightEvent> FlightRecorder::Snapshot(Clock::time_point since) const
+{
+    int64_t sinceTimestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(since.time_since_epoch()).count();
+    uint64_t end = nextIndex.load(std::memory_order_acquire);
+    uint64_t begin = (end > capacity) ? end - capacity : 0;
+
+    std::vector<FlightEvent> events;
+    events.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t index = begin; index < end; ++index)
+    {
+        const Slot& slot = slots[index & mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2)
+        {
+            // Still being written, or already overwritten by a newer event.
+            continue;
+        }
+
+        FlightEvent event{};
+        event.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+        uint32_t typeAndThread = slot.typeAndThread.load(std::memory_order_relaxed);
+        event.type = static_cast<FlightEventType>(typeAndThread & 0xFFFF);
+        event.threadId = typeAndThread >> 16;
+        event.first = slot.first.load(std::memory_order_relaxed);
+        event.second = slot.second.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            continue;
+        }
+
+        if (event.timestamp >= sinceTimestamp)
+        {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+std::string FlightRecorder::Format(const std::vector<FlightEvent>& events, Clock::time_point now)
+{
+    int64_t nowTimestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    std::string text;
+    char line[160];
+    for (const FlightEvent& event : events)
+    {
+        size_t typeIndex = static_cast<size_t>(event.type);
+        if (typeIndex >= static_cast<size_t>(FlightEventType::Count))
+        {
+            continue;
+        }
+
+        const FlightEventInfo& info = EventInfo[typeIndex];
+        int64_t age = nowTimestamp - event.timestamp;
+        int length = std::snprintf(line, sizeof(line), "-%lld.%06llds T%u %s",
+            static_cast<long long>(age / 1000000000),
+            static_cast<long long>((age % 1000000000) / 1000),
+            event.threadId,
+            info.name);
+        if (info.firstName != nullptr && length > 0 && static_cast<size_t>(length) < sizeof(line))
+        {
+            length += std::snprintf(line + length, sizeof(line) - length, " %s=%lld",
+                info.firstName, static_cast<long long>(event.first));
+        }
+        if (info.secondName != nullptr && length > 0 && static_cast<size_t>(length) < sizeof(line))
+        {
+            length += std::snprintf(line + length, sizeof(line) - length, " %s=%lld",
+                info.secondName, static_cast<long long>(event.second));
+        }
+
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+uint64_t FlightRecorder::GetRecordedCount() const
+{
+    return nextIndex.load(std::memory_order_relaxed);
+}
+
+const char* GetFlightEventName(FlightEventType type)
+{
+    size_t typeIndex = static_cast<size_t>(type);
+    return (typeIndex < static_cast<size_t>(FlightEventType::Count)) ? EventInfo[typeIndex].name : "Unknown";
+}
+
+FlightRecorder& GetFlightRecorder()
+{
+    static FlightRecorder recorder;
+    return recorder;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Kinds of flight recorder events. Keep GetFlightEventName and the argument
+// names in FlightRecorder.cpp in sync.
+enum class FlightEventType : uint16_t
+{
+    KeyEvent,           // action, routed to the TV
+    TvAction,           // action, value
+    TvActionResult,     // action, succeeded
+    TvConnect,          // succeeded
+    TvDisconnect,       // -
+    TvRegister,         // succeeded
+    TvSend,             // bytes, succeeded
+    TvReceive,          // bytes, succeeded
+    RoutingChanged,     // useTvVolume, commands
+    DefaultEndpoint,    // matches hint, Dolby Atmos
+    Error,              // log site
+    Count
+};
+
+// One recorded event, as returned by Snapshot.
+struct FlightEvent
+{
+    int64_t timestamp;
+    FlightEventType type;
+    uint32_t threadId;
+    int64_t first;
+    int64_t second;
+};
+
+// Always-on record of recent app activity for post-mortem analysis.
+//
+// Record is lock-free and costs a clock read, one fetch-add and a few stores,
+// so it stays on in release builds. Events go into a fixed ring shared by all
+// threads, each slot guarded by a sequence number; the oldest events are
+// overwritten. Snapshot copies the ring while threads keep recording and
+// skips slots that were rewritten during the copy.
+class FlightRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DefaultCapacity = 8192;
+
+    // capacity is rounded up to a power of two.
+    explicit FlightRecorder(size_t capacity = DefaultCapacity);
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    void Record(FlightEventType type, int64_t first = 0, int64_t second = 0);
+
+    // Returns the events recorded at or after since, oldest first.
+    std::vector<FlightEvent> Snapshot(Clock::time_point since) const;
+
+    // Formats events as text lines, with times relative to now.
+    static std::string Format(const std::vector<FlightEvent>& events, Clock::time_point now);
+
+    uint64_t GetRecordedCount() const;
+
+private:
+    struct Slot
+    {
+        // 2 * index + 1 while event index is written, 2 * index + 2 after.
+        std::atomic<uint64_t> sequence;
+        std::atomic<int64_t> timestamp;
+        std::atomic<uint32_t> typeAndThread;
+        std::atomic<int64_t> first;
+        std::atomic<int64_t> second;
+    };
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> nextIndex;
+};
+
+const char* GetFlightEventName(FlightEventType type);
+
+// The app's flight recorder.
+FlightRecorder& GetFlightRecorder();
+
+inline void RecordFlightEvent(FlightEventType type, int64_t first = 0, int64_t second = 0)
+{
+    GetFlightRecorder().Record(type, first, second);
+}
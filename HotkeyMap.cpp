@@ -0,0 +1,334 @@
+#include "HotkeyMap.h"
+
+#include <cwchar>
+#include <cwctype>
+#include <vector>
+
+namespace
+{
+    // Windows virtual-key codes, spelled out so the map builds anywhere.
+    constexpr uint8_t KeyShiftLeft = 0xA0;
+    constexpr uint8_t KeyShiftRight = 0xA1;
+    constexpr uint8_t KeyControlLeft = 0xA2;
+    constexpr uint8_t KeyControlRight = 0xA3;
+    constexpr uint8_t KeyAltLeft = 0xA4;
+    constexpr uint8_t KeyAltRight = 0xA5;
+    constexpr uint8_t KeyWinLeft = 0x5B;
+    constexpr uint8_t KeyWinRight = 0x5C;
+    constexpr uint8_t KeyF1 = 0x70;
+    constexpr uint8_t KeyVolumeMute = 0xAD;
+    constexpr uint8_t KeyVolumeDown = 0xAE;
+    constexpr uint8_t KeyVolumeUp = 0xAF;
+
+    struct NamedKey
+    {
+        const wchar_t* name;
+        uint8_t virtualKey;
+    };
+
+    constexpr NamedKey NamedKeys[] =
+    {
+        { L"space", 0x20 },
+        { L"pageup", 0x21 },
+        { L"pagedown", 0x22 },
+        { L"end", 0x23 },
+        { L"home", 0x24 },
+        { L"left", 0x25 },
+        { L"up", 0x26 },
+        { L"right", 0x27 },
+        { L"down", 0x28 },
+        { L"insert", 0x2D },
+        { L"delete", 0x2E },
+        { L"add", 0x6B },
+        { L"subtract", 0x6D },
+        { L"volumemute", KeyVolumeMute },
+        { L"volumedown", KeyVolumeDown },
+        { L"volumeup", KeyVolumeUp },
+        { L"medianext", 0xB0 },
+        { L"mediaprev", 0xB1 },
+        { L"mediastop", 0xB2 },
+        { L"mediaplaypause", 0xB3 },
+    };
+
+    std::wstring Lower(const std::wstring& value)
+    {
+        std::wstring result(value);
+        for (wchar_t& character : result)
+        {
+            character = static_cast<wchar_t>(towlower(character));
+        }
+        return result;
+    }
+
+    std::wstring Trim(const std::wstring& value)
+    {
+        size_t first = 0;
+        while (first < value.size() && iswspace(value[first]))
+        {
+            ++first;
+        }
+
+        size_t last = value.size();
+        while (last > first && iswspace(value[last - 1]))
+        {
+            --last;
+        }
+
+        return value.substr(first, last - first);
+    }
+
+    bool ParseInteger(const std::wstring& text, long minimum, long maximum, long& result)
+    {
+        if (text.empty())
+        {
+            return false;
+        }
+
+        wchar_t* end = nullptr;
+        long value = wcstol(text.c_str(), &end, 0);
+        if (end == text.c_str() || *end != L'\0' || value < minimum || value > maximum)
+        {
+            return false;
+        }
+
+        result = value;
+        return true;
+    }
+
+    bool ParseKey(const std::wstring& name, uint8_t& virtualKey)
+    {
+        if (name.size() == 1 && (iswalpha(name[0]) || iswdigit(name[0])))
+        {
+            virtualKey = static_cast<uint8_t>(towupper(name[0]));
+            return true;
+        }
+
+        if (name.size() >= 2 && name[0] == L'f' && iswdigit(name[1]))
+        {
+            long number = 0;
+            if (ParseInteger(name.substr(1), 1, 24, number))
+            {
+                virtualKey = static_cast<uint8_t>(KeyF1 + number - 1);
+                return true;
+            }
+            return false;
+        }
+
+        if (name.size() > 2 && name[0] == L'0' && name[1] == L'x')
+        {
+            long code = 0;
+            if (ParseInteger(name, 1, 0xFE, code))
+            {
+                virtualKey = static_cast<uint8_t>(code);
+                return true;
+            }
+            return false;
+        }
+
+        for (const NamedKey& key : NamedKeys)
+        {
+            if (name == key.name)
+            {
+                virtualKey = key.virtualKey;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParseModifier(const std::wstring& name, uint8_t& modifier)
+    {
+        if (name == L"ctrl" || name == L"control")
+        {
+            modifier = HotkeyModifierControl;
+        }
+        else if (name == L"alt")
+        {
+            modifier = HotkeyModifierAlt;
+        }
+        else if (name == L"shift")
+        {
+            modifier = HotkeyModifierShift;
+        }
+        else if (name == L"win")
+        {
+            modifier = HotkeyModifierWin;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseChord(const std::wstring& chord, uint8_t& virtualKey, uint8_t& modifiers)
+    {
+        std::vector<std::wstring> parts;
+        size_t start = 0;
+        for (;;)
+        {
+            size_t separator = chord.find(L'+', start);
+            parts.push_back(Trim(chord.substr(start, separator - start)));
+            if (separator == std::wstring::npos)
+            {
+                break;
+            }
+            start = separator + 1;
+        }
+
+        modifiers = HotkeyModifierNone;
+        for (size_t index = 0; index + 1 < parts.size(); ++index)
+        {
+            uint8_t modifier = HotkeyModifierNone;
+            if (!ParseModifier(parts[index], modifier))
+            {
+                return false;
+            }
+            modifiers |= modifier;
+        }
+
+        return ParseKey(parts.back(), virtualKey);
+    }
+
+    bool ParseAction(const std::wstring& text, bool& bound, HotkeyTarget& target)
+    {
+        size_t space = text.find_first_of(L" \t");
+        std::wstring verb = text.substr(0, space);
+        std::wstring argument = (space == std::wstring::npos) ? std::wstring() : Trim(text.substr(space));
+
+        bound = true;
+        long value = 1;
+        if (verb == L"up" || verb == L"down")
+        {
+            if (!argument.empty() && !ParseInteger(argument, 1, 100, value))
+            {
+                return false;
+            }
+            target.action = (verb == L"up") ? TvVolumeAction::VolumeUp : TvVolumeAction::VolumeDown;
+        }
+        else if (verb == L"mute" && argument.empty())
+        {
+            target.action = TvVolumeAction::ToggleMute;
+        }
+        else if (verb == L"set")
+        {
+            if (!ParseInteger(argument, 0, 100, value))
+            {
+                return false;
+            }
+            target.action = TvVolumeAction::SetVolume;
+        }
+        else if (verb == L"none" && argument.empty())
+        {
+            bound = false;
+            target.action = TvVolumeAction::VolumeUp;
+        }
+        else
+        {
+            return false;
+        }
+
+        target.value = static_cast<int16_t>(value);
+        return true;
+    }
+}
+
+HotkeyMap::HotkeyMap()
+    : entries()
+{
+}
+
+HotkeyMap HotkeyMap::CreateDefault()
+{
+    HotkeyMap map;
+    map.Bind(KeyVolumeUp, HotkeyModifierNone, true, true, HotkeyTarget{ TvVolumeAction::VolumeUp, 1 });
+    map.Bind(KeyVolumeDown, HotkeyModifierNone, true, true, HotkeyTarget{ TvVolumeAction::VolumeDown, 1 });
+    map.Bind(KeyVolumeMute, HotkeyModifierNone, true, true, HotkeyTarget{ TvVolumeAction::ToggleMute, 1 });
+    return map;
+}
+
+bool HotkeyMap::AddBinding(const std::wstring& binding)
+{
+    std::wstring text = Lower(Trim(binding));
+    size_t colon = text.find(L':');
+    if (colon == std::wstring::npos)
+    {
+        return false;
+    }
+
+    uint8_t virtualKey = 0;
+    uint8_t modifiers = HotkeyModifierNone;
+    if (!ParseChord(Trim(text.substr(0, colon)), virtualKey, modifiers))
+    {
+        return false;
+    }
+
+    bool bound = true;
+    HotkeyTarget target{ TvVolumeAction::VolumeUp, 1 };
+    if (!ParseAction(Trim(text.substr(colon + 1)), bound, target))
+    {
+        return false;
+    }
+
+    Bind(virtualKey, modifiers, modifiers == HotkeyModifierNone, bound, target);
+    return true;
+}
+
+void HotkeyMap::Bind(uint8_t virtualKey, uint8_t modifiers, bool anyModifiers, bool bound, HotkeyTarget target)
+{
+    size_t base = static_cast<size_t>(virtualKey) << 4;
+    uint8_t flags = bound ? EntryBound : 0;
+
+    for (size_t combination = 0; combination < ModifierCombinations; ++combination)
+    {
+        Entry& entry = entries[base | combination];
+        if (combination == (modifiers & 0xF))
+        {
+            entry.target = target;
+            entry.flags = static_cast<uint8_t>(flags | EntryExplicit);
+        }
+        else if (anyModifiers && !(entry.flags & EntryExplicit))
+        {
+            entry.target = target;
+            entry.flags = flags;
+        }
+    }
+}
+
+uint8_t HotkeyMap::GetModifierKeyBit(uint8_t virtualKey)
+{
+    switch (virtualKey)
+    {
+    case KeyControlLeft:
+        return HotkeyModifierControl;
+    case KeyControlRight:
+        return HotkeyModifierControl << 4;
+    case KeyAltLeft:
+        return HotkeyModifierAlt;
+    case KeyAltRight:
+        return HotkeyModifierAlt << 4;
+    case KeyShiftLeft:
+        return HotkeyModifierShift;
+    case KeyShiftRight:
+        return HotkeyModifierShift << 4;
+    case KeyWinLeft:
+        return HotkeyModifierWin;
+    case KeyWinRight:
+        return HotkeyModifierWin << 4;
+    default:
+        return 0;
+    }
+}
+
+size_t HotkeyMap::GetBoundCount() const
+{
+    size_t count = 0;
+    for (const Entry& entry : entries)
+    {
+        if (entry.flags & EntryBound)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
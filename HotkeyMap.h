@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "InputSource.h"
+
+// Logical modifier bits. Left and right keys map to the same bit.
+enum HotkeyModifier : uint8_t
+{
+    HotkeyModifierNone = 0,
+    HotkeyModifierControl = 0x1,
+    HotkeyModifierAlt = 0x2,
+    HotkeyModifierShift = 0x4,
+    HotkeyModifierWin = 0x8
+};
+
+// What a bound key chord does.
+struct HotkeyTarget
+{
+    TvVolumeAction action;
+    int16_t value;
+};
+
+// Maps key chords (a virtual-key code plus modifiers) to TV volume actions.
+//
+// Bindings are kept in a flat table indexed by virtual-key code and modifier
+// bits, so a lookup is a single array access however many bindings exist.
+//
+// A binding is written as "<chord>:<action>", for example
+//   VolumeUp:up            Ctrl+Alt+Up:up 5        F13:set 30
+//   VolumeMute:mute        Ctrl+Alt+Down:down 5    VolumeUp:none
+// A chord is '+'-separated modifiers (Ctrl, Alt, Shift, Win) and one key: a
+// letter, digit, F1-F24, a named key (Up, PageUp, VolumeMute, MediaNext, ...)
+// or a hex virtual-key code such as 0x7C. A chord without modifiers also
+// matches while any modifier is held unless a more specific binding exists.
+// Actions are up [steps], down [steps], mute, set <0-100> and none.
+class HotkeyMap
+{
+public:
+    static constexpr size_t KeyCount = 256;
+    static constexpr size_t ModifierCombinations = 16;
+
+    // Creates a map without bindings.
+    HotkeyMap();
+
+    // Creates the built-in map: the media volume keys with any modifiers.
+    static HotkeyMap CreateDefault();
+
+    // Parses and applies one binding. Returns false and leaves the map
+    // unchanged when the text is malformed.
+    bool AddBinding(const std::wstring& binding);
+
+    // Binds or, with bound == false, unbinds a chord. With anyModifiers the
+    // chord is applied to every modifier combination not explicitly bound.
+    void Bind(uint8_t virtualKey, uint8_t modifiers, bool anyModifiers, bool bound, HotkeyTarget target);
+
+    // Looks up the binding for a key pressed with the given modifiers.
+    const HotkeyTarget* Find(uint8_t virtualKey, uint8_t modifiers) const
+    {
+        const Entry& entry = entries[(static_cast<size_t>(virtualKey) << 4) | (modifiers & 0xF)];
+        return (entry.flags & EntryBound) ? &entry.target : nullptr;
+    }
+
+    // Returns the bit a modifier key occupies in a held-keys mask, or zero
+    // for other keys. Left keys use the low four bits and right keys the high
+    // four, so releasing one side does not clear the other.
+    static uint8_t GetModifierKeyBit(uint8_t virtualKey);
+
+    // Folds a held-keys mask into logical HotkeyModifier bits.
+    static uint8_t FoldModifierKeys(uint8_t heldKeys)
+    {
+        return static_cast<uint8_t>((heldKeys | (heldKeys >> 4)) & 0xF);
+    }
+
+    // Returns the number of chords with a binding, counting each modifier
+    // combination separately.
+    size_t GetBoundCount() const;
+
+private:
+    static constexpr uint8_t EntryBound = 0x1;
+    static constexpr uint8_t EntryExplicit = 0x2;
+
+    struct Entry
+    {
+        HotkeyTarget target;
+        uint8_t flags;
+    };
+
+    std::array<Entry, KeyCount * ModifierCombinations> entries;
+};
@@ -0,0 +1,83 @@
+#include "InputHookController.h"
+
+InputHookController::InputHookController(IInputHookBackend& backendValue)
+    : backend(backendValue),
+    installed(false),
+    installedSince(),
+    installedTime(Clock::duration::zero()),
+    installCount(0),
+    uninstallCount(0),
+    installFailureCount(0)
+{
+}
+
+void InputHookController::Update(bool routeToTv)
+{
+    if (routeToTv == installed)
+    {
+        return;
+    }
+
+    if (!routeToTv)
+    {
+        Uninstall();
+        return;
+    }
+
+    if (!backend.Install())
+    {
+        ++installFailureCount;
+        return;
+    }
+
+    installed = true;
+    installedSince = Clock::now();
+    ++installCount;
+}
+
+void InputHookController::Shutdown()
+{
+    Uninstall();
+}
+
+bool InputHookController::IsInstalled() const
+{
+    return installed;
+}
+
+uint64_t InputHookController::GetInstallCount() const
+{
+    return installCount;
+}
+
+uint64_t InputHookController::GetUninstallCount() const
+{
+    return uninstallCount;
+}
+
+uint64_t InputHookController::GetInstallFailureCount() const
+{
+    return installFailureCount;
+}
+
+InputHookController::Clock::duration InputHookController::GetInstalledTime() const
+{
+    if (installed)
+    {
+        return installedTime + (Clock::now() - installedSince);
+    }
+    return installedTime;
+}
+
+void InputHookController::Uninstall()
+{
+    if (!installed)
+    {
+        return;
+    }
+
+    backend.Uninstall();
+    installed = false;
+    installedTime += Clock::now() - installedSince;
+    ++uninstallCount;
+}
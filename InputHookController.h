@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Installs and removes a system-wide input hook. Implemented over
+// SetWindowsHookEx in the app and over a fake in tests.
+class IInputHookBackend
+{
+public:
+    virtual ~IInputHookBackend() = default;
+
+    // Installs the hook. Returns false if the system refused it.
+    virtual bool Install() = 0;
+
+    // Removes an installed hook.
+    virtual void Uninstall() = 0;
+};
+
+// Keeps the keyboard hook installed only while volume keys are routed to the
+// TV, so keystrokes are not funneled through our process the rest of the time.
+//
+// All calls must come from the thread that owns the hook. The hook callback
+// still checks the routing state itself: between routing turning off and the
+// next Update the hook is installed but passes every key through, and between
+// routing turning on and the next Update keys go to Windows, whose endpoint
+// volume stays pinned.
+class InputHookController
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit InputHookController(IInputHookBackend& backend);
+
+    // Brings the hook in line with the routing state. A failed install is
+    // retried on the next call.
+    void Update(bool routeToTv);
+
+    // Removes the hook regardless of routing state.
+    void Shutdown();
+
+    bool IsInstalled() const;
+
+    uint64_t GetInstallCount() const;
+    uint64_t GetUninstallCount() const;
+    uint64_t GetInstallFailureCount() const;
+
+    // Total time the hook was installed, including the current installation.
+    Clock::duration GetInstalledTime() const;
+
+private:
+    void Uninstall();
+
+    IInputHookBackend& backend;
+    bool installed;
+    Clock::time_point installedSince;
+    Clock::duration installedTime;
+
+    uint64_t installCount;
+    uint64_t uninstallCount;
+    uint64_t installFailureCount;
+};
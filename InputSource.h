@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+
+#include "InputThread.h"
+
+// What a volume key asks the TV to do, independent of where it came from.
+enum class TvVolumeAction
+{
+    VolumeUp = 0,
+    VolumeDown = 1,
+    ToggleMute = 2,
+    SetVolume = 3
+};
+
+// One normalized volume key event. value is the number of steps for
+// VolumeUp/VolumeDown and the absolute level (0-100) for SetVolume. The
+// timestamp is taken as close to the hardware as the source allows, on the
+// steady clock.
+struct TvVolumeEvent
+{
+    TvVolumeAction action = TvVolumeAction::VolumeUp;
+    int value = 1;
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+// Receives volume key events from an input source, on the source's thread.
+class IInputEventSink
+{
+public:
+    virtual ~IInputEventSink() = default;
+
+    // Handles one event. Returns true when the event was taken over and the
+    // key should be kept from the rest of the system where the source can.
+    // Must return quickly; the source may be holding up system input.
+    virtual bool OnTvVolumeEvent(const TvVolumeEvent& event) = 0;
+};
+
+// Produces volume key events on an InputThread.
+//
+// A source is told whether volume keys should currently be captured, i.e.
+// kept from the rest of the system, through a query it re-evaluates on its
+// own thread whenever RequestCaptureUpdate is called.
+class IInputSource : public IInputEventLoop
+{
+public:
+    // Asks the source to re-evaluate whether to capture volume keys. Safe to
+    // call from any thread; a no-op while the source is not running.
+    virtual void RequestCaptureUpdate() = 0;
+};
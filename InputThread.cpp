@@ -0,0 +1,98 @@
+#include "InputThread.h"
+
+InputThread::InputThread()
+    : loop(nullptr),
+    startState(StartState::Pending),
+    running(false)
+{
+}
+
+InputThread::~InputThread()
+{
+    Stop();
+}
+
+bool InputThread::Start(IInputEventLoop& loopValue, ThreadCallback threadStart)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (running)
+    {
+        return false;
+    }
+
+    loop = &loopValue;
+    startState = StartState::Pending;
+
+    try
+    {
+        thread = std::thread(&InputThread::ThreadMain, this, loop, std::move(threadStart));
+    }
+    catch (...)
+    {
+        loop = nullptr;
+        return false;
+    }
+
+    started.wait(lock, [this]() { return startState != StartState::Pending; });
+
+    if (startState == StartState::Failed)
+    {
+        lock.unlock();
+        thread.join();
+        lock.lock();
+        loop = nullptr;
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void InputThread::Stop()
+{
+    IInputEventLoop* runningLoop = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!running)
+        {
+            return;
+        }
+        runningLoop = loop;
+    }
+
+    runningLoop->RequestStop();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    loop = nullptr;
+    running = false;
+}
+
+bool InputThread::IsRunning() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return running;
+}
+
+void InputThread::ThreadMain(IInputEventLoop* runLoop, ThreadCallback threadStart)
+{
+    if (threadStart)
+    {
+        threadStart();
+    }
+
+    bool prepared = runLoop->Prepare();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        startState = prepared ? StartState::Prepared : StartState::Failed;
+    }
+    started.notify_all();
+
+    if (prepared)
+    {
+        runLoop->Run();
+    }
+}
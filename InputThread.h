@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// An event loop that runs on an InputThread: a Windows message pump that owns
+// the keyboard hook in the app, or a synthetic event source in tests.
+class IInputEventLoop
+{
+public:
+    virtual ~IInputEventLoop() = default;
+
+    // Runs first on the input thread. Start returns once this has returned,
+    // so anything set up here can be used by other threads afterwards.
+    virtual bool Prepare() = 0;
+
+    // Dispatches events until RequestStop is called.
+    virtual void Run() = 0;
+
+    // Makes Run return. Called from another thread.
+    virtual void RequestStop() = 0;
+};
+
+// Dedicated thread that does nothing but run an input event loop, so slow
+// work elsewhere in the app can never delay input callbacks.
+class InputThread
+{
+public:
+    using ThreadCallback = std::function<void()>;
+
+    InputThread();
+    ~InputThread();
+
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    // Starts the thread and waits until the loop is prepared. threadStart runs
+    // on the new thread before Prepare, e.g. to raise its priority. Returns
+    // false if the thread could not be created or Prepare failed.
+    bool Start(IInputEventLoop& loop, ThreadCallback threadStart = {});
+
+    // Stops the loop and joins the thread.
+    void Stop();
+
+    bool IsRunning() const;
+
+private:
+    enum class StartState
+    {
+        Pending,
+        Prepared,
+        Failed
+    };
+
+    void ThreadMain(IInputEventLoop* loop, ThreadCallback threadStart);
+
+    mutable std::mutex mutex;
+    std::condition_variable started;
+    std::thread thread;
+    IInputEventLoop* loop;
+    StartState startState;
+    bool running;
+};
@@ -1,15 +1,12 @@
 #include "framework.h"
 #include "LGTVVolumeProxy.h"
 
-#include <mmdeviceapi.h>
-#include <endpointvolume.h>
-#include <functiondiscoverykeys_devpkey.h>
-#include <propvarutil.h>
-#include <wrl/client.h>
 #include <shellapi.h>
 
+#include <algorithm>
 #include <string>
 #include <atomic>
+#include <memory>
 #include <deque>
 #include <fstream>
 #include <cwctype>
@@ -17,10 +14,23 @@
 #include <cstdlib>
 #include <avrt.h>
 
-#include "AudioFormatAliases.h"
+#include "AudioRouter.h"
+#include "ClientKeyStore.h"
 #include "Configuration.h"
+#include "ConfigurationPersister.h"
+#include "ConfigurationStore.h"
+#include "ConfigurationWatcher.h"
+#include "DeviceNameMatcher.h"
+#include "FlightRecorder.h"
+#include "HotkeyMap.h"
+#include "InputSource.h"
+#include "InputThread.h"
 #include "Logging.h"
+#include "MMDeviceEndpointBackend.h"
 #include "TVClient.h"
+#include "TraceRecorder.h"
+#include "TvProfile.h"
+#include "WindowsKeyboardHookSource.h"
 
 #pragma comment(lib, "Ole32.lib")
 #pragma comment(lib, "Mmdevapi.lib")
@@ -31,8 +41,6 @@
 
 #define MAX_LOADSTRING 100
 
-using Microsoft::WRL::ComPtr;
-
 HINSTANCE hInst;                                // current instance
 WCHAR szTitle[MAX_LOADSTRING];                  // title bar text
 WCHAR szWindowClass[MAX_LOADSTRING];            // main window class name
@@ -56,39 +64,32 @@ INT_PTR CALLBACK    About(HWND, UINT, WPARAM, LPARAM);
 
 // Tray icon callback and command identifiers.
 static constexpr UINT WM_TRAYICON = WM_APP + 1;
+
+// Posted to the main window when routing state changed on another thread.
+static constexpr UINT WM_ROUTINGCHANGED = WM_APP + 2;
+
+// Posted to the main window when the configuration file changed on disk.
+static constexpr UINT WM_CONFIGURATIONCHANGED = WM_APP + 3;
 #define IDM_TRAY_OPEN          41001
 #define IDM_TRAY_EXIT          41002
+#define IDM_TRAY_EXPORT_TRACE  41003
+#define IDM_TRAY_DUMP_FLIGHT   41004
 
-/// Returns a lowercase copy of the given string using the current locale.
-static std::wstring ToLower(const std::wstring& value)
+// Configuration snapshots shared across modules and threads.
+static ConfigurationStore g_configurationStore;
+
+/// Returns the current configuration snapshot.
+static std::shared_ptr<const AppConfiguration> GetConfiguration()
 {
-    std::wstring result(value);
-    for (wchar_t& character : result)
-    {
-        character = static_cast<wchar_t>(towlower(character));
-    }
-    return result;
+    return g_configurationStore.Acquire();
 }
 
-// Forward declarations.
-static void UpdateRouting();
-
-// Global configuration shared across modules.
-static AppConfiguration g_configuration;
+// Writes published configurations to disk off the UI thread.
+static ConfigurationPersister g_configurationPersister(SaveConfiguration);
 
 // Audio and routing state.
-static std::atomic<bool> g_defaultDeviceIsLg(false);
-static std::atomic<bool> g_dolbyAtmosActive(false);
-static std::atomic<bool> g_useTvVolume(false);
-static std::atomic<bool> g_tvMuted(false);
-static std::wstring g_defaultDeviceName;
-
-static ComPtr<IAudioEndpointVolume> g_endpointVolume;
-static float g_prevVolumeScalar = 0.25f;
-static GUID  g_volumeEventContext = GUID_NULL;
-
-// Global keyboard hook used to intercept volume keys.
-static HHOOK g_hKeyboardHook = nullptr;
+static MMDeviceEndpointBackend* g_endpointBackend = nullptr;
+static AudioRouter* g_audioRouter = nullptr;
 
 // Controls whether the app starts with the window hidden when paired.
 static bool g_startMinimized = false;
@@ -96,9 +97,17 @@ static bool g_startMinimized = false;
 // Allows WM_CLOSE to destroy the window when true.
 static bool g_allowClose = false;
 
+// Main window, used to marshal status updates back to the UI thread.
+static HWND g_mainWindow = nullptr;
+
+// TV profile shown in the connection settings; Apply, Pair and Unpair act on
+// it. Follows the active profile. UI thread only.
+static std::wstring g_editedTvProfile;
+
 /// Holds handles to all runtime-created UI controls.
 struct UiHandles
 {
+    HWND titleConnection{};
     HWND editTvIp{};
     HWND editTvMac{};
     HWND editDeviceHint{};
@@ -140,38 +149,79 @@ namespace Ui
             return;
         }
 
-        wchar_t buffer[128];
+        TvProfile profile;
+        FindTvProfile(*GetConfiguration(), GetActiveTvProfileName(), profile);
+        wchar_t buffer[192];
 
-        swprintf_s(
-            buffer,
-            L"%s:%hu",
-            g_configuration.tvIpAddress.c_str(),
-            g_configuration.tvPort);
+        if (profile.name.empty())
+        {
+            swprintf_s(buffer, L"%s:%hu", profile.tvIpAddress.c_str(), profile.tvPort);
+        }
+        else
+        {
+            swprintf_s(buffer, L"%s:%hu (%s)", profile.tvIpAddress.c_str(), profile.tvPort, profile.name.c_str());
+        }
         SetWindowTextW(g_handles.statusConnectionValue, buffer);
 
-        SetWindowTextW(g_handles.statusMacValue, g_configuration.tvMacAddress.c_str());
+        SetWindowTextW(g_handles.statusMacValue, profile.tvMacAddress.c_str());
+
+        AudioRoutingStatus routing;
+        if (g_audioRouter)
+        {
+            routing = g_audioRouter->GetStatus();
+        }
 
         const wchar_t* deviceNameToShow =
-            !g_defaultDeviceName.empty()
-            ? g_defaultDeviceName.c_str()
-            : g_configuration.deviceNameHint.c_str();
+            !routing.defaultDeviceName.empty()
+            ? routing.defaultDeviceName.c_str()
+            : profile.deviceNameHint.c_str();
         SetWindowTextW(g_handles.statusDeviceNameValue, deviceNameToShow);
 
         SetWindowTextW(
             g_handles.statusRoutingValue,
-            g_useTvVolume.load() ? L"TV" : L"Windows");
+            routing.useTvVolume ? L"TV" : L"Windows");
 
         SetWindowTextW(
             g_handles.statusDefaultLgValue,
-            g_defaultDeviceIsLg.load() ? L"Yes" : L"No");
+            routing.defaultDeviceMatches ? L"Yes" : L"No");
 
         SetWindowTextW(
             g_handles.statusAtmosValue,
-            g_dolbyAtmosActive.load() ? L"Yes" : L"No");
+            routing.dolbyAtmosAvailable ? L"Yes" : L"No");
 
-        SetWindowTextW(
-            g_handles.statusPairingValue,
-            GetTVClient().HasClientKey() ? L"Yes" : L"No");
+        // Read without the client's lock, so a connect timeout or an open
+        // pairing prompt never stalls the UI thread here.
+        TvClientStatus tvStatus = GetTVClient().GetStatus();
+        if (!tvStatus.paired)
+        {
+            swprintf_s(buffer, L"No");
+        }
+        else if (tvStatus.connected && tvStatus.lastCommandMilliseconds != 0)
+        {
+            swprintf_s(buffer, L"Yes, connected (%u ms)", tvStatus.lastCommandMilliseconds);
+        }
+        else if (tvStatus.connected)
+        {
+            swprintf_s(buffer, L"Yes, connected");
+        }
+        else if (tvStatus.lastError != TvClientError::None)
+        {
+            swprintf_s(buffer, L"Yes, %s", GetTvClientErrorText(tvStatus.lastError));
+        }
+        else
+        {
+            swprintf_s(buffer, L"Yes");
+        }
+        SetWindowTextW(g_handles.statusPairingValue, buffer);
+    }
+
+    /// Asks the UI thread to refresh the status text. Safe to call from any thread.
+    static void RequestStatusRefresh()
+    {
+        if (g_mainWindow)
+        {
+            PostMessageW(g_mainWindow, WM_ROUTINGCHANGED, 0, 0);
+        }
     }
 
     /// Creates the tray icon associated with the main window.
@@ -225,6 +275,8 @@ namespace Ui
         }
 
         AppendMenuW(menu, MF_STRING, IDM_TRAY_OPEN, L"Open");
+        AppendMenuW(menu, MF_STRING, IDM_TRAY_EXPORT_TRACE, L"Export Trace");
+        AppendMenuW(menu, MF_STRING, IDM_TRAY_DUMP_FLIGHT, L"Dump Flight Recorder");
         AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
         AppendMenuW(menu, MF_STRING, IDM_TRAY_EXIT, L"Exit");
 
@@ -262,10 +314,46 @@ namespace Ui
         }
     }
 
+    /// Writes the recorded trace spans next to the executable for a trace viewer.
+    static void ExportTrace(HWND parentWindow)
+    {
+        std::wstring path = GetLogDirectory() + L"LGTVVolumeProxy.trace.json";
+        std::string trace = TraceRecorder::ExportChromeTrace(GetCurrentProcessId());
+
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output << trace;
+        output.close();
+        if (!output)
+        {
+            LGTV_LOG_ERROR(UI, L"Failed to write trace to %s", path.c_str());
+            MessageBoxW(parentWindow, L"The trace could not be written.", L"LG TV Volume Proxy", MB_ICONERROR | MB_OK);
+            return;
+        }
+
+        LGTV_LOG_INFO(UI, L"Trace written to %s", path.c_str());
+        std::wstring message = L"Trace written to:\n\n" + path +
+            L"\n\nOpen it in chrome://tracing or ui.perfetto.dev.";
+        MessageBoxW(parentWindow, message.c_str(), L"LG TV Volume Proxy", MB_ICONINFORMATION | MB_OK);
+    }
+
+    /// Writes the flight recorder's recent events next to the executable.
+    static void DumpFlightRecorderOnRequest(HWND parentWindow)
+    {
+        if (!DumpFlightRecorder(L"tray menu"))
+        {
+            MessageBoxW(parentWindow, L"The flight recorder could not be written.", L"LG TV Volume Proxy", MB_ICONERROR | MB_OK);
+            return;
+        }
+
+        std::wstring message = L"Recent activity written to:\n\n" + GetLogDirectory() + L"LGTVVolumeProxy.flight.txt";
+        MessageBoxW(parentWindow, message.c_str(), L"LG TV Volume Proxy", MB_ICONINFORMATION | MB_OK);
+    }
+
     /// Shows the one-time hint explaining that close minimizes to tray.
     static void ShowCloseToTrayHint(HWND parentWindow)
     {
-        if (!g_configuration.showCloseToTrayMessage)
+        std::shared_ptr<const AppConfiguration> configuration = GetConfiguration();
+        if (!configuration->showCloseToTrayMessage)
         {
             return;
         }
@@ -283,286 +371,189 @@ namespace Ui
 
         if (result == IDNO)
         {
-            g_configuration.showCloseToTrayMessage = false;
-            SaveConfiguration(g_configuration);
+            AppConfiguration updated = *GetConfiguration();
+            updated.showCloseToTrayMessage = false;
+            g_configurationStore.Publish(updated);
+            g_configurationPersister.Schedule(std::move(updated));
         }
     }
 }
 
-// Watches audio endpoint changes and keeps routing state in sync.
-class AudioEndpointWatcher : public IMMNotificationClient
+// Compiled device name hint of one TV profile.
+struct TvProfileMatcher
 {
-public:
-    AudioEndpointWatcher() : _refCount(1) {}
+    std::wstring profileName;
+    DeviceNameMatcher matcher;
+};
+using TvProfileMatchers = std::vector<TvProfileMatcher>;
 
-    HRESULT Initialize()
+// Matchers of every profile in match order (see GetTvProfiles); replaced by
+// BuildHintMatcher and only used on the UI thread.
+static std::shared_ptr<const TvProfileMatchers> g_tvProfileMatchers;
+
+/// Compiles each profile's device name hint; the audio router treats an
+/// endpoint matched by any of them as a TV.
+static EndpointCapabilityCache::HintMatcher BuildHintMatcher()
+{
+    auto matchers = std::make_shared<TvProfileMatchers>();
+    size_t patternCount = 0;
+    for (const TvProfile& profile : GetTvProfiles(*GetConfiguration()))
     {
-        HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator),
-            nullptr,
-            CLSCTX_ALL,
-            __uuidof(IMMDeviceEnumerator),
-            (void**)_enumerator.GetAddressOf());
-        if (FAILED(hr))
-        {
-            DebugLog(L"[Audio] MMDeviceEnumerator failed: 0x%08X\n", hr);
-            return hr;
-        }
+        matchers->push_back({ profile.name, DeviceNameMatcher::Compile(profile.deviceNameHint) });
+        patternCount += matchers->back().matcher.GetPatternCount();
+    }
 
-        hr = _enumerator->RegisterEndpointNotificationCallback(this);
-        if (FAILED(hr))
-        {
-            DebugLog(L"[Audio] RegisterEndpointNotificationCallback failed: 0x%08X\n", hr);
-            return hr;
-        }
+    LGTV_LOG_INFO(Audio, L"Device name hints compiled: %zu profile(s), %zu name pattern(s)",
+        matchers->size(), patternCount);
 
-        RefreshDefaultDevice();
-        return S_OK;
-    }
+    std::shared_ptr<const TvProfileMatchers> compiled = std::move(matchers);
+    g_tvProfileMatchers = compiled;
 
-    void Shutdown()
+    return [compiled](const std::wstring& endpointId, const std::wstring& friendlyName)
     {
-        if (_enumerator)
+        for (const TvProfileMatcher& profile : *compiled)
         {
-            _enumerator->UnregisterEndpointNotificationCallback(this);
-            _enumerator.Reset();
+            if (profile.matcher.Matches(endpointId, friendlyName))
+            {
+                return true;
+            }
         }
-    }
+        return false;
+    };
+}
 
-    // IUnknown
-    ULONG STDMETHODCALLTYPE AddRef() override
-    {
-        return InterlockedIncrement(&_refCount);
-    }
+/// Returns true while volume keys are routed to the TV.
+static bool IsTvVolumeActive()
+{
+    return g_audioRouter && g_audioRouter->IsTvVolumeActive();
+}
 
-    ULONG STDMETHODCALLTYPE Release() override
+/// Sets the Windows endpoint volume of the current default device.
+static void SetEndpointVolume(float level)
+{
+    if (g_audioRouter)
     {
-        ULONG ulRef = InterlockedDecrement(&_refCount);
-        if (ulRef == 0)
-            delete this;
-        return ulRef;
+        g_audioRouter->SetEndpointVolume(level);
     }
+}
 
-    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, VOID** ppvInterface) override
+/// Asks the router to recompute routing, e.g. after the pairing state changed.
+static void UpdateRouting()
+{
+    if (g_audioRouter)
     {
-        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient))
-        {
-            AddRef();
-            *ppvInterface = (IMMNotificationClient*)this;
-            return S_OK;
-        }
-        *ppvInterface = nullptr;
-        return E_NOINTERFACE;
+        g_audioRouter->RequestRoutingUpdate();
     }
+}
 
-    // IMMNotificationClient
-    HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow,
-        ERole role,
-        LPCWSTR) override
-    {
-        if (flow == eRender && (role == eConsole || role == eMultimedia))
-        {
-            DebugLog(L"[Audio] OnDefaultDeviceChanged\n");
-            RefreshDefaultDevice();
-        }
-        return S_OK;
-    }
+static void RequestKeyboardHookUpdate();
+static void ApplyConfiguration(const AppConfiguration& updated, bool fromFile);
 
-    HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { return S_OK; }
-    HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { return S_OK; }
-    HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { return S_OK; }
-    HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { return S_OK; }
+/// Creates the endpoint backend and starts the audio router.
+static void StartAudioRouting()
+{
+    g_endpointBackend = new MMDeviceEndpointBackend();
+    g_audioRouter = new AudioRouter(*g_endpointBackend);
+    g_audioRouter->SetOnlyWhenDolbyAtmos(GetConfiguration()->onlyWhenDolbyAtmos);
+    g_audioRouter->SetHintMatcher(BuildHintMatcher());
 
-private:
-    HRESULT RefreshDefaultDevice()
-    {
-        ComPtr<IMMDevice> device;
-        HRESULT hr = _enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device);
-        if (FAILED(hr))
+    bool started = g_audioRouter->Start(
+        []()
         {
-            DebugLog(L"[Audio] GetDefaultAudioEndpoint failed: 0x%08X\n", hr);
-            g_defaultDeviceIsLg = false;
-            g_dolbyAtmosActive = false;
-            g_defaultDeviceName.clear();
-            g_endpointVolume.Reset();
-            UpdateRouting();
-            return hr;
-        }
-
-        bool isLg = IsLgDevice(device.Get());
-        g_defaultDeviceIsLg = isLg;
-
-        bool atmos = false;
-        if (isLg)
-            atmos = IsDolbyAtmosAvailable(device.Get());
-        g_dolbyAtmosActive = atmos;
-
-        // Update endpoint volume interface
-        g_endpointVolume.Reset();
-        hr = device->Activate(__uuidof(IAudioEndpointVolume),
-            CLSCTX_ALL,
-            nullptr,
-            (void**)g_endpointVolume.GetAddressOf());
-        if (FAILED(hr))
+            return GetTVClient().HasClientKey();
+        },
+        []()
         {
-            DebugLog(L"[Audio] Activate(IAudioEndpointVolume) failed: 0x%08X\n", hr);
-        }
-
-        DebugLog(L"[Audio] Endpoint match: isLg=%d, atmos=%d\n", isLg ? 1 : 0, atmos ? 1 : 0);
-
-        UpdateRouting();
-        return S_OK;
+            RequestKeyboardHookUpdate();
+            Ui::RequestStatusRefresh();
+        });
+    if (!started)
+    {
+        LGTV_LOG_ERROR(Audio, L"Failed to start audio routing");
     }
+}
 
-    bool IsLgDevice(IMMDevice* device)
+/// Stops the audio router and releases the endpoint backend.
+static void StopAudioRouting()
+{
+    if (g_audioRouter)
     {
-        if (!device)
-        {
-            g_defaultDeviceName.clear();
-            return false;
-        }
-
-        ComPtr<IPropertyStore> props;
-        HRESULT hr = device->OpenPropertyStore(STGM_READ, &props);
-        if (FAILED(hr))
-        {
-            g_defaultDeviceName.clear();
-            return false;
-        }
-
-        PROPVARIANT varName;
-        PropVariantInit(&varName);
-
-        hr = props->GetValue(PKEY_Device_FriendlyName, &varName);
-        if (FAILED(hr))
-        {
-            PropVariantClear(&varName);
-            g_defaultDeviceName.clear();
-            return false;
-        }
+        g_audioRouter->Stop();
+
+        const CoalescingWorkQueue& queue = g_audioRouter->GetRefreshQueue();
+        const EndpointCapabilityCache& cache = g_audioRouter->GetCapabilityCache();
+        LGTV_LOG_INFO(Audio, L"Endpoint notifications: posted=%llu, refreshes=%llu, saved=%llu, cache hits=%llu, misses=%llu",
+            static_cast<unsigned long long>(queue.GetPostedCount()),
+            static_cast<unsigned long long>(queue.GetProcessedCount()),
+            static_cast<unsigned long long>(queue.GetCoalescedCount()),
+            static_cast<unsigned long long>(cache.GetHitCount()),
+            static_cast<unsigned long long>(cache.GetMissCount()));
+
+        uint64_t repins = 0;
+        uint64_t suppressed = 0;
+        g_audioRouter->GetVolumePinCounts(repins, suppressed);
+        LGTV_LOG_INFO(Audio, L"Endpoint volume re-pins=%llu, suppressed=%llu",
+            static_cast<unsigned long long>(repins),
+            static_cast<unsigned long long>(suppressed));
+
+        delete g_audioRouter;
+        g_audioRouter = nullptr;
+    }
 
-        bool result = false;
-        if (varName.vt == VT_LPWSTR && varName.pwszVal)
-        {
-            std::wstring name(varName.pwszVal);
-            g_defaultDeviceName = name;
-            std::wstring nameLower = ToLower(name);
-            std::wstring hintLower = ToLower(g_configuration.deviceNameHint);
+    if (g_endpointBackend)
+    {
+        g_endpointBackend->Release();
+        g_endpointBackend = nullptr;
+    }
+}
 
-            if (!hintLower.empty() &&
-                nameLower.find(hintLower) != std::wstring::npos)
-            {
-                result = true;
-            }
+/// Fills the connection settings from the active TV profile and makes it the
+/// profile they edit.
+static void LoadProfileControls()
+{
+    TvProfile profile;
+    FindTvProfile(*GetConfiguration(), GetActiveTvProfileName(), profile);
+    g_editedTvProfile = profile.name;
 
-            DebugLog(L"[Audio] Endpoint name: %s, hint: %s, match=%d\n",
-                name.c_str(), g_configuration.deviceNameHint.c_str(), result ? 1 : 0);
-        }
-        else
+    if (Ui::g_handles.titleConnection)
+    {
+        std::wstring title = L"Connection";
+        if (!profile.name.empty())
         {
-            g_defaultDeviceName.clear();
+            title += L" (" + profile.name + L")";
         }
-
-        PropVariantClear(&varName);
-        return result;
+        SetWindowTextW(Ui::g_handles.titleConnection, title.c_str());
     }
-
-    bool IsDolbyAtmosAvailable(IMMDevice* device)
+    if (Ui::g_handles.editTvIp)
     {
-        if (!device)
-            return false;
-
-        ComPtr<ISpatialAudioClient> spatial;
-        HRESULT hr = device->Activate(__uuidof(ISpatialAudioClient),
-            CLSCTX_INPROC_SERVER,
-            nullptr,
-            (void**)spatial.GetAddressOf());
-        if (FAILED(hr) || !spatial)
-        {
-            DebugLog(L"[Audio] Activate(ISpatialAudioClient) failed: 0x%08X\n", hr);
-            return false;
-        }
-
-        hr = spatial->IsSpatialAudioStreamAvailable(LGTV_SPATIAL_AUDIO_FORMAT_DOLBY_ATMOS,
-            nullptr);
-        if (hr == S_OK)
-            return true;
-
-        DebugLog(L"[Audio] IsSpatialAudioStreamAvailable returned: 0x%08X\n", hr);
-        return false;
+        SetWindowTextW(Ui::g_handles.editTvIp, profile.tvIpAddress.c_str());
     }
-
-    ComPtr<IMMDeviceEnumerator> _enumerator;
-    LONG _refCount;
-};
-
-static AudioEndpointWatcher* g_endpointWatcher = nullptr;
-/// Recomputes routing state and pins or restores the Windows endpoint volume.
-static void UpdateRouting()
-{
-    bool useTv = false;
-
-    if (g_defaultDeviceIsLg.load())
+    if (Ui::g_handles.editTvMac)
     {
-        if (g_configuration.onlyWhenDolbyAtmos)
-            useTv = g_dolbyAtmosActive.load();
-        else
-            useTv = true;
+        SetWindowTextW(Ui::g_handles.editTvMac, profile.tvMacAddress.c_str());
     }
-
-    // TV routing is only active when the default device matches
-    // and the app is currently paired with a TV.
-    if (useTv && !GetTVClient().HasClientKey())
+    if (Ui::g_handles.editDeviceHint)
     {
-        useTv = false;
+        SetWindowTextW(Ui::g_handles.editDeviceHint, profile.deviceNameHint.c_str());
     }
-
-    bool prevUse = g_useTvVolume.load();
-    g_useTvVolume.store(useTv);
-
-    // Pin/unpin endpoint volume around routing toggle
-    if (g_endpointVolume)
+    if (Ui::g_handles.editTvPort)
     {
-        if (useTv && !prevUse)
-        {
-            float current = g_prevVolumeScalar;
-            if (SUCCEEDED(g_endpointVolume->GetMasterVolumeLevelScalar(&current)))
-            {
-                g_prevVolumeScalar = current;
-            }
-
-            if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-            {
-                HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                if (FAILED(guidResult))
-                {
-                    ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                }
-            }
-
-            g_endpointVolume->SetMasterVolumeLevelScalar(1.0f, &g_volumeEventContext);
-        }
-        else if (!useTv && prevUse)
-        {
-            if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-            {
-                HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                if (FAILED(guidResult))
-                {
-                    ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                }
-            }
-
-            g_endpointVolume->SetMasterVolumeLevelScalar(g_prevVolumeScalar,
-                &g_volumeEventContext);
-        }
+        wchar_t portBuffer[16];
+        swprintf_s(portBuffer, L"%hu", profile.tvPort);
+        SetWindowTextW(Ui::g_handles.editTvPort, portBuffer);
+    }
+    if (Ui::g_handles.checkUseSecure)
+    {
+        SendMessageW(Ui::g_handles.checkUseSecure, BM_SETCHECK,
+            profile.useSecureWebSocket ? BST_CHECKED : BST_UNCHECKED, 0);
     }
-
-    Ui::UpdateStatusText();
 }
 
 /// Creates all child controls in the main window based on the current configuration.
 static void CreateChildControls(HWND hWnd)
 {
+    std::shared_ptr<const AppConfiguration> configuration = GetConfiguration();
+
     RECT clientRect{};
     GetClientRect(hWnd, &clientRect);
     const int clientWidth = clientRect.right - clientRect.left;
@@ -599,8 +590,8 @@ static void CreateChildControls(HWND hWnd)
         Ui::ApplyFont(control);
     };
 
-    // TV connection group
-    HWND titleConnection = CreateWindowExW(
+    // TV connection group; LoadProfileControls fills it.
+    Ui::g_handles.titleConnection = CreateWindowExW(
         0,
         L"STATIC",
         L"Connection",
@@ -613,7 +604,7 @@ static void CreateChildControls(HWND hWnd)
         nullptr,
         hInst,
         nullptr);
-    applyFont(titleConnection);
+    applyFont(Ui::g_handles.titleConnection);
     y += controlHeight;
 
     HWND groupConnection = CreateWindowExW(
@@ -651,7 +642,7 @@ static void CreateChildControls(HWND hWnd)
     Ui::g_handles.editTvIp = CreateWindowExW(
         WS_EX_CLIENTEDGE,
         L"EDIT",
-        g_configuration.tvIpAddress.c_str(),
+        L"",
         WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
         valueColumnX,
         rowY - 1,
@@ -682,7 +673,7 @@ static void CreateChildControls(HWND hWnd)
     Ui::g_handles.editTvMac = CreateWindowExW(
         WS_EX_CLIENTEDGE,
         L"EDIT",
-        g_configuration.tvMacAddress.c_str(),
+        L"",
         WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
         valueColumnX,
         rowY - 1,
@@ -713,7 +704,7 @@ static void CreateChildControls(HWND hWnd)
     Ui::g_handles.editDeviceHint = CreateWindowExW(
         WS_EX_CLIENTEDGE,
         L"EDIT",
-        g_configuration.deviceNameHint.c_str(),
+        L"",
         WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
         valueColumnX,
         rowY - 1,
@@ -741,12 +732,10 @@ static void CreateChildControls(HWND hWnd)
         nullptr);
     applyFont(labelTvPort);
 
-    wchar_t portBuffer[16];
-    swprintf_s(portBuffer, L"%hu", g_configuration.tvPort);
     Ui::g_handles.editTvPort = CreateWindowExW(
         WS_EX_CLIENTEDGE,
         L"EDIT",
-        portBuffer,
+        L"",
         WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
         valueColumnX,
         rowY - 1,
@@ -773,11 +762,7 @@ static void CreateChildControls(HWND hWnd)
         hInst,
         nullptr);
     applyFont(Ui::g_handles.checkUseSecure);
-    SendMessageW(
-        Ui::g_handles.checkUseSecure,
-        BM_SETCHECK,
-        g_configuration.useSecureWebSocket ? BST_CHECKED : BST_UNCHECKED,
-        0);
+    LoadProfileControls();
     rowY += controlHeight + 6;
 
     int connectionBottom = rowY;
@@ -842,7 +827,7 @@ static void CreateChildControls(HWND hWnd)
     SendMessageW(
         Ui::g_handles.checkOnlyAtmos,
         BM_SETCHECK,
-        g_configuration.onlyWhenDolbyAtmos ? BST_CHECKED : BST_UNCHECKED,
+        configuration->onlyWhenDolbyAtmos ? BST_CHECKED : BST_UNCHECKED,
         0);
 
     int routingBottom = routingRowY + controlHeight + 10;
@@ -1053,10 +1038,10 @@ static void CreateChildControls(HWND hWnd)
 
     int targetX = 0;
     int targetY = 0;
-    if (g_configuration.hasWindowPosition)
+    if (configuration->hasWindowPosition)
     {
-        targetX = g_configuration.windowLeft;
-        targetY = g_configuration.windowTop;
+        targetX = configuration->windowLeft;
+        targetY = configuration->windowTop;
     }
     else
     {
@@ -1089,21 +1074,34 @@ static void CreateChildControls(HWND hWnd)
 static void ApplyConfigFromUI()
 {
     wchar_t buf[256];
+    AppConfiguration updated = *GetConfiguration();
+
+    // The connection settings belong to the profile they were loaded from.
+    TvProfile profile;
+    if (!FindTvProfile(updated, g_editedTvProfile, profile))
+    {
+        profile.name = g_editedTvProfile;
+    }
 
     if (Ui::g_handles.editTvIp)
     {
         GetWindowTextW(Ui::g_handles.editTvIp, buf, ARRAYSIZE(buf));
-        g_configuration.tvIpAddress = buf;
+        profile.tvIpAddress = buf;
     }
     if (Ui::g_handles.editTvMac)
     {
         GetWindowTextW(Ui::g_handles.editTvMac, buf, ARRAYSIZE(buf));
-        g_configuration.tvMacAddress = buf;
+        profile.tvMacAddress = buf;
     }
     if (Ui::g_handles.editDeviceHint)
     {
         GetWindowTextW(Ui::g_handles.editDeviceHint, buf, ARRAYSIZE(buf));
-        g_configuration.deviceNameHint = buf;
+        profile.deviceNameHint = buf;
+    }
+    if (Ui::g_handles.checkUseSecure)
+    {
+        profile.useSecureWebSocket =
+            (SendMessageW(Ui::g_handles.checkUseSecure, BM_GETCHECK, 0, 0) == BST_CHECKED);
     }
     if (Ui::g_handles.editTvPort)
     {
@@ -1111,85 +1109,133 @@ static void ApplyConfigFromUI()
         int port = _wtoi(buf);
         if (port <= 0 || port > 65535)
         {
-            port = g_configuration.useSecureWebSocket ? 3001 : 3000;
+            port = profile.useSecureWebSocket ? 3001 : 3000;
         }
-        g_configuration.tvPort = static_cast<unsigned short>(port);
+        profile.tvPort = static_cast<unsigned short>(port);
     }
-    if (Ui::g_handles.checkOnlyAtmos)
+    if (!StoreTvProfile(updated, profile))
     {
-        g_configuration.onlyWhenDolbyAtmos =
-            (SendMessageW(Ui::g_handles.checkOnlyAtmos, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        // The other settings are still applied; the profile keeps its
+        // previous connection settings.
+        LGTV_LOG_WARNING(Configuration, L"Not saving TV profile %s: '|' is not allowed in its IP or MAC address",
+            profile.name.c_str());
     }
-    if (Ui::g_handles.checkUseSecure)
+
+    if (Ui::g_handles.checkOnlyAtmos)
     {
-        g_configuration.useSecureWebSocket =
-            (SendMessageW(Ui::g_handles.checkUseSecure, BM_GETCHECK, 0, 0) == BST_CHECKED);
+        updated.onlyWhenDolbyAtmos =
+            (SendMessageW(Ui::g_handles.checkOnlyAtmos, BM_GETCHECK, 0, 0) == BST_CHECKED);
     }
 
-    SaveConfiguration(g_configuration);
-
-    // Recalculate routing with new "onlyWhenAtmos" flag etc.
-    UpdateRouting();
+    ApplyConfiguration(updated, false);
+    g_configurationPersister.Schedule(std::move(updated));
 }
 
-/// Represents a queued TV volume action to be processed off the hook/UI thread.
-enum class TvVolumeAction
+/// Fills the settings controls whose fields changed from the configuration.
+static void LoadControlsFromConfiguration(uint32_t changes)
 {
-    VolumeUp = 0,
-    VolumeDown = 1,
-    ToggleMute = 2
-};
+    constexpr uint32_t ProfileChanges =
+        ConfigurationChangeTvTransport | ConfigurationChangeTvMacAddress |
+        ConfigurationChangeDeviceNameHint | ConfigurationChangeTvProfiles;
+    if (changes & ProfileChanges)
+    {
+        LoadProfileControls();
+    }
+
+    std::shared_ptr<const AppConfiguration> configuration = GetConfiguration();
+    if ((changes & ConfigurationChangeOnlyWhenDolbyAtmos) && Ui::g_handles.checkOnlyAtmos)
+    {
+        SendMessageW(Ui::g_handles.checkOnlyAtmos, BM_SETCHECK,
+            configuration->onlyWhenDolbyAtmos ? BST_CHECKED : BST_UNCHECKED, 0);
+    }
+}
 
 static HANDLE g_tvVolumeWorkerThread = nullptr;
 static HANDLE g_tvVolumeWorkerEvent = nullptr;
 static CRITICAL_SECTION g_tvVolumeQueueLock;
 static bool g_tvVolumeQueueLockInitialized = false;
 static bool g_tvVolumeWorkerShutdown = false;
-static std::deque<TvVolumeAction> g_tvVolumeQueue;
+// Volume key events waiting to be sent to the TV, in arrival order.
+static std::deque<TvVolumeEvent> g_tvVolumeQueue;
+// Set when the active TV profile changed, so the worker connects to it
+// before the first key press rather than during it.
+static std::atomic<bool> g_tvWarmUpRequested(false);
+
+// Set when TV profiles changed, so the worker closes the connections of
+// profiles that were renamed or removed.
+static std::atomic<bool> g_tvProfileCleanupRequested(false);
 
 /// Executes a TV volume action on the TV client.
-static bool ExecuteTvVolumeAction(TvVolumeAction action)
+static bool ExecuteTvVolumeAction(const TvVolumeEvent& event)
 {
+    TraceSpan span("Key", "ExecuteTvVolumeAction");
+    RecordFlightEvent(FlightEventType::TvAction, static_cast<int64_t>(event.action), event.value);
+
     bool handled = false;
 
-    switch (action)
+    switch (event.action)
     {
     case TvVolumeAction::VolumeUp:
-        handled = GetTVClient().VolumeUp();
-        break;
     case TvVolumeAction::VolumeDown:
-        handled = GetTVClient().VolumeDown();
-        break;
-    case TvVolumeAction::ToggleMute:
     {
-        bool previousMuted = g_tvMuted.load();
-        bool newMuted = !previousMuted;
-        handled = GetTVClient().SetMute(newMuted);
-        if (handled)
+        int steps = (std::max)(event.value, 1);
+        handled = true;
+        for (int step = 0; step < steps && handled; ++step)
         {
-            g_tvMuted.store(newMuted);
+            handled = (event.action == TvVolumeAction::VolumeUp)
+                ? GetTVClient().VolumeUp()
+                : GetTVClient().VolumeDown();
         }
         break;
     }
+    case TvVolumeAction::SetVolume:
+        handled = GetTVClient().SetVolume(event.value);
+        break;
+    case TvVolumeAction::ToggleMute:
+    {
+        // Each TV toggles from the state last set on it.
+        LGWebOSClient& client = GetTVClient();
+        handled = client.SetMute(!client.IsMuted());
+        break;
+    }
     default:
         break;
     }
 
+    RecordFlightEvent(FlightEventType::TvActionResult, static_cast<int64_t>(event.action), handled ? 1 : 0);
     if (!handled)
     {
-        DebugLog(L"[Key] TV volume command failed for action=%d",
-            static_cast<int>(action));
+        LGTV_LOG_DEBUG(Key, L"TV volume command failed for action=%d, value=%d",
+            static_cast<int>(event.action), event.value);
     }
 
     return handled;
 }
 
+/// Refreshes the status text when the TV connection opened, closed or failed
+/// differently since the last call. Called on the worker thread only.
+static void RequestStatusRefreshOnTvChange()
+{
+    static bool lastConnected = false;
+    static TvClientError lastError = TvClientError::None;
+
+    TvClientStatus status = GetTVClient().GetStatus();
+    if (status.connected != lastConnected || status.lastError != lastError)
+    {
+        lastConnected = status.connected;
+        lastError = status.lastError;
+        Ui::RequestStatusRefresh();
+    }
+}
+
 /// Worker thread that processes queued TV volume actions at elevated priority.
 static DWORD WINAPI TvVolumeWorkerThreadProc(_In_ LPVOID)
 {
     HANDLE mmcssHandle = nullptr;
     DWORD taskIndex = 0;
 
+    TraceRecorder::SetThreadName("TV worker");
+
     mmcssHandle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
     if (!mmcssHandle)
     {
@@ -1206,7 +1252,7 @@ static DWORD WINAPI TvVolumeWorkerThreadProc(_In_ LPVOID)
 
         for (;;)
         {
-            TvVolumeAction action = TvVolumeAction::VolumeUp;
+            TvVolumeEvent event;
             bool haveWork = false;
             bool shouldShutdown = false;
 
@@ -1215,7 +1261,7 @@ static DWORD WINAPI TvVolumeWorkerThreadProc(_In_ LPVOID)
                 EnterCriticalSection(&g_tvVolumeQueueLock);
                 if (!g_tvVolumeQueue.empty())
                 {
-                    action = g_tvVolumeQueue.front();
+                    event = g_tvVolumeQueue.front();
                     g_tvVolumeQueue.pop_front();
                     haveWork = true;
                 }
@@ -1233,10 +1279,27 @@ static DWORD WINAPI TvVolumeWorkerThreadProc(_In_ LPVOID)
 
             if (!haveWork)
             {
+                if (g_tvProfileCleanupRequested.exchange(false))
+                {
+                    CloseRemovedTvProfileConnections();
+                    continue;
+                }
+                if (g_tvWarmUpRequested.exchange(false))
+                {
+                    GetTVClient().WarmUp();
+                    RequestStatusRefreshOnTvChange();
+                    continue;
+                }
                 break;
             }
 
-            ExecuteTvVolumeAction(action);
+            long long queuedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - event.timestamp).count();
+            LGTV_LOG_DEBUG(Key, L"Executing action=%d after %lld us\n",
+                static_cast<int>(event.action), queuedMicroseconds);
+
+            ExecuteTvVolumeAction(event);
+            RequestStatusRefreshOnTvChange();
         }
     }
 
@@ -1263,7 +1326,7 @@ static bool InitializeTvVolumeWorker()
         g_tvVolumeWorkerEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
         if (!g_tvVolumeWorkerEvent)
         {
-            ErrorLog(L"[Key] CreateEvent for TV volume worker failed: %lu", GetLastError());
+            LGTV_LOG_ERROR(Key, L"CreateEvent for TV volume worker failed: %lu", GetLastError());
             return false;
         }
     }
@@ -1281,7 +1344,7 @@ static bool InitializeTvVolumeWorker()
             nullptr);
         if (!g_tvVolumeWorkerThread)
         {
-            ErrorLog(L"[Key] CreateThread for TV volume worker failed: %lu", GetLastError());
+            LGTV_LOG_ERROR(Key, L"CreateThread for TV volume worker failed: %lu", GetLastError());
             CloseHandle(g_tvVolumeWorkerEvent);
             g_tvVolumeWorkerEvent = nullptr;
             return false;
@@ -1331,9 +1394,11 @@ static void ShutdownTvVolumeWorker()
     g_tvVolumeWorkerShutdown = false;
 }
 
-/// Enqueues a TV volume action to be processed by the worker thread.
-static bool EnqueueTvVolumeAction(TvVolumeAction action)
+/// Enqueues a TV volume event to be processed by the worker thread.
+static bool EnqueueTvVolumeEvent(const TvVolumeEvent& event)
 {
+    TraceSpan span("Key", "EnqueueTvVolumeEvent");
+
     if (!g_tvVolumeWorkerThread || !g_tvVolumeWorkerEvent || !g_tvVolumeQueueLockInitialized)
     {
         return false;
@@ -1342,7 +1407,7 @@ static bool EnqueueTvVolumeAction(TvVolumeAction action)
     EnterCriticalSection(&g_tvVolumeQueueLock);
     if (!g_tvVolumeWorkerShutdown)
     {
-        g_tvVolumeQueue.push_back(action);
+        g_tvVolumeQueue.push_back(event);
         LeaveCriticalSection(&g_tvVolumeQueueLock);
         SetEvent(g_tvVolumeWorkerEvent);
         return true;
@@ -1352,68 +1417,261 @@ static bool EnqueueTvVolumeAction(TvVolumeAction action)
     return false;
 }
 
-/// Low-level keyboard hook used to intercept global volume keys.
-static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+/// Asks the worker thread to connect to the active TV profile.
+static void RequestTvWarmUp()
+{
+    if (g_tvVolumeWorkerEvent)
+    {
+        g_tvWarmUpRequested.store(true);
+        SetEvent(g_tvVolumeWorkerEvent);
+    }
+}
+
+/// Has the worker close connections of TV profiles that no longer exist.
+static void RequestTvProfileCleanup()
+{
+    if (g_tvVolumeWorkerEvent)
+    {
+        g_tvProfileCleanupRequested.store(true);
+        SetEvent(g_tvVolumeWorkerEvent);
+    }
+}
+
+/// Forwards volume key events from the input source to the TV action queue.
+class TvVolumeKeySink : public IInputEventSink
 {
-    if (nCode >= 0)
+public:
+    bool OnTvVolumeEvent(const TvVolumeEvent& event) override
     {
-        KBDLLHOOKSTRUCT* pkb = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-        if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)
+        bool useTv = IsTvVolumeActive();
+        RecordFlightEvent(FlightEventType::KeyEvent, static_cast<int64_t>(event.action), useTv ? 1 : 0);
+        LGTV_LOG_DEBUG(Key, L"action=%d, useTv=%d\n",
+            static_cast<int>(event.action), useTv ? 1 : 0);
+
+        if (!useTv)
         {
-            if (pkb->vkCode == VK_VOLUME_UP ||
-                pkb->vkCode == VK_VOLUME_DOWN ||
-                pkb->vkCode == VK_VOLUME_MUTE)
-            {
-                DebugLog(L"[Key] VK=%u, useTv=%d\n",
-                    pkb->vkCode, g_useTvVolume.load() ? 1 : 0);
+            return false;
+        }
 
-                if (g_useTvVolume.load())
-                {
-                    TvVolumeAction action = TvVolumeAction::VolumeUp;
-                    switch (pkb->vkCode)
-                    {
-                    case VK_VOLUME_UP:
-                        action = TvVolumeAction::VolumeUp;
-                        break;
-                    case VK_VOLUME_DOWN:
-                        action = TvVolumeAction::VolumeDown;
-                        break;
-                    case VK_VOLUME_MUTE:
-                        action = TvVolumeAction::ToggleMute;
-                        break;
-                    default:
-                        break;
-                    }
-
-                    if (!EnqueueTvVolumeAction(action))
-                    {
-                        ErrorLog(L"[Key] Failed to enqueue TV volume action");
-                    }
-
-                    // Keep endpoint volume pinned to 100% while routing to TV.
-                    if (g_endpointVolume)
-                    {
-                        if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-                        {
-                            HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                            if (FAILED(guidResult))
-                            {
-                                ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                            }
-                        }
-                        g_endpointVolume->SetMasterVolumeLevelScalar(
-                            1.0f, &g_volumeEventContext);
-                    }
-
-                    // Swallow the key so Windows does not also change volume,
-                    // even if the TV command later fails.
-                    return 1;
-                }
-            }
+        if (!EnqueueTvVolumeEvent(event))
+        {
+            LGTV_LOG_ERROR(Key, L"Failed to enqueue TV volume action");
+        }
+
+        // Swallow the key so Windows does not also change volume,
+        // even if the TV command later fails.
+        return true;
+    }
+};
+
+static TvVolumeKeySink g_tvVolumeKeySink;
+static WindowsKeyboardHookSource g_inputSource(g_tvVolumeKeySink,
+    []()
+    {
+        return IsTvVolumeActive();
+    });
+static InputThread g_inputThread;
+
+/// Asks the input source to capture or release volume keys to match the
+/// routing state. Safe to call from any thread.
+static void RequestKeyboardHookUpdate()
+{
+    g_inputSource.RequestCaptureUpdate();
+}
+
+/// Builds the hotkey map from the default volume keys and configured bindings.
+static std::shared_ptr<const HotkeyMap> BuildHotkeyMap()
+{
+    std::shared_ptr<const AppConfiguration> configuration = GetConfiguration();
+    HotkeyMap map = HotkeyMap::CreateDefault();
+    for (const std::wstring& binding : configuration->hotkeyBindings)
+    {
+        if (!map.AddBinding(binding))
+        {
+            LGTV_LOG_WARNING(Key, L"Ignoring invalid hotkey binding: %s", binding.c_str());
         }
     }
 
-    return CallNextHookEx(g_hKeyboardHook, nCode, wParam, lParam);
+    LGTV_LOG_INFO(Key, L"Hotkey map has %zu bound chords", map.GetBoundCount());
+    return std::make_shared<const HotkeyMap>(std::move(map));
+}
+
+/// Makes the first profile whose device hint matches the default endpoint
+/// the active one. While no profile matches, the last one stays active unless
+/// it was removed from the configuration.
+static void SelectTvProfileForEndpoint()
+{
+    if (!g_audioRouter || !g_tvProfileMatchers)
+    {
+        return;
+    }
+
+    AudioRoutingStatus routing = g_audioRouter->GetStatus();
+    const std::wstring* selected = nullptr;
+    for (const TvProfileMatcher& profile : *g_tvProfileMatchers)
+    {
+        if (!routing.defaultDeviceId.empty() &&
+            profile.matcher.Matches(routing.defaultDeviceId, routing.defaultDeviceName))
+        {
+            selected = &profile.profileName;
+            break;
+        }
+    }
+
+    std::wstring fallback;
+    if (!selected)
+    {
+        TvProfile active;
+        if (FindTvProfile(*GetConfiguration(), GetActiveTvProfileName(), active))
+        {
+            return;
+        }
+        selected = &fallback;
+    }
+
+    if (SelectTvProfile(*selected))
+    {
+        TvProfile profile;
+        profile.name = *selected;
+        LGTV_LOG_INFO(LGTV, L"Active TV profile: %s", GetTvProfileDisplayName(profile));
+        LoadProfileControls();
+        RequestTvWarmUp();
+        if (g_audioRouter)
+        {
+            g_audioRouter->RequestRoutingUpdate();
+        }
+    }
+}
+
+/// Makes an updated configuration current and refreshes only what depends on
+/// the fields that changed. Window position and the close-to-tray hint are
+/// read when needed, so changing them costs nothing.
+static void ApplyConfiguration(const AppConfiguration& updated, bool fromFile)
+{
+    uint32_t changes = CompareConfigurations(*GetConfiguration(), updated);
+    if (changes == ConfigurationChangeNone)
+    {
+        return;
+    }
+
+    LGTV_LOG_INFO(Configuration, L"Configuration changed%s: fields=0x%03X",
+        fromFile ? L" on disk" : L"", changes);
+    // The TV client notices the new version before its next command.
+    g_configurationStore.Publish(updated);
+
+    if (g_audioRouter && (changes & ConfigurationChangeOnlyWhenDolbyAtmos))
+    {
+        g_audioRouter->SetOnlyWhenDolbyAtmos(updated.onlyWhenDolbyAtmos);
+    }
+    if (g_audioRouter && (changes & ConfigurationChangeTvIdentity))
+    {
+        // Another TV has its own client key, so the paired state may differ.
+        g_audioRouter->RequestRoutingUpdate();
+    }
+    if (g_audioRouter && (changes & (ConfigurationChangeDeviceNameHint | ConfigurationChangeTvProfiles)))
+    {
+        g_audioRouter->SetHintMatcher(BuildHintMatcher());
+        SelectTvProfileForEndpoint();
+    }
+    if (changes & ConfigurationChangeTvProfiles)
+    {
+        RequestTvProfileCleanup();
+    }
+    if (changes & ConfigurationChangeHotkeyBindings)
+    {
+        g_inputSource.SetHotkeyMap(BuildHotkeyMap());
+    }
+    if ((changes & ConfigurationChangeLogLevels) && !ApplyLogLevels(updated.logLevels))
+    {
+        LGTV_LOG_WARNING(Configuration, L"Ignoring malformed parts of log_levels: %s", updated.logLevels.c_str());
+    }
+
+    if (fromFile)
+    {
+        LoadControlsFromConfiguration(changes);
+    }
+    Ui::UpdateStatusText();
+}
+
+/// Re-reads the configuration file after it changed on disk.
+static void ReloadConfigurationFromFile()
+{
+    // The file is about to be overwritten with a newer configuration; reading
+    // it now could undo changes that were not written yet.
+    if (g_configurationPersister.IsPending())
+    {
+        return;
+    }
+
+    AppConfiguration loaded;
+    LoadConfiguration(loaded);
+    ApplyConfiguration(loaded, true);
+}
+
+/// Records the main window's position and schedules it to be saved.
+static void SaveWindowPosition(HWND hWnd)
+{
+    RECT windowRect{};
+    if (!GetWindowRect(hWnd, &windowRect))
+    {
+        return;
+    }
+
+    std::shared_ptr<const AppConfiguration> configuration = GetConfiguration();
+    AppConfiguration updated = *configuration;
+    updated.windowLeft = windowRect.left;
+    updated.windowTop = windowRect.top;
+    updated.hasWindowPosition = true;
+    if (CompareConfigurations(*configuration, updated) == ConfigurationChangeNone)
+    {
+        return;
+    }
+
+    g_configurationStore.Publish(updated);
+    g_configurationPersister.Schedule(std::move(updated));
+}
+
+static ConfigurationWatcher g_configurationWatcher;
+static ConfigurationWatcher g_clientKeyWatcher;
+
+/// Starts the input thread that owns the keyboard hook.
+static void StartInputThread()
+{
+    g_inputSource.SetHotkeyMap(BuildHotkeyMap());
+
+    bool started = g_inputThread.Start(g_inputSource,
+        []()
+        {
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+        });
+    if (!started)
+    {
+        LGTV_LOG_ERROR(Key, L"Failed to start input thread");
+    }
+}
+
+/// Stops the input thread, which removes the hook, and logs what the hook cost.
+static void StopInputThread()
+{
+    g_inputThread.Stop();
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+
+    const InputHookController& hook = g_inputSource.GetHookController();
+    const CallbackLatencyMonitor& latency = g_inputSource.GetLatencyMonitor();
+
+    uint64_t callbacks = latency.GetCallbackCount();
+    long long totalMicroseconds = duration_cast<microseconds>(latency.GetTotalTime()).count();
+    LGTV_LOG_INFO(Key, L"Keyboard hook: installs=%llu, failures=%llu, installed=%lld ms, keystrokes=%llu, avg callback=%lld us, max=%lld us, slow=%llu",
+        static_cast<unsigned long long>(hook.GetInstallCount()),
+        static_cast<unsigned long long>(hook.GetInstallFailureCount()),
+        static_cast<long long>(duration_cast<milliseconds>(hook.GetInstalledTime()).count()),
+        static_cast<unsigned long long>(callbacks),
+        callbacks ? totalMicroseconds / static_cast<long long>(callbacks) : 0LL,
+        static_cast<long long>(duration_cast<microseconds>(latency.GetMaxTime()).count()),
+        static_cast<unsigned long long>(latency.GetSlowCount()));
 }
 
 /// Application entry point.
@@ -1429,9 +1687,18 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     if (FAILED(hr))
         return -1;
 
+    TraceRecorder::SetThreadName("UI");
+
     // Load configuration from disk (if present)
-    LoadConfiguration(g_configuration);
-    InitializeTVClient(&g_configuration);
+    AppConfiguration loaded;
+    LoadConfiguration(loaded);
+    if (!ApplyLogLevels(loaded.logLevels))
+    {
+        LGTV_LOG_WARNING(Configuration, L"Ignoring malformed parts of log_levels: %s", loaded.logLevels.c_str());
+    }
+    g_configurationStore.Publish(std::move(loaded));
+    g_configurationPersister.Start();
+    InitializeTVClient(&g_configurationStore);
     g_startMinimized = GetTVClient().HasClientKey();
 
     LoadStringW(hInstance, IDS_APP_TITLE, szTitle, MAX_LOADSTRING);
@@ -1451,6 +1718,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         DispatchMessage(&msg);
     }
 
+    ShutdownLogging();
     CoUninitialize();
     return (int)msg.wParam;
 }
@@ -1491,6 +1759,8 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
     if (!hWnd)
         return FALSE;
 
+    g_mainWindow = hWnd;
+
     int showCommand = nCmdShow;
     if (g_startMinimized)
     {
@@ -1502,26 +1772,40 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
 
     Ui::CreateTrayIcon(hWnd);
 
-    // Create audio endpoint watcher
-    g_endpointWatcher = new AudioEndpointWatcher();
-    if (g_endpointWatcher)
-        g_endpointWatcher->Initialize();
+    // Start watching audio endpoints and routing volume keys.
+    StartAudioRouting();
 
     // Create TV volume worker thread used to process volume actions.
     if (!InitializeTvVolumeWorker())
     {
-        DebugLog(L"[Key] InitializeTvVolumeWorker failed\n");
+        LGTV_LOG_DEBUG(Key, L"InitializeTvVolumeWorker failed\n");
     }
 
-    // Install low-level keyboard hook
-    g_hKeyboardHook = SetWindowsHookExW(WH_KEYBOARD_LL,
-        LowLevelKeyboardProc,
-        GetModuleHandleW(nullptr),
-        0);
-    if (!g_hKeyboardHook)
-    {
-        DebugLog(L"[Key] SetWindowsHookEx failed: %lu\n", GetLastError());
-    }
+    // The keyboard hook lives on its own thread so slow UI work never
+    // delays keystrokes; it is installed once routing targets the TV.
+    StartInputThread();
+
+    // Pick up hand edits to the configuration file without a restart.
+    g_configurationWatcher.Start(GetConfigurationFilePath(),
+        []()
+        {
+            if (g_mainWindow)
+            {
+                PostMessageW(g_mainWindow, WM_CONFIGURATIONCHANGED, 0, 0);
+            }
+        });
+
+    // Keys copied in or removed by hand change the paired state shown in the
+    // status text.
+    g_clientKeyWatcher.Start(GetClientKeyStore().GetPath(),
+        []()
+        {
+            GetClientKeyStore().Reload();
+            if (g_mainWindow)
+            {
+                PostMessageW(g_mainWindow, WM_ROUTINGCHANGED, 0, 0);
+            }
+        });
 
     return TRUE;
 }
@@ -1561,38 +1845,37 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             DestroyWindow(hWnd);
             break;
 
+        case IDM_TRAY_EXPORT_TRACE:
+            Ui::ExportTrace(hWnd);
+            break;
+
+        case IDM_TRAY_DUMP_FLIGHT:
+            Ui::DumpFlightRecorderOnRequest(hWnd);
+            break;
+
         case IDC_BUTTON_APPLY:
-            DebugLog(L"[UI] Apply clicked\n");
+            LGTV_LOG_DEBUG(UI, L"Apply clicked\n");
             ApplyConfigFromUI();
             Ui::UpdateStatusText();
             break;
 
         case IDC_BUTTON_PAIR:
         {
-            DebugLog(L"[UI] Pair button clicked\n");
+            LGTV_LOG_DEBUG(UI, L"Pair button clicked\n");
 
             // Make sure configuration is up to date (IP/port might have changed)
             ApplyConfigFromUI();
             Ui::UpdateStatusText();
 
-            if (GetTVClient().PairWithTv(hWnd))
+            // Pair the profile the settings show, even if another is active.
+            LGWebOSClient& client = GetTVClientForProfile(g_editedTvProfile);
+            if (client.PairWithTv(hWnd))
             {
-                DebugLog(L"[UI] PairWithTv() succeeded\n");
+                LGTV_LOG_DEBUG(UI, L"PairWithTv() succeeded\n");
 
-                if (g_endpointVolume)
-                {
-                    if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-                    {
-                        HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                        if (FAILED(guidResult))
-                        {
-                            ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                        }
-                    }
-                    g_endpointVolume->SetMasterVolumeLevelScalar(1.0f, &g_volumeEventContext);
-                }
+                SetEndpointVolume(1.0f);
 
-                GetTVClient().SetVolume(10);
+                client.SetVolume(10);
 
                 MessageBoxW(
                     hWnd,
@@ -1602,7 +1885,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             }
             else
             {
-                DebugLog(L"[UI] PairWithTv() FAILED\n");
+                LGTV_LOG_DEBUG(UI, L"PairWithTv() FAILED\n");
                 MessageBoxW(
                     hWnd,
                     L"Pairing failed.\n\nCheck:\n- TV IP / port / ws vs wss\n- TV is on and on the same network\n- You accepted the prompt on the TV.",
@@ -1617,9 +1900,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
         case IDC_BUTTON_UNPAIR:
         {
-            DebugLog(L"[UI] Unpair button clicked\n");
+            LGTV_LOG_DEBUG(UI, L"Unpair button clicked\n");
 
-            if (!GetTVClient().HasClientKey())
+            LGWebOSClient& client = GetTVClientForProfile(g_editedTvProfile);
+            if (!client.HasClientKey())
             {
                 MessageBoxW(
                     hWnd,
@@ -1631,20 +1915,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
             // Set both Windows and TV volume to a safe fallback
             // before removing pairing information.
-            if (g_endpointVolume)
-            {
-                if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-                {
-                    HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                    if (FAILED(guidResult))
-                    {
-                        ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                    }
-                }
-                g_endpointVolume->SetMasterVolumeLevelScalar(0.10f, &g_volumeEventContext);
-            }
+            SetEndpointVolume(0.10f);
 
-            GetTVClient().SetVolume(10);
+            client.SetVolume(10);
 
             int result = MessageBoxW(
                 hWnd,
@@ -1654,9 +1927,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 MB_YESNO | MB_ICONQUESTION);
             if (result == IDYES)
             {
-                if (GetTVClient().UnpairFromTv())
+                if (client.UnpairFromTv())
                 {
-                    DebugLog(L"[UI] UnpairFromTv() succeeded\n");
+                    LGTV_LOG_DEBUG(UI, L"UnpairFromTv() succeeded\n");
                     MessageBoxW(
                         hWnd,
                         L"Pairing information removed.\n\nYou will need to pair again before using TV volume control.",
@@ -1665,7 +1938,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 }
                 else
                 {
-                    DebugLog(L"[UI] UnpairFromTv() FAILED\n");
+                    LGTV_LOG_DEBUG(UI, L"UnpairFromTv() FAILED\n");
                     MessageBoxW(
                         hWnd,
                         L"Failed to remove pairing information.",
@@ -1689,6 +1962,19 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         Ui::HandleTrayIconMessage(hWnd, lParam);
         break;
 
+    case WM_ROUTINGCHANGED:
+        SelectTvProfileForEndpoint();
+        Ui::UpdateStatusText();
+        break;
+
+    case WM_CONFIGURATIONCHANGED:
+        ReloadConfigurationFromFile();
+        break;
+
+    case WM_EXITSIZEMOVE:
+        SaveWindowPosition(hWnd);
+        break;
+
     case WM_PAINT:
     {
         PAINTSTRUCT ps;
@@ -1719,48 +2005,26 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
     {
         // Restore audio to a safe fallback before exiting.
-        if (g_endpointVolume)
-        {
-            if (IsEqualGUID(g_volumeEventContext, GUID_NULL))
-            {
-                HRESULT guidResult = CoCreateGuid(&g_volumeEventContext);
-                if (FAILED(guidResult))
-                {
-                    ErrorLog(L"[Audio] CoCreateGuid failed: 0x%08X", guidResult);
-                }
-            }
-            g_endpointVolume->SetMasterVolumeLevelScalar(0.10f, &g_volumeEventContext);
-        }
+        SetEndpointVolume(0.10f);
 
         if (GetTVClient().HasClientKey())
         {
             GetTVClient().SetVolume(10);
         }
 
-        if (g_hKeyboardHook)
-        {
-            UnhookWindowsHookEx(g_hKeyboardHook);
-            g_hKeyboardHook = nullptr;
-        }
+        g_configurationWatcher.Stop();
+        g_clientKeyWatcher.Stop();
+
+        StopInputThread();
 
         ShutdownTvVolumeWorker();
 
-        if (g_endpointWatcher)
-        {
-            g_endpointWatcher->Shutdown();
-            g_endpointWatcher->Release();
-            g_endpointWatcher = nullptr;
-        }
+        StopAudioRouting();
 
-        RECT windowRect{};
-        if (GetWindowRect(hWnd, &windowRect))
-        {
-            g_configuration.windowLeft = windowRect.left;
-            g_configuration.windowTop = windowRect.top;
-            g_configuration.hasWindowPosition = true;
-            SaveConfiguration(g_configuration);
-        }
+        SaveWindowPosition(hWnd);
+        g_configurationPersister.Stop();
         Ui::DestroyTrayIcon();
+        g_mainWindow = nullptr;
 
         if (Ui::g_font)
         {
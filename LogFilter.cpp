@@ -0,0 +1,156 @@
+#include "LogFilter.h"
+
+#include <cwctype>
+
+std::atomic<uint64_t> g_logEnabledMask{ GetDefaultLogMask() };
+
+namespace
+{
+    constexpr uint32_t LogLevelOff = LogLevelError + 1;
+
+    constexpr const wchar_t* SubsystemNames[LogSubsystemCount] =
+    {
+        L"Audio",
+        L"Key",
+        L"LGTV",
+        L"UI",
+        L"Configuration"
+    };
+
+    std::wstring Trim(const std::wstring& value)
+    {
+        size_t first = 0;
+        while (first < value.size() && iswspace(value[first]))
+        {
+            ++first;
+        }
+
+        size_t last = value.size();
+        while (last > first && iswspace(value[last - 1]))
+        {
+            --last;
+        }
+
+        return value.substr(first, last - first);
+    }
+
+    std::wstring Lower(const std::wstring& value)
+    {
+        std::wstring result(value);
+        for (wchar_t& character : result)
+        {
+            character = static_cast<wchar_t>(towlower(character));
+        }
+        return result;
+    }
+
+    bool ParseLevel(const std::wstring& text, uint32_t& level)
+    {
+        std::wstring name = Lower(Trim(text));
+        if (name == L"debug")
+        {
+            level = LogLevelDebug;
+        }
+        else if (name == L"info")
+        {
+            level = LogLevelInfo;
+        }
+        else if (name == L"warning")
+        {
+            level = LogLevelWarning;
+        }
+        else if (name == L"error")
+        {
+            level = LogLevelError;
+        }
+        else if (name == L"off")
+        {
+            level = LogLevelOff;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseSubsystem(const std::wstring& text, LogSubsystem& subsystem)
+    {
+        std::wstring name = Lower(Trim(text));
+        for (size_t index = 0; index < LogSubsystemCount; ++index)
+        {
+            if (name == Lower(SubsystemNames[index]))
+            {
+                subsystem = static_cast<LogSubsystem>(index);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+const wchar_t* GetLogSubsystemName(LogSubsystem subsystem)
+{
+    size_t index = static_cast<size_t>(subsystem);
+    return (index < LogSubsystemCount) ? SubsystemNames[index] : L"";
+}
+
+void SetLogLevel(LogSubsystem subsystem, uint32_t minimumLevel)
+{
+    uint64_t subsystemBits = 0;
+    uint64_t enabledBits = 0;
+    for (uint32_t level = LogLevelDebug; level <= LogLevelError; ++level)
+    {
+        subsystemBits |= GetLogMaskBit(subsystem, level);
+        if (level >= minimumLevel && level >= static_cast<uint32_t>(LGTV_LOG_COMPILED_LEVEL))
+        {
+            enabledBits |= GetLogMaskBit(subsystem, level);
+        }
+    }
+
+    uint64_t mask = g_logEnabledMask.load(std::memory_order_relaxed);
+    while (!g_logEnabledMask.compare_exchange_weak(mask, (mask & ~subsystemBits) | enabledBits, std::memory_order_relaxed))
+    {
+    }
+}
+
+bool ApplyLogLevels(const std::wstring& specification)
+{
+    bool valid = true;
+    size_t start = 0;
+    while (start <= specification.size())
+    {
+        size_t separator = specification.find_first_of(L";,", start);
+        std::wstring part = Trim(specification.substr(start, separator - start));
+        start = (separator == std::wstring::npos) ? specification.size() + 1 : separator + 1;
+        if (part.empty())
+        {
+            continue;
+        }
+
+        uint32_t level = LogLevelInfo;
+        size_t equals = part.find(L'=');
+        if (equals == std::wstring::npos)
+        {
+            if (!ParseLevel(part, level))
+            {
+                valid = false;
+                continue;
+            }
+            for (size_t index = 0; index < LogSubsystemCount; ++index)
+            {
+                SetLogLevel(static_cast<LogSubsystem>(index), level);
+            }
+            continue;
+        }
+
+        LogSubsystem subsystem = LogSubsystem::Audio;
+        if (!ParseSubsystem(part.substr(0, equals), subsystem) || !ParseLevel(part.substr(equals + 1), level))
+        {
+            valid = false;
+            continue;
+        }
+        SetLogLevel(subsystem, level);
+    }
+    return valid;
+}
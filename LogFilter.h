@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "BinaryLogFormat.h"
+
+// Log front end: per-subsystem tags and level filtering.
+//
+// Log through the LGTV_LOG_* macros, naming the subsystem and passing a
+// format string literal without its tag:
+//   LGTV_LOG_INFO(Audio, L"Default device changed to %s", name.c_str());
+// logs "[Audio] Default device changed to ...". Levels below
+// LGTV_LOG_COMPILED_LEVEL are removed at compile time. The rest are checked
+// against a runtime mask with one load and one branch before anything else
+// happens; a filtered call evaluates none of its arguments.
+
+// Subsystems with their own runtime level. The enumerator name is the tag.
+enum class LogSubsystem : uint8_t
+{
+    Audio,
+    Key,
+    LGTV,
+    UI,
+    Configuration
+};
+
+constexpr size_t LogSubsystemCount = 5;
+
+// The lowest level compiled in; define it on the command line to override.
+#ifndef LGTV_LOG_COMPILED_LEVEL
+#ifdef _DEBUG
+#define LGTV_LOG_COMPILED_LEVEL LogLevelDebug
+#else
+#define LGTV_LOG_COMPILED_LEVEL LogLevelInfo
+#endif
+#endif
+
+// Four bits per subsystem, one per level.
+constexpr uint64_t GetLogMaskBit(LogSubsystem subsystem, uint32_t level)
+{
+    return 1ull << (static_cast<uint32_t>(subsystem) * 4 + level);
+}
+
+// Enables every compiled-in level for every subsystem.
+constexpr uint64_t GetDefaultLogMask()
+{
+    uint64_t mask = 0;
+    for (uint32_t subsystem = 0; subsystem < LogSubsystemCount; ++subsystem)
+    {
+        for (uint32_t level = LGTV_LOG_COMPILED_LEVEL; level <= LogLevelError; ++level)
+        {
+            mask |= GetLogMaskBit(static_cast<LogSubsystem>(subsystem), level);
+        }
+    }
+    return mask;
+}
+
+extern std::atomic<uint64_t> g_logEnabledMask;
+
+inline bool IsLogEnabled(LogSubsystem subsystem, uint32_t level)
+{
+    return (g_logEnabledMask.load(std::memory_order_relaxed) & GetLogMaskBit(subsystem, level)) != 0;
+}
+
+const wchar_t* GetLogSubsystemName(LogSubsystem subsystem);
+
+// Logs level and above for a subsystem; LogLevelError + 1 silences it.
+void SetLogLevel(LogSubsystem subsystem, uint32_t minimumLevel);
+
+// Applies a level specification such as "info" or "warning;Key=debug":
+// a bare level applies to every subsystem, "<Subsystem>=<level>" to one.
+// Levels are debug, info, warning, error and off. Returns false when any
+// part is malformed; the valid parts are still applied.
+bool ApplyLogLevels(const std::wstring& specification);
+
+// Records one message; call through the macros below.
+void WriteLog(uint32_t level, const wchar_t* format, ...);
+
+#define LGTV_LOG(subsystem, level, ...) \
+    do \
+    { \
+        if constexpr ((level) >= LGTV_LOG_COMPILED_LEVEL) \
+        { \
+            if (IsLogEnabled(LogSubsystem::subsystem, (level))) \
+            { \
+                WriteLog((level), L"[" #subsystem "] " __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LGTV_LOG_DEBUG(subsystem, ...) LGTV_LOG(subsystem, LogLevelDebug, __VA_ARGS__)
+#define LGTV_LOG_INFO(subsystem, ...) LGTV_LOG(subsystem, LogLevelInfo, __VA_ARGS__)
+#define LGTV_LOG_WARNING(subsystem, ...) LGTV_LOG(subsystem, LogLevelWarning, __VA_ARGS__)
+#define LGTV_LOG_ERROR(subsystem, ...) LGTV_LOG(subsystem, LogLevelError, __VA_ARGS__)
@@ -0,0 +1,82 @@
+#include "LogRateLimiter.h"
+
+#include <limits>
+
+LogRateLimiter::LogRateLimiter(size_t siteCountValue, uint32_t burstValue, Clock::duration windowValue)
+    : siteCount(siteCountValue),
+    burst(burstValue),
+    window(windowValue),
+    states(new SiteState[siteCountValue]),
+    suppressedCount(0)
+{
+    for (size_t index = 0; index < siteCount; ++index)
+    {
+        // Never admitted yet: the first call always starts a window.
+        states[index].windowStart.store((std::numeric_limits<int64_t>::min)(), std::memory_order_relaxed);
+        states[index].count.store(0, std::memory_order_relaxed);
+        states[index].suppressed.store(0, std::memory_order_relaxed);
+    }
+}
+
+LogRateLimiter::Decision LogRateLimiter::Admit(uint32_t site, Clock::time_point now)
+{
+    Decision decision{ true, 0, Clock::duration::zero() };
+    if (site >= siteCount)
+    {
+        return decision;
+    }
+
+    SiteState& state = states[site];
+    int64_t nowTicks = now.time_since_epoch().count();
+    int64_t start = state.windowStart.load(std::memory_order_relaxed);
+    if (start == (std::numeric_limits<int64_t>::min)() || nowTicks - start >= window.count())
+    {
+        // Only the thread that moves the window reports the old one.
+        if (state.windowStart.compare_exchange_strong(start, nowTicks, std::memory_order_relaxed))
+        {
+            state.count.store(1, std::memory_order_relaxed);
+            decision.repeated = state.suppressed.exchange(0, std::memory_order_relaxed);
+            if (decision.repeated > 0)
+            {
+                decision.period = window;
+            }
+            return decision;
+        }
+    }
+
+    if (state.count.fetch_add(1, std::memory_order_relaxed) < burst)
+    {
+        return decision;
+    }
+
+    state.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+    decision.admitted = false;
+    return decision;
+}
+
+void LogRateLimiter::CollectSuppressed(Clock::time_point now, const SuppressedHandler& handler)
+{
+    int64_t nowTicks = now.time_since_epoch().count();
+    for (size_t site = 0; site < siteCount; ++site)
+    {
+        SiteState& state = states[site];
+        if (state.suppressed.load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+
+        uint32_t repeated = state.suppressed.exchange(0, std::memory_order_relaxed);
+        if (repeated > 0)
+        {
+            int64_t start = state.windowStart.load(std::memory_order_relaxed);
+            Clock::duration period = Clock::duration(nowTicks - start);
+            handler(static_cast<uint32_t>(site), repeated, (period < window) ? period : window);
+        }
+    }
+}
+
+uint64_t LogRateLimiter::GetSuppressedCount() const
+{
+    return suppressedCount.load(std::memory_order_relaxed);
+}
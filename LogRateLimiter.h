@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Limits how often each log site may write, so a failure storm costs bounded
+// log space without losing track of how often it happened.
+//
+// Each site may write burst entries per window; later calls in the same
+// window are suppressed and counted. The first call after the window ends is
+// admitted again and hands back the suppressed count, so the caller can log
+// "[repeated N times in Ts]". CollectSuppressed reports counts for sites
+// that went quiet, e.g. at shutdown.
+//
+// State is a fixed array indexed by site ID (see LogSiteRegistry); Admit is a
+// few relaxed atomic operations and never blocks. Counts are approximate when
+// several threads hit the same site at the moment a window rolls over.
+class LogRateLimiter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using SuppressedHandler = std::function<void(uint32_t site, uint32_t repeated, Clock::duration period)>;
+
+    struct Decision
+    {
+        bool admitted;
+        // Calls suppressed in the previous window, to be reported now, and
+        // the length of that window.
+        uint32_t repeated;
+        Clock::duration period;
+    };
+
+    LogRateLimiter(size_t siteCount, uint32_t burst, Clock::duration window);
+
+    LogRateLimiter(const LogRateLimiter&) = delete;
+    LogRateLimiter& operator=(const LogRateLimiter&) = delete;
+
+    // Sites outside the range given to the constructor are always admitted.
+    Decision Admit(uint32_t site, Clock::time_point now);
+
+    // Hands every outstanding suppressed count to handler and clears it.
+    void CollectSuppressed(Clock::time_point now, const SuppressedHandler& handler);
+
+    uint64_t GetSuppressedCount() const;
+
+private:
+    struct SiteState
+    {
+        std::atomic<int64_t> windowStart;
+        std::atomic<uint32_t> count;
+        std::atomic<uint32_t> suppressed;
+    };
+
+    const size_t siteCount;
+    const uint32_t burst;
+    const Clock::duration window;
+    std::unique_ptr<SiteState[]> states;
+    std::atomic<uint64_t> suppressedCount;
+};
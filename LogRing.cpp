@@ -0,0 +1,200 @@
+#include "LogRing.h"
+
+#include <cstring>
+
+#include "BinaryLogFormat.h"
+
+size_t LogRing::GetFileSize(size_t siteAreaSize, size_t ringSize)
+{
+    return HeaderSize + siteAreaSize + ringSize;
+}
+
+LogRing::LogRing()
+    : base(nullptr),
+    header(nullptr),
+    siteArea(nullptr),
+    ring(nullptr),
+    evictedCount(0)
+{
+}
+
+bool LogRing::Initialize(uint8_t* baseValue, size_t size, size_t siteAreaSize, uint64_t sessionTimestamp, uint32_t processId)
+{
+    if (baseValue == nullptr || size <= HeaderSize + siteAreaSize || siteAreaSize == 0 ||
+        size - HeaderSize - siteAreaSize > UINT32_MAX || siteAreaSize > UINT32_MAX)
+    {
+        return false;
+    }
+
+    base = baseValue;
+    header = reinterpret_cast<Header*>(base);
+    siteArea = base + HeaderSize;
+    ring = siteArea + siteAreaSize;
+    evictedCount = 0;
+
+    std::memset(base, 0, HeaderSize);
+    std::memcpy(header->magic, Magic, sizeof(Magic));
+    header->version = Version;
+    header->headerSize = static_cast<uint32_t>(HeaderSize);
+    header->siteAreaSize = static_cast<uint32_t>(siteAreaSize);
+    header->ringSize = static_cast<uint32_t>(size - HeaderSize - siteAreaSize);
+
+    std::string session;
+    AppendBinaryLogSession(session, sessionTimestamp, processId);
+    return AppendSite(session.data(), session.size());
+}
+
+bool LogRing::IsInitialized() const
+{
+    return header != nullptr;
+}
+
+bool LogRing::AppendSite(const void* block, size_t length)
+{
+    if (header == nullptr || header->siteAreaSize - header->siteAreaUsed < length)
+    {
+        return false;
+    }
+
+    std::memcpy(siteArea + header->siteAreaUsed, block, length);
+    header->siteAreaUsed += static_cast<uint32_t>(length);
+    return true;
+}
+
+bool LogRing::Append(const void* block, size_t length)
+{
+    if (header == nullptr || length == 0 || length >= header->ringSize)
+    {
+        return false;
+    }
+
+    size_t offset = GetRingOffset(header->writePosition);
+    size_t remaining = header->ringSize - offset;
+    if (length > remaining)
+    {
+        // Mark the end of the ring unused and start over at the beginning.
+        while (header->writePosition + remaining - header->tailPosition > header->ringSize)
+        {
+            if (!EvictOldest())
+            {
+                break;
+            }
+        }
+        ring[offset] = BinaryLogBlockPadding;
+        header->writePosition += remaining;
+        offset = 0;
+    }
+
+    // Move the tail first, so a reader never takes the block being
+    // overwritten for a live one.
+    while (header->writePosition + length - header->tailPosition > header->ringSize)
+    {
+        if (!EvictOldest())
+        {
+            break;
+        }
+    }
+
+    std::memcpy(ring + offset, block, length);
+    header->writePosition += length;
+    header->wrapCount = header->writePosition / header->ringSize;
+    return true;
+}
+
+uint64_t LogRing::GetWrapCount() const
+{
+    return (header != nullptr) ? header->wrapCount : 0;
+}
+
+uint64_t LogRing::GetEvictedCount() const
+{
+    return evictedCount;
+}
+
+bool LogRing::Read(const uint8_t* base, size_t size, std::string& stream, uint64_t& wrapCount)
+{
+    if (size < HeaderSize)
+    {
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+        header.headerSize != HeaderSize || header.ringSize == 0 ||
+        static_cast<uint64_t>(size) < static_cast<uint64_t>(HeaderSize) + header.siteAreaSize + header.ringSize ||
+        header.siteAreaUsed > header.siteAreaSize ||
+        header.tailPosition > header.writePosition ||
+        header.writePosition - header.tailPosition > header.ringSize)
+    {
+        return false;
+    }
+
+    const uint8_t* siteArea = base + HeaderSize;
+    const uint8_t* ring = siteArea + header.siteAreaSize;
+    wrapCount = header.wrapCount;
+
+    stream.clear();
+    AppendBinaryLogHeader(stream);
+    stream.append(reinterpret_cast<const char*>(siteArea), header.siteAreaUsed);
+
+    uint64_t position = header.tailPosition;
+    while (position < header.writePosition)
+    {
+        size_t offset = static_cast<size_t>(position % header.ringSize);
+        if (ring[offset] == BinaryLogBlockPadding)
+        {
+            position += header.ringSize - offset;
+            continue;
+        }
+
+        size_t available = header.ringSize - offset;
+        if (header.writePosition - position < available)
+        {
+            available = static_cast<size_t>(header.writePosition - position);
+        }
+
+        size_t blockSize = GetBinaryLogBlockSize(ring + offset, available);
+        if (blockSize == 0)
+        {
+            break;
+        }
+
+        stream.append(reinterpret_cast<const char*>(ring + offset), blockSize);
+        position += blockSize;
+    }
+
+    return true;
+}
+
+size_t LogRing::GetRingOffset(uint64_t position) const
+{
+    return static_cast<size_t>(position % header->ringSize);
+}
+
+bool LogRing::EvictOldest()
+{
+    if (header->tailPosition >= header->writePosition)
+    {
+        return false;
+    }
+
+    size_t offset = GetRingOffset(header->tailPosition);
+    if (ring[offset] == BinaryLogBlockPadding)
+    {
+        header->tailPosition += header->ringSize - offset;
+        return true;
+    }
+
+    size_t blockSize = GetBinaryLogBlockSize(ring + offset, header->ringSize - offset);
+    if (blockSize == 0)
+    {
+        // Unreadable; give up on everything older than the write position.
+        header->tailPosition = header->writePosition;
+        return false;
+    }
+
+    header->tailPosition += blockSize;
+    ++evictedCount;
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fixed-size circular binary log laid out over a block of memory, normally a
+// mapped view of the log file, so appending is a memcpy and the file never
+// grows.
+//
+// The memory holds a header page, a site area with the session block and every
+// site definition, and the ring with entry and dropped blocks. Sites live
+// outside the ring so entries stay decodable after the ring wraps. A block
+// never straddles the end of the ring: when it does not fit, a padding byte
+// marks the rest as unused and the block starts over at the beginning. Before
+// a block is written, the oldest blocks it would overlap are evicted by moving
+// the tail past them.
+//
+// Positions in the header count bytes ever written to the ring, so the offset
+// is position % ringSize and wrapCount is writePosition / ringSize. One thread
+// at a time may append.
+class LogRing
+{
+public:
+    static constexpr char Magic[8] = { 'L', 'G', 'T', 'V', 'R', 'I', 'N', 'G' };
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t HeaderSize = 4096;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t siteAreaSize;
+        uint32_t ringSize;
+        uint32_t siteAreaUsed;
+        uint32_t reserved;
+        uint64_t writePosition;
+        uint64_t tailPosition;
+        uint64_t wrapCount;
+    };
+
+    static size_t GetFileSize(size_t siteAreaSize, size_t ringSize);
+
+    LogRing();
+
+    // Formats memory, which must be GetFileSize bytes, as an empty ring and
+    // records the session block in the site area.
+    bool Initialize(uint8_t* base, size_t size, size_t siteAreaSize, uint64_t sessionTimestamp, uint32_t processId);
+
+    bool IsInitialized() const;
+
+    // Appends a site definition block. Returns false when the site area is
+    // full; entries for that site then decode as unknown.
+    bool AppendSite(const void* block, size_t length);
+
+    // Appends an entry or dropped block, evicting the oldest blocks as
+    // needed. Returns false for blocks larger than the ring.
+    bool Append(const void* block, size_t length);
+
+    uint64_t GetWrapCount() const;
+    uint64_t GetEvictedCount() const;
+
+    // Rebuilds a binary log stream from ring memory: the stream header, the
+    // site area and then the ring's blocks, oldest first. Returns false when
+    // the memory is not a valid ring.
+    static bool Read(const uint8_t* base, size_t size, std::string& stream, uint64_t& wrapCount);
+
+private:
+    size_t GetRingOffset(uint64_t position) const;
+    bool EvictOldest();
+
+    uint8_t* base;
+    Header* header;
+    uint8_t* siteArea;
+    uint8_t* ring;
+    uint64_t evictedCount;
+};
@@ -0,0 +1,92 @@
+#include "LogSiteRegistry.h"
+
+#include <vector>
+
+namespace
+{
+    size_t HashSite(uint32_t level, const wchar_t* format)
+    {
+        uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(format)) ^ level;
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+}
+
+LogSiteRegistry::LogSiteRegistry()
+    : sites(new LogSite[MaxSites]()),
+    table(),
+    sitesById(),
+    count(0)
+{
+}
+
+const LogSite* LogSiteRegistry::Register(uint32_t level, const wchar_t* format)
+{
+    size_t bucket = 0;
+    if (const LogSite* site = Find(level, format, bucket))
+    {
+        return site;
+    }
+
+    std::lock_guard<std::mutex> guard(registerMutex);
+
+    // Another thread may have registered the site meanwhile.
+    if (const LogSite* site = Find(level, format, bucket))
+    {
+        return site;
+    }
+
+    uint32_t id = count.load(std::memory_order_relaxed);
+    if (id >= MaxSites)
+    {
+        return nullptr;
+    }
+
+    LogSite& site = sites[id];
+    site.id = id;
+    site.level = level;
+    site.format = format;
+
+    std::vector<LogConversion> conversions;
+    site.recordable = ParseLogFormat(format, conversions);
+    site.argumentCount = site.recordable
+        ? static_cast<uint8_t>(GetLogArgumentTypes(conversions, site.argumentTypes))
+        : 0;
+
+    sitesById[id].store(&site, std::memory_order_release);
+    table[bucket].store(&site, std::memory_order_release);
+    count.store(id + 1, std::memory_order_release);
+    return &site;
+}
+
+const LogSite* LogSiteRegistry::Get(uint32_t id) const
+{
+    return (id < MaxSites) ? sitesById[id].load(std::memory_order_acquire) : nullptr;
+}
+
+size_t LogSiteRegistry::GetCount() const
+{
+    return count.load(std::memory_order_acquire);
+}
+
+const LogSite* LogSiteRegistry::Find(uint32_t level, const wchar_t* format, size_t& bucket) const
+{
+    // The table is never more than half full, so probing always reaches an
+    // empty bucket.
+    bucket = HashSite(level, format) & (TableSize - 1);
+    for (;;)
+    {
+        const LogSite* site = table[bucket].load(std::memory_order_acquire);
+        if (site == nullptr)
+        {
+            return nullptr;
+        }
+        if (site->format == format && site->level == level)
+        {
+            return site;
+        }
+        bucket = (bucket + 1) & (TableSize - 1);
+    }
+}
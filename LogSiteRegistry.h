@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "BinaryLogFormat.h"
+
+// A registered log call site: one format string at one level.
+struct LogSite
+{
+    uint32_t id;
+    uint32_t level;
+    const wchar_t* format;
+    // False when the format cannot be recorded in binary form; such lines
+    // are formatted by the caller and recorded as a single string.
+    bool recordable;
+    uint8_t argumentCount;
+    LogArgumentType argumentTypes[MaxLogArguments];
+};
+
+// Assigns site IDs to format strings and parses each format only once.
+//
+// Sites are keyed by the format string's address, which is stable for the
+// string literals log calls pass. Lookups, by address or by ID, are lock-free;
+// only the first call from a new site takes a lock. Sites are never removed.
+class LogSiteRegistry
+{
+public:
+    static constexpr size_t MaxSites = 1024;
+
+    LogSiteRegistry();
+
+    LogSiteRegistry(const LogSiteRegistry&) = delete;
+    LogSiteRegistry& operator=(const LogSiteRegistry&) = delete;
+
+    // Returns the site for a format and level, registering it on first use.
+    // Returns nullptr when MaxSites sites already exist.
+    const LogSite* Register(uint32_t level, const wchar_t* format);
+
+    // Returns the site with the given ID, or nullptr.
+    const LogSite* Get(uint32_t id) const;
+
+    size_t GetCount() const;
+
+private:
+    static constexpr size_t TableSize = MaxSites * 2;
+
+    const LogSite* Find(uint32_t level, const wchar_t* format, size_t& bucket) const;
+
+    std::unique_ptr<LogSite[]> sites;
+    std::array<std::atomic<const LogSite*>, TableSize> table;
+    std::array<std::atomic<const LogSite*>, MaxSites> sitesById;
+    std::atomic<uint32_t> count;
+    std::mutex registerMutex;
+};
@@ -1,17 +1,85 @@
 #include "Logging.h"
 
+#include <atomic>
 #include <cstdarg>
 #include <cstdio>
-#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "AsyncLogWriter.h"
+#include "BinaryLogFormat.h"
+#include "FlightRecorder.h"
+#include "LogRateLimiter.h"
+#include "LogRing.h"
+#include "LogSiteRegistry.h"
 
 namespace
 {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "The binary log stores wide text as UTF-16.");
+
     constexpr size_t MaxLogLineLength = 1024;
 
-    std::wstring BuildLogPrefix(const wchar_t* levelTag)
+    // Enough for bursts from the hook and TV worker threads while the writer
+    // is blocked on disk; each slot holds one encoded entry.
+    constexpr size_t LogQueueCapacity = 512;
+
+    // A flight recorder dump covers this much recent activity. Errors dump it
+    // automatically, but at most once per FlightAutoDumpInterval so a failure
+    // storm does not rewrite the file on every error.
+    constexpr std::chrono::seconds FlightDumpWindow{ 60 };
+    constexpr std::chrono::seconds FlightAutoDumpInterval{ 60 };
+
+    // Each warning or error site may write LogBurstPerSite entries per
+    // LogRateWindow; further repeats are counted and reported as
+    // "[repeated N times in Ts]" once the window is over.
+    constexpr uint32_t LogBurstPerSite = 5;
+    constexpr std::chrono::seconds LogRateWindow{ 10 };
+
+    // Sizes of the mapped log file's areas; see LogRing. Site definitions
+    // are a few dozen bytes each, and the ring holds tens of thousands of
+    // typical entries.
+    constexpr size_t LogSiteAreaSize = 256 * 1024;
+    constexpr size_t LogRingSize = 4 * 1024 * 1024;
+
+    // Site used for lines whose format cannot be recorded in binary form; the
+    // caller formats them and records the text as the only argument.
+    constexpr const wchar_t* PreformattedFormat = L"%ls";
+
+    const wchar_t* GetLevelTag(uint32_t level)
+    {
+        switch (level)
+        {
+        case LogLevelDebug:
+            return L"DEBUG";
+        case LogLevelInfo:
+            return L"INFO";
+        case LogLevelWarning:
+            return L"WARNING";
+        default:
+            return L"ERROR";
+        }
+    }
+
+    uint64_t GetLogTimestamp()
     {
+        FILETIME now{};
+        GetSystemTimeAsFileTime(&now);
+        return (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    }
+
+    std::wstring BuildLogPrefix(uint64_t timestamp, const wchar_t* levelTag)
+    {
+        FILETIME utcTime{};
+        utcTime.dwLowDateTime = static_cast<DWORD>(timestamp);
+        utcTime.dwHighDateTime = static_cast<DWORD>(timestamp >> 32);
+
+        FILETIME localFileTime{};
         SYSTEMTIME localTime{};
-        GetLocalTime(&localTime);
+        if (!FileTimeToLocalFileTime(&utcTime, &localFileTime) ||
+            !FileTimeToSystemTime(&localFileTime, &localTime))
+        {
+            GetLocalTime(&localTime);
+        }
 
         wchar_t buffer[64]{};
         swprintf_s(
@@ -28,82 +96,437 @@ namespace
         return std::wstring(buffer);
     }
 
-    std::wstring GetLogFilePath()
+    // Owns the binary log file and the background writer.
+    //
+    // A log call looks up its site, which parses the format string on first
+    // use only, and encodes the raw arguments straight into a queue slot; no
+    // text is formatted. The writer thread copies site definitions and entries
+    // into a LogRing over a mapped view of the log file, so the file keeps a
+    // fixed size however long the app runs and the oldest entries make way for
+    // new ones. The previous session's file is kept as LGTVVolumeProxy.1.binlog.
+    // Text is only produced for an attached debugger; Tools\LogDecoder turns
+    // either file back into the familiar text log. Once the writer has stopped
+    // (or never started) entries are written synchronously under a lock, so
+    // nothing logged during shutdown is lost.
+    class LogPipeline
     {
-        wchar_t pathBuffer[MAX_PATH]{};
-        DWORD result = GetModuleFileNameW(nullptr, pathBuffer, MAX_PATH);
-        if (result == 0 || result >= MAX_PATH)
+    public:
+        LogPipeline()
+            : writer(LogQueueCapacity),
+            rateLimiter(LogSiteRegistry::MaxSites, LogBurstPerSite, LogRateWindow),
+            file(INVALID_HANDLE_VALUE),
+            mapping(nullptr),
+            view(nullptr),
+            automaticDumpRequested(false),
+            lastAutomaticDump(0)
         {
-            return L"LGTVVolumeProxy.log";
+            definedSites.assign(LogSiteRegistry::MaxSites, false);
+            OpenLogFile();
+
+            writer.Start(
+                [this](const LogRecord& record)
+                {
+                    std::lock_guard<std::mutex> guard(fileMutex);
+                    AppendRecord(record);
+                },
+                [this](uint64_t droppedSinceLastBatch)
+                {
+                    if (droppedSinceLastBatch > 0)
+                    {
+                        std::lock_guard<std::mutex> guard(fileMutex);
+                        block.clear();
+                        AppendBinaryLogDropped(block, GetLogTimestamp(), droppedSinceLastBatch);
+                        ring.Append(block.data(), block.size());
+                    }
+
+                    // Dumps requested by error calls are written here, so
+                    // the hook and the TV worker never format or write them.
+                    if (automaticDumpRequested.exchange(false))
+                    {
+                        DumpFlightRecorder(L"error", true);
+                    }
+                });
         }
 
-        std::wstring fullPath(pathBuffer);
-        size_t lastSeparator = fullPath.find_last_of(L"\\/");
-        std::wstring directory =
-            (lastSeparator != std::wstring::npos)
-            ? fullPath.substr(0, lastSeparator + 1)
-            : std::wstring();
+        ~LogPipeline()
+        {
+            Shutdown();
 
-        return directory + L"LGTVVolumeProxy.log";
-    }
+            std::lock_guard<std::mutex> guard(fileMutex);
+            CloseLogFile();
+        }
 
-    void WriteLogLine(const wchar_t* levelTag, const wchar_t* format, va_list arguments)
-    {
-        wchar_t messageBuffer[MaxLogLineLength]{};
-        _vsnwprintf_s(
-            messageBuffer,
-            _TRUNCATE,
-            format,
-            arguments);
-
-        std::wstring finalLine = BuildLogPrefix(levelTag);
-        finalLine += messageBuffer;
-        finalLine += L"\n";
-
-        OutputDebugStringW(finalLine.c_str());
-
-        static const std::wstring logPath = GetLogFilePath();
-        std::wofstream stream(logPath, std::ios::app);
-        if (stream)
+        void Write(uint32_t level, const wchar_t* format, va_list arguments)
+        {
+            uint64_t timestamp = GetLogTimestamp();
+            DWORD threadId = GetCurrentThreadId();
+
+            const LogSite* site = sites.Register(level, format);
+            if (site != nullptr)
+            {
+                if (level == LogLevelError)
+                {
+                    RecordFlightEvent(FlightEventType::Error, site->id);
+
+                    // The writer thread dumps the flight recorder after the
+                    // batch that carries this entry.
+                    automaticDumpRequested.store(true);
+                }
+
+                // Decided before anything is formatted or queued, so a
+                // suppressed repeat costs only the site lookup.
+                if (level >= LogLevelWarning)
+                {
+                    LogRateLimiter::Decision decision = rateLimiter.Admit(site->id, LogRateLimiter::Clock::now());
+                    if (decision.repeated > 0)
+                    {
+                        WriteRepeatSummary(*site, decision.repeated, decision.period);
+                    }
+                    if (!decision.admitted)
+                    {
+                        return;
+                    }
+                }
+            }
+
+            wchar_t messageBuffer[MaxLogLineLength];
+            size_t messageLength = 0;
+            if (site == nullptr || !site->recordable)
+            {
+                int length = _vsnwprintf_s(messageBuffer, _TRUNCATE, format, arguments);
+                messageLength = (length < 0) ? wcslen(messageBuffer) : static_cast<size_t>(length);
+                site = sites.Register(level, PreformattedFormat);
+                if (site == nullptr)
+                {
+                    return;
+                }
+            }
+
+            auto encode = [&](uint8_t* data, size_t capacity)
+            {
+                return (site->format == PreformattedFormat)
+                    ? EncodeLogWideString(messageBuffer, messageLength, data, capacity)
+                    : EncodeLogArguments(site->argumentTypes, site->argumentCount, arguments, data, capacity);
+            };
+
+            Submit(level, *site, threadId, timestamp, encode);
+        }
+
+        void Shutdown()
+        {
+            // Report storms that ended without another call from their site.
+            rateLimiter.CollectSuppressed(LogRateLimiter::Clock::now(),
+                [this](uint32_t siteId, uint32_t repeated, LogRateLimiter::Clock::duration period)
+                {
+                    const LogSite* site = sites.Get(siteId);
+                    if (site != nullptr)
+                    {
+                        WriteRepeatSummary(*site, repeated, period);
+                    }
+                });
+
+            writer.Stop();
+
+            std::lock_guard<std::mutex> guard(fileMutex);
+            if (view != nullptr)
+            {
+                FlushViewOfFile(view, 0);
+            }
+        }
+
+        // Writes the flight recorder's recent events to
+        // LGTVVolumeProxy.flight.txt, followed by the format strings of the
+        // error sites they mention. Automatic dumps are rate-limited.
+        bool DumpFlightRecorder(const wchar_t* reason, bool automatic)
+        {
+            FlightRecorder::Clock::time_point now = FlightRecorder::Clock::now();
+            if (automatic)
+            {
+                int64_t nowTicks = now.time_since_epoch().count();
+                int64_t last = lastAutomaticDump.load();
+                if ((last != 0 && nowTicks - last < FlightRecorder::Clock::duration(FlightAutoDumpInterval).count()) ||
+                    !lastAutomaticDump.compare_exchange_strong(last, nowTicks))
+                {
+                    return false;
+                }
+            }
+
+            std::vector<FlightEvent> events = GetFlightRecorder().Snapshot(now - FlightDumpWindow);
+
+            std::wstring prefix = BuildLogPrefix(GetLogTimestamp(), L"FLIGHT");
+            std::string text = ConvertUtf16ToUtf8(reinterpret_cast<const char16_t*>(prefix.c_str()), prefix.size());
+            text += "Dump (";
+            text += ConvertUtf16ToUtf8(reinterpret_cast<const char16_t*>(reason), wcslen(reason));
+            text += "): " + std::to_string(events.size()) + " events in the last " +
+                std::to_string(FlightDumpWindow.count()) + " s, " +
+                std::to_string(GetFlightRecorder().GetRecordedCount()) + " recorded since start\n\n";
+            text += FlightRecorder::Format(events, now);
+
+            std::string siteText;
+            std::vector<bool> listedSites(LogSiteRegistry::MaxSites, false);
+            for (const FlightEvent& event : events)
+            {
+                if (event.type != FlightEventType::Error || event.first < 0 ||
+                    static_cast<size_t>(event.first) >= listedSites.size() || listedSites[static_cast<size_t>(event.first)])
+                {
+                    continue;
+                }
+
+                listedSites[static_cast<size_t>(event.first)] = true;
+                const LogSite* site = sites.Get(static_cast<uint32_t>(event.first));
+                if (site != nullptr)
+                {
+                    siteText += "site=" + std::to_string(site->id) + " ";
+                    siteText += ConvertUtf16ToUtf8(reinterpret_cast<const char16_t*>(site->format), wcslen(site->format));
+                    siteText += "\n";
+                }
+            }
+            if (!siteText.empty())
+            {
+                text += "\nError sites:\n" + siteText;
+            }
+
+            std::wstring path = GetLogDirectory() + L"LGTVVolumeProxy.flight.txt";
+            HANDLE dumpFile = CreateFileW(
+                path.c_str(),
+                GENERIC_WRITE,
+                FILE_SHARE_READ,
+                nullptr,
+                CREATE_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr);
+            if (dumpFile == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            DWORD written = 0;
+            BOOL result = WriteFile(dumpFile, text.data(), static_cast<DWORD>(text.size()), &written, nullptr);
+            CloseHandle(dumpFile);
+            return result && written == text.size();
+        }
+
+    private:
+        // Queues an entry, or writes it directly once the writer has stopped.
+        template <typename Encoder>
+        void Submit(uint32_t level, const LogSite& site, DWORD threadId, uint64_t timestamp, Encoder&& encode)
         {
-            stream << finalLine;
+            if (writer.IsRunning())
+            {
+                uint64_t ticket = writer.PostEncoded(site.id, threadId, timestamp, encode);
+                if (level == LogLevelError && ticket != 0)
+                {
+                    // Errors often precede a crash or exit, so get the entry
+                    // into the mapped file without waiting out the batch
+                    // delay. The caller may be the keyboard hook or the TV
+                    // worker, so it never waits for the write; only Shutdown
+                    // waits for the queue to drain.
+                    writer.RequestDrain();
+                }
+                return;
+            }
+
+            std::unique_ptr<LogRecord> record(new LogRecord());
+            record->timestamp = timestamp;
+            record->site = site.id;
+            record->threadId = threadId;
+            record->length = static_cast<uint32_t>(encode(record->data, LogRecord::MaxDataLength));
+
+            std::lock_guard<std::mutex> guard(fileMutex);
+            AppendRecord(*record);
+        }
+
+        // Records how often a site was suppressed, as text at the site's level.
+        void WriteRepeatSummary(const LogSite& site, uint32_t repeated, LogRateLimiter::Clock::duration period)
+        {
+            long long seconds = std::chrono::duration_cast<std::chrono::seconds>(period).count();
+            wchar_t summary[MaxLogLineLength];
+            int length = _snwprintf_s(summary, _TRUNCATE, L"%ls [repeated %u times in %llds]",
+                site.format, repeated, (seconds > 0) ? seconds : 1);
+            size_t summaryLength = (length < 0) ? wcslen(summary) : static_cast<size_t>(length);
+
+            const LogSite* summarySite = sites.Register(site.level, PreformattedFormat);
+            if (summarySite == nullptr)
+            {
+                return;
+            }
+
+            Submit(site.level, *summarySite, GetCurrentThreadId(), GetLogTimestamp(),
+                [&](uint8_t* data, size_t capacity)
+                {
+                    return EncodeLogWideString(summary, summaryLength, data, capacity);
+                });
+        }
+
+        // Caller holds fileMutex.
+        void AppendRecord(const LogRecord& record)
+        {
+            const LogSite* site = sites.Get(record.site);
+            if (site == nullptr)
+            {
+                return;
+            }
+
+            if (ring.IsInitialized())
+            {
+                if (!definedSites[site->id])
+                {
+                    block.clear();
+                    AppendBinaryLogSite(block, site->id, site->level, site->argumentTypes, site->argumentCount, site->format);
+                    ring.AppendSite(block.data(), block.size());
+                    definedSites[site->id] = true;
+                }
+
+                block.clear();
+                AppendBinaryLogEntry(block, site->id, record.timestamp, record.threadId, record.data, record.length);
+                ring.Append(block.data(), block.size());
+            }
+
+            if (IsDebuggerPresent())
+            {
+                OutputDebugLine(*site, record);
+            }
+        }
+
+        void OutputDebugLine(const LogSite& site, const LogRecord& record)
+        {
+            std::string message = FormatLogMessage(
+                reinterpret_cast<const char16_t*>(site.format),
+                site.argumentTypes,
+                site.argumentCount,
+                record.data,
+                record.length);
+
+            std::wstring finalLine = BuildLogPrefix(record.timestamp, GetLevelTag(site.level));
+            int length = MultiByteToWideChar(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), nullptr, 0);
+            if (length > 0)
+            {
+                size_t prefixLength = finalLine.size();
+                finalLine.resize(prefixLength + length);
+                MultiByteToWideChar(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), &finalLine[prefixLength], length);
+            }
+            finalLine += L"\n";
+            OutputDebugStringW(finalLine.c_str());
+        }
+
+        // Keeps the previous session's log and maps a fresh, fixed-size ring.
+        // Without a file, log entries only reach an attached debugger.
+        void OpenLogFile()
+        {
+            std::wstring directory = GetLogDirectory();
+            std::wstring logPath = directory + L"LGTVVolumeProxy.binlog";
+            std::wstring previousPath = directory + L"LGTVVolumeProxy.1.binlog";
+            MoveFileExW(logPath.c_str(), previousPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+
+            size_t size = LogRing::GetFileSize(LogSiteAreaSize, LogRingSize);
+            file = CreateFileW(
+                logPath.c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                FILE_SHARE_READ | FILE_SHARE_DELETE,
+                nullptr,
+                CREATE_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), nullptr);
+            if (mapping != nullptr)
+            {
+                view = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+            }
+
+            if (view == nullptr ||
+                !ring.Initialize(view, size, LogSiteAreaSize, GetLogTimestamp(), GetCurrentProcessId()))
+            {
+                CloseLogFile();
+            }
         }
+
+        // Caller holds fileMutex, or no other thread can log.
+        void CloseLogFile()
+        {
+            ring = LogRing();
+            if (view != nullptr)
+            {
+                FlushViewOfFile(view, 0);
+                UnmapViewOfFile(view);
+                view = nullptr;
+            }
+            if (mapping != nullptr)
+            {
+                CloseHandle(mapping);
+                mapping = nullptr;
+            }
+            if (file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file);
+                file = INVALID_HANDLE_VALUE;
+            }
+        }
+
+        LogSiteRegistry sites;
+        AsyncLogWriter writer;
+        LogRateLimiter rateLimiter;
+        std::mutex fileMutex;
+        HANDLE file;
+        HANDLE mapping;
+        uint8_t* view;
+        LogRing ring;
+        std::string block;
+        std::vector<bool> definedSites;
+
+        // Set by error calls, consumed by the writer thread.
+        std::atomic<bool> automaticDumpRequested;
+
+        // Clock ticks of the last automatic flight recorder dump, or 0.
+        std::atomic<int64_t> lastAutomaticDump;
+    };
+
+    LogPipeline& GetLogPipeline()
+    {
+        static LogPipeline pipeline;
+        return pipeline;
+    }
+
+    void WriteLogLine(uint32_t level, const wchar_t* format, va_list arguments)
+    {
+        GetLogPipeline().Write(level, format, arguments);
     }
 }
 
-void DebugLog(const wchar_t* format, ...)
+void WriteLog(uint32_t level, const wchar_t* format, ...)
 {
-#ifdef _DEBUG
     va_list arguments;
     va_start(arguments, format);
-    WriteLogLine(L"DEBUG", format, arguments);
+    WriteLogLine(level, format, arguments);
     va_end(arguments);
-#else
-    (void)format;
-#endif
 }
 
-void InfoLog(const wchar_t* format, ...)
+bool DumpFlightRecorder(const wchar_t* reason)
 {
-    va_list arguments;
-    va_start(arguments, format);
-    WriteLogLine(L"INFO", format, arguments);
-    va_end(arguments);
+    return GetLogPipeline().DumpFlightRecorder(reason, false);
 }
 
-void WarningLog(const wchar_t* format, ...)
+std::wstring GetLogDirectory()
 {
-    va_list arguments;
-    va_start(arguments, format);
-    WriteLogLine(L"WARNING", format, arguments);
-    va_end(arguments);
+    wchar_t pathBuffer[MAX_PATH]{};
+    DWORD result = GetModuleFileNameW(nullptr, pathBuffer, MAX_PATH);
+    if (result == 0 || result >= MAX_PATH)
+    {
+        return std::wstring();
+    }
+
+    std::wstring fullPath(pathBuffer);
+    size_t lastSeparator = fullPath.find_last_of(L"\\/");
+    return (lastSeparator != std::wstring::npos)
+        ? fullPath.substr(0, lastSeparator + 1)
+        : std::wstring();
 }
 
-void ErrorLog(const wchar_t* format, ...)
+void ShutdownLogging()
 {
-    va_list arguments;
-    va_start(arguments, format);
-    WriteLogLine(L"ERROR", format, arguments);
-    va_end(arguments);
+    GetLogPipeline().Shutdown();
 }
-
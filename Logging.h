@@ -4,15 +4,24 @@
 
 #include <string>
 
-// Writes debug-only diagnostic output.
-void DebugLog(const wchar_t* format, ...);
+#include "LogFilter.h"
 
-// Writes informational log output.
-void InfoLog(const wchar_t* format, ...);
+// Log calls record a format string ID and raw arguments in
+// LGTVVolumeProxy.binlog next to the executable, a fixed-size ring that keeps
+// the most recent entries; the previous session's log is kept as
+// LGTVVolumeProxy.1.binlog. Tools\LogDecoder turns either file into text.
+// Log through the LGTV_LOG_* macros in LogFilter.h; format strings must be
+// string literals.
 
-// Writes warning log output.
-void WarningLog(const wchar_t* format, ...);
+// Returns the directory log files are written to, with a trailing separator,
+// or an empty string for the working directory.
+std::wstring GetLogDirectory();
 
-// Writes error log output.
-void ErrorLog(const wchar_t* format, ...);
+// Writes the flight recorder's recent events (see FlightRecorder.h) to
+// LGTVVolumeProxy.flight.txt next to the log. Error log calls have the log
+// writer thread do this automatically, at most once a minute.
+bool DumpFlightRecorder(const wchar_t* reason);
 
+// Writes out queued log entries and stops the background log writer.
+// Entries logged afterwards are written synchronously.
+void ShutdownLogging();
@@ -0,0 +1,403 @@
+#include "MMDeviceEndpointBackend.h"
+
+#include <functiondiscoverykeys_devpkey.h>
+#include <propvarutil.h>
+
+#include "AudioFormatAliases.h"
+#include "Logging.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    // Wraps a COM reference in a shared_ptr that releases it when the last
+    // holder drops it.
+    std::shared_ptr<IAudioEndpointVolume> ShareEndpointVolume(const ComPtr<IAudioEndpointVolume>& endpointVolume)
+    {
+        IAudioEndpointVolume* raw = endpointVolume.Get();
+        raw->AddRef();
+        return std::shared_ptr<IAudioEndpointVolume>(raw,
+            [](IAudioEndpointVolume* value)
+            {
+                value->Release();
+            });
+    }
+}
+
+MMDeviceEndpointBackend::MMDeviceEndpointBackend()
+    : _events(nullptr),
+    _workerComInitialized(false),
+    _volumeEventContext(GUID_NULL),
+    _volumeNotifyRegistered(false),
+    _refCount(1)
+{
+    HRESULT guidResult = CoCreateGuid(&_volumeEventContext);
+    if (FAILED(guidResult))
+    {
+        LGTV_LOG_ERROR(Audio, L"CoCreateGuid failed: 0x%08X", guidResult);
+    }
+}
+
+bool MMDeviceEndpointBackend::ProbeFriendlyName(const std::wstring& endpointId, std::wstring& friendlyName)
+{
+    ComPtr<IMMDevice> device;
+    if (!OpenDevice(endpointId, device))
+    {
+        return false;
+    }
+
+    ComPtr<IPropertyStore> props;
+    HRESULT hr = device->OpenPropertyStore(STGM_READ, &props);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    PROPVARIANT varName;
+    PropVariantInit(&varName);
+
+    hr = props->GetValue(PKEY_Device_FriendlyName, &varName);
+    bool result = false;
+    if (SUCCEEDED(hr) && varName.vt == VT_LPWSTR && varName.pwszVal)
+    {
+        friendlyName.assign(varName.pwszVal);
+        result = true;
+    }
+
+    PropVariantClear(&varName);
+    return result;
+}
+
+bool MMDeviceEndpointBackend::ProbeDolbyAtmos(const std::wstring& endpointId)
+{
+    ComPtr<IMMDevice> device;
+    if (!OpenDevice(endpointId, device))
+    {
+        return false;
+    }
+
+    ComPtr<ISpatialAudioClient> spatial;
+    HRESULT hr = device->Activate(__uuidof(ISpatialAudioClient),
+        CLSCTX_INPROC_SERVER,
+        nullptr,
+        (void**)spatial.GetAddressOf());
+    if (FAILED(hr) || !spatial)
+    {
+        LGTV_LOG_DEBUG(Audio, L"Activate(ISpatialAudioClient) failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    hr = spatial->IsSpatialAudioStreamAvailable(LGTV_SPATIAL_AUDIO_FORMAT_DOLBY_ATMOS,
+        nullptr);
+    if (hr == S_OK)
+        return true;
+
+    LGTV_LOG_DEBUG(Audio, L"IsSpatialAudioStreamAvailable returned: 0x%08X\n", hr);
+    return false;
+}
+
+bool MMDeviceEndpointBackend::Start(IAudioEndpointEvents& events)
+{
+    HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator),
+        nullptr,
+        CLSCTX_ALL,
+        __uuidof(IMMDeviceEnumerator),
+        (void**)_enumerator.GetAddressOf());
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"MMDeviceEnumerator failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    _events.store(&events);
+
+    hr = _enumerator->RegisterEndpointNotificationCallback(this);
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"RegisterEndpointNotificationCallback failed: 0x%08X\n", hr);
+        _events.store(nullptr);
+        return false;
+    }
+
+    return true;
+}
+
+void MMDeviceEndpointBackend::Stop()
+{
+    if (_enumerator)
+    {
+        _enumerator->UnregisterEndpointNotificationCallback(this);
+    }
+
+    // The volume callback stays registered until the worker detaches, so a
+    // notification can still arrive; it sees either the sink or nullptr.
+    _events.store(nullptr);
+}
+
+void MMDeviceEndpointBackend::AttachWorkerThread()
+{
+    // S_FALSE (already initialized) still needs a matching CoUninitialize;
+    // a failure such as RPC_E_CHANGED_MODE must not get one.
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    _workerComInitialized = SUCCEEDED(hr);
+    if (FAILED(hr))
+    {
+        LGTV_LOG_ERROR(Audio, L"CoInitializeEx on refresh thread failed: 0x%08X", hr);
+    }
+}
+
+void MMDeviceEndpointBackend::DetachWorkerThread()
+{
+    ReleaseEndpointVolume();
+    _currentDevice.Reset();
+    _currentDeviceId.clear();
+
+    if (_workerComInitialized)
+    {
+        CoUninitialize();
+        _workerComInitialized = false;
+    }
+}
+
+bool MMDeviceEndpointBackend::GetDefaultEndpoint(std::wstring& endpointId)
+{
+    if (!_enumerator)
+    {
+        return false;
+    }
+
+    ComPtr<IMMDevice> device;
+    HRESULT hr = _enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device);
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"GetDefaultAudioEndpoint failed: 0x%08X\n", hr);
+        _currentDevice.Reset();
+        _currentDeviceId.clear();
+        return false;
+    }
+
+    LPWSTR rawDeviceId = nullptr;
+    hr = device->GetId(&rawDeviceId);
+    if (FAILED(hr) || !rawDeviceId)
+    {
+        LGTV_LOG_DEBUG(Audio, L"IMMDevice::GetId failed: 0x%08X\n", hr);
+        _currentDevice.Reset();
+        _currentDeviceId.clear();
+        return false;
+    }
+
+    endpointId.assign(rawDeviceId);
+    CoTaskMemFree(rawDeviceId);
+
+    _currentDevice = device;
+    _currentDeviceId = endpointId;
+    return true;
+}
+
+bool MMDeviceEndpointBackend::SelectVolumeEndpoint(const std::wstring& endpointId)
+{
+    ReleaseEndpointVolume();
+    if (endpointId.empty())
+    {
+        return false;
+    }
+
+    ComPtr<IMMDevice> device;
+    if (!OpenDevice(endpointId, device))
+    {
+        return false;
+    }
+
+    HRESULT hr = device->Activate(__uuidof(IAudioEndpointVolume),
+        CLSCTX_ALL,
+        nullptr,
+        (void**)_endpointVolume.GetAddressOf());
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"Activate(IAudioEndpointVolume) failed: 0x%08X\n", hr);
+        _endpointVolume.Reset();
+        return false;
+    }
+
+    // Without notifications a pinned volume can still be set, it just will
+    // not be corrected when another application changes it.
+    hr = _endpointVolume->RegisterControlChangeNotify(this);
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"RegisterControlChangeNotify failed: 0x%08X\n", hr);
+    }
+    else
+    {
+        _volumeNotifyRegistered = true;
+    }
+
+    _publishedVolume.Publish(ShareEndpointVolume(_endpointVolume));
+    return true;
+}
+
+bool MMDeviceEndpointBackend::GetVolume(float& level)
+{
+    std::shared_ptr<IAudioEndpointVolume> endpointVolume = _publishedVolume.Acquire();
+    if (!endpointVolume)
+    {
+        return false;
+    }
+
+    return SUCCEEDED(endpointVolume->GetMasterVolumeLevelScalar(&level));
+}
+
+bool MMDeviceEndpointBackend::SetVolume(float level)
+{
+    std::shared_ptr<IAudioEndpointVolume> endpointVolume = _publishedVolume.Acquire();
+    if (!endpointVolume)
+    {
+        return false;
+    }
+
+    return SUCCEEDED(endpointVolume->SetMasterVolumeLevelScalar(level, &_volumeEventContext));
+}
+
+ULONG STDMETHODCALLTYPE MMDeviceEndpointBackend::AddRef()
+{
+    return InterlockedIncrement(&_refCount);
+}
+
+ULONG STDMETHODCALLTYPE MMDeviceEndpointBackend::Release()
+{
+    ULONG ulRef = InterlockedDecrement(&_refCount);
+    if (ulRef == 0)
+        delete this;
+    return ulRef;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::QueryInterface(REFIID riid, VOID** ppvInterface)
+{
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient))
+    {
+        AddRef();
+        *ppvInterface = static_cast<IMMNotificationClient*>(this);
+        return S_OK;
+    }
+    if (riid == __uuidof(IAudioEndpointVolumeCallback))
+    {
+        AddRef();
+        *ppvInterface = static_cast<IAudioEndpointVolumeCallback*>(this);
+        return S_OK;
+    }
+    *ppvInterface = nullptr;
+    return E_NOINTERFACE;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnDefaultDeviceChanged(EDataFlow flow,
+    ERole role,
+    LPCWSTR)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (events && flow == eRender && (role == eConsole || role == eMultimedia))
+    {
+        LGTV_LOG_DEBUG(Audio, L"OnDefaultDeviceChanged\n");
+        events->OnDefaultEndpointChanged();
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnDeviceAdded(LPCWSTR deviceId)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (events && deviceId)
+    {
+        events->OnEndpointAdded(deviceId);
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnDeviceRemoved(LPCWSTR deviceId)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (events && deviceId)
+    {
+        events->OnEndpointRemoved(deviceId);
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnDeviceStateChanged(LPCWSTR deviceId, DWORD newState)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (events && deviceId)
+    {
+        LGTV_LOG_DEBUG(Audio, L"Endpoint state changed to 0x%08X\n", newState);
+        events->OnEndpointStateChanged(deviceId);
+    }
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnPropertyValueChanged(LPCWSTR deviceId, const PROPERTYKEY key)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (!events || !deviceId)
+    {
+        return S_OK;
+    }
+
+    // The friendly name drives the hint match; every other endpoint
+    // property change (format, spatial audio selection, ...) can change
+    // whether Dolby Atmos is available.
+    EndpointPropertyChange change = IsEqualPropertyKey(key, PKEY_Device_FriendlyName)
+        ? EndpointPropertyChange::FriendlyName
+        : EndpointPropertyChange::Format;
+
+    events->OnEndpointPropertyChanged(deviceId, change);
+    return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE MMDeviceEndpointBackend::OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA data)
+{
+    IAudioEndpointEvents* events = _events.load();
+    if (!events || !data)
+    {
+        return S_OK;
+    }
+
+    bool ownChange = IsEqualGUID(data->guidEventContext, _volumeEventContext) != FALSE;
+    events->OnEndpointVolumeChanged(data->fMasterVolume, ownChange);
+    return S_OK;
+}
+
+void MMDeviceEndpointBackend::ReleaseEndpointVolume()
+{
+    // Withdraw the handle first; a caller that already picked it up keeps
+    // its own reference and finishes against the old endpoint.
+    _publishedVolume.Reset();
+
+    if (_endpointVolume && _volumeNotifyRegistered)
+    {
+        _endpointVolume->UnregisterControlChangeNotify(this);
+    }
+    _volumeNotifyRegistered = false;
+    _endpointVolume.Reset();
+}
+
+bool MMDeviceEndpointBackend::OpenDevice(const std::wstring& endpointId, ComPtr<IMMDevice>& device)
+{
+    // The current default device is already open; reuse it instead of
+    // asking the enumerator again.
+    if (_currentDevice && endpointId == _currentDeviceId)
+    {
+        device = _currentDevice;
+        return true;
+    }
+
+    if (!_enumerator)
+    {
+        return false;
+    }
+
+    HRESULT hr = _enumerator->GetDevice(endpointId.c_str(), &device);
+    if (FAILED(hr))
+    {
+        LGTV_LOG_DEBUG(Audio, L"GetDevice failed: 0x%08X\n", hr);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "framework.h"
+
+#include <mmdeviceapi.h>
+#include <endpointvolume.h>
+#include <wrl/client.h>
+
+#include <atomic>
+#include <string>
+
+#include "AudioEndpointBackend.h"
+#include "PublishedHandle.h"
+
+// Endpoint backend built on the Windows MMDevice API.
+//
+// The object is reference counted because it is also registered as an
+// IMMNotificationClient and IAudioEndpointVolumeCallback; release it with
+// Release() rather than delete.
+class MMDeviceEndpointBackend
+    : public IAudioEndpointBackend,
+    public IMMNotificationClient,
+    public IAudioEndpointVolumeCallback
+{
+public:
+    MMDeviceEndpointBackend();
+
+    // IEndpointCapabilityProbe
+    bool ProbeFriendlyName(const std::wstring& endpointId, std::wstring& friendlyName) override;
+    bool ProbeDolbyAtmos(const std::wstring& endpointId) override;
+
+    // IAudioEndpointBackend
+    bool Start(IAudioEndpointEvents& events) override;
+    void Stop() override;
+    void AttachWorkerThread() override;
+    void DetachWorkerThread() override;
+    bool GetDefaultEndpoint(std::wstring& endpointId) override;
+    bool SelectVolumeEndpoint(const std::wstring& endpointId) override;
+    bool GetVolume(float& level) override;
+    bool SetVolume(float level) override;
+
+    // IUnknown
+    ULONG STDMETHODCALLTYPE AddRef() override;
+    ULONG STDMETHODCALLTYPE Release() override;
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, VOID** ppvInterface) override;
+
+    // IMMNotificationClient
+    HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR deviceId) override;
+    HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR deviceId) override;
+    HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR deviceId) override;
+    HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR deviceId, DWORD newState) override;
+    HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR deviceId, const PROPERTYKEY key) override;
+
+    // IAudioEndpointVolumeCallback
+    HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA data) override;
+
+private:
+    ~MMDeviceEndpointBackend() = default;
+
+    bool OpenDevice(const std::wstring& endpointId, Microsoft::WRL::ComPtr<IMMDevice>& device);
+    void ReleaseEndpointVolume();
+
+    Microsoft::WRL::ComPtr<IMMDeviceEnumerator> _enumerator;
+    // Cleared by Stop while notification callbacks may still be running on
+    // COM threads; each callback loads it once.
+    std::atomic<IAudioEndpointEvents*> _events;
+
+    // Only touched on the routing worker thread.
+    bool _workerComInitialized;
+    Microsoft::WRL::ComPtr<IMMDevice> _currentDevice;
+    std::wstring _currentDeviceId;
+
+    Microsoft::WRL::ComPtr<IAudioEndpointVolume> _endpointVolume;
+
+    // The selected endpoint volume as seen by GetVolume/SetVolume, which can
+    // run on any thread while the worker switches endpoints.
+    PublishedHandle<IAudioEndpointVolume> _publishedVolume;
+
+    // Tags our own volume changes so they can be told apart from other apps.
+    // Set once in the constructor and read-only afterwards.
+    GUID _volumeEventContext;
+    bool _volumeNotifyRegistered;
+
+    LONG _refCount;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Publishes a reference-counted handle that any thread can pick up without
+// taking a lock.
+//
+// The handle lives in one of two slots. Readers announce themselves on the
+// active slot, copy the shared_ptr out of it and leave again; a publisher
+// writes the inactive slot once its last reader has left and then flips the
+// active index. Readers never wait, and a reader that loses a race with a
+// flip simply retries on the other slot. Publishers are serialized and wait
+// only for readers still copying out of the slot being overwritten.
+//
+// The object a handle points to is released by whoever drops the last
+// reference, which is usually the publisher replacing it.
+template <typename T>
+class PublishedHandle
+{
+public:
+    PublishedHandle()
+        : slots(),
+        readers{ 0, 0 },
+        active(0),
+        publishMutex(),
+        publishCount(0)
+    {
+    }
+
+    PublishedHandle(const PublishedHandle&) = delete;
+    PublishedHandle& operator=(const PublishedHandle&) = delete;
+
+    // Returns the current handle, or an empty one if nothing is published.
+    std::shared_ptr<T> Acquire() const
+    {
+        for (;;)
+        {
+            uint32_t index = active.load();
+            readers[index].fetch_add(1);
+
+            if (active.load() == index)
+            {
+                std::shared_ptr<T> handle = slots[index];
+                readers[index].fetch_sub(1);
+                return handle;
+            }
+
+            readers[index].fetch_sub(1);
+        }
+    }
+
+    // Replaces the current handle. Readers that already hold the previous
+    // handle keep it alive until they drop it.
+    void Publish(std::shared_ptr<T> handle)
+    {
+        std::lock_guard<std::mutex> guard(publishMutex);
+
+        uint32_t target = 1 - active.load();
+        while (readers[target].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        // No reader can see the inactive slot once its count has drained.
+        slots[target] = std::move(handle);
+        active.store(target);
+        ++publishCount;
+
+        // Clear the now inactive slot so a replaced handle is not kept alive
+        // until the next publish.
+        uint32_t stale = 1 - target;
+        while (readers[stale].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        slots[stale].reset();
+    }
+
+    // Drops the current handle.
+    void Reset()
+    {
+        Publish(nullptr);
+    }
+
+    uint64_t GetPublishCount() const
+    {
+        std::lock_guard<std::mutex> guard(publishMutex);
+        return publishCount;
+    }
+
+private:
+    std::shared_ptr<T> slots[2];
+    mutable std::atomic<uint32_t> readers[2];
+    std::atomic<uint32_t> active;
+
+    mutable std::mutex publishMutex;
+    uint64_t publishCount;
+};
@@ -0,0 +1,109 @@
+#include "RoutingStateMachine.h"
+
+namespace
+{
+    // Routing decision indexed by
+    // deviceMatches | dolbyAtmosAvailable << 1 | paired << 2 | onlyWhenDolbyAtmos << 3.
+    // The TV is used when the default device matches and the app is paired,
+    // and, if so configured, only while Dolby Atmos is available.
+    constexpr bool RoutingTable[16] =
+    {
+        // onlyWhenDolbyAtmos = false
+        false,  // unpaired
+        false,  // unpaired, match
+        false,  // unpaired, atmos
+        false,  // unpaired, match, atmos
+        false,  // paired
+        true,   // paired, match
+        false,  // paired, atmos
+        true,   // paired, match, atmos
+        // onlyWhenDolbyAtmos = true
+        false,  // unpaired
+        false,  // unpaired, match
+        false,  // unpaired, atmos
+        false,  // unpaired, match, atmos
+        false,  // paired
+        false,  // paired, match
+        false,  // paired, atmos
+        true,   // paired, match, atmos
+    };
+
+    // Volume commands indexed by
+    // previousUseTv | useTv << 1 | previousEndpointVolumeAvailable << 2,
+    // applied only when an endpoint volume is available. An endpoint volume
+    // that just became available was never saved or pinned, so it is pinned
+    // if the TV is targeted and left alone otherwise.
+    constexpr uint32_t VolumeCommandTable[8] =
+    {
+        // endpoint volume just became available
+        RoutingCommandNone,                                                   // stays off the TV
+        RoutingCommandNone,                                                   // leaves the TV
+        RoutingCommandSaveEndpointVolume | RoutingCommandPinEndpointVolume,   // moves to the TV
+        RoutingCommandSaveEndpointVolume | RoutingCommandPinEndpointVolume,   // stays on the TV
+        // endpoint volume was already available
+        RoutingCommandNone,                                                   // stays off the TV
+        RoutingCommandRestoreEndpointVolume,                                  // leaves the TV
+        RoutingCommandSaveEndpointVolume | RoutingCommandPinEndpointVolume,   // moves to the TV
+        RoutingCommandNone,                                                   // stays on the TV
+    };
+
+    constexpr unsigned int RoutingIndex(const RoutingInputs& inputs)
+    {
+        return (inputs.deviceMatches ? 0x1u : 0u)
+            | (inputs.dolbyAtmosAvailable ? 0x2u : 0u)
+            | (inputs.paired ? 0x4u : 0u)
+            | (inputs.onlyWhenDolbyAtmos ? 0x8u : 0u);
+    }
+}
+
+bool DecideTvRouting(const RoutingInputs& inputs)
+{
+    return RoutingTable[RoutingIndex(inputs)];
+}
+
+RoutingStateMachine::RoutingStateMachine()
+    : inputs(),
+    hasInputs(false),
+    useTvVolume(false)
+{
+}
+
+RoutingTransition RoutingStateMachine::Advance(const RoutingInputs& newInputs)
+{
+    RoutingTransition transition;
+    transition.useTvVolume = useTvVolume;
+
+    if (hasInputs && newInputs == inputs)
+    {
+        return transition;
+    }
+
+    bool previousUseTv = useTvVolume;
+    bool previousVolumeAvailable = hasInputs && inputs.endpointVolumeAvailable;
+    bool useTv = DecideTvRouting(newInputs);
+
+    if (newInputs.endpointVolumeAvailable)
+    {
+        transition.commands |= VolumeCommandTable[
+            (previousUseTv ? 0x1u : 0u)
+            | (useTv ? 0x2u : 0u)
+            | (previousVolumeAvailable ? 0x4u : 0u)];
+    }
+    transition.commands |= RoutingCommandPublishStatus;
+    transition.useTvVolume = useTv;
+
+    inputs = newInputs;
+    hasInputs = true;
+    useTvVolume = useTv;
+    return transition;
+}
+
+bool RoutingStateMachine::IsTvVolumeActive() const
+{
+    return useTvVolume;
+}
+
+const RoutingInputs& RoutingStateMachine::GetInputs() const
+{
+    return inputs;
+}
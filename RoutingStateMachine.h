@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// Everything the routing decision depends on, captured at one point in time.
+struct RoutingInputs
+{
+    bool deviceMatches = false;
+    bool dolbyAtmosAvailable = false;
+    bool paired = false;
+    bool onlyWhenDolbyAtmos = true;
+    bool endpointVolumeAvailable = false;
+
+    bool operator==(const RoutingInputs&) const = default;
+};
+
+// Side effects requested by a routing transition. When several are set they
+// must be executed in the order the flags are declared.
+enum RoutingCommand : uint32_t
+{
+    RoutingCommandNone = 0,
+    RoutingCommandSaveEndpointVolume = 0x1,
+    RoutingCommandPinEndpointVolume = 0x2,
+    RoutingCommandRestoreEndpointVolume = 0x4,
+    RoutingCommandPublishStatus = 0x8
+};
+
+// Result of feeding a new input snapshot to the state machine.
+struct RoutingTransition
+{
+    bool useTvVolume = false;
+    uint32_t commands = RoutingCommandNone;
+};
+
+// Returns true when volume keys should go to the TV for the given inputs.
+bool DecideTvRouting(const RoutingInputs& inputs);
+
+// Tracks the routing state and turns input changes into commands.
+//
+// The machine has no side effects of its own. Feeding it the same snapshot
+// twice yields no commands, so callers can re-evaluate as often as they like.
+class RoutingStateMachine
+{
+public:
+    RoutingStateMachine();
+
+    // Moves to the state for the given inputs and returns what has to be done.
+    RoutingTransition Advance(const RoutingInputs& inputs);
+
+    // Returns the current routing decision.
+    bool IsTvVolumeActive() const;
+
+    // Returns the inputs of the last Advance call.
+    const RoutingInputs& GetInputs() const;
+
+private:
+    RoutingInputs inputs;
+    bool hasInputs;
+    bool useTvVolume;
+};
@@ -0,0 +1,292 @@
+#include "SimulatedEndpointBackend.h"
+
+SimulatedEndpointBackend::SimulatedEndpointBackend()
+    : endpoints(),
+    defaultEndpointId(),
+    selectedEndpointId(),
+    events(nullptr),
+    nameProbeCount(0),
+    atmosProbeCount(0),
+    volumeWriteCount(0),
+    volumeWrites()
+{
+}
+
+void SimulatedEndpointBackend::Apply(const SimulatedEndpointEvent& event)
+{
+    bool defaultChanged = false;
+    bool added = false;
+    bool removed = false;
+    bool stateChanged = false;
+    bool propertyChanged = false;
+    EndpointPropertyChange change = EndpointPropertyChange::Format;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto found = endpoints.find(event.endpointId);
+        switch (event.kind)
+        {
+        case SimulatedEndpointEventKind::AddEndpoint:
+        {
+            Endpoint& endpoint = endpoints[event.endpointId];
+            endpoint.friendlyName = event.friendlyName;
+            endpoint.dolbyAtmos = event.flag;
+            endpoint.active = true;
+            added = true;
+            break;
+        }
+        case SimulatedEndpointEventKind::RemoveEndpoint:
+            if (found != endpoints.end())
+            {
+                endpoints.erase(found);
+                removed = true;
+                if (defaultEndpointId == event.endpointId)
+                {
+                    defaultEndpointId.clear();
+                    defaultChanged = true;
+                }
+            }
+            break;
+        case SimulatedEndpointEventKind::SetDefault:
+            if (defaultEndpointId != event.endpointId)
+            {
+                defaultEndpointId = event.endpointId;
+                defaultChanged = true;
+            }
+            break;
+        case SimulatedEndpointEventKind::SetDolbyAtmos:
+            if (found != endpoints.end())
+            {
+                found->second.dolbyAtmos = event.flag;
+                propertyChanged = true;
+                change = EndpointPropertyChange::Format;
+            }
+            break;
+        case SimulatedEndpointEventKind::Rename:
+            if (found != endpoints.end())
+            {
+                found->second.friendlyName = event.friendlyName;
+                propertyChanged = true;
+                change = EndpointPropertyChange::FriendlyName;
+            }
+            break;
+        case SimulatedEndpointEventKind::SetActive:
+            if (found != endpoints.end() && found->second.active != event.flag)
+            {
+                found->second.active = event.flag;
+                stateChanged = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Like the MMDevice API, a default change is reported once per role.
+    std::lock_guard<std::mutex> dispatchGuard(dispatchMutex);
+    if (!events)
+    {
+        return;
+    }
+
+    if (added)
+    {
+        events->OnEndpointAdded(event.endpointId);
+    }
+    if (removed)
+    {
+        events->OnEndpointRemoved(event.endpointId);
+    }
+    if (stateChanged)
+    {
+        events->OnEndpointStateChanged(event.endpointId);
+    }
+    if (propertyChanged)
+    {
+        events->OnEndpointPropertyChanged(event.endpointId, change);
+    }
+    if (defaultChanged)
+    {
+        events->OnDefaultEndpointChanged();
+        events->OnDefaultEndpointChanged();
+    }
+}
+
+void SimulatedEndpointBackend::Replay(const std::vector<SimulatedEndpointEvent>& script)
+{
+    for (const SimulatedEndpointEvent& event : script)
+    {
+        Apply(event);
+    }
+}
+
+float SimulatedEndpointBackend::GetEndpointVolume(const std::wstring& endpointId) const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto found = endpoints.find(endpointId);
+    return (found != endpoints.end()) ? found->second.volume : -1.0f;
+}
+
+void SimulatedEndpointBackend::SetEndpointVolume(const std::wstring& endpointId, float level)
+{
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto found = endpoints.find(endpointId);
+        if (found != endpoints.end())
+        {
+            found->second.volume = level;
+            notify = (endpointId == selectedEndpointId);
+        }
+    }
+
+    if (notify)
+    {
+        NotifyVolumeChanged(level, false);
+    }
+}
+
+uint64_t SimulatedEndpointBackend::GetNameProbeCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return nameProbeCount;
+}
+
+uint64_t SimulatedEndpointBackend::GetAtmosProbeCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return atmosProbeCount;
+}
+
+uint64_t SimulatedEndpointBackend::GetVolumeWriteCount() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return volumeWriteCount;
+}
+
+std::vector<SimulatedVolumeWrite> SimulatedEndpointBackend::GetVolumeWrites() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return volumeWrites;
+}
+
+bool SimulatedEndpointBackend::ProbeFriendlyName(
+    const std::wstring& endpointId,
+    std::wstring& friendlyName)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    ++nameProbeCount;
+
+    auto found = endpoints.find(endpointId);
+    if (found == endpoints.end())
+    {
+        return false;
+    }
+
+    friendlyName = found->second.friendlyName;
+    return true;
+}
+
+bool SimulatedEndpointBackend::ProbeDolbyAtmos(const std::wstring& endpointId)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    ++atmosProbeCount;
+
+    auto found = endpoints.find(endpointId);
+    return found != endpoints.end() && found->second.active && found->second.dolbyAtmos;
+}
+
+bool SimulatedEndpointBackend::Start(IAudioEndpointEvents& eventsValue)
+{
+    std::lock_guard<std::mutex> dispatchGuard(dispatchMutex);
+    events = &eventsValue;
+    return true;
+}
+
+void SimulatedEndpointBackend::Stop()
+{
+    std::lock_guard<std::mutex> dispatchGuard(dispatchMutex);
+    events = nullptr;
+}
+
+void SimulatedEndpointBackend::AttachWorkerThread()
+{
+}
+
+void SimulatedEndpointBackend::DetachWorkerThread()
+{
+}
+
+bool SimulatedEndpointBackend::GetDefaultEndpoint(std::wstring& endpointId)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto found = endpoints.find(defaultEndpointId);
+    if (found == endpoints.end() || !found->second.active)
+    {
+        return false;
+    }
+
+    endpointId = defaultEndpointId;
+    return true;
+}
+
+bool SimulatedEndpointBackend::SelectVolumeEndpoint(const std::wstring& endpointId)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (endpointId.empty() || endpoints.find(endpointId) == endpoints.end())
+    {
+        selectedEndpointId.clear();
+        return false;
+    }
+
+    selectedEndpointId = endpointId;
+    return true;
+}
+
+bool SimulatedEndpointBackend::GetVolume(float& level)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto found = endpoints.find(selectedEndpointId);
+    if (found == endpoints.end())
+    {
+        return false;
+    }
+
+    level = found->second.volume;
+    return true;
+}
+
+bool SimulatedEndpointBackend::SetVolume(float level)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto found = endpoints.find(selectedEndpointId);
+        if (found == endpoints.end())
+        {
+            return false;
+        }
+
+        found->second.volume = level;
+        ++volumeWriteCount;
+        volumeWrites.push_back({ selectedEndpointId, level });
+    }
+
+    NotifyVolumeChanged(level, true);
+    return true;
+}
+
+void SimulatedEndpointBackend::NotifyVolumeChanged(float level, bool ownChange)
+{
+    std::lock_guard<std::mutex> dispatchGuard(dispatchMutex);
+    if (events)
+    {
+        events->OnEndpointVolumeChanged(level, ownChange);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AudioEndpointBackend.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Kinds of scripted endpoint events.
+enum class SimulatedEndpointEventKind
+{
+    AddEndpoint,
+    RemoveEndpoint,
+    SetDefault,
+    SetDolbyAtmos,
+    Rename,
+    SetActive
+};
+
+// One scripted endpoint event. Which fields are used depends on the kind:
+// AddEndpoint uses friendlyName and flag (Atmos), Rename uses friendlyName,
+// SetDolbyAtmos and SetActive use flag.
+struct SimulatedEndpointEvent
+{
+    SimulatedEndpointEventKind kind = SimulatedEndpointEventKind::SetDefault;
+    std::wstring endpointId;
+    std::wstring friendlyName;
+    bool flag = false;
+};
+
+// One volume write made through SetVolume.
+struct SimulatedVolumeWrite
+{
+    std::wstring endpointId;
+    float level = 0.0f;
+};
+
+// Endpoint backend without any audio hardware. Scripted events update an
+// in-memory device list and raise the same notifications the MMDevice backend
+// would, on the thread that replays them.
+class SimulatedEndpointBackend : public IAudioEndpointBackend
+{
+public:
+    SimulatedEndpointBackend();
+
+    // Applies one event and raises its notifications.
+    void Apply(const SimulatedEndpointEvent& event);
+
+    // Applies a sequence of events in order.
+    void Replay(const std::vector<SimulatedEndpointEvent>& script);
+
+    // Returns the master volume of an endpoint, or a negative value if unknown.
+    float GetEndpointVolume(const std::wstring& endpointId) const;
+
+    // Sets the master volume of an endpoint as another application would,
+    // raising a volume notification if the endpoint is selected.
+    void SetEndpointVolume(const std::wstring& endpointId, float level);
+
+    uint64_t GetNameProbeCount() const;
+    uint64_t GetAtmosProbeCount() const;
+    uint64_t GetVolumeWriteCount() const;
+
+    // Returns every SetVolume write so far, in order.
+    std::vector<SimulatedVolumeWrite> GetVolumeWrites() const;
+
+    // IEndpointCapabilityProbe
+    bool ProbeFriendlyName(const std::wstring& endpointId, std::wstring& friendlyName) override;
+    bool ProbeDolbyAtmos(const std::wstring& endpointId) override;
+
+    // IAudioEndpointBackend
+    bool Start(IAudioEndpointEvents& events) override;
+    void Stop() override;
+    void AttachWorkerThread() override;
+    void DetachWorkerThread() override;
+    bool GetDefaultEndpoint(std::wstring& endpointId) override;
+    bool SelectVolumeEndpoint(const std::wstring& endpointId) override;
+    bool GetVolume(float& level) override;
+    bool SetVolume(float level) override;
+
+private:
+    void NotifyVolumeChanged(float level, bool ownChange);
+
+    struct Endpoint
+    {
+        std::wstring friendlyName;
+        bool dolbyAtmos = false;
+        bool active = true;
+        float volume = 0.5f;
+    };
+
+    mutable std::mutex mutex;
+    std::mutex dispatchMutex;
+    std::map<std::wstring, Endpoint> endpoints;
+    std::wstring defaultEndpointId;
+    std::wstring selectedEndpointId;
+    IAudioEndpointEvents* events;
+
+    uint64_t nameProbeCount;
+    uint64_t atmosProbeCount;
+    uint64_t volumeWriteCount;
+    std::vector<SimulatedVolumeWrite> volumeWrites;
+};
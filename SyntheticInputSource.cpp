@@ -0,0 +1,75 @@
+#include "SyntheticInputSource.h"
+
+#include <thread>
+
+SyntheticInputSource::SyntheticInputSource(
+    IInputEventSink& sinkValue,
+    std::vector<TvVolumeAction> patternValue,
+    uint64_t eventLimitValue,
+    std::chrono::steady_clock::duration intervalValue)
+    : sink(sinkValue),
+    pattern(std::move(patternValue)),
+    eventLimit(eventLimitValue),
+    interval(intervalValue),
+    stopRequested(false),
+    producedCount(0),
+    consumedCount(0)
+{
+}
+
+bool SyntheticInputSource::Prepare()
+{
+    stopRequested = false;
+    return !pattern.empty();
+}
+
+void SyntheticInputSource::Run()
+{
+    size_t next = 0;
+    std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now();
+
+    while (!stopRequested.load(std::memory_order_relaxed))
+    {
+        if (eventLimit != 0 && producedCount.load(std::memory_order_relaxed) >= eventLimit)
+        {
+            break;
+        }
+
+        if (interval != std::chrono::steady_clock::duration::zero())
+        {
+            due += interval;
+            std::this_thread::sleep_until(due);
+        }
+
+        TvVolumeEvent event;
+        event.action = pattern[next];
+        event.timestamp = std::chrono::steady_clock::now();
+        next = (next + 1) % pattern.size();
+
+        producedCount.fetch_add(1, std::memory_order_relaxed);
+        if (sink.OnTvVolumeEvent(event))
+        {
+            consumedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SyntheticInputSource::RequestStop()
+{
+    stopRequested = true;
+}
+
+void SyntheticInputSource::RequestCaptureUpdate()
+{
+    // Nothing else sees synthetic events, so there is nothing to capture.
+}
+
+uint64_t SyntheticInputSource::GetProducedCount() const
+{
+    return producedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SyntheticInputSource::GetConsumedCount() const
+{
+    return consumedCount.load(std::memory_order_relaxed);
+}
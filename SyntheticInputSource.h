@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "InputSource.h"
+
+// Input source that replays a fixed pattern of volume key events, for
+// benchmarking everything downstream of the input layer.
+class SyntheticInputSource : public IInputSource
+{
+public:
+    // Replays the pattern until eventLimit events were produced (0 means
+    // until stopped), pausing interval between events (zero means as fast as
+    // possible).
+    SyntheticInputSource(
+        IInputEventSink& sink,
+        std::vector<TvVolumeAction> pattern,
+        uint64_t eventLimit,
+        std::chrono::steady_clock::duration interval = std::chrono::steady_clock::duration::zero());
+
+    // IInputEventLoop
+    bool Prepare() override;
+    void Run() override;
+    void RequestStop() override;
+
+    // IInputSource
+    void RequestCaptureUpdate() override;
+
+    uint64_t GetProducedCount() const;
+    uint64_t GetConsumedCount() const;
+
+private:
+    IInputEventSink& sink;
+    std::vector<TvVolumeAction> pattern;
+    uint64_t eventLimit;
+    std::chrono::steady_clock::duration interval;
+
+    std::atomic<bool> stopRequested;
+    std::atomic<uint64_t> producedCount;
+    std::atomic<uint64_t> consumedCount;
+};
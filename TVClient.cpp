@@ -1,13 +1,22 @@
 #include "TVClient.h"
 
+#include "ClientKeyStore.h"
+#include "FlightRecorder.h"
 #include "Logging.h"
+#include "TraceRecorder.h"
 
 #include <winhttp.h>
 #include <iphlpapi.h>
 #include <ws2tcpip.h>
 
+#include <atomic>
 #include <cstdio>
+#include <cwctype>
+#include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #pragma comment(lib, "Winhttp.lib")
 #pragma comment(lib, "Iphlpapi.lib")
@@ -37,43 +46,17 @@ namespace
         }
     };
 
-    std::string WideToUtf8(const std::wstring& value)
+    // Returns the configuration file's path with its extension replaced by
+    // suffix, e.g. "_client_keys.txt".
+    std::wstring GetPathNextToConfiguration(const std::wstring& suffix)
     {
-        if (value.empty())
+        std::wstring basePath = GetConfigurationFilePath();
+        size_t position = basePath.find_last_of(L".");
+        if (position != std::wstring::npos)
         {
-            return {};
+            basePath = basePath.substr(0, position);
         }
-
-        int requiredLength = WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            value.c_str(),
-            static_cast<int>(value.size()),
-            nullptr,
-            0,
-            nullptr,
-            nullptr);
-        if (requiredLength <= 0)
-        {
-            return {};
-        }
-
-        std::string result(static_cast<size_t>(requiredLength), '\0');
-        int written = WideCharToMultiByte(
-            CP_UTF8,
-            0,
-            value.c_str(),
-            static_cast<int>(value.size()),
-            result.data(),
-            requiredLength,
-            nullptr,
-            nullptr);
-        if (written != requiredLength)
-        {
-            result.clear();
-        }
-
-        return result;
+        return basePath + suffix;
     }
 
     bool ResolveMacForIp(const std::wstring& ipAddress, std::wstring& macAddressOut)
@@ -87,7 +70,7 @@ namespace
             &ipv4Address.sin_addr);
         if (inetResult != 1)
         {
-            ErrorLog(L"[LGTV] InetPtonW failed for IP '%s'", ipAddress.c_str());
+            LGTV_LOG_ERROR(LGTV, L"InetPtonW failed for IP '%s'", ipAddress.c_str());
             return false;
         }
 
@@ -101,7 +84,7 @@ namespace
             &physicalAddressLength);
         if (arpResult != NO_ERROR || physicalAddressLength < 6)
         {
-            ErrorLog(L"[LGTV] SendARP failed for IP '%s', result=%lu", ipAddress.c_str(), arpResult);
+            LGTV_LOG_ERROR(LGTV, L"SendARP failed for IP '%s', result=%lu", ipAddress.c_str(), arpResult);
             return false;
         }
 
@@ -137,19 +120,53 @@ namespace
         return normalized;
     }
 
+    // The default profile's client always exists; clients of named profiles
+    // are created when first selected and kept, so GetTVClient callers never
+    // hold a dangling reference.
     LGWebOSClient g_globalTVClient;
+    std::mutex g_tvClientsMutex;
+    std::vector<std::unique_ptr<LGWebOSClient>> g_profileTVClients;
+    std::atomic<LGWebOSClient*> g_activeTVClient(&g_globalTVClient);
+    const ConfigurationStore* g_tvConfigurationStore = nullptr;
+
+    // Returns the client of a profile, creating it on first use. Requires
+    // g_tvClientsMutex.
+    LGWebOSClient& FindOrCreateProfileClient(const std::wstring& profileName)
+    {
+        if (profileName.empty())
+        {
+            return g_globalTVClient;
+        }
+        for (const std::unique_ptr<LGWebOSClient>& candidate : g_profileTVClients)
+        {
+            if (candidate->GetProfileName() == profileName)
+            {
+                return *candidate;
+            }
+        }
+
+        g_profileTVClients.push_back(std::make_unique<LGWebOSClient>());
+        LGWebOSClient& client = *g_profileTVClients.back();
+        client.SetProfile(g_tvConfigurationStore, profileName);
+        return client;
+    }
 }
 
 LGWebOSClient::LGWebOSClient()
-    : configuration(nullptr),
+    : configurationStore(nullptr),
+    profileName(),
+    configurationVersion(0),
+    profile(),
     lastVerifiedIpAddress(),
     lastVerifiedMacAddress(),
     lastMacVerificationResult(false),
     persistentWebSocket(nullptr),
     persistentRegistered(false),
-    cachedClientKey(),
-    clientKeyLoaded(false)
+    keyIdentity(),
+    commandStatus(),
+    muted(false)
 {
+    keyIdentity.Publish(std::make_shared<const KeyIdentity>());
     InitializeCriticalSection(&lock);
 }
 
@@ -166,47 +183,113 @@ LGWebOSClient::~LGWebOSClient()
     DeleteCriticalSection(&lock);
 }
 
-void LGWebOSClient::SetConfiguration(const AppConfiguration* configurationValue)
+void LGWebOSClient::SetProfile(const ConfigurationStore* store, const std::wstring& profileNameValue)
 {
     ScopedCriticalSection guard(&lock);
 
-    configuration = configurationValue;
+    configurationStore = store;
+    profileName = profileNameValue;
+    profile = TvProfile();
+    profile.name = profileName;
+    configurationVersion = 0;
+    if (store != nullptr)
+    {
+        std::shared_ptr<const AppConfiguration> configuration = store->Acquire();
+        FindTvProfile(*configuration, profileName, profile);
+        configurationVersion = configuration->version;
+    }
+
     lastVerifiedIpAddress.clear();
     lastVerifiedMacAddress.clear();
     lastMacVerificationResult = false;
 
-    cachedClientKey.clear();
-    clientKeyLoaded = false;
+    UpdateKeyIdentity();
+    MigrateLegacyClientKey();
 
-    if (persistentWebSocket)
+    ResetPersistentConnection();
+    commandStatus.Reset();
+    muted.store(false, std::memory_order_relaxed);
+}
+
+const std::wstring& LGWebOSClient::GetProfileName() const
+{
+    return profileName;
+}
+
+bool LGWebOSClient::WarmUp()
+{
+    ScopedCriticalSection guard(&lock);
+
+    std::string clientKey = LoadClientKey();
+    if (clientKey.empty())
     {
-        CloseWebSocket(persistentWebSocket);
-        persistentWebSocket = nullptr;
-        persistentRegistered = false;
+        return false;
+    }
+
+    return EnsurePersistentConnection(clientKey);
+}
+
+void LGWebOSClient::RefreshConfiguration()
+{
+    if (!configurationStore || configurationVersion == configurationStore->GetVersion())
+    {
+        return;
+    }
+
+    std::shared_ptr<const AppConfiguration> latest = configurationStore->Acquire();
+    TvProfile latestProfile;
+    if (!FindTvProfile(*latest, profileName, latestProfile))
+    {
+        // The profile was removed; leave it unconfigured until it comes back.
+        latestProfile.name = profileName;
+        latestProfile.tvIpAddress.clear();
+    }
+
+    ApplyConfigurationChanges(CompareTvProfiles(profile, latestProfile));
+    profile = std::move(latestProfile);
+    configurationVersion = latest->version;
+}
+
+void LGWebOSClient::ApplyConfigurationChanges(uint32_t changes)
+{
+    if (changes & ConfigurationChangeTvIdentity)
+    {
+        lastVerifiedIpAddress.clear();
+        lastVerifiedMacAddress.clear();
+        lastMacVerificationResult = false;
+    }
+
+    if (changes & ConfigurationChangeTvTransport)
+    {
+        LGTV_LOG_INFO(LGTV, L"TV address or transport changed, reconnecting on next command");
+        ResetPersistentConnection();
     }
 }
 
 bool LGWebOSClient::VolumeUp()
 {
     ScopedCriticalSection guard(&lock);
-    return SendSimpleCommand("ssap://audio/volumeUp");
+    Clock::time_point started = Clock::now();
+    return CompleteCommand(SendSimpleCommand("ssap://audio/volumeUp"), started);
 }
 
 bool LGWebOSClient::VolumeDown()
 {
     ScopedCriticalSection guard(&lock);
-    return SendSimpleCommand("ssap://audio/volumeDown");
+    Clock::time_point started = Clock::now();
+    return CompleteCommand(SendSimpleCommand("ssap://audio/volumeDown"), started);
 }
 
 bool LGWebOSClient::ToggleMute()
 {
     ScopedCriticalSection guard(&lock);
+    Clock::time_point started = Clock::now();
 
     std::string clientKey = LoadClientKey();
     if (clientKey.empty())
     {
-        DebugLog(L"[LGTV] ToggleMute: no client key yet (not paired)");
-        return false;
+        LGTV_LOG_DEBUG(LGTV, L"ToggleMute: no client key yet (not paired)");
+        return RecordFailure(TvClientError::NotPaired);
     }
 
     if (!EnsurePersistentConnection(clientKey))
@@ -217,35 +300,36 @@ bool LGWebOSClient::ToggleMute()
     std::string getStatusRequest = BuildRequestMessage("ssap://audio/getStatus", nullptr);
     if (!SendText(persistentWebSocket, getStatusRequest))
     {
-        DebugLog(L"[LGTV] ToggleMute: send getStatus failed");
+        LGTV_LOG_DEBUG(LGTV, L"ToggleMute: send getStatus failed");
         ResetPersistentConnection();
-        return false;
+        return RecordFailure(TvClientError::SendFailed);
     }
 
     std::string statusResponse;
     if (!ReceiveOneTextMessage(persistentWebSocket, statusResponse))
     {
-        DebugLog(L"[LGTV] ToggleMute: receive getStatus failed");
+        LGTV_LOG_DEBUG(LGTV, L"ToggleMute: receive getStatus failed");
         ResetPersistentConnection();
-        return false;
+        return RecordFailure(TvClientError::ReceiveFailed);
     }
 
-    bool muted = false;
-    if (!ParseMutedFlag(statusResponse, muted))
+    bool tvMuted = false;
+    if (!ParseMutedFlag(statusResponse, tvMuted))
     {
-        DebugLog(L"[LGTV] ToggleMute: failed to parse muted flag, forcing mute=true");
+        LGTV_LOG_DEBUG(LGTV, L"ToggleMute: failed to parse muted flag, forcing mute=true");
         std::string payload = "{\"mute\":true}";
         std::string setMuteRequest = BuildRequestMessage("ssap://audio/setMute", payload.c_str());
         if (!SendText(persistentWebSocket, setMuteRequest))
         {
             ResetPersistentConnection();
-            return false;
+            return RecordFailure(TvClientError::SendFailed);
         }
 
-        return true;
+        muted.store(true, std::memory_order_relaxed);
+        return CompleteCommand(true, started);
     }
 
-    bool newMuted = !muted;
+    bool newMuted = !tvMuted;
     std::string payload =
         std::string("{\"mute\":") + (newMuted ? "true" : "false") + "}";
     std::string setMuteRequest =
@@ -253,39 +337,41 @@ bool LGWebOSClient::ToggleMute()
     if (!SendText(persistentWebSocket, setMuteRequest))
     {
         ResetPersistentConnection();
-        return false;
+        return RecordFailure(TvClientError::SendFailed);
     }
 
-    return true;
+    muted.store(newMuted, std::memory_order_relaxed);
+    return CompleteCommand(true, started);
 }
 
 bool LGWebOSClient::PairWithTv(HWND parentWindow)
 {
     ScopedCriticalSection guard(&lock);
 
-    DebugLog(L"[LGTV] PairWithTv: starting");
+    LGTV_LOG_DEBUG(LGTV, L"PairWithTv: starting");
+    RefreshConfiguration();
 
     if (!VerifyMacAddressMatchesConfiguration(true))
     {
-        return false;
+        return RecordFailure(TvClientError::MacMismatch);
     }
 
     HINTERNET webSocketHandle = nullptr;
     if (!Connect(webSocketHandle))
     {
-        DebugLog(L"[LGTV] PairWithTv: Connect() failed");
+        LGTV_LOG_DEBUG(LGTV, L"PairWithTv: Connect() failed");
         return false;
     }
 
     std::string emptyKey;
     if (!SendRegister(webSocketHandle, emptyKey))
     {
-        DebugLog(L"[LGTV] PairWithTv: SendRegister() failed");
+        LGTV_LOG_DEBUG(LGTV, L"PairWithTv: SendRegister() failed");
         CloseWebSocket(webSocketHandle);
-        return false;
+        return RecordFailure(TvClientError::RegisterFailed);
     }
 
-    DebugLog(L"[LGTV] PairWithTv: register sent, TV should show PROMPT now");
+    LGTV_LOG_DEBUG(LGTV, L"PairWithTv: register sent, TV should show PROMPT now");
 
     MessageBoxW(
         parentWindow,
@@ -294,7 +380,7 @@ bool LGWebOSClient::PairWithTv(HWND parentWindow)
         L"LG TV Volume Proxy - Pairing",
         MB_OK | MB_ICONINFORMATION);
 
-    DebugLog(L"[LGTV] PairWithTv: waiting for response(s) with client-key");
+    LGTV_LOG_DEBUG(LGTV, L"PairWithTv: waiting for response(s) with client-key");
 
     std::string response;
     std::string newKey;
@@ -304,7 +390,7 @@ bool LGWebOSClient::PairWithTv(HWND parentWindow)
         response.clear();
         if (!ReceiveOneTextMessage(webSocketHandle, response))
         {
-            DebugLog(L"[LGTV] PairWithTv: ReceiveOneTextMessage() failed on iteration %d", index);
+            LGTV_LOG_DEBUG(LGTV, L"PairWithTv: ReceiveOneTextMessage() failed on iteration %d", index);
             break;
         }
 
@@ -313,54 +399,69 @@ bool LGWebOSClient::PairWithTv(HWND parentWindow)
         {
             wideResponse.resize(400);
         }
-        DebugLog(L"[LGTV] PairWithTv: RECV[%d]: %s", index, wideResponse.c_str());
+        LGTV_LOG_DEBUG(LGTV, L"PairWithTv: RECV[%d]: %s", index, wideResponse.c_str());
 
         newKey = ParseClientKey(response);
         if (!newKey.empty())
         {
-            DebugLog(L"[LGTV] PairWithTv: found client-key in RECV[%d]", index);
+            LGTV_LOG_DEBUG(LGTV, L"PairWithTv: found client-key in RECV[%d]", index);
             break;
         }
     }
 
     if (newKey.empty())
     {
-        DebugLog(L"[LGTV] PairWithTv: no client-key found in any response");
+        LGTV_LOG_DEBUG(LGTV, L"PairWithTv: no client-key found in any response");
         CloseWebSocket(webSocketHandle);
-        return false;
+        return RecordFailure(TvClientError::RegisterFailed);
     }
 
     SaveClientKey(newKey);
-    DebugLog(L"[LGTV] PairWithTv: stored client-key (***hidden***)");
+    LGTV_LOG_DEBUG(LGTV, L"PairWithTv: stored client-key (***hidden***)");
 
     CloseWebSocket(webSocketHandle);
+    commandStatus.ClearError();
     return true;
 }
 
 bool LGWebOSClient::UnpairFromTv()
 {
-    ScopedCriticalSection guard(&lock);
-
+    // Only the key store changes; a registered connection stays usable until
+    // it is next reopened, as it would on the TV's side.
     if (!HasClientKey())
     {
-        DebugLog(L"[LGTV] UnpairFromTv: no client key present");
+        LGTV_LOG_DEBUG(LGTV, L"UnpairFromTv: no client key present");
         return true;
     }
 
     if (!DeleteClientKey())
     {
-        WarningLog(L"[LGTV] UnpairFromTv: client key file delete failed");
+        LGTV_LOG_WARNING(LGTV, L"UnpairFromTv: removing the client key failed");
         return false;
     }
 
-    DebugLog(L"[LGTV] UnpairFromTv: client key removed");
+    LGTV_LOG_DEBUG(LGTV, L"UnpairFromTv: client key removed");
     return true;
 }
 
 bool LGWebOSClient::HasClientKey() const
 {
-    ScopedCriticalSection guard(const_cast<CRITICAL_SECTION*>(&lock));
-    return !LoadClientKey().empty();
+    return GetClientKeyStore().Contains(AcquireKeyIdentity()->value);
+}
+
+TvClientStatus LGWebOSClient::GetStatus() const
+{
+    return commandStatus.GetStatus(HasClientKey());
+}
+
+bool LGWebOSClient::RecordFailure(TvClientError error)
+{
+    return commandStatus.RecordFailure(error);
+}
+
+bool LGWebOSClient::CompleteCommand(bool succeeded, Clock::time_point started)
+{
+    return commandStatus.CompleteCommand(succeeded, started, Clock::now());
 }
 
 bool LGWebOSClient::SetVolume(int volumeLevel)
@@ -372,17 +473,55 @@ bool LGWebOSClient::SetVolume(int volumeLevel)
         volumeLevel = 0;
     }
 
+    Clock::time_point started = Clock::now();
     std::string payload = std::string("{\"volume\":") + std::to_string(volumeLevel) + "}";
-    return SendCommandWithPayload("ssap://audio/setVolume", payload.c_str());
+    return CompleteCommand(SendCommandWithPayload("ssap://audio/setVolume", payload.c_str()), started);
 }
 
 bool LGWebOSClient::SetMute(bool mute)
 {
     ScopedCriticalSection guard(&lock);
+    Clock::time_point started = Clock::now();
 
     std::string payload =
         std::string("{\"mute\":") + (mute ? "true" : "false") + "}";
-    return SendCommandWithPayload("ssap://audio/setMute", payload.c_str());
+    if (!SendCommandWithPayload("ssap://audio/setMute", payload.c_str()))
+    {
+        return false;
+    }
+
+    muted.store(mute, std::memory_order_relaxed);
+    return CompleteCommand(true, started);
+}
+
+bool LGWebOSClient::IsMuted() const
+{
+    return muted.load(std::memory_order_relaxed);
+}
+
+bool LGWebOSClient::CloseIfProfileRemoved()
+{
+    ScopedCriticalSection guard(&lock);
+    if (!configurationStore || profileName.empty())
+    {
+        return false;
+    }
+
+    TvProfile current;
+    if (FindTvProfile(*configurationStore->Acquire(), profileName, current))
+    {
+        return false;
+    }
+
+    // Also clears the address, so the profile stays unconfigured until it
+    // comes back.
+    RefreshConfiguration();
+    if (persistentWebSocket)
+    {
+        LGTV_LOG_INFO(LGTV, L"TV profile %s was removed, closing its connection", profileName.c_str());
+    }
+    ResetPersistentConnection();
+    return true;
 }
 
 bool LGWebOSClient::SendSimpleCommand(const char* uri)
@@ -390,8 +529,8 @@ bool LGWebOSClient::SendSimpleCommand(const char* uri)
     std::string clientKey = LoadClientKey();
     if (clientKey.empty())
     {
-        DebugLog(L"[LGTV] SendSimpleCommand: no client key yet (not paired)");
-        return false;
+        LGTV_LOG_DEBUG(LGTV, L"SendSimpleCommand: no client key yet (not paired)");
+        return RecordFailure(TvClientError::NotPaired);
     }
 
     if (!EnsurePersistentConnection(clientKey))
@@ -403,7 +542,7 @@ bool LGWebOSClient::SendSimpleCommand(const char* uri)
     if (!SendText(persistentWebSocket, request))
     {
         ResetPersistentConnection();
-        return false;
+        return RecordFailure(TvClientError::SendFailed);
     }
 
     return true;
@@ -414,8 +553,8 @@ bool LGWebOSClient::SendCommandWithPayload(const char* uri, const char* payload)
     std::string clientKey = LoadClientKey();
     if (clientKey.empty())
     {
-        DebugLog(L"[LGTV] SendCommandWithPayload: no client key yet (not paired)");
-        return false;
+        LGTV_LOG_DEBUG(LGTV, L"SendCommandWithPayload: no client key yet (not paired)");
+        return RecordFailure(TvClientError::NotPaired);
     }
 
     if (!EnsurePersistentConnection(clientKey))
@@ -427,7 +566,7 @@ bool LGWebOSClient::SendCommandWithPayload(const char* uri, const char* payload)
     if (!SendText(persistentWebSocket, request))
     {
         ResetPersistentConnection();
-        return false;
+        return RecordFailure(TvClientError::SendFailed);
     }
 
     return true;
@@ -435,24 +574,27 @@ bool LGWebOSClient::SendCommandWithPayload(const char* uri, const char* payload)
 
 bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
 {
+    TraceSpan span("LGTV", "Connect");
+
     webSocketHandle = nullptr;
+    RefreshConfiguration();
 
-    if (!configuration)
+    if (!configurationStore)
     {
-        ErrorLog(L"[LGTV] Connect: configuration not set");
-        return false;
+        LGTV_LOG_ERROR(LGTV, L"Connect: configuration not set");
+        return RecordFailure(TvClientError::NotConfigured);
     }
 
-    if (configuration->tvIpAddress.empty())
+    if (profile.tvIpAddress.empty())
     {
-        ErrorLog(L"[LGTV] Connect: no TV IP configured");
-        return false;
+        LGTV_LOG_ERROR(LGTV, L"Connect: no TV IP configured");
+        return RecordFailure(TvClientError::NotConfigured);
     }
 
     if (!VerifyMacAddressMatchesConfiguration(false))
     {
-        ErrorLog(L"[LGTV] Connect: MAC verification failed");
-        return false;
+        LGTV_LOG_ERROR(LGTV, L"Connect: MAC verification failed");
+        return RecordFailure(TvClientError::MacMismatch);
     }
 
     HINTERNET sessionHandle = WinHttpOpen(
@@ -463,23 +605,23 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
         0);
     if (!sessionHandle)
     {
-        ErrorLog(L"[LGTV] WinHttpOpen failed: %lu", GetLastError());
-        return false;
+        LGTV_LOG_ERROR(LGTV, L"WinHttpOpen failed: %lu", GetLastError());
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     HINTERNET connectHandle = WinHttpConnect(
         sessionHandle,
-        configuration->tvIpAddress.c_str(),
-        configuration->tvPort,
+        profile.tvIpAddress.c_str(),
+        profile.tvPort,
         0);
     if (!connectHandle)
     {
-        ErrorLog(L"[LGTV] WinHttpConnect failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpConnect failed: %lu", GetLastError());
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
-    DWORD flags = configuration->useSecureWebSocket ? WINHTTP_FLAG_SECURE : 0;
+    DWORD flags = profile.useSecureWebSocket ? WINHTTP_FLAG_SECURE : 0;
 
     HINTERNET requestHandle = WinHttpOpenRequest(
         connectHandle,
@@ -491,13 +633,13 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
         flags);
     if (!requestHandle)
     {
-        ErrorLog(L"[LGTV] WinHttpOpenRequest failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpOpenRequest failed: %lu", GetLastError());
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
-    if (configuration->useSecureWebSocket)
+    if (profile.useSecureWebSocket)
     {
         DWORD securityFlags =
             SECURITY_FLAG_IGNORE_UNKNOWN_CA |
@@ -511,7 +653,7 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
             &securityFlags,
             sizeof(securityFlags)))
         {
-            WarningLog(L"[LGTV] WinHttpSetOption(SECURITY_FLAGS) failed: %lu", GetLastError());
+            LGTV_LOG_WARNING(LGTV, L"WinHttpSetOption(SECURITY_FLAGS) failed: %lu", GetLastError());
         }
     }
 
@@ -522,11 +664,11 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
         nullptr,
         0))
     {
-        ErrorLog(L"[LGTV] WinHttpSetOption(UPGRADE_TO_WEB_SOCKET) failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpSetOption(UPGRADE_TO_WEB_SOCKET) failed: %lu", GetLastError());
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     BOOL sendResult = WinHttpSendRequest(
@@ -539,21 +681,21 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
         0);
     if (!sendResult)
     {
-        ErrorLog(L"[LGTV] WinHttpSendRequest failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpSendRequest failed: %lu", GetLastError());
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     BOOL receiveResult = WinHttpReceiveResponse(requestHandle, nullptr);
     if (!receiveResult)
     {
-        ErrorLog(L"[LGTV] WinHttpReceiveResponse failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpReceiveResponse failed: %lu", GetLastError());
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     DWORD statusCode = 0;
@@ -566,30 +708,30 @@ bool LGWebOSClient::Connect(HINTERNET& webSocketHandle)
         &statusCodeSize,
         WINHTTP_NO_HEADER_INDEX))
     {
-        ErrorLog(L"[LGTV] WinHttpQueryHeaders failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpQueryHeaders failed: %lu", GetLastError());
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     if (statusCode != 101)
     {
-        ErrorLog(L"[LGTV] WebSocket upgrade failed, HTTP status = %lu", statusCode);
+        LGTV_LOG_ERROR(LGTV, L"WebSocket upgrade failed, HTTP status = %lu", statusCode);
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     HINTERNET webSocket = WinHttpWebSocketCompleteUpgrade(requestHandle, 0);
     if (!webSocket)
     {
-        ErrorLog(L"[LGTV] WinHttpWebSocketCompleteUpgrade failed: %lu", GetLastError());
+        LGTV_LOG_ERROR(LGTV, L"WinHttpWebSocketCompleteUpgrade failed: %lu", GetLastError());
         WinHttpCloseHandle(requestHandle);
         WinHttpCloseHandle(connectHandle);
         WinHttpCloseHandle(sessionHandle);
-        return false;
+        return RecordFailure(TvClientError::ConnectFailed);
     }
 
     WinHttpCloseHandle(requestHandle);
@@ -608,6 +750,8 @@ bool LGWebOSClient::SendRegister(HINTERNET webSocketHandle, const std::string& c
 
 bool LGWebOSClient::SendText(HINTERNET webSocketHandle, const std::string& text)
 {
+    TraceSpan span("LGTV", "SendText");
+
     if (!webSocketHandle)
     {
         return false;
@@ -618,9 +762,10 @@ bool LGWebOSClient::SendText(HINTERNET webSocketHandle, const std::string& text)
         WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
         reinterpret_cast<BYTE*>(const_cast<char*>(text.data())),
         static_cast<DWORD>(text.size()));
+    RecordFlightEvent(FlightEventType::TvSend, static_cast<int64_t>(text.size()), SUCCEEDED(result) ? 1 : 0);
     if (FAILED(result))
     {
-        ErrorLog(L"[LGTV] WinHttpWebSocketSend failed: 0x%08X", result);
+        LGTV_LOG_ERROR(LGTV, L"WinHttpWebSocketSend failed: 0x%08X", result);
         return false;
     }
     return true;
@@ -628,6 +773,8 @@ bool LGWebOSClient::SendText(HINTERNET webSocketHandle, const std::string& text)
 
 bool LGWebOSClient::ReceiveOneTextMessage(HINTERNET webSocketHandle, std::string& outMessage)
 {
+    TraceSpan span("LGTV", "ReceiveOneTextMessage");
+
     if (!webSocketHandle)
     {
         return false;
@@ -644,22 +791,25 @@ bool LGWebOSClient::ReceiveOneTextMessage(HINTERNET webSocketHandle, std::string
         sizeof(buffer),
         &bytesRead,
         &bufferType);
+    bool textReceived = SUCCEEDED(result) &&
+        (bufferType == WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE ||
+        bufferType == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE);
+    RecordFlightEvent(FlightEventType::TvReceive, SUCCEEDED(result) ? bytesRead : 0, textReceived ? 1 : 0);
     if (FAILED(result))
     {
-        ErrorLog(L"[LGTV] WinHttpWebSocketReceive failed: 0x%08X", result);
+        LGTV_LOG_ERROR(LGTV, L"WinHttpWebSocketReceive failed: 0x%08X", result);
         return false;
     }
 
     if (bufferType == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
     {
-        DebugLog(L"[LGTV] WebSocket close frame received");
+        LGTV_LOG_DEBUG(LGTV, L"WebSocket close frame received");
         return false;
     }
 
-    if (bufferType != WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE &&
-        bufferType != WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
+    if (!textReceived)
     {
-        ErrorLog(L"[LGTV] Unexpected buffer type: %d", static_cast<int>(bufferType));
+        LGTV_LOG_ERROR(LGTV, L"Unexpected buffer type: %d", static_cast<int>(bufferType));
         return false;
     }
 
@@ -676,6 +826,7 @@ void LGWebOSClient::CloseWebSocket(HINTERNET webSocketHandle)
         return;
     }
 
+    RecordFlightEvent(FlightEventType::TvDisconnect);
     WinHttpWebSocketShutdown(
         webSocketHandle,
         WINHTTP_WEB_SOCKET_SUCCESS_CLOSE_STATUS,
@@ -686,21 +837,28 @@ void LGWebOSClient::CloseWebSocket(HINTERNET webSocketHandle)
 
 bool LGWebOSClient::EnsurePersistentConnection(const std::string& clientKey)
 {
-    if (!configuration)
+    TraceSpan span("LGTV", "EnsurePersistentConnection");
+
+    // A new address or transport closes the current socket first.
+    RefreshConfiguration();
+
+    if (!configurationStore)
     {
-        ErrorLog(L"[LGTV] EnsurePersistentConnection: configuration not set");
-        return false;
+        LGTV_LOG_ERROR(LGTV, L"EnsurePersistentConnection: configuration not set");
+        return RecordFailure(TvClientError::NotConfigured);
     }
 
     if (clientKey.empty())
     {
-        DebugLog(L"[LGTV] EnsurePersistentConnection: empty client key");
-        return false;
+        LGTV_LOG_DEBUG(LGTV, L"EnsurePersistentConnection: empty client key");
+        return RecordFailure(TvClientError::NotPaired);
     }
 
     if (!persistentWebSocket)
     {
-        if (!Connect(persistentWebSocket))
+        bool opened = Connect(persistentWebSocket);
+        RecordFlightEvent(FlightEventType::TvConnect, opened ? 1 : 0);
+        if (!opened)
         {
             return false;
         }
@@ -712,24 +870,24 @@ bool LGWebOSClient::EnsurePersistentConnection(const std::string& clientKey)
     {
         if (!SendRegister(persistentWebSocket, clientKey))
         {
-            DebugLog(L"[LGTV] EnsurePersistentConnection: SendRegister failed");
-            CloseWebSocket(persistentWebSocket);
-            persistentWebSocket = nullptr;
-            persistentRegistered = false;
-            return false;
+            RecordFlightEvent(FlightEventType::TvRegister, 0);
+            LGTV_LOG_DEBUG(LGTV, L"EnsurePersistentConnection: SendRegister failed");
+            ResetPersistentConnection();
+            return RecordFailure(TvClientError::RegisterFailed);
         }
 
         std::string acknowledge;
         if (!ReceiveOneTextMessage(persistentWebSocket, acknowledge))
         {
-            DebugLog(L"[LGTV] EnsurePersistentConnection: failed to receive register ack");
-            CloseWebSocket(persistentWebSocket);
-            persistentWebSocket = nullptr;
-            persistentRegistered = false;
-            return false;
+            RecordFlightEvent(FlightEventType::TvRegister, 0);
+            LGTV_LOG_DEBUG(LGTV, L"EnsurePersistentConnection: failed to receive register ack");
+            ResetPersistentConnection();
+            return RecordFailure(TvClientError::RegisterFailed);
         }
 
+        RecordFlightEvent(FlightEventType::TvRegister, 1);
         persistentRegistered = true;
+        commandStatus.SetConnected(true);
     }
 
     return true;
@@ -743,6 +901,7 @@ void LGWebOSClient::ResetPersistentConnection()
         persistentWebSocket = nullptr;
     }
     persistentRegistered = false;
+    commandStatus.SetConnected(false);
 }
 
 std::string LGWebOSClient::BuildRegisterMessage(const std::string& clientKey)
@@ -798,72 +957,97 @@ std::string LGWebOSClient::BuildRequestMessage(const char* uri, const char* payl
     return message;
 }
 
-std::string LGWebOSClient::GetClientKeyPath() const
+std::wstring LGWebOSClient::GetLegacyClientKeyPath() const
 {
-    std::wstring configPath = GetConfigurationFilePath();
-    std::wstring basePath = configPath;
-    size_t position = basePath.find_last_of(L".");
-    if (position != std::wstring::npos)
+    // Named profiles paired separately; characters that cannot appear in a
+    // file name were replaced.
+    std::wstring suffix = L"_client_key";
+    if (!profileName.empty())
     {
-        basePath = basePath.substr(0, position);
+        suffix += L"_";
+        for (wchar_t character : profileName)
+        {
+            suffix.push_back((iswalnum(character) || character == L'-') ? character : L'_');
+        }
     }
-    basePath += L"_client_key.txt";
-    return WideToUtf8(basePath);
+    suffix += L".txt";
+    return GetPathNextToConfiguration(suffix);
 }
 
-std::string LGWebOSClient::LoadClientKey() const
+void LGWebOSClient::MigrateLegacyClientKey()
 {
-    if (clientKeyLoaded)
+    std::wstring legacyPath = GetLegacyClientKeyPath();
+    std::ifstream input{ std::filesystem::path(legacyPath) };
+    if (!input)
     {
-        return cachedClientKey;
+        return;
     }
 
-    std::string path = GetClientKeyPath();
-    std::ifstream input(path);
-    if (!input)
+    std::string key;
+    std::getline(input, key);
+    input.close();
+
+    std::shared_ptr<const KeyIdentity> identity = AcquireKeyIdentity();
+    if (key.empty() || identity->value.empty())
     {
-        cachedClientKey.clear();
-        clientKeyLoaded = true;
-        return {};
+        return;
     }
 
-    std::getline(input, cachedClientKey);
-    clientKeyLoaded = true;
-    return cachedClientKey;
+    if (GetClientKeyStore().Contains(identity->value) || GetClientKeyStore().Store(identity->value, key))
+    {
+        LGTV_LOG_INFO(LGTV, L"Moved client key from %s into the key store", legacyPath.c_str());
+        DeleteFileW(legacyPath.c_str());
+    }
 }
 
-void LGWebOSClient::SaveClientKey(const std::string& key) const
+void LGWebOSClient::UpdateKeyIdentity()
 {
-    std::string path = GetClientKeyPath();
-    std::ofstream output(path, std::ios::trunc);
-    if (!output)
-    {
-        ErrorLog(L"[LGTV] Failed to write client key file");
-        return;
-    }
-    output << key;
+    KeyIdentity identity;
+    identity.configurationVersion = configurationVersion;
+    identity.value = ClientKeyStore::GetIdentity(profile.tvMacAddress, profile.tvIpAddress);
+    keyIdentity.Publish(std::make_shared<const KeyIdentity>(std::move(identity)));
+}
 
-    cachedClientKey = key;
-    clientKeyLoaded = true;
+std::shared_ptr<const LGWebOSClient::KeyIdentity> LGWebOSClient::AcquireKeyIdentity() const
+{
+    std::shared_ptr<const KeyIdentity> current = keyIdentity.Acquire();
+    if (!configurationStore || current->configurationVersion == configurationStore->GetVersion())
+    {
+        return current;
+    }
+
+    // The MAC or IP may have been edited without a command running
+    // RefreshConfiguration since, so derive the identity from the newest
+    // snapshot. Racing callers publish equal results, and an older one is
+    // replaced on the next call because its version no longer matches.
+    std::shared_ptr<const AppConfiguration> latest = configurationStore->Acquire();
+    TvProfile latestProfile;
+    FindTvProfile(*latest, profileName, latestProfile);
+
+    KeyIdentity identity;
+    identity.configurationVersion = latest->version;
+    identity.value = ClientKeyStore::GetIdentity(latestProfile.tvMacAddress, latestProfile.tvIpAddress);
+    std::shared_ptr<const KeyIdentity> updated = std::make_shared<const KeyIdentity>(std::move(identity));
+    keyIdentity.Publish(updated);
+    return updated;
 }
 
-bool LGWebOSClient::DeleteClientKey() const
+std::string LGWebOSClient::LoadClientKey() const
 {
-    std::string path = GetClientKeyPath();
-    if (path.empty())
-    {
-        return false;
-    }
+    return GetClientKeyStore().Find(AcquireKeyIdentity()->value);
+}
 
-    int result = std::remove(path.c_str());
-    if (result == 0)
+void LGWebOSClient::SaveClientKey(const std::string& key) const
+{
+    if (!GetClientKeyStore().Store(AcquireKeyIdentity()->value, key))
     {
-        cachedClientKey.clear();
-        clientKeyLoaded = true;
-        return true;
+        LGTV_LOG_ERROR(LGTV, L"Failed to store client key");
     }
+}
 
-    return false;
+bool LGWebOSClient::DeleteClientKey() const
+{
+    return GetClientKeyStore().Remove(AcquireKeyIdentity()->value);
 }
 
 std::string LGWebOSClient::ParseClientKey(const std::string& json) const
@@ -929,29 +1113,29 @@ bool LGWebOSClient::ParseMutedFlag(const std::string& json, bool& muted) const
 
 bool LGWebOSClient::VerifyMacAddressMatchesConfiguration(bool showUserError)
 {
-    if (!configuration)
+    if (!configurationStore)
     {
-        ErrorLog(L"[LGTV] MAC verification: configuration not set");
+        LGTV_LOG_ERROR(LGTV, L"MAC verification: configuration not set");
         return false;
     }
 
-    if (configuration->tvIpAddress.empty() || configuration->tvMacAddress.empty())
+    if (profile.tvIpAddress.empty() || profile.tvMacAddress.empty())
     {
-        ErrorLog(L"[LGTV] MAC verification: TV IP or MAC not configured");
+        LGTV_LOG_ERROR(LGTV, L"MAC verification: TV IP or MAC not configured");
         return false;
     }
 
     if (!lastVerifiedIpAddress.empty() &&
-        lastVerifiedIpAddress == configuration->tvIpAddress &&
-        lastVerifiedMacAddress == configuration->tvMacAddress)
+        lastVerifiedIpAddress == profile.tvIpAddress &&
+        lastVerifiedMacAddress == profile.tvMacAddress)
     {
         return lastMacVerificationResult;
     }
 
     std::wstring resolvedMac;
-    if (!ResolveMacForIp(configuration->tvIpAddress, resolvedMac))
+    if (!ResolveMacForIp(profile.tvIpAddress, resolvedMac))
     {
-        ErrorLog(L"[LGTV] MAC verification: failed to resolve MAC for IP %s", configuration->tvIpAddress.c_str());
+        LGTV_LOG_ERROR(LGTV, L"MAC verification: failed to resolve MAC for IP %s", profile.tvIpAddress.c_str());
         if (showUserError)
         {
             MessageBoxW(
@@ -966,20 +1150,20 @@ bool LGWebOSClient::VerifyMacAddressMatchesConfiguration(bool showUserError)
         return false;
     }
 
-    std::wstring expected = NormalizeMacString(configuration->tvMacAddress);
+    std::wstring expected = NormalizeMacString(profile.tvMacAddress);
     std::wstring actual = NormalizeMacString(resolvedMac);
 
     bool match = (expected == actual);
 
-    lastVerifiedIpAddress = configuration->tvIpAddress;
-    lastVerifiedMacAddress = configuration->tvMacAddress;
+    lastVerifiedIpAddress = profile.tvIpAddress;
+    lastVerifiedMacAddress = profile.tvMacAddress;
     lastMacVerificationResult = match;
 
     if (!match)
     {
-        ErrorLog(
-            L"[LGTV] MAC verification failed: configured=%s, actual=%s",
-            configuration->tvMacAddress.c_str(),
+        LGTV_LOG_ERROR(LGTV,
+            L"MAC verification failed: configured=%s, actual=%s",
+            profile.tvMacAddress.c_str(),
             resolvedMac.c_str());
 
         if (showUserError)
@@ -998,10 +1182,54 @@ bool LGWebOSClient::VerifyMacAddressMatchesConfiguration(bool showUserError)
 
 LGWebOSClient& GetTVClient()
 {
-    return g_globalTVClient;
+    return *g_activeTVClient.load(std::memory_order_acquire);
+}
+
+void InitializeTVClient(const ConfigurationStore* configurationStore)
+{
+    std::lock_guard<std::mutex> guard(g_tvClientsMutex);
+    GetClientKeyStore().Open(GetPathNextToConfiguration(L"_client_keys.txt"));
+    g_tvConfigurationStore = configurationStore;
+    g_globalTVClient.SetProfile(configurationStore, std::wstring());
+    g_activeTVClient.store(&g_globalTVClient, std::memory_order_release);
+}
+
+LGWebOSClient& GetTVClientForProfile(const std::wstring& profileName)
+{
+    std::lock_guard<std::mutex> guard(g_tvClientsMutex);
+    return FindOrCreateProfileClient(profileName);
+}
+
+bool SelectTvProfile(const std::wstring& profileName)
+{
+    std::lock_guard<std::mutex> guard(g_tvClientsMutex);
+    LGWebOSClient* client = &FindOrCreateProfileClient(profileName);
+    return g_activeTVClient.exchange(client, std::memory_order_acq_rel) != client;
+}
+
+std::wstring GetActiveTvProfileName()
+{
+    // Clients are never destroyed and their name is set before they are
+    // published, so no lock is needed.
+    return g_activeTVClient.load(std::memory_order_acquire)->GetProfileName();
 }
 
-void InitializeTVClient(const AppConfiguration* configuration)
+void CloseRemovedTvProfileConnections()
 {
-    g_globalTVClient.SetConfiguration(configuration);
+    // Client locks can be held for a connect timeout, so only the list is
+    // read under the mutex.
+    std::vector<LGWebOSClient*> clients;
+    {
+        std::lock_guard<std::mutex> guard(g_tvClientsMutex);
+        clients.reserve(g_profileTVClients.size());
+        for (const std::unique_ptr<LGWebOSClient>& client : g_profileTVClients)
+        {
+            clients.push_back(client.get());
+        }
+    }
+
+    for (LGWebOSClient* client : clients)
+    {
+        client->CloseIfProfileRemoved();
+    }
 }
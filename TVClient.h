@@ -3,17 +3,42 @@
 #include "framework.h"
 #include <winhttp.h>
 #include "Configuration.h"
+#include "ConfigurationStore.h"
+#include "PublishedHandle.h"
+#include "TvClientStatus.h"
+#include "TvProfile.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 
-// Client used to control an LG webOS TV over WebSockets.
+// Client used to control an LG webOS TV over WebSockets. Each TV profile has
+// its own client, so its connection and client key survive switching to
+// another profile.
+//
+// Commands and pairing hold the client's lock for their network I/O, which
+// can last a connect timeout or an open pairing prompt. Queries (HasClientKey,
+// GetStatus) and UnpairFromTv never take it: the connection owner publishes
+// its state through a TvClientStatusTracker, and the key store is
+// thread-safe.
 class LGWebOSClient
 {
 public:
     LGWebOSClient();
     ~LGWebOSClient();
 
-    // Sets the configuration that supplies TV IP, MAC and port information.
-    void SetConfiguration(const AppConfiguration* configuration);
+    // Sets the store and the name of the profile (see TvProfile) that
+    // supply TV IP, MAC and port information. Newer snapshots are picked up
+    // before the next command.
+    void SetProfile(const ConfigurationStore* store, const std::wstring& profileName);
+
+    // Returns the profile name; it does not change after SetProfile.
+    const std::wstring& GetProfileName() const;
+
+    // Opens and registers the persistent connection if the TV is paired, so
+    // the next command does not wait for it.
+    bool WarmUp();
 
     // Sends a volume up command to the TV.
     bool VolumeUp();
@@ -30,16 +55,36 @@ public:
     // Removes the stored client key so the next operation requires pairing again.
     bool UnpairFromTv();
 
-    // Returns true when a client key is present on disk.
+    // Returns true when the key store holds a client key for this TV.
     bool HasClientKey() const;
 
+    // Returns the connection state and the outcome of the last command.
+    TvClientStatus GetStatus() const;
+
     // Sets the TV volume to a specific level.
     bool SetVolume(int volumeLevel);
 
     // Sets the TV mute state explicitly.
     bool SetMute(bool mute);
 
+    // Returns the mute state this client last set on its TV, so each TV
+    // toggles from its own state. Lock-free.
+    bool IsMuted() const;
+
+    // Closes the persistent connection when the profile is no longer in the
+    // store's newest snapshot, e.g. after it was renamed or removed in the
+    // file. Waits for a running command. Returns true when it was removed.
+    bool CloseIfProfileRemoved();
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    // Records error as the last failure and returns false, so failure paths
+    // can end with "return RecordFailure(...)".
+    bool RecordFailure(TvClientError error);
+    // Records the duration of a successful command; returns succeeded.
+    bool CompleteCommand(bool succeeded, Clock::time_point started);
+
     bool SendSimpleCommand(const char* uri);
     bool SendCommandWithPayload(const char* uri, const char* payload);
     bool Connect(HINTERNET& webSocketHandle);
@@ -51,7 +96,25 @@ private:
     std::string BuildRegisterMessage(const std::string& clientKey);
     std::string BuildRequestMessage(const char* uri, const char* payloadOrNull);
 
-    std::string GetClientKeyPath() const;
+    // Key store identity (see ClientKeyStore) of the profile's TV, derived
+    // from one configuration version.
+    struct KeyIdentity
+    {
+        uint64_t configurationVersion = 0;
+        std::string value;
+    };
+
+    // Keys used to live in one file per profile; SetProfile moves such a
+    // file into the key store.
+    std::wstring GetLegacyClientKeyPath() const;
+    void MigrateLegacyClientKey();
+
+    // Publishes the identity of the current profile. Requires the lock.
+    void UpdateKeyIdentity();
+    // Returns the identity for the store's newest configuration, deriving it
+    // again when the configuration changed. Lock-free.
+    std::shared_ptr<const KeyIdentity> AcquireKeyIdentity() const;
+
     std::string LoadClientKey() const;
     void SaveClientKey(const std::string& key) const;
     bool DeleteClientKey() const;
@@ -64,7 +127,16 @@ private:
     bool EnsurePersistentConnection(const std::string& clientKey);
     void ResetPersistentConnection();
 
-    const AppConfiguration* configuration;
+    // Switches to the profile in the store's current snapshot if it is
+    // newer, dropping only the state that depends on the changed fields (see
+    // ConfigurationChange).
+    void RefreshConfiguration();
+    void ApplyConfigurationChanges(uint32_t changes);
+
+    const ConfigurationStore* configurationStore;
+    std::wstring profileName;
+    uint64_t configurationVersion;
+    TvProfile profile;
     std::wstring lastVerifiedIpAddress;
     std::wstring lastVerifiedMacAddress;
     bool lastMacVerificationResult;
@@ -72,12 +144,36 @@ private:
     CRITICAL_SECTION lock;
     HINTERNET persistentWebSocket;
     bool persistentRegistered;
-    mutable std::string cachedClientKey;
-    mutable bool clientKeyLoaded;
+    // Published so HasClientKey can read it without the lock; replaced by
+    // AcquireKeyIdentity once it is out of date.
+    mutable PublishedHandle<const KeyIdentity> keyIdentity;
+
+    // Written under the lock, read by GetStatus without it.
+    TvClientStatusTracker commandStatus;
+    std::atomic<bool> muted;
 };
 
-// Returns the global LG webOS client instance.
+// Returns the client of the active TV profile.
 LGWebOSClient& GetTVClient();
 
-// Initializes the global client with the current configuration.
-void InitializeTVClient(const AppConfiguration* configuration);
+// Initializes the default profile's client with the app's configuration store
+// and makes it active.
+void InitializeTVClient(const ConfigurationStore* configurationStore);
+
+// Returns the named profile's client, creating it on first use, whether or
+// not it is active; e.g. for pairing the profile shown in the settings.
+LGWebOSClient& GetTVClientForProfile(const std::wstring& profileName);
+
+// Makes the named profile's client active, creating it on first use. Clients
+// of inactive profiles keep their connections. Returns true when the active
+// profile changed.
+bool SelectTvProfile(const std::wstring& profileName);
+
+// Returns the name of the active profile. Lock-free.
+std::wstring GetActiveTvProfileName();
+
+// Closes the connections of clients whose profile is no longer in the
+// configuration. Clients are never destroyed, so references stay valid; a
+// profile that comes back reconnects on its next command. Waits for running
+// commands, so call it from the TV worker.
+void CloseRemovedTvProfileConnections();
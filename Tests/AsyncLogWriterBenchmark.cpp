@@ -0,0 +1,52 @@
+#include "BenchmarkHarness.h"
+
+#include "AsyncLogWriter.h"
+
+#include <thread>
+
+// Measures what a log call pays to queue an entry while the writer thread
+// drains, and the cost of the drop path when the ring is full.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 10000 : 2000000;
+
+    const char message[] = "endpoint volume 0.42 hr=0x00000000 step 12345";
+
+    {
+        AsyncLogWriter writer(1 << 16);
+        uint64_t written = 0;
+        writer.Start([&written](const LogRecord& record) { written += record.length; }, {});
+
+        // Producers are paced like a busy app rather than a tight loop, so
+        // the ring does not stay full.
+        BenchmarkHarness::Measure("Post, writer draining", iterations, [&](uint64_t i)
+        {
+            writer.Post(1, 0, i, message, sizeof(message));
+            if ((i & 31) == 31)
+            {
+                std::this_thread::yield();
+            }
+        });
+        writer.Stop();
+        BenchmarkHarness::DoNotOptimize(written);
+        std::printf("dropped %llu of %llu\n",
+            static_cast<unsigned long long>(writer.GetDroppedCount()),
+            static_cast<unsigned long long>(iterations));
+    }
+
+    {
+        AsyncLogWriter writer(16);
+        for (int i = 0; i < 16; ++i)
+        {
+            writer.Post(1, 0, 0, message, sizeof(message));
+        }
+
+        BenchmarkHarness::Measure("Post, ring full", iterations, [&](uint64_t i)
+        {
+            writer.Post(1, 0, i, message, sizeof(message));
+        });
+    }
+
+    return 0;
+}
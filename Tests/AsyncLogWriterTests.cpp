@@ -0,0 +1,265 @@
+#include "TestHarness.h"
+
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    // Keeps what the writer thread hands over. Each entry carries a
+    // producer-assigned sequence number as its data.
+    struct RecordingSink
+    {
+        struct Entry
+        {
+            uint32_t site;
+            uint32_t threadId;
+            uint64_t timestamp;
+            uint32_t length;
+            uint64_t sequence;
+        };
+
+        bool Start(AsyncLogWriter& writer)
+        {
+            return writer.Start(
+                [this](const LogRecord& record)
+                {
+                    std::this_thread::sleep_for(recordDelay);
+                    Entry entry{ record.site, record.threadId, record.timestamp, record.length, 0 };
+                    std::memcpy(&entry.sequence, record.data, (std::min)(sizeof(entry.sequence), size_t(record.length)));
+
+                    std::lock_guard<std::mutex> guard(mutex);
+                    entries.push_back(entry);
+                },
+                [this](uint64_t droppedSinceLastBatch)
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    ++batches;
+                    reportedDropped += droppedSinceLastBatch;
+                });
+        }
+
+        size_t GetCount()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return entries.size();
+        }
+
+        std::chrono::microseconds recordDelay{ 0 };
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        uint64_t batches = 0;
+        uint64_t reportedDropped = 0;
+    };
+
+    uint64_t PostSequence(AsyncLogWriter& writer, uint32_t site, uint32_t threadId, uint64_t sequence)
+    {
+        return writer.Post(site, threadId, sequence * 10, &sequence, sizeof(sequence));
+    }
+}
+
+TEST_CASE(DeliversEveryProducersEntriesInOrder)
+{
+    AsyncLogWriter writer(4096);
+    RecordingSink sink;
+    REQUIRE(sink.Start(writer));
+
+    constexpr uint32_t Producers = 4;
+    constexpr uint64_t EntriesPerProducer = 20000;
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < Producers; ++producer)
+    {
+        producers.emplace_back([&writer, producer]()
+            {
+                for (uint64_t sequence = 0; sequence < EntriesPerProducer; ++sequence)
+                {
+                    PostSequence(writer, 1, producer, sequence);
+                }
+            });
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    writer.Stop();
+
+    // Entries may be dropped when the ring fills, but none may be lost
+    // otherwise or arrive out of order, and every drop is reported.
+    std::vector<int64_t> lastSequence(Producers, -1);
+    for (const RecordingSink::Entry& entry : sink.entries)
+    {
+        REQUIRE(entry.threadId < Producers);
+        CHECK(static_cast<int64_t>(entry.sequence) > lastSequence[entry.threadId]);
+        CHECK(entry.timestamp == entry.sequence * 10);
+        CHECK(entry.length == sizeof(uint64_t));
+        lastSequence[entry.threadId] = static_cast<int64_t>(entry.sequence);
+    }
+
+    CHECK(writer.GetPostedCount() + writer.GetDroppedCount() == Producers * EntriesPerProducer);
+    CHECK(sink.entries.size() == writer.GetPostedCount());
+    CHECK(writer.GetWrittenCount() == writer.GetPostedCount());
+    CHECK(sink.reportedDropped == writer.GetDroppedCount());
+}
+
+TEST_CASE(FullRingDropsNewestEntriesAndReportsThem)
+{
+    AsyncLogWriter writer(8);
+
+    // Nothing drains the ring until the writer starts.
+    std::vector<uint64_t> tickets;
+    for (uint64_t sequence = 0; sequence < 12; ++sequence)
+    {
+        tickets.push_back(PostSequence(writer, 1, 0, sequence));
+    }
+    for (size_t index = 0; index < tickets.size(); ++index)
+    {
+        CHECK((tickets[index] != 0) == (index < 8));
+    }
+    CHECK(writer.GetDroppedCount() == 4);
+
+    RecordingSink sink;
+    REQUIRE(sink.Start(writer));
+    REQUIRE(writer.Flush(tickets[7], 10s));
+
+    {
+        std::lock_guard<std::mutex> guard(sink.mutex);
+        REQUIRE(sink.entries.size() == 8);
+        for (uint64_t sequence = 0; sequence < 8; ++sequence)
+        {
+            CHECK(sink.entries[sequence].sequence == sequence);
+        }
+        CHECK(sink.reportedDropped == 4);
+    }
+
+    // The ring accepts entries again once drained.
+    CHECK(PostSequence(writer, 1, 0, 12) != 0);
+    writer.Stop();
+    CHECK(sink.entries.size() == 9);
+}
+
+TEST_CASE(FlushWaitsForEntryAndEverythingBeforeIt)
+{
+    AsyncLogWriter writer(256);
+    RecordingSink sink;
+    sink.recordDelay = 500us;
+    REQUIRE(sink.Start(writer));
+
+    uint64_t ticket = 0;
+    for (uint64_t sequence = 0; sequence < 50; ++sequence)
+    {
+        ticket = PostSequence(writer, 1, 0, sequence);
+    }
+    REQUIRE(ticket != 0);
+    CHECK(writer.Flush(ticket, 10s));
+    CHECK(sink.GetCount() == 50);
+
+    CHECK(!writer.Flush(0, 10ms));
+    writer.Stop();
+    CHECK(!writer.Flush(ticket + 1, 10ms));
+}
+
+TEST_CASE(RequestDrainNeverWaitsForWriter)
+{
+    AsyncLogWriter writer(64);
+    std::atomic<bool> writing(false);
+    std::atomic<bool> release(false);
+    std::atomic<uint64_t> written(0);
+    REQUIRE(writer.Start(
+        [&](const LogRecord&)
+        {
+            writing.store(true);
+            while (!release.load())
+            {
+                std::this_thread::yield();
+            }
+            written.fetch_add(1);
+        },
+        nullptr));
+
+    uint64_t first = 1;
+    REQUIRE(writer.Post(1, 0, 0, &first, sizeof(first)) != 0);
+    CHECK(TestHarness::WaitUntil([&]() { return writing.load(); }));
+
+    // The writer is stuck in the sink, yet the request returns at once.
+    uint64_t second = 2;
+    REQUIRE(writer.Post(1, 0, 0, &second, sizeof(second)) != 0);
+    writer.RequestDrain();
+    CHECK(written.load() == 0);
+
+    release.store(true);
+    CHECK(TestHarness::WaitUntil([&]() { return written.load() == 2; }));
+    writer.Stop();
+}
+
+TEST_CASE(StopWritesOutQueuedEntries)
+{
+    AsyncLogWriter writer(1024);
+    RecordingSink sink;
+    REQUIRE(sink.Start(writer));
+    CHECK(writer.IsRunning());
+
+    for (uint64_t sequence = 0; sequence < 1000; ++sequence)
+    {
+        PostSequence(writer, 1, 0, sequence);
+    }
+    writer.Stop();
+
+    CHECK(!writer.IsRunning());
+    CHECK(sink.entries.size() == 1000);
+
+    // A stopped writer can be started again.
+    REQUIRE(sink.Start(writer));
+    PostSequence(writer, 1, 0, 1000);
+    writer.Stop();
+    CHECK(sink.entries.size() == 1001);
+}
+
+TEST_CASE(BurstIsWrittenInOneBatch)
+{
+    AsyncLogWriter writer(1024);
+    RecordingSink sink;
+    REQUIRE(sink.Start(writer));
+
+    uint64_t ticket = 0;
+    for (uint64_t sequence = 0; sequence < 100; ++sequence)
+    {
+        ticket = PostSequence(writer, 1, 0, sequence);
+    }
+    REQUIRE(writer.Flush(ticket, 10s));
+
+    // The first entry wakes the writer, which lets the rest of the burst
+    // gather before it drains; a slow host may split it once or twice.
+    CHECK(writer.GetBatchCount() <= 3);
+    CHECK(writer.GetWrittenCount() == 100);
+    writer.Stop();
+}
+
+TEST_CASE(LongDataIsTruncated)
+{
+    AsyncLogWriter writer(16);
+    RecordingSink sink;
+    REQUIRE(sink.Start(writer));
+
+    std::vector<uint8_t> data(LogRecord::MaxDataLength + 100, 0xAB);
+    writer.Post(2, 0, 0, data.data(), data.size());
+    writer.PostEncoded(3, 0, 0, [](uint8_t* buffer, size_t capacity)
+        {
+            std::memset(buffer, 0xCD, capacity);
+            return capacity * 2;
+        });
+    writer.Stop();
+
+    REQUIRE(sink.entries.size() == 2);
+    CHECK(sink.entries[0].site == 2);
+    CHECK(sink.entries[0].length == LogRecord::MaxDataLength);
+    CHECK(sink.entries[1].site == 3);
+    CHECK(sink.entries[1].length == LogRecord::MaxDataLength);
+}
@@ -0,0 +1,306 @@
+#include "TestHarness.h"
+
+#include "AudioRouter.h"
+#include "SimulatedEndpointBackend.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::chrono::milliseconds TestDebounceWindow{ 2 };
+    constexpr std::chrono::milliseconds TestMaxDelay{ 20 };
+
+    SimulatedEndpointEvent MakeEvent(
+        SimulatedEndpointEventKind kind,
+        const std::wstring& endpointId,
+        const std::wstring& friendlyName = std::wstring(),
+        bool flag = false)
+    {
+        SimulatedEndpointEvent event;
+        event.kind = kind;
+        event.endpointId = endpointId;
+        event.friendlyName = friendlyName;
+        event.flag = flag;
+        return event;
+    }
+
+    bool MatchesTv(const std::wstring&, const std::wstring& friendlyName)
+    {
+        return friendlyName.find(L"LG TV") != std::wstring::npos;
+    }
+
+    // A router on a simulated backend with one TV (Atmos) and one speaker
+    // endpoint. The backend outlives the router.
+    struct RouterFixture
+    {
+        SimulatedEndpointBackend backend;
+        AudioRouter router{ backend };
+        std::atomic<bool> paired{ true };
+        std::atomic<uint64_t> statusChanges{ 0 };
+
+        RouterFixture()
+        {
+            backend.Replay({
+                MakeEvent(SimulatedEndpointEventKind::AddEndpoint, L"tv", L"LG TV (NVIDIA High Definition Audio)", true),
+                MakeEvent(SimulatedEndpointEventKind::AddEndpoint, L"speakers", L"Speakers (Realtek Audio)", false),
+            });
+        }
+
+        bool Start(const std::wstring& defaultEndpointId)
+        {
+            backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, defaultEndpointId));
+            router.SetHintMatcher(MatchesTv);
+            return router.Start(
+                [this]() { return paired.load(); },
+                [this]() { ++statusChanges; },
+                TestDebounceWindow,
+                TestMaxDelay);
+        }
+
+        bool WaitForRouting(const std::wstring& defaultEndpointId, bool useTvVolume)
+        {
+            return TestHarness::WaitUntil([&]()
+            {
+                AudioRoutingStatus status = router.GetStatus();
+                return status.defaultDeviceId == defaultEndpointId
+                    && status.useTvVolume == useTvVolume
+                    && router.IsTvVolumeActive() == useTvVolume;
+            });
+        }
+    };
+}
+
+TEST_CASE(RoutesToTvWhileMatchingEndpointIsDefault)
+{
+    RouterFixture fixture;
+    fixture.backend.SetEndpointVolume(L"speakers", 0.25f);
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    AudioRoutingStatus status = fixture.router.GetStatus();
+    CHECK(status.defaultDeviceMatches);
+    CHECK(status.dolbyAtmosAvailable);
+    CHECK(status.defaultDeviceName == L"LG TV (NVIDIA High Definition Audio)");
+    CHECK(fixture.backend.GetEndpointVolume(L"tv") == 1.0f);
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, L"speakers"));
+    REQUIRE(fixture.WaitForRouting(L"speakers", false));
+
+    // The level saved before pinning is put back once routing leaves the TV.
+    CHECK(TestHarness::WaitUntil([&]() { return fixture.backend.GetEndpointVolume(L"speakers") == 0.5f; }));
+    CHECK(!fixture.router.GetStatus().defaultDeviceMatches);
+
+    // The pinned level is never written to the speakers, not even briefly
+    // before routing leaves the TV.
+    for (const SimulatedVolumeWrite& write : fixture.backend.GetVolumeWrites())
+    {
+        CHECK(write.endpointId != L"speakers" || write.level != 1.0f);
+    }
+}
+
+TEST_CASE(StaysOffTvWithoutDolbyAtmosWhenRequired)
+{
+    RouterFixture fixture;
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDolbyAtmos, L"tv", std::wstring(), false));
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(TestHarness::WaitUntil([&]() { return fixture.router.GetStatus().defaultDeviceMatches; }));
+    CHECK(!fixture.router.IsTvVolumeActive());
+    CHECK(fixture.backend.GetEndpointVolume(L"tv") == 0.5f);
+
+    fixture.router.SetOnlyWhenDolbyAtmos(false);
+    CHECK(fixture.WaitForRouting(L"tv", true));
+
+    fixture.router.SetOnlyWhenDolbyAtmos(true);
+    CHECK(fixture.WaitForRouting(L"tv", false));
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDolbyAtmos, L"tv", std::wstring(), true));
+    CHECK(fixture.WaitForRouting(L"tv", true));
+}
+
+TEST_CASE(StaysOffTvUntilPaired)
+{
+    RouterFixture fixture;
+    fixture.paired = false;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(TestHarness::WaitUntil([&]() { return fixture.router.GetStatus().defaultDeviceMatches; }));
+    CHECK(!fixture.router.IsTvVolumeActive());
+
+    fixture.paired = true;
+    fixture.router.RequestRoutingUpdate();
+    CHECK(fixture.WaitForRouting(L"tv", true));
+}
+
+TEST_CASE(RenameReevaluatesHint)
+{
+    RouterFixture fixture;
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::Rename, L"tv", L"Living Room"));
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(TestHarness::WaitUntil([&]() { return fixture.router.GetStatus().defaultDeviceName == L"Living Room"; }));
+    CHECK(!fixture.router.IsTvVolumeActive());
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::Rename, L"tv", L"LG TV"));
+    CHECK(fixture.WaitForRouting(L"tv", true));
+    CHECK(fixture.router.GetStatus().defaultDeviceName == L"LG TV");
+}
+
+TEST_CASE(RemovingDefaultEndpointLeavesTv)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::RemoveEndpoint, L"tv"));
+    CHECK(fixture.WaitForRouting(std::wstring(), false));
+
+    fixture.backend.Replay({
+        MakeEvent(SimulatedEndpointEventKind::AddEndpoint, L"tv", L"LG TV", true),
+        MakeEvent(SimulatedEndpointEventKind::SetDefault, L"tv"),
+    });
+    CHECK(fixture.WaitForRouting(L"tv", true));
+}
+
+TEST_CASE(DisablingDefaultEndpointLeavesTv)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetActive, L"tv", std::wstring(), false));
+    CHECK(fixture.WaitForRouting(std::wstring(), false));
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetActive, L"tv", std::wstring(), true));
+    CHECK(fixture.WaitForRouting(L"tv", true));
+}
+
+TEST_CASE(EventStormFromSeveralThreadsSettlesOnLastDefault)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"speakers"));
+    REQUIRE(fixture.WaitForRouting(L"speakers", false));
+
+    constexpr int ThreadCount = 4;
+    constexpr int EventsPerThread = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCount; ++t)
+    {
+        threads.emplace_back([&fixture, t]()
+        {
+            for (int i = 0; i < EventsPerThread; ++i)
+            {
+                const wchar_t* endpointId = ((i + t) % 2 == 0) ? L"tv" : L"speakers";
+                fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, endpointId));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, L"tv"));
+
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+    std::this_thread::sleep_for(TestMaxDelay * 5);
+    CHECK(fixture.WaitForRouting(L"tv", true));
+    CHECK(fixture.backend.GetEndpointVolume(L"tv") == 1.0f);
+
+    // Thousands of notifications collapse into a handful of refreshes, and
+    // switching between two known endpoints never probes them again.
+    const CoalescingWorkQueue& queue = fixture.router.GetRefreshQueue();
+    CHECK(queue.GetPostedCount() > 1000);
+    CHECK(queue.GetProcessedCount() * 10 < queue.GetPostedCount());
+    CHECK(fixture.backend.GetNameProbeCount() == 2);
+    CHECK(fixture.backend.GetAtmosProbeCount() == 1);
+}
+
+TEST_CASE(RepinsWhenAnotherApplicationMovesVolume)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    for (float level : { 0.2f, 0.0f, 0.75f })
+    {
+        fixture.backend.SetEndpointVolume(L"tv", level);
+        CHECK(TestHarness::WaitUntil([&]() { return fixture.backend.GetEndpointVolume(L"tv") == 1.0f; }));
+    }
+
+    uint64_t repins = 0;
+    uint64_t suppressed = 0;
+    fixture.router.GetVolumePinCounts(repins, suppressed);
+    CHECK(repins == 3);
+    CHECK(suppressed == 0);
+
+    // Nothing is held once routing leaves the TV.
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, L"speakers"));
+    REQUIRE(fixture.WaitForRouting(L"speakers", false));
+    fixture.backend.SetEndpointVolume(L"speakers", 0.2f);
+    std::this_thread::sleep_for(TestMaxDelay * 2);
+    CHECK(fixture.backend.GetEndpointVolume(L"speakers") == 0.2f);
+}
+
+TEST_CASE(FightingApplicationIsRateLimited)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 500; ++i)
+    {
+        fixture.backend.SetEndpointVolume(L"tv", 0.3f);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t repins = 0;
+    uint64_t suppressed = 0;
+    fixture.router.GetVolumePinCounts(repins, suppressed);
+
+    VolumePinPolicy::Settings settings;
+    uint64_t windows = 1 + static_cast<uint64_t>(elapsed / settings.window);
+    CHECK(suppressed > 0);
+    CHECK(repins <= windows * settings.maxRepinsPerWindow);
+}
+
+TEST_CASE(RepinCoalescedWithRefreshStillRuns)
+{
+    // With a debounce window that never expires, a refresh posted by a
+    // property change stays pending until the repin absorbs it.
+    RouterFixture fixture;
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, L"tv"));
+    fixture.router.SetHintMatcher(MatchesTv);
+    REQUIRE(fixture.router.Start(nullptr, nullptr, std::chrono::hours(1), std::chrono::hours(1)));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    // The handler count is bumped only after the start-up refresh returns.
+    const CoalescingWorkQueue& queue = fixture.router.GetRefreshQueue();
+    REQUIRE(TestHarness::WaitUntil([&]() { return queue.GetProcessedCount() == 1; }));
+
+    fixture.backend.Apply(MakeEvent(SimulatedEndpointEventKind::Rename, L"tv", L"LG TV (HDMI 2)"));
+    fixture.backend.SetEndpointVolume(L"tv", 0.2f);
+
+    CHECK(TestHarness::WaitUntil([&]() { return fixture.backend.GetEndpointVolume(L"tv") == 1.0f; }));
+    CHECK(TestHarness::WaitUntil([&]() { return fixture.router.GetStatus().defaultDeviceName == L"LG TV (HDMI 2)"; }));
+    CHECK(TestHarness::WaitUntil([&]() { return queue.GetProcessedCount() == 2; }));
+    CHECK(queue.GetCoalescedCount() == 1);
+}
+
+TEST_CASE(StopReleasesVolumeEndpoint)
+{
+    RouterFixture fixture;
+    REQUIRE(fixture.Start(L"tv"));
+    REQUIRE(fixture.WaitForRouting(L"tv", true));
+
+    fixture.router.Stop();
+    uint64_t writes = fixture.backend.GetVolumeWriteCount();
+
+    // Nothing is selected any more, so another application's change is not
+    // reported and not corrected.
+    fixture.backend.SetEndpointVolume(L"tv", 0.3f);
+    std::this_thread::sleep_for(TestMaxDelay * 2);
+    CHECK(fixture.backend.GetEndpointVolume(L"tv") == 0.3f);
+    CHECK(fixture.backend.GetVolumeWriteCount() == writes);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Shared helpers for the portable benchmarks.
+//
+// Benchmarks run their full iteration count when started by hand. ctest runs
+// them with --quick so the gate only checks that they still work.
+namespace BenchmarkHarness
+{
+    inline bool IsQuickRun(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--quick") == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs body(iteration) the given number of times and prints the mean cost.
+    template <typename Body>
+    double Measure(const char* name, uint64_t iterations, Body&& body)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            body(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+        double perIteration = (iterations != 0) ? nanoseconds / static_cast<double>(iterations) : 0.0;
+        std::printf("%-40s %12llu iterations %12.1f ns/op\n",
+            name,
+            static_cast<unsigned long long>(iterations),
+            perIteration);
+        return perIteration;
+    }
+
+    // Keeps the compiler from discarding a computed value.
+    template <typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+        const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+        (void)*sink;
+    }
+}
@@ -0,0 +1,74 @@
+#include "BenchmarkHarness.h"
+
+#include "AsyncLogWriter.h"
+#include "BinaryLogFormat.h"
+#include "LogSiteRegistry.h"
+
+#include <cstdarg>
+#include <cwchar>
+#include <string>
+
+namespace
+{
+    LogSiteRegistry g_registry;
+    uint8_t g_data[LogRecord::MaxDataLength];
+    wchar_t g_text[1024];
+
+    // What a log call does on the caller's thread with the binary log.
+    size_t Encode(const wchar_t* format, ...)
+    {
+        const LogSite* site = g_registry.Register(LogLevelInfo, format);
+        va_list arguments;
+        va_start(arguments, format);
+        size_t length = EncodeLogArguments(site->argumentTypes, site->argumentCount, arguments, g_data, sizeof(g_data));
+        va_end(arguments);
+        return length;
+    }
+
+    // What it used to do: format the text.
+    int Format(const wchar_t* format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        int written = vswprintf(g_text, 1024, format, arguments);
+        va_end(arguments);
+        return written;
+    }
+}
+
+// Compares recording a typical log line in binary form with formatting it,
+// and measures decoding it back to text.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 10000 : 5000000;
+
+    std::wstring name = L"Wohnzimmer TV";
+    const wchar_t* format = L"[Audio] endpoint %ls volume %.2f hr=0x%08X step %d";
+
+    size_t encoded = 0;
+    BenchmarkHarness::Measure("Site lookup and encode", iterations, [&](uint64_t i)
+    {
+        encoded += Encode(format, name.c_str(), 0.42, 0u, static_cast<int>(i));
+    });
+    BenchmarkHarness::DoNotOptimize(encoded);
+
+    int formatted = 0;
+    BenchmarkHarness::Measure("vswprintf", iterations, [&](uint64_t i)
+    {
+        formatted += Format(format, name.c_str(), 0.42, 0u, static_cast<int>(i));
+    });
+    BenchmarkHarness::DoNotOptimize(formatted);
+
+    const LogSite* site = g_registry.Register(LogLevelInfo, format);
+    size_t length = Encode(format, name.c_str(), 0.42, 0u, 12345);
+    std::u16string wideFormat(format, format + std::char_traits<wchar_t>::length(format));
+    size_t decoded = 0;
+    BenchmarkHarness::Measure("FormatLogMessage", iterations / 4, [&](uint64_t)
+    {
+        decoded += FormatLogMessage(wideFormat, site->argumentTypes, site->argumentCount, g_data, length).size();
+    });
+    BenchmarkHarness::DoNotOptimize(decoded);
+
+    return 0;
+}
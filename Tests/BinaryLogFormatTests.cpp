@@ -0,0 +1,276 @@
+#include "TestHarness.h"
+
+#include "AsyncLogWriter.h"
+#include "BinaryLogFormat.h"
+#include "LogSiteRegistry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cwchar>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Collects a binary log in memory the way the writer thread does: each
+    // site is defined before its first entry.
+    class LogBuilder
+    {
+    public:
+        LogBuilder()
+        {
+            AppendBinaryLogHeader(file);
+            AppendBinaryLogSession(file, 1000, 42);
+        }
+
+        // Records one call and returns what swprintf makes of it.
+        std::string Log(uint32_t level, const wchar_t* format, ...)
+        {
+            const LogSite* site = registry.Register(level, format);
+            CHECK(site != nullptr && site->recordable);
+            if (site == nullptr)
+            {
+                return {};
+            }
+
+            if (defined.size() <= site->id)
+            {
+                defined.resize(site->id + 1, false);
+            }
+            if (!defined[site->id])
+            {
+                AppendBinaryLogSite(file, site->id, site->level, site->argumentTypes, site->argumentCount, site->format);
+                defined[site->id] = true;
+            }
+
+            uint8_t data[LogRecord::MaxDataLength];
+            va_list arguments;
+            va_start(arguments, format);
+            size_t length = EncodeLogArguments(site->argumentTypes, site->argumentCount, arguments, data, sizeof(data));
+            va_end(arguments);
+            AppendBinaryLogEntry(file, site->id, 2000 + entries++, 7, data, length);
+
+            wchar_t buffer[1024];
+            va_start(arguments, format);
+            vswprintf(buffer, 1024, format, arguments);
+            va_end(arguments);
+
+            std::u16string text;
+            for (const wchar_t* character = buffer; *character != L'\0'; ++character)
+            {
+                text.push_back(static_cast<char16_t>(*character));
+            }
+            return ConvertUtf16ToUtf8(text.data(), text.size());
+        }
+
+        LogSiteRegistry registry;
+        std::vector<bool> defined;
+        std::string file;
+        uint64_t entries = 0;
+    };
+
+    // Decodes the file in chunks of the given size, as the decoder sees a
+    // file that is still being written.
+    std::vector<BinaryLogDecoder::Line> Decode(const std::string& file, size_t chunkSize, BinaryLogDecoder& decoder)
+    {
+        std::vector<BinaryLogDecoder::Line> lines;
+        std::string pending;
+        size_t position = 0;
+        while (position < file.size())
+        {
+            size_t length = (std::min)(chunkSize, file.size() - position);
+            pending.append(file, position, length);
+            position += length;
+
+            bool valid = false;
+            size_t consumed = decoder.Decode(reinterpret_cast<const uint8_t*>(pending.data()), pending.size(),
+                [&lines](const BinaryLogDecoder::Line& line) { lines.push_back(line); }, valid);
+            CHECK(valid);
+            pending.erase(0, consumed);
+        }
+        CHECK(pending.empty());
+        return lines;
+    }
+}
+
+TEST_CASE(DecodedMessagesMatchSwprintf)
+{
+    LogBuilder builder;
+    std::wstring name = L"Wohnzimmer TV \x00E9";
+    std::vector<std::string> expected;
+
+    expected.push_back(builder.Log(LogLevelInfo, L"[Audio] plain"));
+    expected.push_back(builder.Log(LogLevelInfo, L"[Audio] hr=0x%08X count=%d big=%llu neg=%lld size=%zu long=%lu",
+        0x8889000Au, -5, 18446744073709551615ull, -42ll, static_cast<size_t>(77), 4000000000ul));
+    expected.push_back(builder.Log(LogLevelWarning, L"[LGTV] name=%ls host=%hs pct=%.2f%% c=%lc w=%*d p=%.*f x=%02X hu=%hu",
+        name.c_str(), "192.168.1.5", 42.1234, L'Z', 6, 12, 3, 3.14159, 0xA, static_cast<unsigned short>(65535)));
+    expected.push_back(builder.Log(LogLevelInfo, L"[Route] left %-8ls| %5.3ls|", L"ab", L"abcdef"));
+    expected.push_back(builder.Log(LogLevelError, L"[Err] code %d", 9));
+
+    for (size_t chunkSize : { size_t(1), size_t(7), size_t(37), builder.file.size() })
+    {
+        BinaryLogDecoder decoder;
+        std::vector<BinaryLogDecoder::Line> lines = Decode(builder.file, chunkSize, decoder);
+
+        // The session block decodes to a line of its own.
+        REQUIRE(lines.size() == expected.size() + 1);
+        CHECK(lines[0].message == "[Logging] Session started (process 42)");
+        for (size_t index = 0; index < expected.size(); ++index)
+        {
+            CHECK(lines[index + 1].message == expected[index]);
+            CHECK(lines[index + 1].timestamp == 2000 + index);
+            CHECK(lines[index + 1].threadId == 7);
+        }
+        CHECK(lines[3].level == LogLevelWarning);
+        CHECK(lines[5].level == LogLevelError);
+        CHECK(decoder.GetEntryCount() == expected.size());
+        CHECK(decoder.GetSessionCount() == 1);
+    }
+}
+
+TEST_CASE(ReportsDroppedAndUnknownSites)
+{
+    LogBuilder builder;
+    builder.Log(LogLevelInfo, L"[Audio] volume %d", 5);
+    AppendBinaryLogDropped(builder.file, 3000, 17);
+
+    // Site IDs only hold within a session.
+    AppendBinaryLogSession(builder.file, 4000, 43);
+    uint8_t data[4] = {};
+    AppendBinaryLogEntry(builder.file, 0, 5000, 7, data, sizeof(data));
+
+    BinaryLogDecoder decoder;
+    std::vector<BinaryLogDecoder::Line> lines = Decode(builder.file, builder.file.size(), decoder);
+    REQUIRE(lines.size() == 5);
+    CHECK(lines[1].message == "[Audio] volume 5");
+    CHECK(lines[2].message == "[Logging] Log queue full; dropped 17 line(s)");
+    CHECK(lines[4].message == "[Logging] Entry for unknown site 0");
+    CHECK(decoder.GetDroppedCount() == 17);
+    CHECK(decoder.GetSessionCount() == 2);
+    CHECK(decoder.GetUnknownSiteCount() == 1);
+}
+
+TEST_CASE(RejectsForeignAndCorruptData)
+{
+    const uint8_t notALog[BinaryLogHeaderSize] = { 'L', 'G', 'T', 'V', 'T', 'E', 'X', 'T' };
+    BinaryLogDecoder decoder;
+    bool valid = true;
+    CHECK(decoder.Decode(notALog, sizeof(notALog), [](const BinaryLogDecoder::Line&) {}, valid) == 0);
+    CHECK(!valid);
+
+    std::string file;
+    AppendBinaryLogHeader(file);
+    AppendBinaryLogSession(file, 1, 1);
+    size_t goodSize = file.size();
+    file.push_back(static_cast<char>(0x7F));
+
+    BinaryLogDecoder other;
+    CHECK(other.Decode(reinterpret_cast<const uint8_t*>(file.data()), file.size(),
+        [](const BinaryLogDecoder::Line&) {}, valid) == goodSize);
+    CHECK(!valid);
+}
+
+TEST_CASE(ParsesWhatItCanRecord)
+{
+    std::vector<LogConversion> conversions;
+    CHECK(ParseLogFormat(L"%d %ls %.*f %%", conversions));
+    CHECK(conversions.size() == 4);
+
+    LogArgumentType types[MaxLogArguments];
+    CHECK(GetLogArgumentTypes(conversions, types) == 4);
+    CHECK(types[0] == LogArgumentType::Int32);
+    CHECK(types[1] == LogArgumentType::WideString);
+    CHECK(types[2] == LogArgumentType::Int32);
+    CHECK(types[3] == LogArgumentType::Double);
+
+    CHECK(!ParseLogFormat(L"count %n", conversions));
+    CHECK(!ParseLogFormat(L"%Lf", conversions));
+    CHECK(!ParseLogFormat(L"%q", conversions));
+    CHECK(!ParseLogFormat(L"%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", conversions));
+
+    LogSiteRegistry registry;
+    const LogSite* site = registry.Register(LogLevelInfo, L"count %n");
+    REQUIRE(site != nullptr);
+    CHECK(!site->recordable);
+}
+
+TEST_CASE(LongStringsAreTruncatedToFit)
+{
+    std::wstring longText(5000, L'x');
+    LogArgumentType types[] = { LogArgumentType::WideString, LogArgumentType::Int32 };
+
+    uint8_t buffer[LogRecord::MaxDataLength];
+    auto encode = [&](const wchar_t* format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        size_t length = EncodeLogArguments(types, 2, arguments, buffer, sizeof(buffer));
+        va_end(arguments);
+        return length;
+    };
+    size_t length = encode(L"%ls %d", longText.c_str(), 12345);
+    CHECK(length == sizeof(buffer));
+
+    // The string keeps all the room left by the argument after it, and both
+    // decode in full.
+    size_t keptCharacters = (sizeof(buffer) - 2 - sizeof(int32_t)) / sizeof(char16_t);
+    std::string message = FormatLogMessage(u"%ls %d", types, 2, buffer, length);
+    CHECK(message == std::string(keptCharacters, 'x') + " 12345");
+}
+
+TEST_CASE(RegistryHandsOutOneSitePerFormatAndLevel)
+{
+    static const wchar_t* const formats[] =
+    {
+        L"[A] one %d", L"[A] two %ls", L"[B] three", L"[B] four %u", L"[C] five %zu",
+    };
+
+    LogSiteRegistry registry;
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> threads;
+    std::vector<std::vector<const LogSite*>> seen(4);
+    for (size_t thread = 0; thread < seen.size(); ++thread)
+    {
+        threads.emplace_back([&, thread]()
+            {
+                while (!go.load())
+                {
+                }
+                for (int round = 0; round < 1000; ++round)
+                {
+                    for (const wchar_t* format : formats)
+                    {
+                        for (uint32_t level = LogLevelDebug; level <= LogLevelError; ++level)
+                        {
+                            const LogSite* site = registry.Register(level, format);
+                            if (round == 0)
+                            {
+                                seen[thread].push_back(site);
+                            }
+                        }
+                    }
+                }
+            });
+    }
+    go.store(true);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(registry.GetCount() == 5 * 4);
+    for (size_t thread = 1; thread < seen.size(); ++thread)
+    {
+        CHECK(seen[thread] == seen[0]);
+    }
+    for (uint32_t id = 0; id < registry.GetCount(); ++id)
+    {
+        const LogSite* site = registry.Get(id);
+        REQUIRE(site != nullptr);
+        CHECK(site->id == id);
+        CHECK(registry.Register(site->level, site->format) == site);
+    }
+    CHECK(registry.Get(static_cast<uint32_t>(registry.GetCount())) == nullptr);
+}
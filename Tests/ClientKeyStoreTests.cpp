@@ -0,0 +1,204 @@
+#include "TestHarness.h"
+
+#include "ClientKeyStore.h"
+#include "Configuration.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    bool g_failWrites = false;
+
+    std::filesystem::path GetKeyFilePath()
+    {
+        return std::filesystem::temp_directory_path() / "LGTVVolumeProxy_client_keys_test.txt";
+    }
+
+    std::wstring ResetKeyFile()
+    {
+        g_failWrites = false;
+        std::error_code error;
+        std::filesystem::remove(GetKeyFilePath(), error);
+        return GetKeyFilePath().wstring();
+    }
+
+    void WriteKeyFile(const std::string& contents)
+    {
+        std::ofstream output(GetKeyFilePath(), std::ios::binary | std::ios::trunc);
+        output << contents;
+    }
+
+    std::string ReadKeyFile()
+    {
+        std::ifstream input(GetKeyFilePath(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+}
+
+// Stands in for the Win32 implementation in Configuration.cpp: write a
+// temporary file and rename it over the original.
+bool WriteFileAtomically(const std::wstring& path, const std::string& contents)
+{
+    if (g_failWrites)
+    {
+        return false;
+    }
+
+    std::filesystem::path target(path);
+    std::filesystem::path temporary = target;
+    temporary += ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output << contents;
+        if (!output.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    return !error;
+}
+
+TEST_CASE(IdentityPrefersMacAddress)
+{
+    CHECK(ClientKeyStore::GetIdentity(L"aa:bb:cc:dd:ee:0f", L"10.0.0.2") == "AABBCCDDEE0F");
+    CHECK(ClientKeyStore::GetIdentity(L"AA-BB-CC-DD-EE-0F", L"") == "AABBCCDDEE0F");
+    CHECK(ClientKeyStore::GetIdentity(L"AA:BB", L" 10.0.0.2 ") == "ip:10.0.0.2");
+    CHECK(ClientKeyStore::GetIdentity(L"", L"a=b") == "ip:ab");
+    CHECK(ClientKeyStore::GetIdentity(L"", L" ").empty());
+    CHECK(ClientKeyStore::GetIdentity(L"", L"").empty());
+}
+
+TEST_CASE(MissingFileStartsEmptyAndStoresPersist)
+{
+    std::wstring path = ResetKeyFile();
+    ClientKeyStore store;
+    store.Open(path);
+    CHECK(store.GetPath() == path);
+    CHECK(!store.Contains("AABBCCDDEE0F"));
+    CHECK(store.Find("AABBCCDDEE0F").empty());
+
+    CHECK(store.Store("AABBCCDDEE0F", "first"));
+    CHECK(store.Store("ip:10.0.0.2", "second"));
+    CHECK(store.Store("AABBCCDDEE0F", "replaced"));
+    CHECK(store.Find("AABBCCDDEE0F") == "replaced");
+    CHECK(ReadKeyFile() == "AABBCCDDEE0F=replaced\nip:10.0.0.2=second\n");
+
+    ClientKeyStore reopened;
+    reopened.Open(path);
+    CHECK(reopened.Find("AABBCCDDEE0F") == "replaced");
+    CHECK(reopened.Find("ip:10.0.0.2") == "second");
+
+    CHECK(store.Remove("ip:10.0.0.2"));
+    CHECK(!store.Remove("ip:10.0.0.2"));
+    CHECK(!store.Contains("ip:10.0.0.2"));
+    CHECK(ReadKeyFile() == "AABBCCDDEE0F=replaced\n");
+}
+
+TEST_CASE(RejectsInvalidKeysAndKeepsMapWhenWriteFails)
+{
+    ClientKeyStore store;
+    store.Open(ResetKeyFile());
+    CHECK(!store.Store("", "key"));
+    CHECK(!store.Store("AABBCCDDEE0F", ""));
+    CHECK(!store.Store("AABBCCDDEE0F", "a\nb"));
+    CHECK(!store.Store("AABBCCDDEE0F", "a\rb"));
+    CHECK(!store.Contains("AABBCCDDEE0F"));
+
+    CHECK(store.Store("AABBCCDDEE0F", "kept"));
+    g_failWrites = true;
+    CHECK(!store.Store("AABBCCDDEE0F", "lost"));
+    CHECK(!store.Store("ip:10.0.0.2", "lost"));
+    CHECK(!store.Remove("AABBCCDDEE0F"));
+    g_failWrites = false;
+
+    CHECK(store.Find("AABBCCDDEE0F") == "kept");
+    CHECK(!store.Contains("ip:10.0.0.2"));
+    CHECK(ReadKeyFile() == "AABBCCDDEE0F=kept\n");
+}
+
+TEST_CASE(ReloadPicksUpReplacedFile)
+{
+    std::wstring path = ResetKeyFile();
+    WriteKeyFile("AABBCCDDEE0F=one\r\n=no identity\nno separator\nip:10.0.0.2=\nip:10.0.0.3=a=b\n");
+
+    ClientKeyStore store;
+    store.Open(path);
+    CHECK(store.Find("AABBCCDDEE0F") == "one");
+    CHECK(!store.Contains("ip:10.0.0.2"));
+    CHECK(store.Find("ip:10.0.0.3") == "a=b");
+    CHECK(!store.Contains("no separator"));
+
+    WriteKeyFile("112233445566=copied\n");
+    CHECK(store.Reload());
+    CHECK(!store.Contains("AABBCCDDEE0F"));
+    CHECK(store.Find("112233445566") == "copied");
+
+    // Deleting the file means there are no keys.
+    ResetKeyFile();
+    CHECK(store.Reload());
+    CHECK(!store.Contains("112233445566"));
+}
+
+TEST_CASE(FindNeverSeesTornUpdates)
+{
+    ClientKeyStore store;
+    store.Open(ResetKeyFile());
+    REQUIRE(store.Store("ip:10.0.0.2", "fixed"));
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> runningReaders(0);
+    std::atomic<int> badReads(0);
+    std::vector<std::thread> readers;
+    for (int index = 0; index < 3; ++index)
+    {
+        readers.emplace_back([&]()
+        {
+            bool counted = false;
+            while (!stop.load())
+            {
+                std::string rotating = store.Find("AABBCCDDEE0F");
+                if ((!rotating.empty() && rotating.compare(0, 4, "key-") != 0) || store.Find("ip:10.0.0.2") != "fixed")
+                {
+                    badReads.fetch_add(1);
+                }
+                if (!counted)
+                {
+                    counted = true;
+                    runningReaders.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    CHECK(TestHarness::WaitUntil([&]() { return runningReaders.load() == 3; }));
+    for (int round = 0; round < 500; ++round)
+    {
+        CHECK(store.Store("AABBCCDDEE0F", "key-" + std::to_string(round)));
+        if (round % 7 == 0)
+        {
+            CHECK(store.Reload());
+        }
+        if (round % 11 == 0)
+        {
+            CHECK(store.Remove("AABBCCDDEE0F"));
+        }
+    }
+
+    stop.store(true);
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    CHECK(badReads.load() == 0);
+    CHECK(store.Find("AABBCCDDEE0F") == "key-499");
+    ResetKeyFile();
+}
@@ -0,0 +1,89 @@
+#include "BenchmarkHarness.h"
+
+#include "CoalescingWorkQueue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Drives the queue with synthetic notification bursts: the cost of a single
+// post, contention between posting threads, and how many handler runs a
+// stream of per-role default device notifications collapses into.
+int main(int argc, char** argv)
+{
+    using namespace std::chrono_literals;
+
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 10000 : 5000000;
+
+    {
+        CoalescingWorkQueue queue;
+        queue.Start(150ms, 1s, [](uint32_t) {});
+
+        BenchmarkHarness::Measure("post, single thread", iterations, [&](uint64_t)
+        {
+            queue.Post(0x1);
+        });
+    }
+
+    {
+        constexpr int ThreadCount = 4;
+
+        CoalescingWorkQueue queue;
+        queue.Start(150ms, 1s, [](uint32_t) {});
+
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+        for (int t = 1; t < ThreadCount; ++t)
+        {
+            threads.emplace_back([&]()
+            {
+                while (!go.load())
+                {
+                    std::this_thread::yield();
+                }
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    queue.Post(0x2);
+                }
+            });
+        }
+
+        go = true;
+        BenchmarkHarness::Measure("post, 4 contending threads", iterations, [&](uint64_t)
+        {
+            queue.Post(0x1);
+        });
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    {
+        // A device switch raises one default change per role. Bursts are
+        // 5 ms apart, longer than the 2 ms debounce window, so each burst
+        // should end up as exactly one handler run.
+        uint64_t bursts = quick ? 20 : 400;
+
+        CoalescingWorkQueue queue;
+        queue.Start(2ms, 20ms, [](uint32_t) {});
+
+        BenchmarkHarness::Measure("burst of 3 role notifications", bursts, [&](uint64_t)
+        {
+            queue.Post(0x1);
+            queue.Post(0x1);
+            queue.Post(0x1);
+            std::this_thread::sleep_for(5ms);
+        });
+        queue.Stop();
+
+        std::printf("%-40s %12llu posted %12llu processed %12llu saved\n",
+            "burst coalescing",
+            static_cast<unsigned long long>(queue.GetPostedCount()),
+            static_cast<unsigned long long>(queue.GetProcessedCount()),
+            static_cast<unsigned long long>(queue.GetCoalescedCount()));
+    }
+
+    return 0;
+}
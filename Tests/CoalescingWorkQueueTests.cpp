@@ -0,0 +1,227 @@
+#include "TestHarness.h"
+
+#include "CoalescingWorkQueue.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    // Records every handler call.
+    struct HandlerLog
+    {
+        std::mutex mutex;
+        std::vector<uint32_t> calls;
+
+        CoalescingWorkQueue::WorkHandler MakeHandler()
+        {
+            return [this](uint32_t workFlags)
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                calls.push_back(workFlags);
+            };
+        }
+
+        size_t GetCallCount()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return calls.size();
+        }
+
+        uint32_t GetCombinedFlags()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            uint32_t combined = 0;
+            for (uint32_t flags : calls)
+            {
+                combined |= flags;
+            }
+            return combined;
+        }
+    };
+}
+
+TEST_CASE(BurstIsProcessedOnce)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(50ms, 10s, log.MakeHandler()));
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        queue.Post(1u << (i % 3));
+    }
+
+    REQUIRE(TestHarness::WaitUntil([&]() { return log.GetCallCount() == 1; }));
+    std::this_thread::sleep_for(100ms);
+
+    CHECK(log.GetCallCount() == 1);
+    CHECK(log.GetCombinedFlags() == 0x7);
+    CHECK(queue.GetPostedCount() == 100);
+    CHECK(queue.GetProcessedCount() == 1);
+    CHECK(queue.GetCoalescedCount() == 99);
+}
+
+TEST_CASE(MaxDelayBoundsContinuousStorm)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(20ms, 50ms, log.MakeHandler()));
+
+    // Posts arrive faster than the debounce window for much longer than the
+    // maximum delay, so only the maximum delay can let the handler run.
+    auto end = std::chrono::steady_clock::now() + 400ms;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        queue.Post(0x1);
+        std::this_thread::sleep_for(1ms);
+    }
+
+    // Once the last batch has run, every post was either handled or folded
+    // into a batch, and the storm cannot have taken fewer than one batch per
+    // maximum delay. Whether a post was still pending when the storm ended
+    // depends on timing, so that is not checked.
+    uint64_t posted = queue.GetPostedCount();
+    REQUIRE(TestHarness::WaitUntil([&]()
+    {
+        return queue.GetCoalescedCount() + queue.GetProcessedCount() == posted;
+    }));
+    CHECK(queue.GetProcessedCount() >= 400 / 50 - 1);
+}
+
+TEST_CASE(PostImmediateSkipsDebounceAndAbsorbsPendingWork)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(1h, 1h, log.MakeHandler()));
+
+    queue.Post(0x1);
+    queue.PostImmediate(0x2);
+
+    REQUIRE(TestHarness::WaitUntil([&]() { return log.GetCallCount() == 1; }));
+    CHECK(log.GetCombinedFlags() == 0x3);
+    CHECK(queue.GetCoalescedCount() == 1);
+}
+
+TEST_CASE(IgnoresEmptyWorkAndPostsWhileStopped)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+
+    queue.PostImmediate(0x1);
+    CHECK(queue.GetPostedCount() == 0);
+
+    REQUIRE(queue.Start(0ms, 0ms, log.MakeHandler()));
+    queue.PostImmediate(0);
+    CHECK(queue.GetPostedCount() == 0);
+
+    queue.PostImmediate(0x4);
+    REQUIRE(TestHarness::WaitUntil([&]() { return log.GetCallCount() == 1; }));
+    CHECK(log.GetCombinedFlags() == 0x4);
+
+    queue.Stop();
+    queue.PostImmediate(0x1);
+    CHECK(queue.GetPostedCount() == 1);
+}
+
+TEST_CASE(RejectsSecondStartAndMissingHandler)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+
+    CHECK(!queue.Start(0ms, 0ms, CoalescingWorkQueue::WorkHandler()));
+    CHECK(queue.Start(0ms, 0ms, log.MakeHandler()));
+    CHECK(!queue.Start(0ms, 0ms, log.MakeHandler()));
+}
+
+TEST_CASE(StopDiscardsPendingWorkAndQueueCanRestart)
+{
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(1h, 1h, log.MakeHandler()));
+
+    queue.Post(0x1);
+    queue.Stop();
+    CHECK(log.GetCallCount() == 0);
+
+    REQUIRE(queue.Start(0ms, 0ms, log.MakeHandler()));
+    queue.Post(0x2);
+    REQUIRE(TestHarness::WaitUntil([&]() { return log.GetCallCount() == 1; }));
+    CHECK(log.GetCombinedFlags() == 0x2);
+}
+
+TEST_CASE(ThreadCallbacksRunOnWorkerThread)
+{
+    std::mutex mutex;
+    std::thread::id startThread;
+    std::thread::id handlerThread;
+    std::thread::id stopThread;
+
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(
+        0ms,
+        0ms,
+        [&](uint32_t)
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            handlerThread = std::this_thread::get_id();
+        },
+        [&]()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            startThread = std::this_thread::get_id();
+        },
+        [&]()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopThread = std::this_thread::get_id();
+        }));
+
+    queue.PostImmediate(0x1);
+    REQUIRE(TestHarness::WaitUntil([&]() { return queue.GetProcessedCount() == 1; }));
+    queue.Stop();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    CHECK(startThread != std::thread::id());
+    CHECK(startThread != std::this_thread::get_id());
+    CHECK(handlerThread == startThread);
+    CHECK(stopThread == startThread);
+}
+
+TEST_CASE(ConcurrentPostersLoseNoWork)
+{
+    constexpr uint32_t ThreadCount = 8;
+    constexpr uint32_t PostsPerThread = 20000;
+
+    HandlerLog log;
+    CoalescingWorkQueue queue;
+    REQUIRE(queue.Start(1ms, 5ms, log.MakeHandler()));
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < ThreadCount; ++t)
+    {
+        threads.emplace_back([&queue, t]()
+        {
+            for (uint32_t i = 0; i < PostsPerThread; ++i)
+            {
+                queue.Post(1u << t);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(queue.GetPostedCount() == ThreadCount * PostsPerThread);
+    REQUIRE(TestHarness::WaitUntil([&]()
+    {
+        return queue.GetProcessedCount() + queue.GetCoalescedCount() == queue.GetPostedCount();
+    }));
+    CHECK(log.GetCombinedFlags() == (1u << ThreadCount) - 1);
+    CHECK(queue.GetProcessedCount() < queue.GetPostedCount() / 10);
+}
@@ -0,0 +1,267 @@
+#include "TestHarness.h"
+
+#include "ConfigurationPersister.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    // Writer with injectable faults. Every attempt is recorded by the TV port
+    // of the snapshot; the first failuresToInject attempts fail.
+    class FaultyWriter
+    {
+    public:
+        ConfigurationPersister::Writer Bind()
+        {
+            return [this](const AppConfiguration& configuration) { return Write(configuration); };
+        }
+
+        void InjectFailures(int count)
+        {
+            failuresToInject = count;
+        }
+
+        void SetWriteDuration(std::chrono::milliseconds duration)
+        {
+            writeDuration = duration;
+        }
+
+        std::vector<unsigned short> GetAttempts()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return attempts;
+        }
+
+        std::vector<unsigned short> GetWritten()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return written;
+        }
+
+    private:
+        bool Write(const AppConfiguration& configuration)
+        {
+            std::this_thread::sleep_for(writeDuration.load());
+
+            std::lock_guard<std::mutex> guard(mutex);
+            attempts.push_back(configuration.tvPort);
+            if (failuresToInject > 0)
+            {
+                --failuresToInject;
+                return false;
+            }
+            written.push_back(configuration.tvPort);
+            return true;
+        }
+
+        std::atomic<int> failuresToInject{ 0 };
+        std::atomic<std::chrono::milliseconds> writeDuration{ 0ms };
+        std::mutex mutex;
+        std::vector<unsigned short> attempts;
+        std::vector<unsigned short> written;
+    };
+
+    AppConfiguration MakeConfiguration(unsigned short marker)
+    {
+        AppConfiguration configuration;
+        configuration.tvPort = marker;
+        return configuration;
+    }
+}
+
+TEST_CASE(BurstOfChangesIsWrittenOnce)
+{
+    FaultyWriter writer;
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    for (unsigned short marker = 1; marker <= 100; ++marker)
+    {
+        persister.Schedule(MakeConfiguration(marker));
+    }
+    CHECK(persister.IsPending());
+
+    REQUIRE(TestHarness::WaitUntil([&]() { return persister.GetWriteCount() == 1; }));
+    CHECK(!persister.IsPending());
+    CHECK(writer.GetWritten() == std::vector<unsigned short>{ 100 });
+
+    std::this_thread::sleep_for(ConfigurationPersister::DebounceDelay * 2);
+    CHECK(persister.GetWriteCount() == 1);
+}
+
+TEST_CASE(ContinuousChangesAreWrittenWithinMaxDelay)
+{
+    FaultyWriter writer;
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    // Changes keep arriving faster than the debounce delay, e.g. while the
+    // window is dragged; the maximum delay still forces a write.
+    auto start = std::chrono::steady_clock::now();
+    unsigned short marker = 0;
+    while (persister.GetWriteCount() == 0
+        && std::chrono::steady_clock::now() - start < ConfigurationPersister::MaxDelay * 3)
+    {
+        persister.Schedule(MakeConfiguration(++marker));
+        std::this_thread::sleep_for(ConfigurationPersister::DebounceDelay / 5);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    CHECK(persister.GetWriteCount() == 1);
+    CHECK(elapsed >= ConfigurationPersister::MaxDelay);
+    CHECK(elapsed < ConfigurationPersister::MaxDelay + ConfigurationPersister::DebounceDelay * 2);
+
+    // Whatever was scheduled after that write is flushed by Stop.
+    persister.Stop();
+    std::vector<unsigned short> written = writer.GetWritten();
+    REQUIRE(!written.empty());
+    CHECK(written.size() <= 2);
+    CHECK(written.back() == marker);
+}
+
+TEST_CASE(FailedWriteIsRetried)
+{
+    FaultyWriter writer;
+    writer.InjectFailures(1);
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    persister.Schedule(MakeConfiguration(7));
+    REQUIRE(TestHarness::WaitUntil([&]() { return persister.GetFailureCount() == 1; }));
+    auto failedAt = std::chrono::steady_clock::now();
+
+    // The snapshot stays pending so the file watcher does not reload an old
+    // file over it.
+    CHECK(persister.IsPending());
+
+    REQUIRE(TestHarness::WaitUntil(
+        [&]() { return persister.GetWriteCount() == 1; },
+        ConfigurationPersister::RetryDelay * 2));
+    CHECK(std::chrono::steady_clock::now() - failedAt >= ConfigurationPersister::RetryDelay - 100ms);
+    CHECK(writer.GetAttempts() == (std::vector<unsigned short>{ 7, 7 }));
+    CHECK(!persister.IsPending());
+}
+
+TEST_CASE(NewerChangeReplacesFailedSnapshot)
+{
+    FaultyWriter writer;
+    writer.InjectFailures(1);
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    persister.Schedule(MakeConfiguration(1));
+    REQUIRE(TestHarness::WaitUntil([&]() { return persister.GetFailureCount() == 1; }));
+
+    // A change during the retry wait is written after the normal debounce,
+    // and the failed snapshot is never retried on its own.
+    auto scheduledAt = std::chrono::steady_clock::now();
+    persister.Schedule(MakeConfiguration(2));
+    REQUIRE(TestHarness::WaitUntil([&]() { return persister.GetWriteCount() == 1; }));
+    CHECK(std::chrono::steady_clock::now() - scheduledAt < ConfigurationPersister::RetryDelay);
+    CHECK(writer.GetAttempts() == (std::vector<unsigned short>{ 1, 2 }));
+}
+
+TEST_CASE(StopFlushesPendingChange)
+{
+    FaultyWriter writer;
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    persister.Schedule(MakeConfiguration(3));
+    persister.Stop();
+    CHECK(writer.GetWritten() == std::vector<unsigned short>{ 3 });
+    CHECK(!persister.IsPending());
+}
+
+TEST_CASE(StopDoesNotHangWhenFinalWriteFails)
+{
+    FaultyWriter writer;
+    writer.InjectFailures(100);
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    persister.Schedule(MakeConfiguration(4));
+    auto start = std::chrono::steady_clock::now();
+    persister.Stop();
+
+    CHECK(std::chrono::steady_clock::now() - start < ConfigurationPersister::RetryDelay);
+    CHECK(writer.GetAttempts() == std::vector<unsigned short>{ 4 });
+    CHECK(persister.GetFailureCount() == 1);
+    CHECK(!persister.IsPending());
+}
+
+TEST_CASE(ChangeDuringSlowWriteIsWrittenAfterIt)
+{
+    FaultyWriter writer;
+    writer.SetWriteDuration(200ms);
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    persister.Schedule(MakeConfiguration(5));
+    REQUIRE(TestHarness::WaitUntil([&]() { return writer.GetAttempts().empty() && persister.IsPending(); }));
+    std::this_thread::sleep_for(ConfigurationPersister::DebounceDelay + 50ms);
+
+    // The first write is in progress now; the snapshot queued meanwhile must
+    // not be lost or merged into it.
+    persister.Schedule(MakeConfiguration(6));
+    REQUIRE(TestHarness::WaitUntil([&]() { return persister.GetWriteCount() == 2; }));
+    CHECK(writer.GetWritten() == (std::vector<unsigned short>{ 5, 6 }));
+}
+
+TEST_CASE(WritesSynchronouslyWhenNotStarted)
+{
+    FaultyWriter writer;
+    writer.InjectFailures(1);
+    ConfigurationPersister persister(writer.Bind());
+
+    persister.Schedule(MakeConfiguration(8));
+    CHECK(persister.GetFailureCount() == 1);
+    persister.Schedule(MakeConfiguration(9));
+    CHECK(persister.GetWriteCount() == 1);
+    CHECK(writer.GetWritten() == std::vector<unsigned short>{ 9 });
+
+    ConfigurationPersister withoutWriter{ ConfigurationPersister::Writer() };
+    CHECK(!withoutWriter.Start());
+    withoutWriter.Schedule(MakeConfiguration(10));
+    CHECK(withoutWriter.GetFailureCount() == 1);
+}
+
+TEST_CASE(ConcurrentSchedulersEndWithOneOfTheLastSnapshots)
+{
+    constexpr int ThreadCount = 4;
+    constexpr unsigned short PerThread = 2000;
+
+    FaultyWriter writer;
+    ConfigurationPersister persister(writer.Bind());
+    REQUIRE(persister.Start());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCount; ++t)
+    {
+        threads.emplace_back([&persister, t]()
+        {
+            for (unsigned short i = 1; i <= PerThread; ++i)
+            {
+                persister.Schedule(MakeConfiguration(static_cast<unsigned short>(t * PerThread + i)));
+                persister.IsPending();
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    persister.Stop();
+
+    // Whatever the interleaving, the file ends with some thread's final
+    // snapshot.
+    std::vector<unsigned short> written = writer.GetWritten();
+    REQUIRE(!written.empty());
+    CHECK(written.back() % PerThread == 0);
+    CHECK(written.size() <= 2);
+}
@@ -0,0 +1,352 @@
+#include "TestHarness.h"
+
+#include "Configuration.h"
+#include "ConfigurationSchema.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // Loads file contents the way LoadConfiguration does, line by line.
+    AppConfiguration Parse(std::string_view contents)
+    {
+        AppConfiguration configuration;
+        size_t start = 0;
+        while (start < contents.size())
+        {
+            size_t end = contents.find('\n', start);
+            if (end == std::string_view::npos)
+            {
+                end = contents.size();
+            }
+
+            std::string_view key;
+            ApplyConfigurationLine(contents.substr(start, end - start), configuration, key);
+            start = end + 1;
+        }
+        return configuration;
+    }
+
+    uint32_t NextRandom(uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 16);
+    }
+
+    // Text as a user could enter it: no line breaks, no surrounding
+    // whitespace, with non-ASCII and non-BMP characters mixed in.
+    std::wstring RandomText(uint64_t& state)
+    {
+        static const uint32_t extra[] = { 0xE9, 0x3A9, 0x30C6, 0xFFFD, 0x1F4FA, 0x10FFFF };
+
+        std::wstring text;
+        size_t length = NextRandom(state) % 12;
+        for (size_t index = 0; index < length; ++index)
+        {
+            uint32_t pick = NextRandom(state) % 10;
+            uint32_t codePoint = (pick < 8)
+                ? 0x20 + NextRandom(state) % 0x5F
+                : extra[NextRandom(state) % 6];
+
+            if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+            {
+                codePoint -= 0x10000;
+                text.push_back(static_cast<wchar_t>(0xD800 | (codePoint >> 10)));
+                text.push_back(static_cast<wchar_t>(0xDC00 | (codePoint & 0x3FF)));
+            }
+            else
+            {
+                text.push_back(static_cast<wchar_t>(codePoint));
+            }
+        }
+
+        while (!text.empty() && text.front() == L' ')
+        {
+            text.erase(text.begin());
+        }
+        while (!text.empty() && text.back() == L' ')
+        {
+            text.pop_back();
+        }
+        return text;
+    }
+
+    AppConfiguration RandomConfiguration(uint64_t& state)
+    {
+        AppConfiguration configuration;
+        configuration.tvIpAddress = RandomText(state);
+        configuration.tvMacAddress = RandomText(state);
+        configuration.deviceNameHint = RandomText(state);
+        configuration.onlyWhenDolbyAtmos = (NextRandom(state) & 1) != 0;
+        configuration.useSecureWebSocket = (NextRandom(state) & 1) != 0;
+        configuration.tvPort = static_cast<unsigned short>(1 + NextRandom(state) % 65535);
+        configuration.showCloseToTrayMessage = (NextRandom(state) & 1) != 0;
+        configuration.hasWindowPosition = (NextRandom(state) & 1) != 0;
+        if (configuration.hasWindowPosition)
+        {
+            configuration.windowLeft = static_cast<int>(NextRandom(state) % 2000001) - 1000000;
+            configuration.windowTop = static_cast<int>(NextRandom(state) % 2000001) - 1000000;
+        }
+        for (uint32_t count = NextRandom(state) % 4; count > 0; --count)
+        {
+            configuration.hotkeyBindings.push_back(RandomText(state));
+        }
+        configuration.logLevels = RandomText(state);
+        for (uint32_t count = NextRandom(state) % 3; count > 0; --count)
+        {
+            configuration.tvProfiles.push_back(RandomText(state));
+        }
+        return configuration;
+    }
+}
+
+TEST_CASE(DefaultsMatchFieldTable)
+{
+    AppConfiguration configuration;
+    CHECK(configuration.tvIpAddress.empty());
+    CHECK(configuration.deviceNameHint == L"LG");
+    CHECK(configuration.onlyWhenDolbyAtmos);
+    CHECK(configuration.useSecureWebSocket);
+    CHECK(configuration.tvPort == 3001);
+    CHECK(configuration.showCloseToTrayMessage);
+    CHECK(!configuration.hasWindowPosition);
+    CHECK(configuration.windowLeft == -1);
+    CHECK(configuration.hotkeyBindings.empty());
+    CHECK(configuration.version == 0);
+
+    // Optional keys are left out of a default file.
+    CHECK(FormatConfiguration(configuration) ==
+        "tv_ip=\n"
+        "tv_mac=\n"
+        "device_hint=LG\n"
+        "only_when_atmos=1\n"
+        "use_secure_websocket=1\n"
+        "tv_port=3001\n"
+        "show_close_to_tray_message=1\n");
+}
+
+TEST_CASE(EveryKeyResolvesAndNearMissesDoNot)
+{
+    size_t count = 0;
+    const ConfigurationField* fields = GetConfigurationFields(count);
+    REQUIRE(count == 12);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        std::string key(fields[index].key);
+        CHECK(FindConfigurationField(key) == &fields[index]);
+
+        std::string upper(key);
+        upper[0] = static_cast<char>(upper[0] - 'a' + 'A');
+        CHECK(FindConfigurationField(upper) == nullptr);
+        CHECK(FindConfigurationField(key + "x") == nullptr);
+        CHECK(FindConfigurationField(key.substr(0, key.size() - 1)) == nullptr);
+        CHECK(FindConfigurationField(" " + key) == nullptr);
+    }
+    CHECK(FindConfigurationField("") == nullptr);
+}
+
+TEST_CASE(LoadsExistingFile)
+{
+    AppConfiguration configuration = Parse(
+        "tv_ip=192.168.1.20\r\n"
+        "tv_mac = AA:BB:CC:DD:EE:FF \n"
+        "device_hint=LG;!Monitor\n"
+        "only_when_atmos=false\n"
+        "use_secure_websocket=True\n"
+        "tv_port=3000\n"
+        "window_left=-1920\n"
+        "window_top=40\n"
+        "hotkey=Ctrl+Alt+Up:VolumeUp\n"
+        "hotkey=Ctrl+Alt+Down:VolumeDown\n"
+        "\n"
+        "# comment without separator\n"
+        "unknown_key=1\n");
+
+    CHECK(configuration.tvIpAddress == L"192.168.1.20");
+    CHECK(configuration.tvMacAddress == L"AA:BB:CC:DD:EE:FF");
+    CHECK(configuration.deviceNameHint == L"LG;!Monitor");
+    CHECK(!configuration.onlyWhenDolbyAtmos);
+    CHECK(configuration.useSecureWebSocket);
+    CHECK(configuration.tvPort == 3000);
+    CHECK(configuration.hasWindowPosition);
+    CHECK(configuration.windowLeft == -1920);
+    CHECK(configuration.windowTop == 40);
+    CHECK(configuration.hotkeyBindings == (std::vector<std::wstring>{ L"Ctrl+Alt+Up:VolumeUp", L"Ctrl+Alt+Down:VolumeDown" }));
+}
+
+TEST_CASE(ReportsLineResultsAndKeepsValueOnInvalidInput)
+{
+    struct Case
+    {
+        const char* line;
+        ConfigurationLineResult result;
+        const char* key;
+    };
+    const Case cases[] =
+    {
+        { "tv_port=8080", ConfigurationLineResult::Applied, "tv_port" },
+        { "tv_port=0", ConfigurationLineResult::InvalidValue, "tv_port" },
+        { "tv_port=65536", ConfigurationLineResult::InvalidValue, "tv_port" },
+        { "tv_port=80a", ConfigurationLineResult::InvalidValue, "tv_port" },
+        { "tv_port=", ConfigurationLineResult::InvalidValue, "tv_port" },
+        { "only_when_atmos=yes", ConfigurationLineResult::InvalidValue, "only_when_atmos" },
+        { "window_left=1000001", ConfigurationLineResult::InvalidValue, "window_left" },
+        { "window_top=-1000000", ConfigurationLineResult::Applied, "window_top" },
+        { "no separator", ConfigurationLineResult::Skipped, "" },
+        { " = value", ConfigurationLineResult::Skipped, "" },
+        { "tv_ports=1", ConfigurationLineResult::UnknownKey, "tv_ports" },
+    };
+
+    AppConfiguration configuration;
+    for (const Case& item : cases)
+    {
+        std::string_view key;
+        CHECK(ApplyConfigurationLine(item.line, configuration, key) == item.result);
+        CHECK(key == item.key);
+    }
+
+    CHECK(configuration.tvPort == 8080);
+    CHECK(configuration.onlyWhenDolbyAtmos);
+    CHECK(configuration.windowLeft == -1);
+    CHECK(configuration.windowTop == -1000000);
+    CHECK(configuration.hasWindowPosition);
+}
+
+TEST_CASE(DecodesUtf8AndReplacesMalformedBytes)
+{
+    AppConfiguration configuration = Parse(
+        "tv_ip=caf\xC3\xA9 \xF0\x9F\x93\xBA\n"
+        "tv_mac=a\xC3\x28" "b\xE0\x80\x80" "c\xED\xA0\x80" "d\xFF\n");
+
+    std::wstring expected = L"caf\xE9 ";
+    if (sizeof(wchar_t) == 2)
+    {
+        expected += L"\xD83D\xDCFA";
+    }
+    else
+    {
+        expected.push_back(static_cast<wchar_t>(0x1F4FA));
+    }
+    CHECK(configuration.tvIpAddress == expected);
+
+    // One replacement per bad byte: the truncated sequence, each byte of the
+    // overlong form and of the encoded surrogate, and the invalid lead byte.
+    CHECK(configuration.tvMacAddress ==
+        L"a\xFFFD(b\xFFFD\xFFFD\xFFFD" L"c\xFFFD\xFFFD\xFFFD" L"d\xFFFD");
+
+    std::string formatted = FormatConfiguration(configuration);
+    CHECK(formatted.find("tv_ip=caf\xC3\xA9 \xF0\x9F\x93\xBA\n") != std::string::npos);
+}
+
+TEST_CASE(EachFieldReportsItsOwnChange)
+{
+    AppConfiguration base;
+    CHECK(CompareConfigurations(base, base) == ConfigurationChangeNone);
+
+    struct Case
+    {
+        void (*mutate)(AppConfiguration&);
+        uint32_t change;
+    };
+    const Case cases[] =
+    {
+        { [](AppConfiguration& c) { c.tvIpAddress = L"10.0.0.2"; }, ConfigurationChangeTvIpAddress },
+        { [](AppConfiguration& c) { c.tvMacAddress = L"00:11"; }, ConfigurationChangeTvMacAddress },
+        { [](AppConfiguration& c) { c.deviceNameHint = L"OLED"; }, ConfigurationChangeDeviceNameHint },
+        { [](AppConfiguration& c) { c.onlyWhenDolbyAtmos = false; }, ConfigurationChangeOnlyWhenDolbyAtmos },
+        { [](AppConfiguration& c) { c.useSecureWebSocket = false; }, ConfigurationChangeUseSecureWebSocket },
+        { [](AppConfiguration& c) { c.tvPort = 3000; }, ConfigurationChangeTvPort },
+        { [](AppConfiguration& c) { c.showCloseToTrayMessage = false; }, ConfigurationChangeShowCloseToTrayMessage },
+        { [](AppConfiguration& c) { c.windowTop = 5; }, ConfigurationChangeWindowPosition },
+        { [](AppConfiguration& c) { c.hasWindowPosition = true; }, ConfigurationChangeWindowPosition },
+        { [](AppConfiguration& c) { c.hotkeyBindings.push_back(L"F9:Mute"); }, ConfigurationChangeHotkeyBindings },
+        { [](AppConfiguration& c) { c.logLevels = L"debug"; }, ConfigurationChangeLogLevels },
+        { [](AppConfiguration& c) { c.tvProfiles.push_back(L"Bedroom"); }, ConfigurationChangeTvProfiles },
+        { [](AppConfiguration& c) { c.version = 42; }, ConfigurationChangeNone },
+    };
+
+    for (const Case& item : cases)
+    {
+        AppConfiguration changed = base;
+        item.mutate(changed);
+        CHECK(CompareConfigurations(base, changed) == item.change);
+        CHECK(CompareConfigurations(changed, base) == item.change);
+    }
+}
+
+TEST_CASE(RandomConfigurationsRoundTrip)
+{
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    int failures = 0;
+
+    for (int round = 0; round < 20000; ++round)
+    {
+        AppConfiguration original = RandomConfiguration(state);
+        std::string formatted = FormatConfiguration(original);
+        AppConfiguration parsed = Parse(formatted);
+
+        uint32_t changes = CompareConfigurations(original, parsed);
+        if (changes != ConfigurationChangeNone || FormatConfiguration(parsed) != formatted)
+        {
+            if (failures++ < 5)
+            {
+                std::fprintf(stderr, "round trip changed 0x%x:\n%s\n", changes, formatted.c_str());
+            }
+        }
+    }
+    CHECK(failures == 0);
+}
+
+TEST_CASE(RandomInputParsesAndReformatsStably)
+{
+    static const char* const fragments[] =
+    {
+        "tv_ip", "tv_port", "device_hint", "window_left", "window_top", "hotkey", "tv_profile",
+        "only_when_atmos", "log_levels", "=", "==", " ", "\t", "\r", "\n", "1", "0", "-1",
+        "65535", "65536", "2147483648", "true", "False", "\xC3", "\xA9", "\xF0\x9F", "\xFF",
+        "\xED\xA0\x80", "\0", "x",
+    };
+    constexpr size_t FragmentCount = sizeof(fragments) / sizeof(fragments[0]);
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    int failures = 0;
+
+    for (int round = 0; round < 50000; ++round)
+    {
+        std::string input;
+        for (uint32_t count = NextRandom(state) % 24; count > 0; --count)
+        {
+            uint32_t pick = NextRandom(state) % (FragmentCount + 1);
+            if (pick == FragmentCount)
+            {
+                input.push_back(static_cast<char>(NextRandom(state)));
+            }
+            else if (fragments[pick][0] == '\0')
+            {
+                input.push_back('\0');
+            }
+            else
+            {
+                input += fragments[pick];
+            }
+        }
+
+        // Whatever the input, what gets saved must load back unchanged.
+        AppConfiguration first = Parse(input);
+        std::string formatted = FormatConfiguration(first);
+        AppConfiguration second = Parse(formatted);
+        if (CompareConfigurations(first, second) != ConfigurationChangeNone ||
+            FormatConfiguration(second) != formatted)
+        {
+            ++failures;
+        }
+    }
+    CHECK(failures == 0);
+}
@@ -0,0 +1,91 @@
+#include "TestHarness.h"
+
+#include "ConfigurationStore.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE(StartsWithDefaultConfiguration)
+{
+    ConfigurationStore store;
+    CHECK(store.GetVersion() == 0);
+
+    std::shared_ptr<const AppConfiguration> snapshot = store.Acquire();
+    REQUIRE(snapshot != nullptr);
+    CHECK(snapshot->version == 0);
+    CHECK(snapshot->tvPort == AppConfiguration().tvPort);
+}
+
+TEST_CASE(PublishStampsVersionAndKeepsOldSnapshots)
+{
+    ConfigurationStore store;
+    std::shared_ptr<const AppConfiguration> original = store.Acquire();
+
+    AppConfiguration changed = *original;
+    changed.tvIpAddress = L"192.168.1.20";
+    changed.version = 99;
+    CHECK(store.Publish(changed) == 1);
+
+    changed.tvPort = 3000;
+    CHECK(store.Publish(changed) == 2);
+    CHECK(store.GetVersion() == 2);
+
+    // The version is the store's, not the caller's.
+    std::shared_ptr<const AppConfiguration> current = store.Acquire();
+    CHECK(current->version == 2);
+    CHECK(current->tvIpAddress == L"192.168.1.20");
+    CHECK(current->tvPort == 3000);
+
+    // Snapshots handed out earlier never change.
+    CHECK(original->version == 0);
+    CHECK(original->tvIpAddress.empty());
+}
+
+TEST_CASE(ReadersNeverSeeOlderSnapshotThanVersion)
+{
+    ConfigurationStore store;
+    constexpr uint64_t Publishes = 20000;
+
+    // Each snapshot's port encodes its version, so a reader can tell a
+    // snapshot that does not belong to its version.
+    std::atomic<bool> done{ false };
+    std::atomic<uint64_t> problems{ 0 };
+    std::atomic<uint64_t> reads{ 0 };
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; ++reader)
+    {
+        readers.emplace_back([&]()
+            {
+                uint64_t lastVersion = 0;
+                while (!done.load())
+                {
+                    uint64_t version = store.GetVersion();
+                    std::shared_ptr<const AppConfiguration> snapshot = store.Acquire();
+                    if (snapshot->version < version || snapshot->version < lastVersion ||
+                        (snapshot->version != 0 && snapshot->tvPort != 1 + snapshot->version % 60000))
+                    {
+                        ++problems;
+                    }
+                    lastVersion = snapshot->version;
+                    ++reads;
+                }
+            });
+    }
+
+    CHECK(TestHarness::WaitUntil([&]() { return reads.load() >= 3; }));
+    for (uint64_t index = 1; index <= Publishes; ++index)
+    {
+        AppConfiguration next = *store.Acquire();
+        next.tvPort = static_cast<unsigned short>(1 + index % 60000);
+        CHECK(store.Publish(next) == index);
+    }
+    done.store(true);
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    CHECK(problems == 0);
+    CHECK(store.Acquire()->version == Publishes);
+}
@@ -0,0 +1,90 @@
+#include "BenchmarkHarness.h"
+
+#include "DeviceNameMatcher.h"
+#include "EndpointNameCorpus.h"
+
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // What matching cost before the matcher: fold the name and the hint on
+    // every call, then search once per pattern.
+    bool FoldAndSearch(const std::wstring& friendlyName, const std::vector<std::wstring>& patterns)
+    {
+        std::wstring name(friendlyName);
+        for (wchar_t& character : name)
+        {
+            character = static_cast<wchar_t>(towlower(character));
+        }
+
+        for (const std::wstring& pattern : patterns)
+        {
+            std::wstring folded(pattern);
+            for (wchar_t& character : folded)
+            {
+                character = static_cast<wchar_t>(towlower(character));
+            }
+            if (name.find(folded) != std::wstring::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Run(const char* label, const std::vector<std::wstring>& patterns, uint64_t iterations)
+    {
+        const std::vector<std::wstring>& corpus = GetEndpointNameCorpus();
+
+        std::wstring specification;
+        for (const std::wstring& pattern : patterns)
+        {
+            specification += pattern + L";";
+        }
+        DeviceNameMatcher matcher = DeviceNameMatcher::Compile(specification);
+
+        std::string compiledName = std::string("compiled, ") + label;
+        std::string naiveName = std::string("fold and search, ") + label;
+
+        uint32_t matches = 0;
+        BenchmarkHarness::Measure(compiledName.c_str(), iterations, [&](uint64_t i)
+        {
+            matches += matcher.Matches(L"id", corpus[i % corpus.size()]) ? 1 : 0;
+        });
+        BenchmarkHarness::Measure(naiveName.c_str(), iterations, [&](uint64_t i)
+        {
+            matches += FoldAndSearch(corpus[i % corpus.size()], patterns) ? 1 : 0;
+        });
+        BenchmarkHarness::DoNotOptimize(matches);
+    }
+}
+
+// Matches the endpoint name corpus against hints of growing size, compiled
+// once versus folded and searched on every call.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 10000 : 10000000;
+
+    Run("1 pattern", { L"LG" }, iterations);
+    Run("5 patterns", { L"LG TV", L"OLED", L"webOS", L"SOUNDBAR", L"AVR" }, iterations);
+    Run("20 patterns",
+        {
+            L"LG TV", L"OLED", L"webOS", L"SOUNDBAR", L"AVR", L"RECEIVER", L"DENON", L"MARANTZ",
+            L"ONKYO", L"YAMAHA", L"SONY", L"SAMSUNG", L"BRAVIA", L"QLED", L"NANOCELL", L"eARC",
+            L"HDMI", L"SONOS", L"BOSE", L"VIZIO",
+        },
+        iterations);
+
+    BenchmarkHarness::Measure("compile 20 patterns", quick ? 100 : 100000, [](uint64_t)
+    {
+        DeviceNameMatcher matcher = DeviceNameMatcher::Compile(
+            L"LG TV;OLED;webOS;SOUNDBAR;AVR;RECEIVER;DENON;MARANTZ;ONKYO;YAMAHA;"
+            L"SONY;SAMSUNG;BRAVIA;QLED;NANOCELL;eARC;HDMI;SONOS;BOSE;VIZIO;!Monitor");
+        BenchmarkHarness::DoNotOptimize(matcher);
+    });
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "TestHarness.h"
+
+#include "DeviceNameMatcher.h"
+#include "EndpointNameCorpus.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::wstring Fold(std::wstring value)
+    {
+        for (wchar_t& character : value)
+        {
+            character = static_cast<wchar_t>(towlower(character));
+        }
+        return value;
+    }
+
+    // The hint semantics implemented the obvious way: fold everything on each
+    // call and search for every pattern separately.
+    struct ReferenceMatcher
+    {
+        std::vector<std::wstring> includes;
+        std::vector<std::wstring> excludes;
+        std::vector<std::wstring> includedIds;
+        std::vector<std::wstring> excludedIds;
+
+        bool Matches(const std::wstring& endpointId, const std::wstring& friendlyName) const
+        {
+            std::wstring id = Fold(endpointId);
+            std::wstring name = Fold(friendlyName);
+
+            if (std::find(excludedIds.begin(), excludedIds.end(), id) != excludedIds.end())
+            {
+                return false;
+            }
+            if (std::find(includedIds.begin(), includedIds.end(), id) != includedIds.end())
+            {
+                return true;
+            }
+            for (const std::wstring& pattern : excludes)
+            {
+                if (name.find(pattern) != std::wstring::npos)
+                {
+                    return false;
+                }
+            }
+            for (const std::wstring& pattern : includes)
+            {
+                if (name.find(pattern) != std::wstring::npos)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::wstring ToSpecification() const
+        {
+            std::wstring specification;
+            for (const std::wstring& pattern : includes)
+            {
+                specification += pattern + L";";
+            }
+            for (const std::wstring& pattern : excludes)
+            {
+                specification += L"!" + pattern + L";";
+            }
+            for (const std::wstring& id : includedIds)
+            {
+                specification += L"id:" + id + L";";
+            }
+            for (const std::wstring& id : excludedIds)
+            {
+                specification += L"!id:" + id + L";";
+            }
+            return specification;
+        }
+    };
+
+    uint32_t NextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Short strings over a tiny alphabet overlap a lot, which exercises the
+    // failure links far more than real names do.
+    std::wstring RandomText(uint32_t& state, size_t maxLength)
+    {
+        static const wchar_t alphabet[] = L"abAB ";
+        std::wstring text;
+        size_t length = 1 + NextRandom(state) % maxLength;
+        for (size_t i = 0; i < length; ++i)
+        {
+            text += alphabet[NextRandom(state) % 5];
+        }
+        return text;
+    }
+}
+
+TEST_CASE(ParsesEntriesIdsAndExclusions)
+{
+    DeviceNameMatcher matcher = DeviceNameMatcher::Compile(
+        L"  LG ; ; !Monitor;ID: {0.0.0.00000000}.{AVR} ;!id:{0.0.0.00000000}.{LG-MONITOR};OLED");
+
+    CHECK(!matcher.IsEmpty());
+    CHECK(matcher.GetPatternCount() == 3);
+
+    CHECK(matcher.Matches(L"x", L"LG TV (NVIDIA High Definition Audio)"));
+    CHECK(matcher.Matches(L"x", L"lg tv"));
+    CHECK(matcher.Matches(L"x", L"OLED65C1 (NVIDIA High Definition Audio)"));
+    CHECK(!matcher.Matches(L"x", L"Monitor LG 27GL850 (NVIDIA High Definition Audio)"));
+    CHECK(!matcher.Matches(L"x", L"LG ULTRAGEAR MONITOR"));
+    CHECK(!matcher.Matches(L"x", L"Speakers (Realtek(R) Audio)"));
+
+    // IDs compare case-insensitively and win over name patterns.
+    CHECK(matcher.Matches(L"{0.0.0.00000000}.{avr}", L"DENON-AVRHD"));
+    CHECK(!matcher.Matches(L"{0.0.0.00000000}.{LG-Monitor}", L"LG TV"));
+    CHECK(!matcher.Matches(L"{0.0.0.00000000}.{avr}x", L"DENON-AVRHD"));
+}
+
+TEST_CASE(EmptyAndExclusionOnlyHintsMatchNothing)
+{
+    DeviceNameMatcher none;
+    CHECK(none.IsEmpty());
+    CHECK(!none.Matches(L"x", L"LG TV"));
+
+    DeviceNameMatcher blank = DeviceNameMatcher::Compile(L" ; ;; ! ;id:");
+    CHECK(blank.IsEmpty());
+    CHECK(!blank.Matches(L"x", L"LG TV"));
+
+    DeviceNameMatcher excludeOnly = DeviceNameMatcher::Compile(L"!Monitor");
+    CHECK(!excludeOnly.IsEmpty());
+    CHECK(!excludeOnly.Matches(L"x", L"LG TV"));
+
+    DeviceNameMatcher idOnly = DeviceNameMatcher::Compile(L"id:tv");
+    CHECK(idOnly.Matches(L"TV", L"Anything"));
+    CHECK(!idOnly.Matches(L"speakers", L"LG TV"));
+}
+
+TEST_CASE(OverlappingPatternsAreAllFound)
+{
+    // Patterns that overlap must all be reported: in "ushers" the excluded
+    // "she" ends inside the included "hers".
+    DeviceNameMatcher matcher = DeviceNameMatcher::Compile(L"hers;!she");
+    CHECK(!matcher.Matches(L"x", L"ushers-x"));
+    CHECK(matcher.Matches(L"x", L"hhers"));
+
+    DeviceNameMatcher nested = DeviceNameMatcher::Compile(L"abcd;!bc");
+    CHECK(!nested.Matches(L"x", L"abcd"));
+    CHECK(DeviceNameMatcher::Compile(L"abcd;bc").Matches(L"x", L"xbcx"));
+    CHECK(DeviceNameMatcher::Compile(L"aab").Matches(L"x", L"aaab"));
+}
+
+TEST_CASE(MatchesReferenceOnCorpus)
+{
+    const wchar_t* specifications[] =
+    {
+        L"LG",
+        L"LG;!Monitor;!ULTRAGEAR",
+        L"OLED;webOS;LG TV;!soundbar",
+        L"AVR;RECEIVER;denon;marantz;onkyo;yamaha",
+        L"realtek;!digital",
+        L"(NVIDIA High Definition Audio);!LG",
+    };
+
+    for (const wchar_t* specification : specifications)
+    {
+        DeviceNameMatcher matcher = DeviceNameMatcher::Compile(specification);
+
+        ReferenceMatcher reference;
+        std::wstring rest = specification;
+        size_t start = 0;
+        while (start <= rest.size())
+        {
+            size_t separator = std::min(rest.find(L';', start), rest.size());
+            std::wstring entry = rest.substr(start, separator - start);
+            start = separator + 1;
+            if (!entry.empty() && entry[0] == L'!')
+            {
+                reference.excludes.push_back(Fold(entry.substr(1)));
+            }
+            else if (!entry.empty())
+            {
+                reference.includes.push_back(Fold(entry));
+            }
+        }
+
+        for (const std::wstring& name : GetEndpointNameCorpus())
+        {
+            CHECK(matcher.Matches(L"id", name) == reference.Matches(L"id", name));
+        }
+    }
+}
+
+TEST_CASE(MatchesReferenceOnRandomHints)
+{
+    uint32_t state = 0x9E3779B9u;
+    int mismatches = 0;
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        ReferenceMatcher reference;
+        uint32_t includeCount = NextRandom(state) % 5;
+        uint32_t excludeCount = NextRandom(state) % 3;
+        for (uint32_t i = 0; i < includeCount; ++i)
+        {
+            reference.includes.push_back(Fold(RandomText(state, 4)));
+        }
+        for (uint32_t i = 0; i < excludeCount; ++i)
+        {
+            reference.excludes.push_back(Fold(RandomText(state, 4)));
+        }
+        if (NextRandom(state) % 4 == 0)
+        {
+            reference.includedIds.push_back(L"id-a");
+        }
+        if (NextRandom(state) % 4 == 0)
+        {
+            reference.excludedIds.push_back(L"id-b");
+        }
+
+        // Patterns of only spaces are trimmed away by the parser.
+        auto blank = [](const std::wstring& value)
+        {
+            return value.find_first_not_of(L' ') == std::wstring::npos;
+        };
+        reference.includes.erase(std::remove_if(reference.includes.begin(), reference.includes.end(), blank), reference.includes.end());
+        reference.excludes.erase(std::remove_if(reference.excludes.begin(), reference.excludes.end(), blank), reference.excludes.end());
+        for (std::vector<std::wstring>* patterns : { &reference.includes, &reference.excludes })
+        {
+            for (std::wstring& pattern : *patterns)
+            {
+                size_t first = pattern.find_first_not_of(L' ');
+                size_t last = pattern.find_last_not_of(L' ');
+                pattern = pattern.substr(first, last - first + 1);
+            }
+        }
+
+        DeviceNameMatcher matcher = DeviceNameMatcher::Compile(reference.ToSpecification());
+
+        for (int probe = 0; probe < 20; ++probe)
+        {
+            std::wstring name = RandomText(state, 16);
+            const wchar_t* id = (probe % 3 == 0) ? L"ID-A" : ((probe % 3 == 1) ? L"id-b" : L"id-c");
+            if (matcher.Matches(id, name) != reference.Matches(id, name))
+            {
+                if (mismatches++ < 5)
+                {
+                    std::fprintf(stderr, "mismatch: hint \"%ls\" name \"%ls\" id %ls\n",
+                        reference.ToSpecification().c_str(), name.c_str(), id);
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
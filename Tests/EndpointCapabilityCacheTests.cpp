@@ -0,0 +1,333 @@
+#include "TestHarness.h"
+
+#include "EndpointCapabilityCache.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Prober over an in-memory device list that counts every activation.
+    // beforeAtmosProbe runs inside ProbeDolbyAtmos to simulate changes that
+    // race with a probe.
+    class FakeProbe : public IEndpointCapabilityProbe
+    {
+    public:
+        struct Device
+        {
+            std::wstring friendlyName;
+            bool hasFriendlyName = true;
+            bool dolbyAtmos = false;
+        };
+
+        void SetDevice(const std::wstring& endpointId, const Device& device)
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            devices[endpointId] = device;
+        }
+
+        bool ProbeFriendlyName(const std::wstring& endpointId, std::wstring& friendlyName) override
+        {
+            ++nameProbes;
+
+            std::lock_guard<std::mutex> guard(mutex);
+            auto found = devices.find(endpointId);
+            if (found == devices.end() || !found->second.hasFriendlyName)
+            {
+                return false;
+            }
+            friendlyName = found->second.friendlyName;
+            return true;
+        }
+
+        bool ProbeDolbyAtmos(const std::wstring& endpointId) override
+        {
+            ++atmosProbes;
+
+            bool dolbyAtmos = false;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                auto found = devices.find(endpointId);
+                dolbyAtmos = (found != devices.end()) && found->second.dolbyAtmos;
+            }
+
+            if (beforeAtmosProbeReturns)
+            {
+                std::function<void()> hook = std::move(beforeAtmosProbeReturns);
+                beforeAtmosProbeReturns = nullptr;
+                hook();
+            }
+            return dolbyAtmos;
+        }
+
+        std::atomic<uint64_t> nameProbes{ 0 };
+        std::atomic<uint64_t> atmosProbes{ 0 };
+        std::function<void()> beforeAtmosProbeReturns;
+
+    private:
+        std::mutex mutex;
+        std::map<std::wstring, Device> devices;
+    };
+
+    bool MatchesLg(const std::wstring&, const std::wstring& friendlyName)
+    {
+        return friendlyName.find(L"LG") != std::wstring::npos;
+    }
+
+    void AddDefaultDevices(FakeProbe& probe)
+    {
+        probe.SetDevice(L"tv", { L"LG TV", true, true });
+        probe.SetDevice(L"speakers", { L"Speakers", true, false });
+    }
+}
+
+TEST_CASE(KnownEndpointCostsNoProbes)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+
+    EndpointCapabilities first = cache.Lookup(L"tv");
+    CHECK(first.hasFriendlyName);
+    CHECK(first.friendlyName == L"LG TV");
+    CHECK(first.matchesHint);
+    CHECK(first.dolbyAtmosAvailable);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        cache.Lookup(L"speakers");
+        EndpointCapabilities again = cache.Lookup(L"tv");
+        CHECK(again.friendlyName == first.friendlyName);
+        CHECK(again.dolbyAtmosAvailable);
+    }
+
+    CHECK(probe.nameProbes == 2);
+    CHECK(probe.atmosProbes == 1);
+    CHECK(cache.GetMissCount() == 2);
+    CHECK(cache.GetHitCount() == 19);
+}
+
+TEST_CASE(AtmosIsOnlyProbedForMatchingEndpoints)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    probe.SetDevice(L"speakers", { L"Speakers", true, true });
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+
+    EndpointCapabilities speakers = cache.Lookup(L"speakers");
+    CHECK(!speakers.matchesHint);
+    CHECK(!speakers.dolbyAtmosAvailable);
+    CHECK(probe.atmosProbes == 0);
+}
+
+TEST_CASE(MissingFriendlyNameNeverMatchesAndIsCached)
+{
+    FakeProbe probe;
+    probe.SetDevice(L"unnamed", { L"LG TV", false, true });
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher([](const std::wstring&, const std::wstring&) { return true; });
+
+    EndpointCapabilities result = cache.Lookup(L"unnamed");
+    CHECK(!result.hasFriendlyName);
+    CHECK(result.friendlyName.empty());
+    CHECK(!result.matchesHint);
+
+    cache.Lookup(L"unnamed");
+    CHECK(probe.nameProbes == 1);
+    CHECK(probe.atmosProbes == 0);
+}
+
+TEST_CASE(FriendlyNameChangeReprobesOnlyTheName)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+    cache.Lookup(L"tv");
+
+    probe.SetDevice(L"tv", { L"Living Room", true, true });
+    CHECK(cache.InvalidateProperty(L"tv", EndpointPropertyChange::FriendlyName));
+    CHECK(!cache.InvalidateProperty(L"tv", EndpointPropertyChange::FriendlyName));
+
+    EndpointCapabilities renamed = cache.Lookup(L"tv");
+    CHECK(renamed.friendlyName == L"Living Room");
+    CHECK(!renamed.matchesHint);
+    CHECK(!renamed.dolbyAtmosAvailable);
+    CHECK(probe.nameProbes == 2);
+    CHECK(probe.atmosProbes == 1);
+
+    // Matching again uses the Atmos result that stayed cached.
+    probe.SetDevice(L"tv", { L"LG TV", true, true });
+    CHECK(cache.InvalidateProperty(L"tv", EndpointPropertyChange::FriendlyName));
+    CHECK(cache.Lookup(L"tv").dolbyAtmosAvailable);
+    CHECK(probe.nameProbes == 3);
+    CHECK(probe.atmosProbes == 1);
+    CHECK(cache.GetInvalidationCount() == 2);
+}
+
+TEST_CASE(FormatChangeReprobesOnlyAtmos)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+    cache.Lookup(L"tv");
+
+    probe.SetDevice(L"tv", { L"LG TV", true, false });
+    CHECK(cache.InvalidateProperty(L"tv", EndpointPropertyChange::Format));
+    CHECK(!cache.Lookup(L"tv").dolbyAtmosAvailable);
+    CHECK(probe.nameProbes == 1);
+    CHECK(probe.atmosProbes == 2);
+
+    // Nothing is dropped for an endpoint that is not cached, or for a format
+    // change on an endpoint whose Atmos state was never probed.
+    cache.Lookup(L"speakers");
+    CHECK(!cache.InvalidateProperty(L"unknown", EndpointPropertyChange::Format));
+    CHECK(!cache.InvalidateProperty(L"speakers", EndpointPropertyChange::Format));
+    CHECK(cache.GetInvalidationCount() == 1);
+}
+
+TEST_CASE(EndpointInvalidationDropsEverything)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+    cache.Lookup(L"tv");
+    cache.Lookup(L"speakers");
+
+    CHECK(cache.InvalidateEndpoint(L"tv"));
+    CHECK(!cache.InvalidateEndpoint(L"tv"));
+    cache.Lookup(L"tv");
+    CHECK(probe.nameProbes == 3);
+    CHECK(probe.atmosProbes == 2);
+
+    cache.Clear();
+    CHECK(cache.GetInvalidationCount() == 3);
+    cache.Lookup(L"speakers");
+    CHECK(probe.nameProbes == 4);
+}
+
+TEST_CASE(NewHintMatcherReusesCachedProbes)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+    cache.Lookup(L"tv");
+    cache.Lookup(L"speakers");
+
+    cache.SetHintMatcher([](const std::wstring&, const std::wstring& friendlyName)
+    {
+        return friendlyName == L"Speakers";
+    });
+    CHECK(!cache.Lookup(L"tv").matchesHint);
+    CHECK(cache.Lookup(L"speakers").matchesHint);
+    CHECK(probe.nameProbes == 2);
+    CHECK(probe.atmosProbes == 2);
+
+    // Without a matcher nothing matches.
+    cache.SetHintMatcher(nullptr);
+    CHECK(!cache.Lookup(L"speakers").matchesHint);
+}
+
+TEST_CASE(InvalidationDuringProbeDiscardsStaleResult)
+{
+    FakeProbe probe;
+    AddDefaultDevices(probe);
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+
+    // The format changes while the Atmos probe is still running.
+    probe.beforeAtmosProbeReturns = [&]()
+    {
+        probe.SetDevice(L"tv", { L"LG TV", true, false });
+        cache.InvalidateProperty(L"tv", EndpointPropertyChange::Format);
+    };
+    CHECK(cache.Lookup(L"tv").dolbyAtmosAvailable);
+
+    CHECK(!cache.Lookup(L"tv").dolbyAtmosAvailable);
+    CHECK(probe.atmosProbes == 2);
+
+    // The same holds for a matcher replaced mid-probe.
+    cache.InvalidateProperty(L"tv", EndpointPropertyChange::Format);
+    probe.beforeAtmosProbeReturns = [&]()
+    {
+        cache.SetHintMatcher([](const std::wstring&, const std::wstring&) { return false; });
+    };
+    CHECK(cache.Lookup(L"tv").matchesHint);
+    CHECK(!cache.Lookup(L"tv").matchesHint);
+}
+
+TEST_CASE(ConcurrentLookupsAndInvalidationsConverge)
+{
+    FakeProbe probe;
+    const std::wstring endpointIds[] = { L"tv", L"speakers", L"headphones", L"avr" };
+    probe.SetDevice(L"tv", { L"LG TV", true, true });
+    probe.SetDevice(L"speakers", { L"Speakers", true, false });
+    probe.SetDevice(L"headphones", { L"LG Headphones", true, false });
+    probe.SetDevice(L"avr", { L"AVR", true, true });
+
+    EndpointCapabilityCache cache(probe);
+    cache.SetHintMatcher(MatchesLg);
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (uint32_t i = 0; !stop.load(); ++i)
+            {
+                cache.Lookup(endpointIds[(i + t) % 4]);
+            }
+        });
+    }
+    threads.emplace_back([&]()
+    {
+        for (uint32_t i = 0; !stop.load(); ++i)
+        {
+            const std::wstring& endpointId = endpointIds[i % 4];
+            switch (i % 3)
+            {
+            case 0:
+                cache.InvalidateProperty(endpointId, EndpointPropertyChange::FriendlyName);
+                break;
+            case 1:
+                cache.InvalidateProperty(endpointId, EndpointPropertyChange::Format);
+                break;
+            default:
+                cache.InvalidateEndpoint(endpointId);
+                break;
+            }
+        }
+    });
+
+    // Flip the TV's Atmos state while the cache is hammered; the last state
+    // must win once everything has settled.
+    for (int i = 0; i < 200; ++i)
+    {
+        probe.SetDevice(L"tv", { L"LG TV", true, (i % 2) == 0 });
+        cache.InvalidateProperty(L"tv", EndpointPropertyChange::Format);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    probe.SetDevice(L"tv", { L"LG TV", true, false });
+    cache.InvalidateProperty(L"tv", EndpointPropertyChange::Format);
+
+    stop = true;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(!cache.Lookup(L"tv").dolbyAtmosAvailable);
+    CHECK(cache.Lookup(L"tv").matchesHint);
+    CHECK(cache.Lookup(L"headphones").matchesHint);
+    CHECK(!cache.Lookup(L"avr").matchesHint);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Friendly names of real audio endpoints, as Windows reports them, shared by
+// the device name matcher test and benchmark.
+inline const std::vector<std::wstring>& GetEndpointNameCorpus()
+{
+    static const std::vector<std::wstring> corpus =
+    {
+        L"LG TV SSCR2 (NVIDIA High Definition Audio)",
+        L"LG TV (NVIDIA High Definition Audio)",
+        L"LG ULTRAGEAR (NVIDIA High Definition Audio)",
+        L"LG HDR 4K (AMD High Definition Audio Device)",
+        L"OLED65C1 (NVIDIA High Definition Audio)",
+        L"[LG] webOS TV OLED55C2 (Intel(R) Display Audio)",
+        L"LG SOUNDBAR S95QR (NVIDIA High Definition Audio)",
+        L"SONY TV *00 (NVIDIA High Definition Audio)",
+        L"SAMSUNG (NVIDIA High Definition Audio)",
+        L"DENON-AVRHD (NVIDIA High Definition Audio)",
+        L"YAMAHA AV RECEIVER (AMD High Definition Audio Device)",
+        L"ONKYO AVR (Intel(R) Display Audio)",
+        L"Marantz AVR (NVIDIA High Definition Audio)",
+        L"Speakers (Realtek(R) Audio)",
+        L"Speakers (Realtek High Definition Audio)",
+        L"Headphones (Realtek(R) Audio)",
+        L"Realtek Digital Output (Realtek(R) Audio)",
+        L"Digital Audio (S/PDIF) (High Definition Audio Device)",
+        L"Speakers (2- USB Audio Device)",
+        L"Headset Earphone (HyperX Cloud Flight Wireless Headset)",
+        L"Headphones (WH-1000XM4 Stereo)",
+        L"Headset (WH-1000XM4 Hands-Free AG Audio)",
+        L"Speakers (Steam Streaming Speakers)",
+        L"Speakers (Steam Streaming Microphone)",
+        L"CABLE Input (VB-Audio Virtual Cable)",
+        L"VoiceMeeter Input (VB-Audio VoiceMeeter VAIO)",
+        L"Speakers (NVIDIA Broadcast)",
+        L"DELL U2720Q (NVIDIA High Definition Audio)",
+        L"Acer XB271HU (NVIDIA High Definition Audio)",
+        L"Monitor LG 27GL850 (NVIDIA High Definition Audio)",
+        L"Speakers (Logitech G935 Gaming Headset)",
+        L"Speakers (Razer Nari Ultimate)",
+        L"Speakers (SteelSeries Arctis 7 Game)",
+        L"Speakers (Focusrite USB Audio)",
+        L"Line (Elgato Wave:3)",
+        L"Kopfhörer (Realtek(R) Audio)",
+        L"Lautsprecher (Realtek(R) Audio)",
+        L"Haut-parleurs (Realtek(R) Audio)",
+        L"Altavoces (Realtek(R) Audio)",
+        L"\x30B9\x30D4\x30FC\x30AB\x30FC (Realtek(R) Audio)",
+    };
+    return corpus;
+}
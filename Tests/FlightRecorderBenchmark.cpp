@@ -0,0 +1,26 @@
+#include "BenchmarkHarness.h"
+
+#include "FlightRecorder.h"
+
+// Measures recording an event, which every key press, TV message and error
+// pays, and taking the snapshot an error dump starts with.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 50000000;
+
+    FlightRecorder recorder;
+    BenchmarkHarness::Measure("Record", iterations, [&](uint64_t i)
+    {
+        recorder.Record(FlightEventType::TvSend, static_cast<int64_t>(i), 1);
+    });
+
+    size_t events = 0;
+    BenchmarkHarness::Measure("Snapshot, full ring", quick ? 100 : 10000, [&](uint64_t)
+    {
+        events += recorder.Snapshot(FlightRecorder::Clock::time_point{}).size();
+    });
+    BenchmarkHarness::DoNotOptimize(events);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "TestHarness.h"
+
+#include "FlightRecorder.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    const FlightRecorder::Clock::time_point Always{};
+}
+
+TEST_CASE(SnapshotReturnsEventsOldestFirst)
+{
+    FlightRecorder recorder(16);
+    recorder.Record(FlightEventType::KeyEvent, 0, 1);
+    recorder.Record(FlightEventType::TvAction, 0, 5);
+    recorder.Record(FlightEventType::TvActionResult, 0, 1);
+
+    std::vector<FlightEvent> events = recorder.Snapshot(Always);
+    REQUIRE(events.size() == 3);
+    CHECK(events[0].type == FlightEventType::KeyEvent);
+    CHECK(events[1].type == FlightEventType::TvAction);
+    CHECK(events[1].second == 5);
+    CHECK(events[2].type == FlightEventType::TvActionResult);
+    CHECK(events[0].timestamp <= events[1].timestamp);
+    CHECK(events[1].timestamp <= events[2].timestamp);
+    CHECK(events[0].threadId == events[2].threadId);
+    CHECK(recorder.GetRecordedCount() == 3);
+}
+
+TEST_CASE(RingKeepsNewestEvents)
+{
+    // 10 rounds up to 16.
+    FlightRecorder recorder(10);
+    for (int64_t index = 0; index < 100; ++index)
+    {
+        recorder.Record(FlightEventType::TvSend, index, 1);
+    }
+
+    std::vector<FlightEvent> events = recorder.Snapshot(Always);
+    REQUIRE(events.size() == 16);
+    for (size_t index = 0; index < events.size(); ++index)
+    {
+        CHECK(events[index].first == static_cast<int64_t>(84 + index));
+    }
+}
+
+TEST_CASE(SnapshotSkipsEventsBeforeSince)
+{
+    FlightRecorder recorder(64);
+    recorder.Record(FlightEventType::TvConnect, 0);
+    std::this_thread::sleep_for(5ms);
+    auto since = FlightRecorder::Clock::now();
+    recorder.Record(FlightEventType::TvConnect, 1);
+
+    std::vector<FlightEvent> events = recorder.Snapshot(since);
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].first == 1);
+    CHECK(recorder.Snapshot(FlightRecorder::Clock::now() + 1s).empty());
+}
+
+TEST_CASE(FormatNamesEventsAndArguments)
+{
+    FlightRecorder recorder(16);
+    recorder.Record(FlightEventType::KeyEvent, 1, 1);
+    recorder.Record(FlightEventType::TvDisconnect);
+    recorder.Record(FlightEventType::Error, 17);
+
+    std::vector<FlightEvent> events = recorder.Snapshot(Always);
+    REQUIRE(events.size() == 3);
+
+    // Times are relative to the dump; pin them for the comparison.
+    auto now = FlightRecorder::Clock::time_point(std::chrono::nanoseconds(events[2].timestamp) + 1500ms);
+    events[0].timestamp = events[2].timestamp - 250000000;
+    events[1].timestamp = events[2].timestamp;
+
+    std::string thread = "T" + std::to_string(events[0].threadId);
+    CHECK(FlightRecorder::Format(events, now) ==
+        "-1.750000s " + thread + " KeyEvent action=1 toTv=1\n"
+        "-1.500000s " + thread + " TvDisconnect\n"
+        "-1.500000s " + thread + " Error site=17\n");
+
+    CHECK(std::string(GetFlightEventName(FlightEventType::DefaultEndpoint)) == "DefaultEndpoint");
+    CHECK(std::string(GetFlightEventName(FlightEventType::Count)) == "Unknown");
+}
+
+TEST_CASE(SnapshotWhileThreadsRecordHasNoTornEvents)
+{
+    FlightRecorder recorder(256);
+    std::atomic<bool> stop{ false };
+
+    // second is always twice first, so an event mixed from two writes
+    // stands out; first counts up per thread.
+    std::vector<std::thread> recorders;
+    for (int thread = 0; thread < 3; ++thread)
+    {
+        recorders.emplace_back([&]()
+            {
+                for (int64_t index = 0; !stop.load(); ++index)
+                {
+                    recorder.Record(FlightEventType::TvSend, index, index * 2);
+                }
+            });
+    }
+
+    CHECK(TestHarness::WaitUntil([&]() { return recorder.GetRecordedCount() > 1000; }));
+
+    size_t total = 0;
+    size_t torn = 0;
+    size_t reordered = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        std::map<uint32_t, int64_t> lastByThread;
+        for (const FlightEvent& event : recorder.Snapshot(Always))
+        {
+            ++total;
+            if (event.type != FlightEventType::TvSend || event.second != event.first * 2)
+            {
+                ++torn;
+            }
+
+            auto last = lastByThread.find(event.threadId);
+            if (last != lastByThread.end() && event.first <= last->second)
+            {
+                ++reordered;
+            }
+            lastByThread[event.threadId] = event.first;
+        }
+    }
+
+    stop.store(true);
+    for (std::thread& thread : recorders)
+    {
+        thread.join();
+    }
+
+    CHECK(total > 0);
+    CHECK(torn == 0);
+    CHECK(reordered == 0);
+}
@@ -0,0 +1,47 @@
+#include "BenchmarkHarness.h"
+
+#include "HotkeyMap.h"
+
+#include <vector>
+
+// Measures the per-keystroke lookup with the default bindings and with every
+// chord bound, over random keys so the table does not stay in one cache line.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 100000000;
+
+    std::vector<uint16_t> chords(4096);
+    uint32_t state = 0x12345678;
+    for (uint16_t& chord : chords)
+    {
+        state = state * 1664525 + 1013904223;
+        chord = static_cast<uint16_t>(state >> 20);
+    }
+
+    HotkeyMap defaultMap = HotkeyMap::CreateDefault();
+    HotkeyMap fullMap;
+    for (uint32_t key = 1; key < 0xFF; ++key)
+    {
+        for (uint8_t modifiers = 0; modifiers < HotkeyMap::ModifierCombinations; ++modifiers)
+        {
+            fullMap.Bind(static_cast<uint8_t>(key), modifiers, false, true, HotkeyTarget{ TvVolumeAction::VolumeUp, 1 });
+        }
+    }
+
+    uint32_t found = 0;
+    BenchmarkHarness::Measure("Find, default bindings", iterations, [&](uint64_t i)
+    {
+        uint16_t chord = chords[i & 4095];
+        found += defaultMap.Find(static_cast<uint8_t>(chord >> 4), static_cast<uint8_t>(chord & 0xF)) != nullptr;
+    });
+
+    BenchmarkHarness::Measure("Find, all chords bound", iterations, [&](uint64_t i)
+    {
+        uint16_t chord = chords[i & 4095];
+        found += fullMap.Find(static_cast<uint8_t>(chord >> 4), static_cast<uint8_t>(chord & 0xF)) != nullptr;
+    });
+    BenchmarkHarness::DoNotOptimize(found);
+
+    return 0;
+}
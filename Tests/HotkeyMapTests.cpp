@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "HotkeyMap.h"
+
+namespace
+{
+    constexpr uint8_t KeyUp = 0x26;
+    constexpr uint8_t KeyDown = 0x28;
+    constexpr uint8_t KeyF13 = 0x7C;
+    constexpr uint8_t KeyControlLeft = 0xA2;
+    constexpr uint8_t KeyControlRight = 0xA3;
+    constexpr uint8_t KeyAltRight = 0xA5;
+    constexpr uint8_t KeyVolumeMute = 0xAD;
+    constexpr uint8_t KeyVolumeDown = 0xAE;
+    constexpr uint8_t KeyVolumeUp = 0xAF;
+
+    constexpr uint8_t ControlAlt = HotkeyModifierControl | HotkeyModifierAlt;
+
+    bool Targets(const HotkeyTarget* target, TvVolumeAction action, int value)
+    {
+        return target != nullptr && target->action == action && target->value == value;
+    }
+}
+
+TEST_CASE(DefaultMapBindsVolumeKeysWithAnyModifiers)
+{
+    HotkeyMap map = HotkeyMap::CreateDefault();
+    CHECK(map.GetBoundCount() == 3 * HotkeyMap::ModifierCombinations);
+
+    for (uint8_t modifiers = 0; modifiers < HotkeyMap::ModifierCombinations; ++modifiers)
+    {
+        CHECK(Targets(map.Find(KeyVolumeUp, modifiers), TvVolumeAction::VolumeUp, 1));
+        CHECK(Targets(map.Find(KeyVolumeDown, modifiers), TvVolumeAction::VolumeDown, 1));
+        CHECK(Targets(map.Find(KeyVolumeMute, modifiers), TvVolumeAction::ToggleMute, 1));
+        CHECK(map.Find(KeyUp, modifiers) == nullptr);
+    }
+    CHECK(HotkeyMap().GetBoundCount() == 0);
+}
+
+TEST_CASE(ParsesDocumentedBindings)
+{
+    HotkeyMap map;
+    CHECK(map.AddBinding(L"Ctrl+Alt+Up:up 5"));
+    CHECK(map.AddBinding(L"ctrl + alt + down : down 5"));
+    CHECK(map.AddBinding(L"F13:set 30"));
+    CHECK(map.AddBinding(L"Shift+0x7C:set 0"));
+    CHECK(map.AddBinding(L"Win+M:mute"));
+    CHECK(map.AddBinding(L"Control+F24:down"));
+
+    CHECK(Targets(map.Find(KeyUp, ControlAlt), TvVolumeAction::VolumeUp, 5));
+    CHECK(Targets(map.Find(KeyDown, ControlAlt), TvVolumeAction::VolumeDown, 5));
+    CHECK(Targets(map.Find(KeyF13, HotkeyModifierNone), TvVolumeAction::SetVolume, 30));
+    CHECK(Targets(map.Find(KeyF13, HotkeyModifierShift), TvVolumeAction::SetVolume, 0));
+    CHECK(Targets(map.Find('M', HotkeyModifierWin), TvVolumeAction::ToggleMute, 1));
+    CHECK(Targets(map.Find(0x87, HotkeyModifierControl), TvVolumeAction::VolumeDown, 1));
+
+    // A chord with modifiers matches only those modifiers.
+    CHECK(map.Find(KeyUp, HotkeyModifierNone) == nullptr);
+    CHECK(map.Find(KeyUp, HotkeyModifierControl) == nullptr);
+    CHECK(map.Find('M', HotkeyModifierNone) == nullptr);
+}
+
+TEST_CASE(RejectsMalformedBindingsWithoutChangingMap)
+{
+    const wchar_t* malformed[] =
+    {
+        L"", L"Up", L":up", L"Up:", L"Up:sideways", L"Up:up 0", L"Up:up 101", L"Up:up x",
+        L"Up:set", L"Up:set 101", L"Up:set -1", L"Up:mute 2", L"Up:none 1", L"Hyper+Up:up",
+        L"Ctrl+:up", L"F0:up", L"F25:up", L"0x0:up", L"0xFF:up", L"Ctrl+Alt:up", L"NoSuchKey:up",
+    };
+
+    HotkeyMap map = HotkeyMap::CreateDefault();
+    for (const wchar_t* binding : malformed)
+    {
+        CHECK(!map.AddBinding(binding));
+    }
+    CHECK(map.GetBoundCount() == 3 * HotkeyMap::ModifierCombinations);
+    CHECK(Targets(map.Find(KeyVolumeUp, HotkeyModifierShift), TvVolumeAction::VolumeUp, 1));
+}
+
+TEST_CASE(SpecificChordWinsOverModifierlessBinding)
+{
+    HotkeyMap map;
+    CHECK(map.AddBinding(L"Ctrl+Up:up 5"));
+    CHECK(map.AddBinding(L"Up:down"));
+
+    // The later modifier-less binding fills every combination except the
+    // one bound explicitly, whichever order they were added in.
+    CHECK(Targets(map.Find(KeyUp, HotkeyModifierControl), TvVolumeAction::VolumeUp, 5));
+    CHECK(Targets(map.Find(KeyUp, HotkeyModifierNone), TvVolumeAction::VolumeDown, 1));
+    CHECK(Targets(map.Find(KeyUp, ControlAlt), TvVolumeAction::VolumeDown, 1));
+
+    HotkeyMap reversed;
+    CHECK(reversed.AddBinding(L"Up:down"));
+    CHECK(reversed.AddBinding(L"Ctrl+Up:up 5"));
+    CHECK(Targets(reversed.Find(KeyUp, HotkeyModifierControl), TvVolumeAction::VolumeUp, 5));
+    CHECK(Targets(reversed.Find(KeyUp, HotkeyModifierShift), TvVolumeAction::VolumeDown, 1));
+}
+
+TEST_CASE(NoneUnbindsDefaultKeys)
+{
+    HotkeyMap map = HotkeyMap::CreateDefault();
+    CHECK(map.AddBinding(L"Ctrl+VolumeUp:up 5"));
+    CHECK(map.AddBinding(L"VolumeUp:none"));
+
+    CHECK(map.Find(KeyVolumeUp, HotkeyModifierNone) == nullptr);
+    CHECK(map.Find(KeyVolumeUp, HotkeyModifierShift) == nullptr);
+    CHECK(Targets(map.Find(KeyVolumeUp, HotkeyModifierControl), TvVolumeAction::VolumeUp, 5));
+
+    CHECK(map.AddBinding(L"Ctrl+VolumeUp:none"));
+    CHECK(map.Find(KeyVolumeUp, HotkeyModifierControl) == nullptr);
+    CHECK(map.GetBoundCount() == 2 * HotkeyMap::ModifierCombinations);
+}
+
+TEST_CASE(ModifierKeysFoldLeftAndRight)
+{
+    uint8_t held = 0;
+    held |= HotkeyMap::GetModifierKeyBit(KeyControlLeft);
+    held |= HotkeyMap::GetModifierKeyBit(KeyControlRight);
+    held |= HotkeyMap::GetModifierKeyBit(KeyAltRight);
+    CHECK(HotkeyMap::FoldModifierKeys(held) == ControlAlt);
+
+    // Releasing one Ctrl key keeps the other one held.
+    held &= static_cast<uint8_t>(~HotkeyMap::GetModifierKeyBit(KeyControlLeft));
+    CHECK(HotkeyMap::FoldModifierKeys(held) == ControlAlt);
+
+    held &= static_cast<uint8_t>(~HotkeyMap::GetModifierKeyBit(KeyControlRight));
+    CHECK(HotkeyMap::FoldModifierKeys(held) == HotkeyModifierAlt);
+
+    CHECK(HotkeyMap::GetModifierKeyBit(KeyUp) == 0);
+    CHECK(HotkeyMap::GetModifierKeyBit(KeyVolumeUp) == 0);
+}
@@ -0,0 +1,145 @@
+#include "TestHarness.h"
+
+#include "InputHookController.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    // Records install and uninstall calls and refuses installs on request.
+    class FakeHookBackend : public IInputHookBackend
+    {
+    public:
+        bool Install() override
+        {
+            ++installCalls;
+            if (failInstalls > 0)
+            {
+                --failInstalls;
+                return false;
+            }
+            CHECK(!installed);
+            installed = true;
+            return true;
+        }
+
+        void Uninstall() override
+        {
+            ++uninstallCalls;
+            CHECK(installed);
+            installed = false;
+        }
+
+        bool installed = false;
+        int installCalls = 0;
+        int uninstallCalls = 0;
+        int failInstalls = 0;
+    };
+}
+
+TEST_CASE(InstallsOnlyWhileRoutedToTv)
+{
+    FakeHookBackend backend;
+    InputHookController controller(backend);
+    CHECK(!controller.IsInstalled());
+
+    controller.Update(false);
+    CHECK(backend.installCalls == 0);
+
+    controller.Update(true);
+    CHECK(controller.IsInstalled());
+    CHECK(backend.installed);
+
+    controller.Update(false);
+    CHECK(!controller.IsInstalled());
+    CHECK(!backend.installed);
+
+    controller.Update(true);
+    CHECK(backend.installed);
+    CHECK(controller.GetInstallCount() == 2);
+    CHECK(controller.GetUninstallCount() == 1);
+}
+
+TEST_CASE(RepeatedUpdatesDoNotTouchTheHook)
+{
+    FakeHookBackend backend;
+    InputHookController controller(backend);
+
+    for (int index = 0; index < 100; ++index)
+    {
+        controller.Update(true);
+    }
+    CHECK(backend.installCalls == 1);
+
+    for (int index = 0; index < 100; ++index)
+    {
+        controller.Update(false);
+    }
+    CHECK(backend.uninstallCalls == 1);
+}
+
+TEST_CASE(FailedInstallIsRetriedOnNextUpdate)
+{
+    FakeHookBackend backend;
+    backend.failInstalls = 2;
+    InputHookController controller(backend);
+
+    controller.Update(true);
+    CHECK(!controller.IsInstalled());
+    controller.Update(true);
+    CHECK(!controller.IsInstalled());
+    controller.Update(true);
+    CHECK(controller.IsInstalled());
+
+    CHECK(backend.installCalls == 3);
+    CHECK(controller.GetInstallFailureCount() == 2);
+    CHECK(controller.GetInstallCount() == 1);
+
+    // Nothing was installed by the failed attempts, so there is nothing to
+    // remove when routing turns off before an install succeeds.
+    FakeHookBackend refusing;
+    refusing.failInstalls = 1;
+    InputHookController other(refusing);
+    other.Update(true);
+    other.Update(false);
+    CHECK(refusing.uninstallCalls == 0);
+}
+
+TEST_CASE(ShutdownRemovesTheHookOnce)
+{
+    FakeHookBackend backend;
+    InputHookController controller(backend);
+
+    controller.Shutdown();
+    CHECK(backend.uninstallCalls == 0);
+
+    controller.Update(true);
+    controller.Shutdown();
+    controller.Shutdown();
+    CHECK(backend.uninstallCalls == 1);
+    CHECK(!backend.installed);
+}
+
+TEST_CASE(InstalledTimeCoversEachInstallation)
+{
+    FakeHookBackend backend;
+    InputHookController controller(backend);
+    CHECK(controller.GetInstalledTime() == InputHookController::Clock::duration::zero());
+
+    controller.Update(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    controller.Update(false);
+
+    auto firstTime = controller.GetInstalledTime();
+    CHECK(firstTime >= std::chrono::milliseconds(20));
+
+    // Time spent uninstalled does not count.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(controller.GetInstalledTime() == firstTime);
+
+    // The current installation counts while it lasts.
+    controller.Update(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(controller.GetInstalledTime() >= firstTime + std::chrono::milliseconds(20));
+}
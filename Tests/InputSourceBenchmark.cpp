@@ -0,0 +1,109 @@
+#include "BenchmarkHarness.h"
+
+#include "EvdevInputSource.h"
+#include "InputThread.h"
+#include "SyntheticInputSource.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    class CountingSink : public IInputEventSink
+    {
+    public:
+        bool OnTvVolumeEvent(const TvVolumeEvent&) override
+        {
+            count.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+
+        std::atomic<uint64_t> count{ 0 };
+    };
+}
+
+// Measures the input layer without keyboard hardware: synthetic events
+// through an InputThread, and on Linux the round trip from writing an
+// input_event to a FIFO until the evdev source delivers it.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+
+    {
+        uint64_t events = quick ? 10000 : 10000000;
+        CountingSink sink;
+        SyntheticInputSource source(
+            sink,
+            { TvVolumeAction::VolumeUp, TvVolumeAction::VolumeDown, TvVolumeAction::ToggleMute },
+            events);
+
+        auto start = std::chrono::steady_clock::now();
+        InputThread thread;
+        thread.Start(source);
+        while (sink.count.load(std::memory_order_acquire) < events)
+        {
+            std::this_thread::yield();
+        }
+        thread.Stop();
+        double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-40s %12llu iterations %12.1f ns/op\n",
+            "synthetic event to sink",
+            static_cast<unsigned long long>(events),
+            nanoseconds / static_cast<double>(events));
+    }
+
+#ifdef __linux__
+    {
+        char pattern[] = "/tmp/lgtv-input-bench-XXXXXX";
+        if (!mkdtemp(pattern))
+        {
+            return 1;
+        }
+        std::string directory = pattern;
+        std::string path = directory + "/event0";
+        if (mkfifo(path.c_str(), 0600) != 0)
+        {
+            rmdir(directory.c_str());
+            return 1;
+        }
+
+        CountingSink sink;
+        EvdevInputSource source(sink, nullptr);
+        source.AddDevice(path);
+        int writer = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+
+        InputThread thread;
+        thread.Start(source);
+
+        input_event event{};
+        event.type = EV_KEY;
+        event.code = KEY_VOLUMEUP;
+        event.value = 1;
+
+        BenchmarkHarness::Measure("FIFO write to evdev delivery", quick ? 1000 : 200000, [&](uint64_t i)
+        {
+            ssize_t written = write(writer, &event, sizeof(event));
+            (void)written;
+            while (sink.count.load(std::memory_order_acquire) <= i)
+            {
+            }
+        });
+
+        thread.Stop();
+        close(writer);
+        unlink(path.c_str());
+        rmdir(directory.c_str());
+    }
+#endif
+
+    return 0;
+}
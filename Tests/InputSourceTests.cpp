@@ -0,0 +1,337 @@
+#include "TestHarness.h"
+
+#include "EvdevInputSource.h"
+#include "InputThread.h"
+#include "SyntheticInputSource.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Collects every event it receives; returns consume for each.
+    class RecordingSink : public IInputEventSink
+    {
+    public:
+        explicit RecordingSink(bool consumeValue = true)
+            : consume(consumeValue)
+        {
+        }
+
+        bool OnTvVolumeEvent(const TvVolumeEvent& event) override
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            events.push_back(event);
+            return consume;
+        }
+
+        std::vector<TvVolumeEvent> GetEvents()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return events;
+        }
+
+        size_t GetCount()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            return events.size();
+        }
+
+    private:
+        bool consume;
+        std::mutex mutex;
+        std::vector<TvVolumeEvent> events;
+    };
+
+#ifdef __linux__
+    // A temporary directory with a FIFO standing in for an evdev node. The
+    // source reads it as a raw stream of input_event records.
+    class FakeInputDevice
+    {
+    public:
+        FakeInputDevice()
+        {
+            char pattern[] = "/tmp/lgtv-input-XXXXXX";
+            if (mkdtemp(pattern))
+            {
+                directory = pattern;
+                path = directory + "/event0";
+                if (mkfifo(path.c_str(), 0600) != 0)
+                {
+                    path.clear();
+                }
+            }
+        }
+
+        ~FakeInputDevice()
+        {
+            CloseWriter();
+            if (!path.empty())
+            {
+                unlink(path.c_str());
+            }
+            if (!directory.empty())
+            {
+                rmdir(directory.c_str());
+            }
+        }
+
+        // Opens the writing end; the source must already hold the reading end.
+        bool OpenWriter()
+        {
+            writer = open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            return writer >= 0;
+        }
+
+        void CloseWriter()
+        {
+            if (writer >= 0)
+            {
+                close(writer);
+                writer = -1;
+            }
+        }
+
+        bool WriteBytes(const void* data, size_t size)
+        {
+            return write(writer, data, size) == static_cast<ssize_t>(size);
+        }
+
+        bool WriteEvent(uint16_t type, uint16_t code, int32_t value)
+        {
+            input_event event{};
+            event.type = type;
+            event.code = code;
+            event.value = value;
+            return WriteBytes(&event, sizeof(event));
+        }
+
+        std::string directory;
+        std::string path;
+
+    private:
+        int writer = -1;
+    };
+#endif
+}
+
+#ifdef __linux__
+
+TEST_CASE(EvdevReadsVolumeKeysFromFakeDevice)
+{
+    FakeInputDevice device;
+    REQUIRE(!device.path.empty());
+
+    RecordingSink sink;
+    EvdevInputSource source(sink, nullptr);
+    REQUIRE(source.AddDevice(device.path));
+    CHECK(source.GetDeviceCount() == 1);
+    REQUIRE(device.OpenWriter());
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+
+    auto before = std::chrono::steady_clock::now();
+
+    // Presses and autorepeats of the volume keys count; releases, repeats of
+    // mute, other keys and non-key events do not.
+    CHECK(device.WriteEvent(EV_KEY, KEY_VOLUMEUP, 1));
+    CHECK(device.WriteEvent(EV_SYN, SYN_REPORT, 0));
+    CHECK(device.WriteEvent(EV_KEY, KEY_VOLUMEUP, 2));
+    CHECK(device.WriteEvent(EV_KEY, KEY_VOLUMEUP, 0));
+    CHECK(device.WriteEvent(EV_KEY, KEY_VOLUMEDOWN, 1));
+    CHECK(device.WriteEvent(EV_KEY, KEY_A, 1));
+    CHECK(device.WriteEvent(EV_MSC, MSC_SCAN, KEY_MUTE));
+    CHECK(device.WriteEvent(EV_KEY, KEY_MUTE, 1));
+    CHECK(device.WriteEvent(EV_KEY, KEY_MUTE, 2));
+    CHECK(device.WriteEvent(EV_KEY, KEY_MUTE, 0));
+
+    REQUIRE(TestHarness::WaitUntil([&]() { return sink.GetCount() == 4; }));
+    std::vector<TvVolumeEvent> events = sink.GetEvents();
+    CHECK(events[0].action == TvVolumeAction::VolumeUp);
+    CHECK(events[1].action == TvVolumeAction::VolumeUp);
+    CHECK(events[2].action == TvVolumeAction::VolumeDown);
+    CHECK(events[3].action == TvVolumeAction::ToggleMute);
+    for (const TvVolumeEvent& event : events)
+    {
+        CHECK(event.value == 1);
+        CHECK(event.timestamp >= before);
+        CHECK(event.timestamp <= std::chrono::steady_clock::now());
+    }
+    CHECK(source.GetEventCount() == 4);
+
+    thread.Stop();
+    CHECK(!thread.IsRunning());
+}
+
+TEST_CASE(EvdevReassemblesRecordsSplitAcrossReads)
+{
+    FakeInputDevice device;
+    REQUIRE(!device.path.empty());
+
+    RecordingSink sink;
+    EvdevInputSource source(sink, nullptr);
+    REQUIRE(source.AddDevice(device.path));
+    REQUIRE(device.OpenWriter());
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+
+    input_event records[2] = {};
+    records[0].type = EV_KEY;
+    records[0].code = KEY_VOLUMEDOWN;
+    records[0].value = 1;
+    records[1].type = EV_KEY;
+    records[1].code = KEY_MUTE;
+    records[1].value = 1;
+
+    // Split the two records at odd offsets so each read ends mid-record.
+    const char* bytes = reinterpret_cast<const char*>(records);
+    size_t cuts[] = { 0, 3, sizeof(input_event) + 5, sizeof(records) };
+    for (size_t index = 0; index + 1 < sizeof(cuts) / sizeof(cuts[0]); ++index)
+    {
+        CHECK(device.WriteBytes(bytes + cuts[index], cuts[index + 1] - cuts[index]));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    REQUIRE(TestHarness::WaitUntil([&]() { return sink.GetCount() == 2; }));
+    std::vector<TvVolumeEvent> events = sink.GetEvents();
+    CHECK(events[0].action == TvVolumeAction::VolumeDown);
+    CHECK(events[1].action == TvVolumeAction::ToggleMute);
+}
+
+TEST_CASE(EvdevDropsDeviceAtEndOfStream)
+{
+    FakeInputDevice device;
+    REQUIRE(!device.path.empty());
+
+    RecordingSink sink;
+    EvdevInputSource source(sink, nullptr);
+    REQUIRE(source.AddDevice(device.path));
+    REQUIRE(device.OpenWriter());
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+
+    CHECK(device.WriteEvent(EV_KEY, KEY_VOLUMEUP, 1));
+    device.CloseWriter();
+
+    CHECK(TestHarness::WaitUntil([&]() { return source.GetLostDeviceCount() == 1; }));
+    CHECK(sink.GetCount() == 1);
+
+    // The loop keeps running without devices and still stops promptly.
+    CHECK(thread.IsRunning());
+    thread.Stop();
+}
+
+TEST_CASE(EvdevEvaluatesCaptureQueryOnInputThread)
+{
+    FakeInputDevice device;
+    REQUIRE(!device.path.empty());
+
+    RecordingSink sink;
+    std::atomic<int> queries(0);
+    std::atomic<bool> wrongThread(false);
+    std::thread::id caller = std::this_thread::get_id();
+
+    EvdevInputSource source(sink, [&]()
+    {
+        wrongThread = wrongThread || (std::this_thread::get_id() == caller);
+        ++queries;
+        return true;
+    });
+    REQUIRE(source.AddDevice(device.path));
+    REQUIRE(device.OpenWriter());
+
+    // Nothing runs before the thread does.
+    source.RequestCaptureUpdate();
+    CHECK(queries == 0);
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+    CHECK(queries == 1);
+
+    source.RequestCaptureUpdate();
+    CHECK(TestHarness::WaitUntil([&]() { return queries == 2; }));
+    CHECK(!wrongThread);
+    thread.Stop();
+}
+
+TEST_CASE(EvdevSkipsPathsThatAreNotVolumeKeyDevices)
+{
+    FakeInputDevice device;
+    REQUIRE(!device.path.empty());
+
+    RecordingSink sink;
+    EvdevInputSource source(sink, nullptr);
+
+    // A FIFO does not answer the key capability query, so a directory scan
+    // does not pick it up, and missing paths are refused.
+    CHECK(source.AddVolumeKeyDevices(device.directory) == 0);
+    CHECK(source.AddVolumeKeyDevices(device.directory + "/missing") == 0);
+    CHECK(!source.AddDevice(device.directory + "/missing"));
+    CHECK(source.GetDeviceCount() == 0);
+}
+
+#endif
+
+TEST_CASE(SyntheticSourceReplaysPatternUpToLimit)
+{
+    RecordingSink sink(false);
+    SyntheticInputSource source(
+        sink,
+        { TvVolumeAction::VolumeUp, TvVolumeAction::VolumeUp, TvVolumeAction::ToggleMute },
+        7);
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+    REQUIRE(TestHarness::WaitUntil([&]() { return source.GetProducedCount() == 7; }));
+    thread.Stop();
+
+    std::vector<TvVolumeEvent> events = sink.GetEvents();
+    REQUIRE(events.size() == 7);
+    CHECK(events[2].action == TvVolumeAction::ToggleMute);
+    CHECK(events[5].action == TvVolumeAction::ToggleMute);
+    CHECK(events[6].action == TvVolumeAction::VolumeUp);
+    for (size_t index = 1; index < events.size(); ++index)
+    {
+        CHECK(events[index].timestamp >= events[index - 1].timestamp);
+    }
+    CHECK(source.GetConsumedCount() == 0);
+}
+
+TEST_CASE(SyntheticSourceRunsUntilStopped)
+{
+    RecordingSink sink;
+    SyntheticInputSource source(sink, { TvVolumeAction::VolumeDown }, 0, std::chrono::microseconds(100));
+
+    InputThread thread;
+    REQUIRE(thread.Start(source));
+    REQUIRE(TestHarness::WaitUntil([&]() { return source.GetProducedCount() >= 10; }));
+    thread.Stop();
+
+    uint64_t produced = source.GetProducedCount();
+    CHECK(source.GetConsumedCount() == produced);
+    CHECK(sink.GetCount() == produced);
+}
+
+TEST_CASE(InputThreadReportsFailedPrepare)
+{
+    RecordingSink sink;
+    SyntheticInputSource source(sink, {}, 1);
+
+    InputThread thread;
+    CHECK(!thread.Start(source));
+    CHECK(!thread.IsRunning());
+    thread.Stop();
+}
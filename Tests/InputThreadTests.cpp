@@ -0,0 +1,165 @@
+#include "TestHarness.h"
+
+#include "CallbackLatencyMonitor.h"
+#include "InputThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    // Stands in for the hook's message pump: Run dispatches a timed callback
+    // in a loop until stopped, recording each one like the hook does.
+    class TimedCallbackLoop : public IInputEventLoop
+    {
+    public:
+        explicit TimedCallbackLoop(CallbackLatencyMonitor& monitorValue)
+            : monitor(monitorValue)
+        {
+        }
+
+        bool Prepare() override
+        {
+            preparedOn = std::this_thread::get_id();
+            std::this_thread::sleep_for(prepareDelay);
+            prepared.store(true);
+            return true;
+        }
+
+        void Run() override
+        {
+            while (!stopRequested.load())
+            {
+                auto start = CallbackLatencyMonitor::Clock::now();
+                callbacks.fetch_add(1);
+                monitor.Record(CallbackLatencyMonitor::Clock::now() - start);
+                std::this_thread::sleep_for(100us);
+            }
+        }
+
+        void RequestStop() override
+        {
+            stopRequested.store(true);
+        }
+
+        CallbackLatencyMonitor& monitor;
+        std::chrono::milliseconds prepareDelay{ 0 };
+        std::thread::id preparedOn;
+        std::atomic<bool> prepared{ false };
+        std::atomic<bool> stopRequested{ false };
+        std::atomic<uint64_t> callbacks{ 0 };
+    };
+}
+
+TEST_CASE(ThreadStartRunsBeforePrepareOnInputThread)
+{
+    CallbackLatencyMonitor monitor(20ms);
+    TimedCallbackLoop loop(monitor);
+    loop.prepareDelay = 50ms;
+
+    std::thread::id startedOn;
+    bool preparedBeforeStart = true;
+
+    InputThread thread;
+    REQUIRE(thread.Start(loop, [&]()
+        {
+            startedOn = std::this_thread::get_id();
+            preparedBeforeStart = loop.prepared.load();
+        }));
+
+    // Start waits for Prepare, so its results are visible here.
+    CHECK(loop.prepared.load());
+    CHECK(!preparedBeforeStart);
+    CHECK(startedOn == loop.preparedOn);
+    CHECK(startedOn != std::this_thread::get_id());
+    CHECK(thread.IsRunning());
+
+    thread.Stop();
+    CHECK(!thread.IsRunning());
+}
+
+TEST_CASE(SecondStartFailsUntilStopped)
+{
+    CallbackLatencyMonitor monitor(20ms);
+    TimedCallbackLoop first(monitor);
+    TimedCallbackLoop second(monitor);
+
+    InputThread thread;
+    REQUIRE(thread.Start(first));
+    CHECK(!thread.Start(second));
+    thread.Stop();
+    thread.Stop();
+
+    REQUIRE(thread.Start(second));
+    CHECK(TestHarness::WaitUntil([&]() { return second.callbacks.load() > 0; }));
+    thread.Stop();
+    CHECK(second.stopRequested.load());
+}
+
+TEST_CASE(CallbacksContinueWhileAnotherThreadIsBusy)
+{
+    CallbackLatencyMonitor monitor(20ms);
+    TimedCallbackLoop loop(monitor);
+
+    InputThread thread;
+    REQUIRE(thread.Start(loop));
+    REQUIRE(TestHarness::WaitUntil([&]() { return loop.callbacks.load() > 0; }));
+
+    // A long stretch of work on another thread, like a pairing dialog or a
+    // config reload on the UI thread, must not hold up the input callbacks.
+    uint64_t before = loop.callbacks.load();
+    std::this_thread::sleep_for(200ms);
+    uint64_t during = loop.callbacks.load();
+    thread.Stop();
+
+    CHECK(during > before);
+    CHECK(monitor.GetCallbackCount() == loop.callbacks.load());
+}
+
+TEST_CASE(MonitorCountsSlowCallbacksAboveThreshold)
+{
+    CallbackLatencyMonitor monitor(20ms);
+    CHECK(monitor.GetWarningThreshold() == CallbackLatencyMonitor::Clock::duration(20ms));
+
+    CHECK(!monitor.Record(1ms));
+    CHECK(!monitor.Record(20ms));
+    CHECK(monitor.Record(21ms));
+    CHECK(!monitor.Record(5ms));
+    CHECK(monitor.Record(300ms));
+
+    CHECK(monitor.GetCallbackCount() == 5);
+    CHECK(monitor.GetSlowCount() == 2);
+    CHECK(monitor.GetTotalTime() == CallbackLatencyMonitor::Clock::duration(347ms));
+    CHECK(monitor.GetMaxTime() == CallbackLatencyMonitor::Clock::duration(300ms));
+}
+
+TEST_CASE(MonitorCanBeReadWhileCallbackThreadRecords)
+{
+    CallbackLatencyMonitor monitor(20ms);
+    constexpr uint64_t Callbacks = 200000;
+
+    std::thread recorder([&]()
+        {
+            for (uint64_t index = 1; index <= Callbacks; ++index)
+            {
+                monitor.Record(std::chrono::microseconds(index % 1000));
+            }
+        });
+
+    // Counters only grow, and the maximum never exceeds what was recorded.
+    uint64_t lastCount = 0;
+    while (lastCount < Callbacks)
+    {
+        uint64_t count = monitor.GetCallbackCount();
+        CHECK(count >= lastCount);
+        CHECK(monitor.GetMaxTime() <= std::chrono::microseconds(999));
+        lastCount = count;
+    }
+    recorder.join();
+
+    CHECK(monitor.GetSlowCount() == 0);
+    CHECK(monitor.GetMaxTime() == CallbackLatencyMonitor::Clock::duration(std::chrono::microseconds(999)));
+}
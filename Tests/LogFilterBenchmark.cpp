@@ -0,0 +1,41 @@
+#include "BenchmarkHarness.h"
+
+#include "LogFilter.h"
+
+namespace
+{
+    uint64_t g_writtenCount = 0;
+
+    int ExpensiveArgument(uint64_t value)
+    {
+        return static_cast<int>(value * 2654435761u);
+    }
+}
+
+// Stands in for the real sink; only counts.
+void WriteLog(uint32_t, const wchar_t*, ...)
+{
+    ++g_writtenCount;
+}
+
+// Measures a log call that the runtime mask filters out, which is what most
+// debug and info call sites cost in a release build.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 500000000;
+
+    ApplyLogLevels(L"info;Key=off");
+    BenchmarkHarness::Measure("Runtime-filtered call", iterations, [&](uint64_t i)
+    {
+        LGTV_LOG_INFO(Key, L"key %d", ExpensiveArgument(i));
+    });
+
+    BenchmarkHarness::Measure("Enabled call, counting sink", iterations, [&](uint64_t i)
+    {
+        LGTV_LOG_INFO(Audio, L"volume %d", ExpensiveArgument(i));
+    });
+    BenchmarkHarness::DoNotOptimize(g_writtenCount);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "TestHarness.h"
+
+#include "LogFilter.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct LoggedCall
+    {
+        uint32_t level;
+        std::wstring format;
+    };
+
+    std::vector<LoggedCall> g_loggedCalls;
+    int g_argumentEvaluations = 0;
+
+    int CountEvaluation()
+    {
+        ++g_argumentEvaluations;
+        return 7;
+    }
+
+    void Reset()
+    {
+        g_logEnabledMask.store(GetDefaultLogMask());
+        g_loggedCalls.clear();
+        g_argumentEvaluations = 0;
+    }
+
+    bool IsEnabledFrom(LogSubsystem subsystem, uint32_t minimumLevel)
+    {
+        for (uint32_t level = LogLevelDebug; level <= LogLevelError; ++level)
+        {
+            bool expected = level >= minimumLevel && level >= static_cast<uint32_t>(LGTV_LOG_COMPILED_LEVEL);
+            if (IsLogEnabled(subsystem, level) != expected)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// The tests stand in for the real sink in Logging.cpp.
+void WriteLog(uint32_t level, const wchar_t* format, ...)
+{
+    g_loggedCalls.push_back({ level, format });
+}
+
+TEST_CASE(MacrosTagFormatWithSubsystem)
+{
+    Reset();
+    LGTV_LOG_INFO(Audio, L"Default device changed to %ls", L"TV");
+    LGTV_LOG_ERROR(LGTV, L"Connect failed: %d", 5);
+
+    REQUIRE(g_loggedCalls.size() == 2);
+    CHECK(g_loggedCalls[0].level == LogLevelInfo);
+    CHECK(g_loggedCalls[0].format == L"[Audio] Default device changed to %ls");
+    CHECK(g_loggedCalls[1].level == LogLevelError);
+    CHECK(g_loggedCalls[1].format == L"[LGTV] Connect failed: %d");
+}
+
+TEST_CASE(FilteredCallsEvaluateNoArguments)
+{
+    Reset();
+    SetLogLevel(LogSubsystem::Key, LogLevelError);
+
+    LGTV_LOG_INFO(Key, L"key %d", CountEvaluation());
+    LGTV_LOG_WARNING(Key, L"key %d", CountEvaluation());
+    CHECK(g_loggedCalls.empty());
+    CHECK(g_argumentEvaluations == 0);
+
+    // Other subsystems keep their levels.
+    LGTV_LOG_INFO(UI, L"ui %d", CountEvaluation());
+    CHECK(g_loggedCalls.size() == 1);
+    CHECK(g_argumentEvaluations == 1);
+}
+
+TEST_CASE(LevelsBelowCompiledLevelCannotBeEnabled)
+{
+    Reset();
+    CHECK(ApplyLogLevels(L"debug"));
+
+    LGTV_LOG_DEBUG(Key, L"key %d", CountEvaluation());
+    if constexpr (LGTV_LOG_COMPILED_LEVEL > LogLevelDebug)
+    {
+        CHECK(!IsLogEnabled(LogSubsystem::Key, LogLevelDebug));
+        CHECK(g_loggedCalls.empty());
+        CHECK(g_argumentEvaluations == 0);
+    }
+    else
+    {
+        CHECK(g_loggedCalls.size() == 1);
+    }
+}
+
+TEST_CASE(AppliesLevelSpecifications)
+{
+    Reset();
+    CHECK(ApplyLogLevels(L"warning;Key=info, LGTV = Error"));
+    CHECK(IsEnabledFrom(LogSubsystem::Audio, LogLevelWarning));
+    CHECK(IsEnabledFrom(LogSubsystem::UI, LogLevelWarning));
+    CHECK(IsEnabledFrom(LogSubsystem::Configuration, LogLevelWarning));
+    CHECK(IsEnabledFrom(LogSubsystem::Key, LogLevelInfo));
+    CHECK(IsEnabledFrom(LogSubsystem::LGTV, LogLevelError));
+
+    // Later parts override earlier ones.
+    CHECK(ApplyLogLevels(L"configuration=debug;ui=off;;"));
+    CHECK(IsEnabledFrom(LogSubsystem::Configuration, LogLevelDebug));
+    CHECK(IsEnabledFrom(LogSubsystem::UI, LogLevelError + 1));
+    CHECK(IsEnabledFrom(LogSubsystem::Key, LogLevelInfo));
+
+    CHECK(ApplyLogLevels(L""));
+    CHECK(IsEnabledFrom(LogSubsystem::Key, LogLevelInfo));
+}
+
+TEST_CASE(MalformedPartsAreReportedAndSkipped)
+{
+    Reset();
+    CHECK(!ApplyLogLevels(L"error;bogus=debug;Key=loud;verbose;Audio=warning"));
+    CHECK(IsEnabledFrom(LogSubsystem::Key, LogLevelError));
+    CHECK(IsEnabledFrom(LogSubsystem::Audio, LogLevelWarning));
+    CHECK(IsEnabledFrom(LogSubsystem::LGTV, LogLevelError));
+}
+
+TEST_CASE(SubsystemNamesMatchTags)
+{
+    CHECK(std::wstring(GetLogSubsystemName(LogSubsystem::Audio)) == L"Audio");
+    CHECK(std::wstring(GetLogSubsystemName(LogSubsystem::Key)) == L"Key");
+    CHECK(std::wstring(GetLogSubsystemName(LogSubsystem::LGTV)) == L"LGTV");
+    CHECK(std::wstring(GetLogSubsystemName(LogSubsystem::UI)) == L"UI");
+    CHECK(std::wstring(GetLogSubsystemName(LogSubsystem::Configuration)) == L"Configuration");
+    CHECK(std::wstring(GetLogSubsystemName(static_cast<LogSubsystem>(LogSubsystemCount))).empty());
+}
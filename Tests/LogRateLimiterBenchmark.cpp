@@ -0,0 +1,29 @@
+#include "BenchmarkHarness.h"
+
+#include "LogRateLimiter.h"
+
+// Measures the cost of a suppressed call, which is what every repeat in a
+// failure storm pays, and of an admitted one.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 100000000;
+
+    LogRateLimiter::Clock::time_point now = LogRateLimiter::Clock::now();
+
+    LogRateLimiter storm(16, 5, std::chrono::seconds(10));
+    uint64_t admitted = 0;
+    BenchmarkHarness::Measure("Admit, suppressed", iterations, [&](uint64_t)
+    {
+        admitted += storm.Admit(2, now).admitted ? 1 : 0;
+    });
+
+    LogRateLimiter quiet(16, 0xFFFFFFFF, std::chrono::seconds(10));
+    BenchmarkHarness::Measure("Admit, admitted", iterations, [&](uint64_t)
+    {
+        admitted += quiet.Admit(2, now).admitted ? 1 : 0;
+    });
+    BenchmarkHarness::DoNotOptimize(admitted);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "TestHarness.h"
+
+#include "LogRateLimiter.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+    using Clock = LogRateLimiter::Clock;
+
+    const Clock::time_point Start{ std::chrono::seconds(1000) };
+}
+
+TEST_CASE(StormAdmitsBurstThenReportsRepeats)
+{
+    LogRateLimiter limiter(16, 5, 10s);
+
+    // 62 calls in 6.1 s: the first 5 are written, the rest counted.
+    int admitted = 0;
+    for (int call = 0; call < 62; ++call)
+    {
+        LogRateLimiter::Decision decision = limiter.Admit(3, Start + call * 100ms);
+        admitted += decision.admitted ? 1 : 0;
+        CHECK(decision.repeated == 0);
+    }
+    CHECK(admitted == 5);
+    CHECK(limiter.GetSuppressedCount() == 57);
+
+    // The first call after the window is admitted and carries the count.
+    LogRateLimiter::Decision decision = limiter.Admit(3, Start + 11s);
+    CHECK(decision.admitted);
+    CHECK(decision.repeated == 57);
+    CHECK(decision.period == Clock::duration(10s));
+
+    decision = limiter.Admit(3, Start + 11s);
+    CHECK(decision.admitted);
+    CHECK(decision.repeated == 0);
+}
+
+TEST_CASE(SitesAreLimitedIndependently)
+{
+    LogRateLimiter limiter(4, 2, 10s);
+    CHECK(limiter.Admit(0, Start).admitted);
+    CHECK(limiter.Admit(0, Start).admitted);
+    CHECK(!limiter.Admit(0, Start).admitted);
+
+    CHECK(limiter.Admit(1, Start).admitted);
+    CHECK(limiter.Admit(1, Start).admitted);
+
+    // Sites outside the table are never limited.
+    for (int call = 0; call < 10; ++call)
+    {
+        CHECK(limiter.Admit(4, Start).admitted);
+        CHECK(limiter.Admit(1000, Start).admitted);
+    }
+    CHECK(limiter.GetSuppressedCount() == 1);
+}
+
+TEST_CASE(QuietSitesAreCollected)
+{
+    LogRateLimiter limiter(16, 5, 10s);
+    for (int call = 0; call < 20; ++call)
+    {
+        limiter.Admit(4, Start);
+    }
+    for (int call = 0; call < 7; ++call)
+    {
+        limiter.Admit(9, Start + 1s);
+    }
+    limiter.Admit(2, Start);
+
+    std::vector<uint32_t> sites;
+    std::vector<uint32_t> repeats;
+    std::vector<Clock::duration> periods;
+    auto collect = [&](uint32_t site, uint32_t repeated, Clock::duration period)
+    {
+        sites.push_back(site);
+        repeats.push_back(repeated);
+        periods.push_back(period);
+    };
+
+    limiter.CollectSuppressed(Start + 3s, collect);
+    REQUIRE(sites.size() == 2);
+    CHECK(sites[0] == 4);
+    CHECK(repeats[0] == 15);
+    CHECK(periods[0] == Clock::duration(3s));
+    CHECK(sites[1] == 9);
+    CHECK(repeats[1] == 2);
+    CHECK(periods[1] == Clock::duration(2s));
+
+    // Collected counts are not reported again, and the period is capped at
+    // the window.
+    sites.clear();
+    limiter.CollectSuppressed(Start + 4s, collect);
+    CHECK(sites.empty());
+    limiter.Admit(4, Start + 5s);
+    limiter.CollectSuppressed(Start + 30s, collect);
+    REQUIRE(sites.size() == 1);
+    CHECK(periods.back() == Clock::duration(10s));
+    CHECK(limiter.Admit(4, Start + 31s).repeated == 0);
+}
+
+TEST_CASE(CountsAddUpUnderContention)
+{
+    LogRateLimiter limiter(4, 5, 1ms);
+    constexpr uint64_t CallsPerThread = 200000;
+
+    std::atomic<uint64_t> admitted{ 0 };
+    std::atomic<uint64_t> reported{ 0 };
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread)
+    {
+        threads.emplace_back([&]()
+            {
+                for (uint64_t call = 0; call < CallsPerThread; ++call)
+                {
+                    LogRateLimiter::Decision decision = limiter.Admit(static_cast<uint32_t>(call & 3), Clock::now());
+                    admitted += decision.admitted ? 1 : 0;
+                    reported += decision.repeated;
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    uint64_t outstanding = 0;
+    limiter.CollectSuppressed(Clock::now(), [&](uint32_t, uint32_t repeated, Clock::duration)
+        {
+            outstanding += repeated;
+        });
+
+    // Every call is either written or counted, and every count is reported
+    // exactly once.
+    CHECK(admitted + limiter.GetSuppressedCount() == 4 * CallsPerThread);
+    CHECK(reported + outstanding == limiter.GetSuppressedCount());
+}
@@ -0,0 +1,39 @@
+#include "BenchmarkHarness.h"
+
+#include "BinaryLogFormat.h"
+#include "LogRing.h"
+
+#include <string>
+#include <vector>
+
+// Measures appending a typical entry to a ring that wraps continuously, so
+// nearly every append also evicts.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 50000000;
+
+    constexpr size_t SiteAreaSize = 256 * 1024;
+    constexpr size_t RingSize = 4 * 1024 * 1024;
+    std::vector<uint8_t> memory(LogRing::GetFileSize(SiteAreaSize, RingSize));
+
+    LogRing ring;
+    if (!ring.Initialize(memory.data(), memory.size(), SiteAreaSize, 0, 0))
+    {
+        return 1;
+    }
+
+    uint8_t data[40] = {};
+    std::string block;
+    AppendBinaryLogEntry(block, 0, 0, 7, data, sizeof(data));
+
+    BenchmarkHarness::Measure("Append, wrapping ring", iterations, [&](uint64_t)
+    {
+        ring.Append(block.data(), block.size());
+    });
+    std::printf("wraps %llu evicted %llu\n",
+        static_cast<unsigned long long>(ring.GetWrapCount()),
+        static_cast<unsigned long long>(ring.GetEvictedCount()));
+
+    return 0;
+}
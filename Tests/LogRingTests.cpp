@@ -0,0 +1,197 @@
+#include "TestHarness.h"
+
+#include "BinaryLogFormat.h"
+#include "LogRing.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr size_t SiteAreaSize = 1024;
+    constexpr uint32_t EntrySite = 0;
+
+    // A ring over plain memory, standing in for the mapped log file.
+    struct RingFixture
+    {
+        explicit RingFixture(size_t ringSize)
+            : memory(LogRing::GetFileSize(SiteAreaSize, ringSize))
+        {
+            initialized = ring.Initialize(memory.data(), memory.size(), SiteAreaSize, 1000, 42);
+
+            LogArgumentType types[] = { LogArgumentType::Int32, LogArgumentType::WideString };
+            std::string site;
+            AppendBinaryLogSite(site, EntrySite, LogLevelInfo, types, 2, L"entry %d %ls");
+            siteDefined = ring.AppendSite(site.data(), site.size());
+        }
+
+        // Appends entry <number> with padding text of the given length.
+        bool AppendEntry(int32_t number, size_t textLength)
+        {
+            uint8_t data[LogRecordCapacity];
+            std::memcpy(data, &number, sizeof(number));
+            std::wstring text(textLength, L'x');
+            size_t length = sizeof(number) + EncodeLogWideString(text.c_str(), text.size(), data + sizeof(number), sizeof(data) - sizeof(number));
+
+            std::string block;
+            AppendBinaryLogEntry(block, EntrySite, 2000 + number, 7, data, length);
+            return ring.Append(block.data(), block.size());
+        }
+
+        // Decodes the ring and returns the entry numbers in order.
+        std::vector<int32_t> ReadEntries(bool& valid, uint64_t& wrapCount)
+        {
+            std::string stream;
+            valid = LogRing::Read(memory.data(), memory.size(), stream, wrapCount);
+            std::vector<int32_t> numbers;
+            if (!valid)
+            {
+                return numbers;
+            }
+
+            BinaryLogDecoder decoder;
+            size_t consumed = decoder.Decode(reinterpret_cast<const uint8_t*>(stream.data()), stream.size(),
+                [&numbers](const BinaryLogDecoder::Line& line)
+                {
+                    if (line.threadId == 7)
+                    {
+                        numbers.push_back(std::stoi(line.message.substr(6)));
+                    }
+                }, valid);
+            valid = valid && consumed == stream.size() && decoder.GetSessionCount() == 1;
+            return numbers;
+        }
+
+        static constexpr size_t LogRecordCapacity = 2048;
+
+        std::vector<uint8_t> memory;
+        LogRing ring;
+        bool initialized = false;
+        bool siteDefined = false;
+    };
+}
+
+TEST_CASE(EmptyRingReadsAsSessionAndSites)
+{
+    RingFixture fixture(4096);
+    REQUIRE(fixture.initialized);
+    CHECK(fixture.siteDefined);
+    CHECK(fixture.ring.IsInitialized());
+
+    bool valid = false;
+    uint64_t wrapCount = 1;
+    CHECK(fixture.ReadEntries(valid, wrapCount).empty());
+    CHECK(valid);
+    CHECK(wrapCount == 0);
+}
+
+TEST_CASE(WrappedRingReadsBackNewestContiguousRun)
+{
+    RingFixture fixture(4096);
+    REQUIRE(fixture.initialized);
+
+    uint32_t state = 12345;
+    for (int32_t number = 0; number < 5000; ++number)
+    {
+        state = state * 1664525 + 1013904223;
+        REQUIRE(fixture.AppendEntry(number, (state >> 16) % 200));
+
+        if (number % 97 == 0 || number == 4999)
+        {
+            bool valid = false;
+            uint64_t wrapCount = 0;
+            std::vector<int32_t> numbers = fixture.ReadEntries(valid, wrapCount);
+            REQUIRE(valid);
+            REQUIRE(!numbers.empty());
+            CHECK(numbers.back() == number);
+            for (size_t index = 1; index < numbers.size(); ++index)
+            {
+                CHECK(numbers[index] == numbers[index - 1] + 1);
+            }
+            CHECK(wrapCount == fixture.ring.GetWrapCount());
+        }
+    }
+
+    CHECK(fixture.ring.GetWrapCount() > 50);
+    CHECK(fixture.ring.GetEvictedCount() > 4000);
+}
+
+TEST_CASE(BlocksNearRingSizeEvictEverythingElse)
+{
+    RingFixture fixture(1024);
+    REQUIRE(fixture.initialized);
+
+    // An entry block takes 19 bytes of framing plus 6 for the number and
+    // string length, so 499 characters make 1023 bytes, one less than the
+    // ring, and 500 make a block that can never fit.
+    for (int32_t number = 0; number < 20; ++number)
+    {
+        REQUIRE(fixture.AppendEntry(number, (number % 2 == 0) ? 499 : 3));
+
+        bool valid = false;
+        uint64_t wrapCount = 0;
+        std::vector<int32_t> numbers = fixture.ReadEntries(valid, wrapCount);
+        REQUIRE(valid);
+        REQUIRE(!numbers.empty());
+        CHECK(numbers.back() == number);
+
+        // The large block overlaps every other position in the ring, so
+        // each append leaves only itself.
+        CHECK(numbers.size() == 1);
+    }
+    CHECK(!fixture.AppendEntry(99, 500));
+}
+
+TEST_CASE(FullSiteAreaLeavesEntriesUnknown)
+{
+    RingFixture fixture(4096);
+    REQUIRE(fixture.initialized);
+
+    std::string site;
+    AppendBinaryLogSite(site, 1, LogLevelInfo, nullptr, 0, L"filler");
+    size_t added = 0;
+    while (fixture.ring.AppendSite(site.data(), site.size()))
+    {
+        ++added;
+    }
+    CHECK(added > 0);
+    CHECK(added < SiteAreaSize / site.size());
+
+    std::string entry;
+    AppendBinaryLogEntry(entry, 5, 3000, 8, nullptr, 0);
+    REQUIRE(fixture.ring.Append(entry.data(), entry.size()));
+
+    std::string stream;
+    uint64_t wrapCount = 0;
+    REQUIRE(LogRing::Read(fixture.memory.data(), fixture.memory.size(), stream, wrapCount));
+    BinaryLogDecoder decoder;
+    bool valid = false;
+    decoder.Decode(reinterpret_cast<const uint8_t*>(stream.data()), stream.size(), [](const BinaryLogDecoder::Line&) {}, valid);
+    CHECK(valid);
+    CHECK(decoder.GetUnknownSiteCount() == 1);
+}
+
+TEST_CASE(RejectsMemoryThatIsNotARing)
+{
+    std::vector<uint8_t> memory(LogRing::GetFileSize(SiteAreaSize, 4096));
+    std::string stream;
+    uint64_t wrapCount = 0;
+    CHECK(!LogRing::Read(memory.data(), memory.size(), stream, wrapCount));
+
+    LogRing ring;
+    CHECK(!ring.Initialize(memory.data(), LogRing::HeaderSize + SiteAreaSize, SiteAreaSize, 0, 0));
+    CHECK(!ring.Initialize(memory.data(), memory.size(), 0, 0, 0));
+    CHECK(!ring.IsInitialized());
+    CHECK(!ring.Append("x", 1));
+
+    REQUIRE(ring.Initialize(memory.data(), memory.size(), SiteAreaSize, 0, 0));
+    CHECK(!LogRing::Read(memory.data(), memory.size() - 1, stream, wrapCount));
+
+    // A header whose positions claim more than the ring holds.
+    LogRing::Header header{};
+    std::memcpy(&header, memory.data(), sizeof(header));
+    header.writePosition = header.tailPosition + header.ringSize + 1;
+    std::memcpy(memory.data(), &header, sizeof(header));
+    CHECK(!LogRing::Read(memory.data(), memory.size(), stream, wrapCount));
+}
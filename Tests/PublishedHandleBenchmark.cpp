@@ -0,0 +1,60 @@
+#include "BenchmarkHarness.h"
+
+#include "PublishedHandle.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Measures what the keyboard hook pays to pick up the endpoint volume handle:
+// a lock-free Acquire, with and without a publisher swapping the handle, next
+// to a shared_ptr copy under a mutex.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 20000000;
+
+    PublishedHandle<const int> handle;
+    handle.Publish(std::make_shared<const int>(0));
+
+    uint64_t sum = 0;
+    BenchmarkHarness::Measure("Acquire, no publisher", iterations, [&](uint64_t)
+    {
+        sum += static_cast<uint64_t>(*handle.Acquire());
+    });
+
+    std::mutex mutex;
+    std::shared_ptr<const int> locked = std::make_shared<const int>(0);
+    BenchmarkHarness::Measure("shared_ptr copy under mutex", iterations, [&](uint64_t)
+    {
+        std::shared_ptr<const int> copy;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            copy = locked;
+        }
+        sum += static_cast<uint64_t>(*copy);
+    });
+
+    std::atomic<bool> publishing(true);
+    std::thread publisher([&]()
+    {
+        for (int value = 1; publishing.load(); ++value)
+        {
+            handle.Publish(std::make_shared<const int>(value));
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    BenchmarkHarness::Measure("Acquire, publisher swapping", iterations, [&](uint64_t)
+    {
+        std::shared_ptr<const int> value = handle.Acquire();
+        sum += value ? static_cast<uint64_t>(*value) : 0;
+    });
+
+    publishing = false;
+    publisher.join();
+
+    BenchmarkHarness::DoNotOptimize(sum);
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "TestHarness.h"
+
+#include "PublishedHandle.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::atomic<int64_t> g_liveObjects(0);
+
+    // A published object that can tell when it is used after release or torn.
+    struct Payload
+    {
+        explicit Payload(uint64_t sequenceValue)
+            : sequence(sequenceValue),
+            check(~sequenceValue),
+            alive(true)
+        {
+            ++g_liveObjects;
+        }
+
+        ~Payload()
+        {
+            alive = false;
+            --g_liveObjects;
+        }
+
+        bool IsIntact() const
+        {
+            return alive && check == ~sequence;
+        }
+
+        uint64_t sequence;
+        uint64_t check;
+        bool alive;
+    };
+}
+
+TEST_CASE(PublishesAndReleasesHandles)
+{
+    {
+        PublishedHandle<const Payload> handle;
+        CHECK(!handle.Acquire());
+        CHECK(handle.GetPublishCount() == 0);
+
+        handle.Publish(std::make_shared<const Payload>(1));
+        std::shared_ptr<const Payload> first = handle.Acquire();
+        REQUIRE(first);
+        CHECK(first->sequence == 1);
+
+        // A reader keeps its handle alive across a publish; the handle itself
+        // does not keep the replaced object.
+        handle.Publish(std::make_shared<const Payload>(2));
+        CHECK(handle.Acquire()->sequence == 2);
+        CHECK(first->IsIntact());
+        CHECK(g_liveObjects == 2);
+        first.reset();
+        CHECK(g_liveObjects == 1);
+
+        handle.Reset();
+        CHECK(!handle.Acquire());
+        CHECK(g_liveObjects == 0);
+        CHECK(handle.GetPublishCount() == 3);
+
+        handle.Publish(std::make_shared<const Payload>(3));
+    }
+    CHECK(g_liveObjects == 0);
+}
+
+TEST_CASE(ConcurrentReadersAndPublishersStress)
+{
+    constexpr int ReaderCount = 6;
+    constexpr int PublisherCount = 2;
+    constexpr uint64_t PublishesPerPublisher = 20000;
+
+    PublishedHandle<const Payload> handle;
+    handle.Publish(std::make_shared<const Payload>(0));
+
+    std::atomic<uint64_t> nextSequence(1);
+    std::atomic<bool> publishing(true);
+    std::atomic<int> brokenReads(0);
+    std::atomic<uint64_t> reads(0);
+    std::atomic<int> runningReaders(0);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < ReaderCount; ++r)
+    {
+        threads.emplace_back([&]()
+        {
+            uint64_t localReads = 0;
+            while (publishing.load())
+            {
+                std::shared_ptr<const Payload> payload = handle.Acquire();
+                if (!payload || !payload->IsIntact())
+                {
+                    ++brokenReads;
+                }
+                if (localReads++ == 0)
+                {
+                    ++runningReaders;
+                }
+            }
+            reads += localReads;
+        });
+    }
+
+    // Publish only once every reader is in its loop, so the swaps really
+    // race with reads even on a loaded host.
+    CHECK(TestHarness::WaitUntil([&]() { return runningReaders.load() == ReaderCount; }));
+
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < PublisherCount; ++p)
+    {
+        publishers.emplace_back([&]()
+        {
+            for (uint64_t i = 0; i < PublishesPerPublisher; ++i)
+            {
+                handle.Publish(std::make_shared<const Payload>(nextSequence++));
+            }
+        });
+    }
+    for (std::thread& publisher : publishers)
+    {
+        publisher.join();
+    }
+    publishing = false;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(brokenReads == 0);
+    CHECK(reads > 0);
+    CHECK(handle.GetPublishCount() == 1 + PublisherCount * PublishesPerPublisher);
+
+    // Only the current object is left once every reader has let go.
+    CHECK(g_liveObjects == 1);
+    handle.Reset();
+    CHECK(g_liveObjects == 0);
+}
+
+TEST_CASE(SinglePublisherIsSeenInOrder)
+{
+    constexpr int ReaderCount = 4;
+    constexpr uint64_t PublishCount = 50000;
+
+    PublishedHandle<const Payload> handle;
+    handle.Publish(std::make_shared<const Payload>(0));
+
+    std::atomic<bool> publishing(true);
+    std::atomic<int> violations(0);
+    std::atomic<int> runningReaders(0);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < ReaderCount; ++r)
+    {
+        threads.emplace_back([&]()
+        {
+            uint64_t lastSequence = 0;
+            bool running = false;
+            while (publishing.load())
+            {
+                std::shared_ptr<const Payload> payload = handle.Acquire();
+                if (!running)
+                {
+                    ++runningReaders;
+                    running = true;
+                }
+                if (!payload || !payload->IsIntact() || payload->sequence < lastSequence)
+                {
+                    ++violations;
+                    continue;
+                }
+                lastSequence = payload->sequence;
+            }
+        });
+    }
+    CHECK(TestHarness::WaitUntil([&]() { return runningReaders.load() == ReaderCount; }));
+
+    for (uint64_t i = 1; i <= PublishCount; ++i)
+    {
+        handle.Publish(std::make_shared<const Payload>(i));
+    }
+    publishing = false;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(violations == 0);
+    CHECK(handle.Acquire()->sequence == PublishCount);
+}
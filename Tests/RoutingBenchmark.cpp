@@ -0,0 +1,100 @@
+#include "BenchmarkHarness.h"
+
+#include "AudioRouter.h"
+#include "SimulatedEndpointBackend.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    SimulatedEndpointEvent MakeEvent(
+        SimulatedEndpointEventKind kind,
+        const std::wstring& endpointId,
+        const std::wstring& friendlyName = std::wstring(),
+        bool flag = false)
+    {
+        SimulatedEndpointEvent event;
+        event.kind = kind;
+        event.endpointId = endpointId;
+        event.friendlyName = friendlyName;
+        event.flag = flag;
+        return event;
+    }
+
+    bool MatchesTv(const std::wstring&, const std::wstring& friendlyName)
+    {
+        return friendlyName.find(L"LG TV") != std::wstring::npos;
+    }
+
+    void AddEndpoints(SimulatedEndpointBackend& backend)
+    {
+        backend.Replay({
+            MakeEvent(SimulatedEndpointEventKind::AddEndpoint, L"tv", L"LG TV (NVIDIA High Definition Audio)", true),
+            MakeEvent(SimulatedEndpointEventKind::AddEndpoint, L"speakers", L"Speakers (Realtek Audio)", false),
+            MakeEvent(SimulatedEndpointEventKind::SetDefault, L"speakers"),
+        });
+    }
+
+    void WaitForTvVolume(const AudioRouter& router, bool useTvVolume)
+    {
+        while (router.IsTvVolumeActive() != useTvVolume)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Measures how long a default device switch takes to reach the routing
+// decision, and how cheap it is to deliver notifications while the router
+// coalesces a storm of them.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+
+    {
+        SimulatedEndpointBackend backend;
+        AddEndpoints(backend);
+
+        AudioRouter router(backend);
+        router.SetHintMatcher(MatchesTv);
+        router.Start(nullptr, nullptr, std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+        WaitForTvVolume(router, false);
+
+        BenchmarkHarness::Measure("default switch to routing decision", quick ? 200 : 20000, [&](uint64_t i)
+        {
+            bool toTv = (i % 2) == 0;
+            backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, toTv ? L"tv" : L"speakers"));
+            WaitForTvVolume(router, toTv);
+        });
+
+        router.Stop();
+    }
+
+    {
+        SimulatedEndpointBackend backend;
+        AddEndpoints(backend);
+
+        AudioRouter router(backend);
+        router.SetHintMatcher(MatchesTv);
+        router.Start(nullptr, nullptr);
+        WaitForTvVolume(router, false);
+
+        uint64_t iterations = quick ? 10000 : 1000000;
+        BenchmarkHarness::Measure("notification delivery during storm", iterations, [&](uint64_t i)
+        {
+            backend.Apply(MakeEvent(SimulatedEndpointEventKind::SetDefault, (i % 2) == 0 ? L"tv" : L"speakers"));
+        });
+
+        const CoalescingWorkQueue& queue = router.GetRefreshQueue();
+        std::printf("%-40s %12llu posted %12llu processed\n",
+            "storm coalescing",
+            static_cast<unsigned long long>(queue.GetPostedCount()),
+            static_cast<unsigned long long>(queue.GetProcessedCount()));
+
+        router.Stop();
+    }
+
+    return 0;
+}
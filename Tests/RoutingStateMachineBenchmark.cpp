@@ -0,0 +1,43 @@
+#include "BenchmarkHarness.h"
+
+#include "RoutingStateMachine.h"
+
+// Measures the routing decision on its own, a transition that changes the
+// inputs, and the redundant re-evaluation that notification bursts cause.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 100000000;
+
+    RoutingInputs snapshots[32];
+    for (uint32_t bits = 0; bits < 32; ++bits)
+    {
+        snapshots[bits].deviceMatches = (bits & 0x1) != 0;
+        snapshots[bits].dolbyAtmosAvailable = (bits & 0x2) != 0;
+        snapshots[bits].paired = (bits & 0x4) != 0;
+        snapshots[bits].onlyWhenDolbyAtmos = (bits & 0x8) != 0;
+        snapshots[bits].endpointVolumeAvailable = (bits & 0x10) != 0;
+    }
+
+    uint32_t decisions = 0;
+    BenchmarkHarness::Measure("DecideTvRouting", iterations, [&](uint64_t i)
+    {
+        decisions += DecideTvRouting(snapshots[i % 32]) ? 1 : 0;
+    });
+    BenchmarkHarness::DoNotOptimize(decisions);
+
+    RoutingStateMachine machine;
+    uint32_t commands = 0;
+    BenchmarkHarness::Measure("Advance, changing inputs", iterations, [&](uint64_t i)
+    {
+        commands ^= machine.Advance(snapshots[(i * 7) % 32]).commands;
+    });
+
+    BenchmarkHarness::Measure("Advance, repeated inputs", iterations, [&](uint64_t)
+    {
+        commands ^= machine.Advance(snapshots[31]).commands;
+    });
+    BenchmarkHarness::DoNotOptimize(commands);
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "TestHarness.h"
+
+#include "RoutingStateMachine.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t InputCombinations = 32;
+
+    RoutingInputs MakeInputs(uint32_t bits)
+    {
+        RoutingInputs inputs;
+        inputs.deviceMatches = (bits & 0x1) != 0;
+        inputs.dolbyAtmosAvailable = (bits & 0x2) != 0;
+        inputs.paired = (bits & 0x4) != 0;
+        inputs.onlyWhenDolbyAtmos = (bits & 0x8) != 0;
+        inputs.endpointVolumeAvailable = (bits & 0x10) != 0;
+        return inputs;
+    }
+
+    // The routing rule written out directly, independent of the table.
+    bool ExpectedTvRouting(const RoutingInputs& inputs)
+    {
+        return inputs.deviceMatches
+            && inputs.paired
+            && (inputs.dolbyAtmosAvailable || !inputs.onlyWhenDolbyAtmos);
+    }
+
+    // What an executor of the commands knows about the endpoint volume.
+    struct VolumeModel
+    {
+        bool saved = false;
+        bool pinned = false;
+    };
+
+    // Applies one transition to the model and checks every property that must
+    // hold after it. Returns false on the first violation so callers can
+    // report the sequence that caused it.
+    bool CheckStep(
+        VolumeModel& model,
+        bool firstStep,
+        const RoutingInputs& previous,
+        const RoutingInputs& next,
+        const RoutingTransition& transition)
+    {
+        bool ok = true;
+        uint32_t commands = transition.commands;
+        bool changed = firstStep || !(previous == next);
+
+        ok = ok && (transition.useTvVolume == ExpectedTvRouting(next));
+        ok = ok && (((commands & RoutingCommandPublishStatus) != 0) == changed);
+        if (!changed)
+        {
+            ok = ok && (commands == RoutingCommandNone);
+        }
+
+        bool save = (commands & RoutingCommandSaveEndpointVolume) != 0;
+        bool pin = (commands & RoutingCommandPinEndpointVolume) != 0;
+        bool restore = (commands & RoutingCommandRestoreEndpointVolume) != 0;
+
+        // Volume commands need an endpoint, a pin always saves first, and a
+        // restore never comes without a level that was saved.
+        if (!next.endpointVolumeAvailable)
+        {
+            ok = ok && !save && !pin && !restore;
+        }
+        ok = ok && (save == pin);
+        ok = ok && !(restore && pin);
+        ok = ok && (!restore || (model.saved && model.pinned));
+
+        // Losing the endpoint drops whatever was held on it.
+        if (!next.endpointVolumeAvailable)
+        {
+            model = VolumeModel();
+        }
+        if (save)
+        {
+            model.saved = true;
+        }
+        if (pin)
+        {
+            model.pinned = true;
+        }
+        if (restore)
+        {
+            model = VolumeModel();
+        }
+
+        // With an endpoint, it is pinned exactly while the TV is targeted.
+        if (next.endpointVolumeAvailable)
+        {
+            ok = ok && (model.pinned == transition.useTvVolume);
+        }
+        return ok;
+    }
+}
+
+TEST_CASE(DecisionMatchesRuleForAllInputs)
+{
+    for (uint32_t bits = 0; bits < InputCombinations; ++bits)
+    {
+        RoutingInputs inputs = MakeInputs(bits);
+        CHECK(DecideTvRouting(inputs) == ExpectedTvRouting(inputs));
+    }
+}
+
+TEST_CASE(AllSequencesOfThreeSnapshotsKeepInvariants)
+{
+    int violations = 0;
+    for (uint32_t a = 0; a < InputCombinations; ++a)
+    {
+        for (uint32_t b = 0; b < InputCombinations; ++b)
+        {
+            for (uint32_t c = 0; c < InputCombinations; ++c)
+            {
+                const uint32_t sequence[] = { a, b, c, c };
+                RoutingStateMachine machine;
+                VolumeModel model;
+                RoutingInputs previous;
+
+                for (size_t step = 0; step < 4; ++step)
+                {
+                    RoutingInputs next = MakeInputs(sequence[step]);
+                    RoutingTransition transition = machine.Advance(next);
+                    if (!CheckStep(model, step == 0, previous, next, transition))
+                    {
+                        if (violations++ < 10)
+                        {
+                            std::fprintf(stderr, "violation at step %zu of %u %u %u\n",
+                                step, a, b, c);
+                        }
+                        break;
+                    }
+
+                    CHECK(machine.IsTvVolumeActive() == transition.useTvVolume);
+                    CHECK(machine.GetInputs() == next);
+                    previous = next;
+                }
+            }
+        }
+    }
+    CHECK(violations == 0);
+}
+
+TEST_CASE(LongPseudoRandomSequencesKeepInvariants)
+{
+    uint32_t state = 0x12345678u;
+    auto nextRandom = [&state]()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    for (int run = 0; run < 200; ++run)
+    {
+        RoutingStateMachine machine;
+        VolumeModel model;
+        RoutingInputs previous;
+        bool ok = true;
+
+        for (int step = 0; step < 500 && ok; ++step)
+        {
+            // Flip one input most of the time, like real notifications do.
+            uint32_t bits = 0;
+            if (step == 0 || nextRandom() % 4 == 0)
+            {
+                bits = nextRandom() % InputCombinations;
+            }
+            else
+            {
+                RoutingInputs current = machine.GetInputs();
+                bits = (current.deviceMatches ? 0x1u : 0u)
+                    | (current.dolbyAtmosAvailable ? 0x2u : 0u)
+                    | (current.paired ? 0x4u : 0u)
+                    | (current.onlyWhenDolbyAtmos ? 0x8u : 0u)
+                    | (current.endpointVolumeAvailable ? 0x10u : 0u);
+                bits ^= 1u << (nextRandom() % 5);
+            }
+
+            RoutingInputs next = MakeInputs(bits);
+            ok = CheckStep(model, step == 0, previous, next, machine.Advance(next));
+            previous = next;
+        }
+        CHECK(ok);
+    }
+}
+
+TEST_CASE(EndpointVolumeBecomingAvailable)
+{
+    RoutingInputs onTv = MakeInputs(0x1 | 0x2 | 0x4 | 0x8);
+    RoutingInputs offTv = MakeInputs(0x2 | 0x4 | 0x8);
+
+    // The TV is targeted before its endpoint volume can be controlled; the
+    // endpoint is pinned as soon as it can.
+    {
+        RoutingStateMachine machine;
+        CHECK(machine.Advance(onTv).commands == RoutingCommandPublishStatus);
+
+        onTv.endpointVolumeAvailable = true;
+        RoutingTransition transition = machine.Advance(onTv);
+        CHECK(transition.useTvVolume);
+        CHECK(transition.commands == (RoutingCommandSaveEndpointVolume
+            | RoutingCommandPinEndpointVolume
+            | RoutingCommandPublishStatus));
+        onTv.endpointVolumeAvailable = false;
+    }
+
+    // Leaving the TV in the same step the endpoint appears restores nothing,
+    // since nothing was saved on it.
+    {
+        RoutingStateMachine machine;
+        machine.Advance(onTv);
+
+        offTv.endpointVolumeAvailable = true;
+        RoutingTransition transition = machine.Advance(offTv);
+        CHECK(!transition.useTvVolume);
+        CHECK(transition.commands == RoutingCommandPublishStatus);
+        offTv.endpointVolumeAvailable = false;
+    }
+
+    // An endpoint that shows up while routing stays off the TV is left alone.
+    {
+        RoutingStateMachine machine;
+        machine.Advance(offTv);
+
+        offTv.endpointVolumeAvailable = true;
+        CHECK(machine.Advance(offTv).commands == RoutingCommandPublishStatus);
+    }
+}
+
+TEST_CASE(RepeatedSnapshotYieldsNoCommands)
+{
+    for (uint32_t bits = 0; bits < InputCombinations; ++bits)
+    {
+        RoutingStateMachine machine;
+        RoutingInputs inputs = MakeInputs(bits);
+
+        RoutingTransition first = machine.Advance(inputs);
+        RoutingTransition second = machine.Advance(inputs);
+        CHECK((first.commands & RoutingCommandPublishStatus) != 0);
+        CHECK(second.commands == RoutingCommandNone);
+        CHECK(second.useTvVolume == first.useTvVolume);
+    }
+}
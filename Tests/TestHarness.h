@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal test runner shared by the portable tests.
+//
+// TEST_CASE registers a function that TestMain.cpp runs. CHECK records a
+// failure and carries on, so one run reports every broken expectation.
+namespace TestHarness
+{
+    using TestFunction = void (*)();
+
+    struct TestCase
+    {
+        const char* name;
+        TestFunction function;
+    };
+
+    inline std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    inline int& GetFailureCount()
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, TestFunction function)
+        {
+            GetTestCases().push_back({ name, function });
+        }
+    };
+
+    inline void ReportFailure(const char* file, int line, const char* expression)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        ++GetFailureCount();
+    }
+
+    // Polls the condition until it holds or the timeout expires. Used to wait
+    // for work that completes on another thread.
+    inline bool WaitUntil(
+        const std::function<bool()>& condition,
+        std::chrono::milliseconds timeout = std::chrono::seconds(10))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static TestHarness::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    do \
+    { \
+        if (!(expression)) \
+        { \
+            TestHarness::ReportFailure(__FILE__, __LINE__, #expression); \
+        } \
+    } while (false)
+
+// Stops the current test case when the expression does not hold, for checks
+// that later ones depend on.
+#define REQUIRE(expression) \
+    do \
+    { \
+        if (!(expression)) \
+        { \
+            TestHarness::ReportFailure(__FILE__, __LINE__, #expression); \
+            return; \
+        } \
+    } while (false)
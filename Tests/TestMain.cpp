@@ -0,0 +1,30 @@
+#include "TestHarness.h"
+
+#include <cstring>
+
+// Runs every registered test case, or only those whose name contains the
+// first argument.
+int main(int argc, char** argv)
+{
+    const char* filter = (argc > 1) ? argv[1] : nullptr;
+
+    int run = 0;
+    for (const TestHarness::TestCase& testCase : TestHarness::GetTestCases())
+    {
+        if (filter && !std::strstr(testCase.name, filter))
+        {
+            continue;
+        }
+
+        int failuresBefore = TestHarness::GetFailureCount();
+        testCase.function();
+        ++run;
+
+        std::printf("%s %s\n",
+            (TestHarness::GetFailureCount() == failuresBefore) ? "PASS" : "FAIL",
+            testCase.name);
+    }
+
+    std::printf("%d test cases, %d failed checks\n", run, TestHarness::GetFailureCount());
+    return (TestHarness::GetFailureCount() == 0 && run > 0) ? 0 : 1;
+}
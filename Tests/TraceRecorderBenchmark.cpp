@@ -0,0 +1,24 @@
+#include "BenchmarkHarness.h"
+
+#include "TraceRecorder.h"
+
+// Measures a TraceSpan around an empty scope, which is the overhead each
+// instrumented call pays, and the same span recorded with known times.
+int main(int argc, char** argv)
+{
+    bool quick = BenchmarkHarness::IsQuickRun(argc, argv);
+    uint64_t iterations = quick ? 100000 : 50000000;
+
+    BenchmarkHarness::Measure("TraceSpan, empty scope", iterations, [](uint64_t)
+    {
+        TraceSpan span("Key", "Callback");
+    });
+
+    TraceRecorder::Clock::time_point start = TraceRecorder::Clock::now();
+    BenchmarkHarness::Measure("Record, no clock reads", iterations, [&](uint64_t)
+    {
+        TraceRecorder::Record("Key", "Callback", start, start);
+    });
+
+    return 0;
+}
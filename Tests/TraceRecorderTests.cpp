@@ -0,0 +1,328 @@
+#include "TestHarness.h"
+
+#include "TraceRecorder.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Just enough of a JSON parser to tell whether the export is well formed.
+    class JsonChecker
+    {
+    public:
+        explicit JsonChecker(const std::string& textValue)
+            : text(textValue),
+            position(0)
+        {
+        }
+
+        bool IsValid()
+        {
+            return ParseValue() && (SkipSpace(), position == text.size());
+        }
+
+    private:
+        void SkipSpace()
+        {
+            while (position < text.size() && (text[position] == ' ' || text[position] == '\n' || text[position] == '\t' || text[position] == '\r'))
+            {
+                ++position;
+            }
+        }
+
+        bool Consume(char expected)
+        {
+            SkipSpace();
+            if (position < text.size() && text[position] == expected)
+            {
+                ++position;
+                return true;
+            }
+            return false;
+        }
+
+        bool ParseString()
+        {
+            if (!Consume('"'))
+            {
+                return false;
+            }
+            while (position < text.size())
+            {
+                unsigned char character = static_cast<unsigned char>(text[position++]);
+                if (character == '"')
+                {
+                    return true;
+                }
+                if (character < 0x20)
+                {
+                    return false;
+                }
+                if (character == '\\')
+                {
+                    if (position >= text.size() || std::string("\"\\/bfnrtu").find(text[position]) == std::string::npos)
+                    {
+                        return false;
+                    }
+                    ++position;
+                }
+            }
+            return false;
+        }
+
+        bool ParseNumber()
+        {
+            size_t start = position;
+            if (position < text.size() && text[position] == '-')
+            {
+                ++position;
+            }
+            while (position < text.size() && ((text[position] >= '0' && text[position] <= '9') || text[position] == '.'))
+            {
+                ++position;
+            }
+            return position > start;
+        }
+
+        bool ParseValue()
+        {
+            SkipSpace();
+            if (position >= text.size())
+            {
+                return false;
+            }
+
+            char first = text[position];
+            if (first == '"')
+            {
+                return ParseString();
+            }
+            if (first == '{' || first == '[')
+            {
+                char close = (first == '{') ? '}' : ']';
+                ++position;
+                if (Consume(close))
+                {
+                    return true;
+                }
+                do
+                {
+                    if (first == '{' && !(ParseString() && Consume(':')))
+                    {
+                        return false;
+                    }
+                    if (!ParseValue())
+                    {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume(close);
+            }
+            return ParseNumber();
+        }
+
+        const std::string& text;
+        size_t position;
+    };
+
+    struct ExportedSpan
+    {
+        std::string name;
+        std::string category;
+        double start;
+        double duration;
+    };
+
+    std::string ReadField(const std::string& line, const char* field)
+    {
+        std::string key = std::string("\"") + field + "\":";
+        size_t start = line.find(key);
+        if (start == std::string::npos)
+        {
+            return {};
+        }
+        start += key.size();
+        if (line[start] == '"')
+        {
+            size_t end = start + 1;
+            while (end < line.size() && (line[end] != '"' || line[end - 1] == '\\'))
+            {
+                ++end;
+            }
+            return line.substr(start + 1, end - start - 1);
+        }
+        size_t end = line.find_first_of(",}", start);
+        return line.substr(start, end - start);
+    }
+
+    // Groups the exported spans by thread name. The export writes one event
+    // per line.
+    std::map<std::string, std::vector<ExportedSpan>> ReadSpansByThread(const std::string& json)
+    {
+        std::map<std::string, std::string> threadNames;
+        std::map<std::string, std::vector<ExportedSpan>> spans;
+
+        size_t start = 0;
+        while (start < json.size())
+        {
+            size_t end = json.find('\n', start);
+            std::string line = json.substr(start, end - start);
+            start = (end == std::string::npos) ? json.size() : end + 1;
+
+            std::string phase = ReadField(line, "ph");
+            std::string tid = ReadField(line, "tid");
+            if (phase == "M")
+            {
+                threadNames[tid] = line.substr(line.find("\"args\":{\"name\":\"") + 16);
+                threadNames[tid].erase(threadNames[tid].find("\"}}"));
+            }
+            else if (phase == "X")
+            {
+                spans[threadNames[tid]].push_back({ ReadField(line, "name"), ReadField(line, "cat"),
+                    std::atof(ReadField(line, "ts").c_str()), std::atof(ReadField(line, "dur").c_str()) });
+            }
+        }
+        return spans;
+    }
+}
+
+TEST_CASE(NestedSpansExportPerNamedThread)
+{
+    std::thread worker([]()
+        {
+            TraceRecorder::SetThreadName("Nested worker");
+            TraceSpan outer("LGTV", "EnsurePersistentConnection");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            {
+                TraceSpan inner("LGTV", "SendText");
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    worker.join();
+
+    // The thread is gone, but its spans are still exported.
+    std::string json = TraceRecorder::ExportChromeTrace(1234);
+    CHECK(JsonChecker(json).IsValid());
+    CHECK(json.find("\"pid\":1234") != std::string::npos);
+
+    auto spans = ReadSpansByThread(json);
+    const std::vector<ExportedSpan>& recorded = spans["Nested worker"];
+    REQUIRE(recorded.size() == 2);
+
+    // Spans are recorded as they end, so the inner one comes first.
+    const ExportedSpan& inner = recorded[0];
+    const ExportedSpan& outer = recorded[1];
+    CHECK(inner.name == "SendText");
+    CHECK(outer.name == "EnsurePersistentConnection");
+    CHECK(outer.category == "LGTV");
+    CHECK(outer.start <= inner.start);
+    CHECK(inner.start + inner.duration <= outer.start + outer.duration);
+    CHECK(inner.duration >= 1000.0);
+    CHECK(outer.duration >= 2000.0);
+}
+
+TEST_CASE(NamesAreEscapedForJson)
+{
+    std::thread worker([]()
+        {
+            TraceRecorder::SetThreadName("Escape \"worker\" \\ \t");
+            TraceSpan span("Key\\", "Quote\"d\nname");
+        });
+    worker.join();
+
+    std::string json = TraceRecorder::ExportChromeTrace(1);
+    CHECK(JsonChecker(json).IsValid());
+    CHECK(json.find("\"Quote\\\"dname\"") != std::string::npos);
+    CHECK(json.find("\"Key\\\\\"") != std::string::npos);
+}
+
+TEST_CASE(BufferKeepsMostRecentSpans)
+{
+    constexpr size_t Extra = 10;
+    std::thread worker([]()
+        {
+            TraceRecorder::SetThreadName("Wrapping worker");
+            TraceRecorder::Clock::time_point base{};
+            for (size_t index = 0; index < TraceRecorder::SpansPerThread + Extra; ++index)
+            {
+                auto start = base + std::chrono::microseconds(index);
+                TraceRecorder::Record("Test", "Span", start, start + std::chrono::nanoseconds(5));
+            }
+        });
+    worker.join();
+
+    auto spans = ReadSpansByThread(TraceRecorder::ExportChromeTrace(1));
+    const std::vector<ExportedSpan>& recorded = spans["Wrapping worker"];
+    REQUIRE(recorded.size() == TraceRecorder::SpansPerThread);
+    CHECK(recorded.front().start == static_cast<double>(Extra));
+    CHECK(recorded.back().start == static_cast<double>(TraceRecorder::SpansPerThread + Extra - 1));
+    CHECK(recorded.back().duration == 0.005);
+}
+
+TEST_CASE(ExportWhileThreadsRecordSkipsTornSpans)
+{
+    static const char* const names[] = { "Recorder 0", "Recorder 1", "Recorder 2" };
+
+    // Each span's duration in nanoseconds is its start in microseconds, so
+    // a span mixed from two slot writes stands out.
+    std::atomic<bool> stop{ false };
+    std::atomic<int> running{ 0 };
+    std::vector<std::thread> recorders;
+    for (const char* name : names)
+    {
+        recorders.emplace_back([&stop, &running, name]()
+            {
+                TraceRecorder::SetThreadName(name);
+                TraceRecorder::Clock::time_point base{};
+                bool counted = false;
+                for (int64_t index = 1; !stop.load(); index = index % 999 + 1)
+                {
+                    auto start = base + std::chrono::microseconds(index);
+                    TraceRecorder::Record("Test", "Span", start, start + std::chrono::nanoseconds(index));
+                    if (!counted)
+                    {
+                        ++running;
+                        counted = true;
+                    }
+                }
+            });
+    }
+    CHECK(TestHarness::WaitUntil([&]() { return running.load() >= 3; }));
+
+    int exports = 0;
+    int tornSpans = 0;
+    size_t exportedSpans = 0;
+    while (exports < 20)
+    {
+        std::string json = TraceRecorder::ExportChromeTrace(1);
+        CHECK(JsonChecker(json).IsValid());
+
+        auto spans = ReadSpansByThread(json);
+        for (const char* name : names)
+        {
+            for (const ExportedSpan& span : spans[name])
+            {
+                if (static_cast<int64_t>(span.duration * 1000.0 + 0.5) != static_cast<int64_t>(span.start + 0.5))
+                {
+                    ++tornSpans;
+                }
+            }
+            exportedSpans += spans[name].size();
+        }
+        ++exports;
+    }
+
+    stop.store(true);
+    for (std::thread& recorder : recorders)
+    {
+        recorder.join();
+    }
+
+    CHECK(tornSpans == 0);
+    CHECK(exportedSpans > 0);
+}
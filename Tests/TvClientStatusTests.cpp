@@ -0,0 +1,158 @@
+#include "TestHarness.h"
+
+#include "TvClientStatus.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    constexpr TvClientError AllErrors[] =
+    {
+        TvClientError::None,
+        TvClientError::NotPaired,
+        TvClientError::NotConfigured,
+        TvClientError::MacMismatch,
+        TvClientError::ConnectFailed,
+        TvClientError::RegisterFailed,
+        TvClientError::SendFailed,
+        TvClientError::ReceiveFailed,
+    };
+}
+
+TEST_CASE(StartsIdle)
+{
+    TvClientStatusTracker tracker;
+    TvClientStatus status = tracker.GetStatus(false);
+    CHECK(!status.paired);
+    CHECK(!status.connected);
+    CHECK(status.lastError == TvClientError::None);
+    CHECK(status.lastCommandMilliseconds == 0);
+    CHECK(tracker.GetStatus(true).paired);
+}
+
+TEST_CASE(CommandOutcomeUpdatesErrorAndDuration)
+{
+    TvClientStatusTracker tracker;
+    TvClientStatusTracker::Clock::time_point started = TvClientStatusTracker::Clock::now();
+
+    CHECK(!tracker.RecordFailure(TvClientError::ConnectFailed));
+    CHECK(!tracker.CompleteCommand(false, started, started + 30ms));
+    TvClientStatus status = tracker.GetStatus(true);
+    CHECK(status.lastError == TvClientError::ConnectFailed);
+    CHECK(status.lastCommandMilliseconds == 0);
+
+    CHECK(tracker.CompleteCommand(true, started, started + 42ms + 900us));
+    status = tracker.GetStatus(true);
+    CHECK(status.lastError == TvClientError::None);
+    CHECK(status.lastCommandMilliseconds == 42);
+
+    // A later failure keeps the last successful duration.
+    tracker.RecordFailure(TvClientError::SendFailed);
+    CHECK(!tracker.CompleteCommand(false, started, started + 5ms));
+    status = tracker.GetStatus(true);
+    CHECK(status.lastError == TvClientError::SendFailed);
+    CHECK(status.lastCommandMilliseconds == 42);
+}
+
+TEST_CASE(ConnectionStateAndReset)
+{
+    TvClientStatusTracker tracker;
+    tracker.RecordFailure(TvClientError::RegisterFailed);
+    tracker.SetConnected(true);
+    TvClientStatus status = tracker.GetStatus(true);
+    CHECK(status.connected);
+    CHECK(status.lastError == TvClientError::None);
+
+    // Losing the connection keeps the failure that caused it.
+    tracker.RecordFailure(TvClientError::ReceiveFailed);
+    tracker.SetConnected(false);
+    status = tracker.GetStatus(true);
+    CHECK(!status.connected);
+    CHECK(status.lastError == TvClientError::ReceiveFailed);
+
+    tracker.ClearError();
+    CHECK(tracker.GetStatus(true).lastError == TvClientError::None);
+
+    TvClientStatusTracker::Clock::time_point started = TvClientStatusTracker::Clock::now();
+    tracker.CompleteCommand(true, started, started + 7ms);
+    tracker.RecordFailure(TvClientError::NotPaired);
+    tracker.Reset();
+    status = tracker.GetStatus(false);
+    CHECK(status.lastError == TvClientError::None);
+    CHECK(status.lastCommandMilliseconds == 0);
+}
+
+TEST_CASE(EveryErrorHasItsOwnText)
+{
+    std::set<std::wstring> texts;
+    for (TvClientError error : AllErrors)
+    {
+        std::wstring text = GetTvClientErrorText(error);
+        CHECK(!text.empty());
+        CHECK(texts.insert(text).second);
+    }
+    CHECK(std::wstring(GetTvClientErrorText(static_cast<TvClientError>(200))) == L"unknown error");
+}
+
+TEST_CASE(ReadersNeverWaitForTheConnectionOwner)
+{
+    // The owner holds its lock for a whole command, as LGWebOSClient does
+    // during network I/O; readers must still get through.
+    TvClientStatusTracker tracker;
+    std::mutex ownerLock;
+    std::atomic<bool> stop(false);
+    std::atomic<bool> ownerHoldsLock(false);
+    std::atomic<uint64_t> reads(0);
+    std::atomic<uint64_t> badReads(0);
+
+    std::thread owner([&]()
+    {
+        TvClientStatusTracker::Clock::time_point started = TvClientStatusTracker::Clock::now();
+        std::lock_guard<std::mutex> guard(ownerLock);
+        ownerHoldsLock.store(true);
+        while (!stop.load())
+        {
+            tracker.SetConnected(true);
+            tracker.CompleteCommand(true, started, started + 5ms);
+            tracker.RecordFailure(TvClientError::SendFailed);
+            tracker.SetConnected(false);
+        }
+    });
+
+    CHECK(TestHarness::WaitUntil([&]() { return ownerHoldsLock.load(); }));
+
+    std::vector<std::thread> readers;
+    for (int index = 0; index < 2; ++index)
+    {
+        readers.emplace_back([&]()
+        {
+            while (reads.load() < 100000)
+            {
+                TvClientStatus status = tracker.GetStatus(true);
+                bool knownError = status.lastError == TvClientError::None || status.lastError == TvClientError::SendFailed;
+                if (!knownError || (status.lastCommandMilliseconds != 0 && status.lastCommandMilliseconds != 5))
+                {
+                    badReads.fetch_add(1);
+                }
+                reads.fetch_add(1);
+            }
+        });
+    }
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+    stop.store(true);
+    owner.join();
+
+    CHECK(reads.load() >= 100000);
+    CHECK(badReads.load() == 0);
+}
@@ -0,0 +1,239 @@
+#include "TestHarness.h"
+
+#include "ConfigurationSchema.h"
+#include "TvProfile.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    AppConfiguration MakeConfiguration()
+    {
+        AppConfiguration configuration;
+        configuration.tvIpAddress = L"10.0.0.2";
+        configuration.tvMacAddress = L"00:11:22:33:44:55";
+        configuration.tvProfiles =
+        {
+            L"Bedroom|10.0.0.3|AA-BB|3000|0|LG OLED;!Monitor|x",
+            L"|10.0.0.9|x|3001|1|nameless",
+            L"Bad|10.0.0.9|x|99999|1|hint",
+            L"Bedroom|10.0.0.10|x|3001|1|duplicate",
+            L"Office|10.0.0.4||3001|1|",
+        };
+        return configuration;
+    }
+
+    AppConfiguration Reload(const AppConfiguration& configuration)
+    {
+        std::string contents = FormatConfiguration(configuration);
+        AppConfiguration loaded;
+        size_t start = 0;
+        while (start < contents.size())
+        {
+            size_t end = contents.find('\n', start);
+            std::string_view key;
+            ApplyConfigurationLine(std::string_view(contents).substr(start, end - start), loaded, key);
+            start = end + 1;
+        }
+        return loaded;
+    }
+}
+
+TEST_CASE(ParsesDocumentedEntry)
+{
+    TvProfile profile;
+    REQUIRE(ParseTvProfile(L"Bedroom|10.0.0.3|AA-BB|3000|0|LG OLED;!Monitor|x", profile));
+    CHECK(profile.name == L"Bedroom");
+    CHECK(profile.tvIpAddress == L"10.0.0.3");
+    CHECK(profile.tvMacAddress == L"AA-BB");
+    CHECK(profile.tvPort == 3000);
+    CHECK(!profile.useSecureWebSocket);
+    CHECK(profile.deviceNameHint == L"LG OLED;!Monitor|x");
+    CHECK(std::wstring(GetTvProfileDisplayName(profile)) == L"Bedroom");
+
+    REQUIRE(ParseTvProfile(L"Office|||65535|1|", profile));
+    CHECK(profile.tvIpAddress.empty());
+    CHECK(profile.tvPort == 65535);
+    CHECK(profile.useSecureWebSocket);
+    CHECK(profile.deviceNameHint.empty());
+}
+
+TEST_CASE(RejectsMalformedEntriesWithoutTouchingProfile)
+{
+    const wchar_t* malformed[] =
+    {
+        L"", L"Bedroom", L"Bedroom|ip|mac|3000|1", L"|ip|mac|3000|1|hint", L"Bedroom|ip|mac|0|1|hint",
+        L"Bedroom|ip|mac|65536|1|hint", L"Bedroom|ip|mac|300a|1|hint", L"Bedroom|ip|mac||1|hint",
+        L"Bedroom|ip|mac|003000|1|hint", L"Bedroom|ip|mac|3000|yes|hint", L"Bedroom|ip|mac|3000||hint",
+    };
+
+    TvProfile profile;
+    profile.name = L"Unchanged";
+    for (const wchar_t* entry : malformed)
+    {
+        CHECK(!ParseTvProfile(entry, profile));
+        CHECK(profile.name == L"Unchanged");
+    }
+}
+
+TEST_CASE(FormatRoundTripsThroughParse)
+{
+    uint32_t state = 0x1234567;
+    auto next = [&state]()
+    {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    };
+    auto randomText = [&next](bool allowSeparator)
+    {
+        static const wchar_t characters[] = L"abcXYZ019.:-_; !\x00E9\x30C6|";
+        size_t choices = allowSeparator ? 19 : 18;
+        std::wstring text;
+        for (uint32_t length = next() % 12; length > 0; --length)
+        {
+            text.push_back(characters[next() % choices]);
+        }
+        return text;
+    };
+
+    for (int round = 0; round < 5000; ++round)
+    {
+        TvProfile profile;
+        profile.name = L"P" + randomText(false);
+        profile.tvIpAddress = randomText(false);
+        profile.tvMacAddress = randomText(false);
+        profile.deviceNameHint = randomText(true);
+        profile.tvPort = static_cast<unsigned short>(1 + next() % 65535);
+        profile.useSecureWebSocket = (next() & 1) != 0;
+
+        TvProfile parsed;
+        REQUIRE(ParseTvProfile(FormatTvProfile(profile), parsed));
+        CHECK(parsed.name == profile.name);
+        CHECK(CompareTvProfiles(profile, parsed) == ConfigurationChangeNone);
+    }
+}
+
+TEST_CASE(ListsNamedProfilesThenDefault)
+{
+    std::vector<TvProfile> profiles = GetTvProfiles(MakeConfiguration());
+
+    // Malformed entries and the repeated name are skipped.
+    REQUIRE(profiles.size() == 3);
+    CHECK(profiles[0].name == L"Bedroom");
+    CHECK(profiles[0].tvIpAddress == L"10.0.0.3");
+    CHECK(profiles[1].name == L"Office");
+    CHECK(profiles[2].name.empty());
+    CHECK(profiles[2].tvIpAddress == L"10.0.0.2");
+    CHECK(profiles[2].tvMacAddress == L"00:11:22:33:44:55");
+    CHECK(profiles[2].deviceNameHint == L"LG");
+    CHECK(std::wstring(GetTvProfileDisplayName(profiles[2])) == L"Default");
+
+    TvProfile found;
+    CHECK(FindTvProfile(MakeConfiguration(), L"Office", found));
+    CHECK(found.tvIpAddress == L"10.0.0.4");
+    CHECK(FindTvProfile(MakeConfiguration(), L"", found));
+    CHECK(found.tvIpAddress == L"10.0.0.2");
+    CHECK(!FindTvProfile(MakeConfiguration(), L"Bad", found));
+    CHECK(!FindTvProfile(MakeConfiguration(), L"Nope", found));
+}
+
+TEST_CASE(StoreUpdatesTheEntryProfilesAreReadFrom)
+{
+    AppConfiguration configuration = MakeConfiguration();
+
+    TvProfile bedroom;
+    REQUIRE(FindTvProfile(configuration, L"Bedroom", bedroom));
+    bedroom.tvMacAddress = L"CC-DD";
+    CHECK(StoreTvProfile(configuration, bedroom));
+
+    // The first Bedroom entry is rewritten in place; the ignored duplicate
+    // and the other entries stay as they were.
+    CHECK(configuration.tvProfiles.size() == 5);
+    CHECK(configuration.tvProfiles[0] == L"Bedroom|10.0.0.3|CC-DD|3000|0|LG OLED;!Monitor|x");
+    CHECK(configuration.tvProfiles[3] == L"Bedroom|10.0.0.10|x|3001|1|duplicate");
+
+    TvProfile kitchen;
+    kitchen.name = L"Kitchen";
+    kitchen.tvIpAddress = L"10.0.0.5";
+    CHECK(StoreTvProfile(configuration, kitchen));
+    CHECK(configuration.tvProfiles.size() == 6);
+    CHECK(configuration.tvProfiles.back() == L"Kitchen|10.0.0.5||3001|1|");
+
+    TvProfile defaultProfile;
+    REQUIRE(FindTvProfile(configuration, L"", defaultProfile));
+    defaultProfile.tvPort = 3000;
+    defaultProfile.useSecureWebSocket = false;
+    CHECK(StoreTvProfile(configuration, defaultProfile));
+    CHECK(configuration.tvPort == 3000);
+    CHECK(!configuration.useSecureWebSocket);
+    CHECK(configuration.tvProfiles.size() == 6);
+
+    // Every profile survives a save and reload.
+    AppConfiguration reloaded = Reload(configuration);
+    std::vector<TvProfile> before = GetTvProfiles(configuration);
+    std::vector<TvProfile> after = GetTvProfiles(reloaded);
+    REQUIRE(before.size() == after.size());
+    for (size_t index = 0; index < before.size(); ++index)
+    {
+        CHECK(after[index].name == before[index].name);
+        CHECK(CompareTvProfiles(before[index], after[index]) == ConfigurationChangeNone);
+    }
+}
+
+TEST_CASE(StoreRejectsSeparatorBeforeHint)
+{
+    AppConfiguration configuration = MakeConfiguration();
+    std::vector<std::wstring> entries = configuration.tvProfiles;
+
+    TvProfile office;
+    REQUIRE(FindTvProfile(configuration, L"Office", office));
+
+    TvProfile changed = office;
+    changed.tvIpAddress = L"10.0.0.4|3000";
+    CHECK(!StoreTvProfile(configuration, changed));
+    changed = office;
+    changed.tvMacAddress = L"AA|BB";
+    CHECK(!StoreTvProfile(configuration, changed));
+    changed = office;
+    changed.name = L"Office|Upstairs";
+    CHECK(!StoreTvProfile(configuration, changed));
+    CHECK(configuration.tvProfiles == entries);
+
+    // The hint is last, so it may contain the separator.
+    changed = office;
+    changed.deviceNameHint = L"LG|Samsung";
+    CHECK(StoreTvProfile(configuration, changed));
+    REQUIRE(FindTvProfile(configuration, L"Office", office));
+    CHECK(office.deviceNameHint == L"LG|Samsung");
+
+    // The default profile lives in separate settings.
+    TvProfile defaultProfile;
+    REQUIRE(FindTvProfile(configuration, L"", defaultProfile));
+    defaultProfile.tvMacAddress = L"AA|BB";
+    CHECK(StoreTvProfile(configuration, defaultProfile));
+    CHECK(configuration.tvMacAddress == L"AA|BB");
+}
+
+TEST_CASE(CompareReportsEachChangedField)
+{
+    TvProfile base;
+    CHECK(CompareTvProfiles(base, base) == ConfigurationChangeNone);
+
+    TvProfile changed = base;
+    changed.name = L"Renamed";
+    CHECK(CompareTvProfiles(base, changed) == ConfigurationChangeNone);
+
+    changed = base;
+    changed.tvIpAddress = L"10.0.0.7";
+    changed.tvPort = 3000;
+    CHECK(CompareTvProfiles(base, changed) == (ConfigurationChangeTvIpAddress | ConfigurationChangeTvPort));
+
+    changed = base;
+    changed.tvMacAddress = L"x";
+    changed.deviceNameHint = L"y";
+    changed.useSecureWebSocket = false;
+    CHECK(CompareTvProfiles(base, changed) ==
+        (ConfigurationChangeTvMacAddress | ConfigurationChangeDeviceNameHint | ConfigurationChangeUseSecureWebSocket));
+}
@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "VolumePinPolicy.h"
+
+#include <cstdint>
+
+namespace
+{
+    using namespace std::chrono_literals;
+    using Clock = VolumePinPolicy::Clock;
+
+    // An endpoint volume that other applications move. Our own writes are
+    // reported back as own changes, like a tagged event context.
+    struct SimulatedVolume
+    {
+        VolumePinPolicy& policy;
+        float level = 0.5f;
+        uint64_t ownWrites = 0;
+
+        void SetByOtherApplication(float value, Clock::time_point now)
+        {
+            level = value;
+            if (policy.OnVolumeChanged(level, false, now))
+            {
+                level = policy.GetPinnedLevel();
+                ++ownWrites;
+                policy.OnVolumeChanged(level, true, now);
+            }
+        }
+    };
+}
+
+TEST_CASE(IgnoresChangesWhileUnpinnedAndOwnChanges)
+{
+    VolumePinPolicy policy;
+    Clock::time_point now = Clock::now();
+
+    CHECK(!policy.IsPinned());
+    CHECK(!policy.OnVolumeChanged(0.2f, false, now));
+
+    policy.Pin(1.0f);
+    CHECK(policy.IsPinned());
+    CHECK(policy.GetPinnedLevel() == 1.0f);
+    CHECK(!policy.OnVolumeChanged(0.2f, true, now));
+
+    policy.Unpin();
+    CHECK(!policy.OnVolumeChanged(0.2f, false, now));
+
+    CHECK(policy.GetNotificationCount() == 3);
+    CHECK(policy.GetDriftCount() == 0);
+    CHECK(policy.GetRepinCount() == 0);
+}
+
+TEST_CASE(RepinsOnlyBeyondTolerance)
+{
+    VolumePinPolicy::Settings settings;
+    settings.tolerance = 0.01f;
+    VolumePinPolicy policy(settings);
+    policy.Pin(0.5f);
+    Clock::time_point now = Clock::now();
+
+    CHECK(!policy.OnVolumeChanged(0.505f, false, now));
+    CHECK(!policy.OnVolumeChanged(0.495f, false, now));
+    CHECK(policy.OnVolumeChanged(0.52f, false, now));
+    CHECK(policy.OnVolumeChanged(0.48f, false, now));
+    CHECK(policy.GetDriftCount() == 2);
+    CHECK(policy.GetRepinCount() == 2);
+}
+
+TEST_CASE(RateLimitsRepinsPerWindow)
+{
+    VolumePinPolicy::Settings settings;
+    settings.maxRepinsPerWindow = 3;
+    settings.window = 1s;
+    VolumePinPolicy policy(settings);
+    policy.Pin(1.0f);
+
+    Clock::time_point start = Clock::now();
+    int repins = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        repins += policy.OnVolumeChanged(0.3f, false, start + i * 10ms) ? 1 : 0;
+    }
+    CHECK(repins == 3);
+    CHECK(policy.GetSuppressedCount() == 7);
+
+    // A new window allows repins again.
+    CHECK(policy.OnVolumeChanged(0.3f, false, start + 1s));
+    CHECK(policy.GetRepinCount() == 4);
+
+    // Pinning again starts from a fresh window.
+    for (int i = 0; i < 2; ++i)
+    {
+        policy.OnVolumeChanged(0.3f, false, start + 1s);
+    }
+    CHECK(!policy.OnVolumeChanged(0.3f, false, start + 1s));
+    policy.Pin(1.0f);
+    CHECK(policy.OnVolumeChanged(0.3f, false, start + 1s));
+}
+
+TEST_CASE(HoldsLevelAgainstOtherApplications)
+{
+    VolumePinPolicy policy;
+    SimulatedVolume volume{ policy };
+    policy.Pin(1.0f);
+
+    // Occasional changes by other applications are all corrected.
+    Clock::time_point now = Clock::now();
+    for (int i = 0; i < 50; ++i)
+    {
+        volume.SetByOtherApplication(0.1f * static_cast<float>(i % 10), now);
+        CHECK(volume.level == 1.0f);
+        now += 500ms;
+    }
+    CHECK(policy.GetSuppressedCount() == 0);
+
+    // An application that fights over the volume gets at most the allowed
+    // number of corrections per window instead of a busy loop.
+    Clock::time_point fightStart = now;
+    uint64_t writesBeforeFight = volume.ownWrites;
+    for (int i = 0; i < 1000; ++i)
+    {
+        volume.SetByOtherApplication(0.25f, fightStart + i * 1ms);
+    }
+    uint64_t windows = 1 + (1000ms / VolumePinPolicy::Settings().window);
+    CHECK(policy.GetSuppressedCount() > 0);
+    CHECK(volume.ownWrites - writesBeforeFight <= windows * VolumePinPolicy::Settings().maxRepinsPerWindow);
+
+    // Once the window has passed, the next change is corrected again.
+    volume.SetByOtherApplication(0.25f, fightStart + 10s);
+    CHECK(volume.level == 1.0f);
+}
@@ -0,0 +1,145 @@
+// Turns a binary log (LGTVVolumeProxy.binlog, a LogRing file, or a plain
+// binary log stream) back into the text log format, oldest entry first.
+//
+// Usage: LogDecoder [--threads] <file.binlog>
+//
+// Builds with the LogDecoder project in the solution, or anywhere with a
+// C++20 compiler, for example on Linux:
+//   g++ -std=c++20 -O2 -I../.. LogDecoder.cpp ../../BinaryLogFormat.cpp ../../LogRing.cpp -o LogDecoder
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#include "BinaryLogFormat.h"
+#include "LogRing.h"
+
+namespace
+{
+    // FILETIME counts 100 ns intervals since 1601-01-01.
+    constexpr uint64_t FileTimeTicksPerSecond = 10000000ull;
+    constexpr uint64_t FileTimeUnixEpochSeconds = 11644473600ull;
+
+    std::string FormatTimestamp(uint64_t timestamp)
+    {
+        std::time_t seconds = static_cast<std::time_t>(timestamp / FileTimeTicksPerSecond - FileTimeUnixEpochSeconds);
+        std::tm localTime{};
+#ifdef _WIN32
+        localtime_s(&localTime, &seconds);
+#else
+        localtime_r(&seconds, &localTime);
+#endif
+
+        char buffer[32]{};
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &localTime);
+        return buffer;
+    }
+
+    int PrintUsage()
+    {
+        std::fprintf(stderr, "Usage: LogDecoder [--threads] <file.binlog>\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool showThreads = false;
+    const char* path = nullptr;
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--threads") == 0)
+        {
+            showThreads = true;
+        }
+        else if (path == nullptr)
+        {
+            path = argv[index];
+        }
+        else
+        {
+            return PrintUsage();
+        }
+    }
+
+    if (path == nullptr)
+    {
+        return PrintUsage();
+    }
+
+    std::FILE* file = nullptr;
+#ifdef _WIN32
+    fopen_s(&file, path, "rb");
+#else
+    file = std::fopen(path, "rb");
+#endif
+    if (file == nullptr)
+    {
+        std::fprintf(stderr, "LogDecoder: cannot open %s\n", path);
+        return 1;
+    }
+
+    std::string contents;
+    char chunk[65536];
+    size_t read = 0;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        contents.append(chunk, read);
+    }
+    std::fclose(file);
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+    std::string stream;
+    uint64_t wrapCount = 0;
+    bool isRing = contents.size() >= sizeof(LogRing::Magic) &&
+        std::memcmp(data, LogRing::Magic, sizeof(LogRing::Magic)) == 0;
+    if (isRing)
+    {
+        if (!LogRing::Read(data, contents.size(), stream, wrapCount))
+        {
+            std::fprintf(stderr, "LogDecoder: %s has a corrupt ring header\n", path);
+            return 1;
+        }
+        data = reinterpret_cast<const uint8_t*>(stream.data());
+    }
+    size_t size = isRing ? stream.size() : contents.size();
+
+    BinaryLogDecoder decoder;
+    bool valid = true;
+    size_t consumed = decoder.Decode(data, size, [showThreads](const BinaryLogDecoder::Line& line)
+        {
+            std::string timestamp = FormatTimestamp(line.timestamp);
+            if (showThreads)
+            {
+                std::printf("[%s][%s][%u] %s\n", timestamp.c_str(), GetLogLevelName(line.level),
+                    static_cast<unsigned int>(line.threadId), line.message.c_str());
+            }
+            else
+            {
+                std::printf("[%s][%s] %s\n", timestamp.c_str(), GetLogLevelName(line.level), line.message.c_str());
+            }
+        }, valid);
+
+    if (!valid)
+    {
+        std::fprintf(stderr, "LogDecoder: %s is not a binary log or is corrupt\n", path);
+        return 1;
+    }
+    if (consumed < size)
+    {
+        std::fprintf(stderr, "LogDecoder: ignored %zu trailing bytes of an incomplete entry\n", size - consumed);
+    }
+    if (wrapCount > 0)
+    {
+        std::fprintf(stderr, "LogDecoder: the ring wrapped %llu time(s); older entries were overwritten\n",
+            static_cast<unsigned long long>(wrapCount));
+    }
+
+    std::fprintf(stderr, "LogDecoder: %llu entries, %llu sessions, %llu dropped, %llu with unknown sites\n",
+        static_cast<unsigned long long>(decoder.GetEntryCount()),
+        static_cast<unsigned long long>(decoder.GetSessionCount()),
+        static_cast<unsigned long long>(decoder.GetDroppedCount()),
+        static_cast<unsigned long long>(decoder.GetUnknownSiteCount()));
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // Span fields are atomics so export can read a slot while its thread
+    // rewrites it; the slot's index tells whether the copy is still valid.
+    struct SpanSlot
+    {
+        std::atomic<const char*> category;
+        std::atomic<const char*> name;
+        std::atomic<int64_t> start;
+        std::atomic<int64_t> duration;
+    };
+
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(uint32_t threadIdValue)
+            : threadId(threadIdValue),
+            name(nullptr),
+            started(0),
+            finished(0),
+            slots(new SpanSlot[TraceRecorder::SpansPerThread])
+        {
+        }
+
+        const uint32_t threadId;
+        std::atomic<const char*> name;
+        // Spans ever begun and completely written; span n lives in slot
+        // n % SpansPerThread. Only the owning thread writes.
+        std::atomic<uint64_t> started;
+        std::atomic<uint64_t> finished;
+        std::unique_ptr<SpanSlot[]> slots;
+    };
+
+    struct Span
+    {
+        const char* category;
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+
+    std::mutex g_bufferMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+
+    ThreadBuffer* CreateThreadBuffer()
+    {
+        std::lock_guard<std::mutex> guard(g_bufferMutex);
+        g_buffers.emplace_back(new ThreadBuffer(static_cast<uint32_t>(g_buffers.size() + 1)));
+        return g_buffers.back().get();
+    }
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = CreateThreadBuffer();
+        return *buffer;
+    }
+
+    int64_t ToNanoseconds(TraceRecorder::Clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    // Copies the spans still present in a buffer, oldest first.
+    void CopySpans(const ThreadBuffer& buffer, std::vector<Span>& spans)
+    {
+        spans.clear();
+
+        uint64_t end = buffer.finished.load(std::memory_order_acquire);
+        uint64_t begin = (end > TraceRecorder::SpansPerThread) ? end - TraceRecorder::SpansPerThread : 0;
+        for (uint64_t index = begin; index < end; ++index)
+        {
+            const SpanSlot& slot = buffer.slots[index % TraceRecorder::SpansPerThread];
+            Span span{};
+            span.category = slot.category.load(std::memory_order_relaxed);
+            span.name = slot.name.load(std::memory_order_relaxed);
+            span.start = slot.start.load(std::memory_order_relaxed);
+            span.duration = slot.duration.load(std::memory_order_relaxed);
+            spans.push_back(span);
+        }
+
+        // Anything the thread wrapped over while we copied may be torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = buffer.started.load(std::memory_order_relaxed);
+        uint64_t firstValid = (after > TraceRecorder::SpansPerThread) ? after - TraceRecorder::SpansPerThread : 0;
+        if (firstValid > begin)
+        {
+            size_t torn = static_cast<size_t>((std::min)(firstValid - begin, end - begin));
+            spans.erase(spans.begin(), spans.begin() + torn);
+        }
+    }
+
+    void AppendJsonString(std::string& json, const char* text)
+    {
+        json += '"';
+        for (const char* character = (text != nullptr) ? text : ""; *character != '\0'; ++character)
+        {
+            if (*character == '"' || *character == '\\')
+            {
+                json += '\\';
+            }
+            if (static_cast<unsigned char>(*character) >= 0x20)
+            {
+                json += *character;
+            }
+        }
+        json += '"';
+    }
+
+    // Chrome trace timestamps are microseconds; keep nanosecond precision.
+    void AppendMicroseconds(std::string& json, int64_t nanoseconds)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%lld.%03lld",
+            static_cast<long long>(nanoseconds / 1000),
+            static_cast<long long>(nanoseconds % 1000));
+        json += text;
+    }
+}
+
+namespace TraceRecorder
+{
+    void SetThreadName(const char* name)
+    {
+        GetThreadBuffer().name.store(name, std::memory_order_relaxed);
+    }
+
+    void Record(const char* category, const char* name, Clock::time_point start, Clock::time_point end)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        uint64_t index = buffer.finished.load(std::memory_order_relaxed);
+        SpanSlot& slot = buffer.slots[index % SpansPerThread];
+
+        // Announce the rewrite before touching the slot so export can tell
+        // that its copy of the slot's previous span may be torn.
+        buffer.started.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(ToNanoseconds(start.time_since_epoch()), std::memory_order_relaxed);
+        slot.duration.store(ToNanoseconds(end - start), std::memory_order_relaxed);
+        buffer.finished.store(index + 1, std::memory_order_release);
+    }
+
+    std::string ExportChromeTrace(uint32_t processId)
+    {
+        std::vector<ThreadBuffer*> buffers;
+        {
+            std::lock_guard<std::mutex> guard(g_bufferMutex);
+            for (const std::unique_ptr<ThreadBuffer>& buffer : g_buffers)
+            {
+                buffers.push_back(buffer.get());
+            }
+        }
+
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        std::string pid = std::to_string(processId);
+        bool first = true;
+        std::vector<Span> spans;
+        for (const ThreadBuffer* buffer : buffers)
+        {
+            std::string tid = std::to_string(buffer->threadId);
+            const char* threadName = buffer->name.load(std::memory_order_relaxed);
+            std::string defaultName = "Thread " + tid;
+
+            json += first ? "\n" : ",\n";
+            first = false;
+            json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+            AppendJsonString(json, (threadName != nullptr) ? threadName : defaultName.c_str());
+            json += "}}";
+
+            CopySpans(*buffer, spans);
+            for (const Span& span : spans)
+            {
+                json += ",\n{\"name\":";
+                AppendJsonString(json, span.name);
+                json += ",\"cat\":";
+                AppendJsonString(json, span.category);
+                json += ",\"ph\":\"X\",\"ts\":";
+                AppendMicroseconds(json, span.start);
+                json += ",\"dur\":";
+                AppendMicroseconds(json, span.duration);
+                json += ",\"pid\":" + pid + ",\"tid\":" + tid + "}";
+            }
+        }
+        json += "\n]}\n";
+        return json;
+    }
+}
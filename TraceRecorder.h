@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Records timing spans from any thread and exports them as a Chrome trace
+// (JSON "trace event" format), which chrome://tracing and ui.perfetto.dev
+// open directly.
+//
+// Each thread records into its own fixed-size buffer, created on the thread's
+// first span, so recording takes no lock and never allocates afterwards. A
+// buffer keeps the thread's most recent SpansPerThread spans. Export copies
+// the buffers while threads keep recording; spans overwritten during the copy
+// are left out. Buffers are kept after their thread exits so its spans can
+// still be exported.
+namespace TraceRecorder
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t SpansPerThread = 4096;
+
+    // Names the calling thread in exported traces. name must outlive the
+    // process, normally a string literal.
+    void SetThreadName(const char* name);
+
+    // Records a finished span. category and name must be string literals.
+    void Record(const char* category, const char* name, Clock::time_point start, Clock::time_point end);
+
+    // Builds a Chrome trace of every recorded span.
+    std::string ExportChromeTrace(uint32_t processId);
+}
+
+// Records the enclosing scope as a span:
+//   TraceSpan span("LGTV", "SendText");
+class TraceSpan
+{
+public:
+    TraceSpan(const char* categoryValue, const char* nameValue)
+        : category(categoryValue),
+        name(nameValue),
+        start(TraceRecorder::Clock::now())
+    {
+    }
+
+    ~TraceSpan()
+    {
+        TraceRecorder::Record(category, name, start, TraceRecorder::Clock::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* category;
+    const char* name;
+    TraceRecorder::Clock::time_point start;
+};
@@ -0,0 +1,79 @@
+#include "TvClientStatus.h"
+
+const wchar_t* GetTvClientErrorText(TvClientError error)
+{
+    switch (error)
+    {
+    case TvClientError::None:
+        return L"no error";
+    case TvClientError::NotPaired:
+        return L"not paired";
+    case TvClientError::NotConfigured:
+        return L"no TV address";
+    case TvClientError::MacMismatch:
+        return L"MAC mismatch";
+    case TvClientError::ConnectFailed:
+        return L"connect failed";
+    case TvClientError::RegisterFailed:
+        return L"registration failed";
+    case TvClientError::SendFailed:
+        return L"send failed";
+    case TvClientError::ReceiveFailed:
+        return L"receive failed";
+    }
+    return L"unknown error";
+}
+
+TvClientStatusTracker::TvClientStatusTracker()
+    : connected(false),
+    lastError(TvClientError::None),
+    lastCommandMilliseconds(0)
+{
+}
+
+void TvClientStatusTracker::Reset()
+{
+    lastError.store(TvClientError::None, std::memory_order_release);
+    lastCommandMilliseconds.store(0, std::memory_order_relaxed);
+}
+
+void TvClientStatusTracker::SetConnected(bool connectedValue)
+{
+    connected.store(connectedValue, std::memory_order_release);
+    if (connectedValue)
+    {
+        lastError.store(TvClientError::None, std::memory_order_release);
+    }
+}
+
+void TvClientStatusTracker::ClearError()
+{
+    lastError.store(TvClientError::None, std::memory_order_release);
+}
+
+bool TvClientStatusTracker::RecordFailure(TvClientError error)
+{
+    lastError.store(error, std::memory_order_release);
+    return false;
+}
+
+bool TvClientStatusTracker::CompleteCommand(bool succeeded, Clock::time_point started, Clock::time_point finished)
+{
+    if (succeeded)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(finished - started);
+        lastCommandMilliseconds.store(static_cast<uint32_t>(elapsed.count()), std::memory_order_relaxed);
+        lastError.store(TvClientError::None, std::memory_order_release);
+    }
+    return succeeded;
+}
+
+TvClientStatus TvClientStatusTracker::GetStatus(bool paired) const
+{
+    TvClientStatus status;
+    status.paired = paired;
+    status.connected = connected.load(std::memory_order_acquire);
+    status.lastError = lastError.load(std::memory_order_acquire);
+    status.lastCommandMilliseconds = lastCommandMilliseconds.load(std::memory_order_relaxed);
+    return status;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Why the last command or connection attempt failed.
+enum class TvClientError : uint8_t
+{
+    None,
+    NotPaired,
+    // No configuration store, or no TV IP address.
+    NotConfigured,
+    MacMismatch,
+    ConnectFailed,
+    RegisterFailed,
+    SendFailed,
+    ReceiveFailed
+};
+
+// Returns a short description for the status text.
+const wchar_t* GetTvClientErrorText(TvClientError error);
+
+// What the UI shows about a client; see LGWebOSClient::GetStatus.
+struct TvClientStatus
+{
+    bool paired = false;
+    // The persistent connection is open and registered.
+    bool connected = false;
+    TvClientError lastError = TvClientError::None;
+    // Time the last successful command took, including opening the
+    // connection when it had to; 0 before the first one.
+    uint32_t lastCommandMilliseconds = 0;
+};
+
+// The connection state and command outcome of one client. The connection
+// owner updates it while holding the client's lock; GetStatus reads it from
+// any thread without that lock, so the UI never waits for network I/O.
+class TvClientStatusTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TvClientStatusTracker();
+
+    TvClientStatusTracker(const TvClientStatusTracker&) = delete;
+    TvClientStatusTracker& operator=(const TvClientStatusTracker&) = delete;
+
+    // Forgets the error and command time, e.g. when the profile changes.
+    void Reset();
+
+    // Records whether the persistent connection is registered. A registered
+    // connection clears the last error.
+    void SetConnected(bool connected);
+
+    // Clears the last error, e.g. after pairing succeeded.
+    void ClearError();
+
+    // Records error as the last failure and returns false, so failure paths
+    // can end with "return RecordFailure(...)".
+    bool RecordFailure(TvClientError error);
+
+    // Records the duration of a successful command and clears the error; a
+    // failed command keeps the error it recorded. Returns succeeded.
+    bool CompleteCommand(bool succeeded, Clock::time_point started, Clock::time_point finished);
+
+    TvClientStatus GetStatus(bool paired) const;
+
+private:
+    std::atomic<bool> connected;
+    std::atomic<TvClientError> lastError;
+    std::atomic<uint32_t> lastCommandMilliseconds;
+};
@@ -0,0 +1,210 @@
+#include "TvProfile.h"
+
+namespace
+{
+    constexpr wchar_t Separator = L'|';
+    constexpr size_t FieldsBeforeHint = 5;
+
+    bool ParsePort(const std::wstring& value, unsigned short& port)
+    {
+        if (value.empty() || value.size() > 5)
+        {
+            return false;
+        }
+
+        unsigned long parsed = 0;
+        for (wchar_t character : value)
+        {
+            if (character < L'0' || character > L'9')
+            {
+                return false;
+            }
+            parsed = parsed * 10 + static_cast<unsigned long>(character - L'0');
+        }
+
+        if (parsed == 0 || parsed > 65535)
+        {
+            return false;
+        }
+
+        port = static_cast<unsigned short>(parsed);
+        return true;
+    }
+
+    bool ContainsSeparator(const std::wstring& value)
+    {
+        return value.find(Separator) != std::wstring::npos;
+    }
+}
+
+bool ParseTvProfile(const std::wstring& entry, TvProfile& profile)
+{
+    std::wstring fields[FieldsBeforeHint];
+    size_t start = 0;
+    for (size_t index = 0; index < FieldsBeforeHint; ++index)
+    {
+        size_t separator = entry.find(Separator, start);
+        if (separator == std::wstring::npos)
+        {
+            return false;
+        }
+        fields[index] = entry.substr(start, separator - start);
+        start = separator + 1;
+    }
+
+    TvProfile parsed;
+    parsed.name = fields[0];
+    parsed.tvIpAddress = fields[1];
+    parsed.tvMacAddress = fields[2];
+    parsed.deviceNameHint = entry.substr(start);
+
+    if (parsed.name.empty() || !ParsePort(fields[3], parsed.tvPort))
+    {
+        return false;
+    }
+
+    if (fields[4] == L"1")
+    {
+        parsed.useSecureWebSocket = true;
+    }
+    else if (fields[4] == L"0")
+    {
+        parsed.useSecureWebSocket = false;
+    }
+    else
+    {
+        return false;
+    }
+
+    profile = std::move(parsed);
+    return true;
+}
+
+std::wstring FormatTvProfile(const TvProfile& profile)
+{
+    std::wstring entry = profile.name;
+    entry += Separator;
+    entry += profile.tvIpAddress;
+    entry += Separator;
+    entry += profile.tvMacAddress;
+    entry += Separator;
+    entry += std::to_wstring(profile.tvPort);
+    entry += Separator;
+    entry += profile.useSecureWebSocket ? L'1' : L'0';
+    entry += Separator;
+    entry += profile.deviceNameHint;
+    return entry;
+}
+
+bool StoreTvProfile(AppConfiguration& configuration, const TvProfile& profile)
+{
+    if (profile.name.empty())
+    {
+        configuration.tvIpAddress = profile.tvIpAddress;
+        configuration.tvMacAddress = profile.tvMacAddress;
+        configuration.deviceNameHint = profile.deviceNameHint;
+        configuration.useSecureWebSocket = profile.useSecureWebSocket;
+        configuration.tvPort = profile.tvPort;
+        return true;
+    }
+
+    // Only the hint is last and may contain the separator.
+    if (ContainsSeparator(profile.name) ||
+        ContainsSeparator(profile.tvIpAddress) ||
+        ContainsSeparator(profile.tvMacAddress))
+    {
+        return false;
+    }
+
+    std::wstring entry = FormatTvProfile(profile);
+    for (std::wstring& existing : configuration.tvProfiles)
+    {
+        TvProfile parsed;
+        if (ParseTvProfile(existing, parsed) && parsed.name == profile.name)
+        {
+            existing = std::move(entry);
+            return true;
+        }
+    }
+    configuration.tvProfiles.push_back(std::move(entry));
+    return true;
+}
+
+std::vector<TvProfile> GetTvProfiles(const AppConfiguration& configuration)
+{
+    std::vector<TvProfile> profiles;
+    profiles.reserve(configuration.tvProfiles.size() + 1);
+
+    for (const std::wstring& entry : configuration.tvProfiles)
+    {
+        TvProfile profile;
+        if (!ParseTvProfile(entry, profile))
+        {
+            continue;
+        }
+
+        bool duplicate = false;
+        for (const TvProfile& existing : profiles)
+        {
+            duplicate = duplicate || existing.name == profile.name;
+        }
+        if (!duplicate)
+        {
+            profiles.push_back(std::move(profile));
+        }
+    }
+
+    TvProfile defaultProfile;
+    defaultProfile.tvIpAddress = configuration.tvIpAddress;
+    defaultProfile.tvMacAddress = configuration.tvMacAddress;
+    defaultProfile.deviceNameHint = configuration.deviceNameHint;
+    defaultProfile.useSecureWebSocket = configuration.useSecureWebSocket;
+    defaultProfile.tvPort = configuration.tvPort;
+    profiles.push_back(std::move(defaultProfile));
+
+    return profiles;
+}
+
+bool FindTvProfile(const AppConfiguration& configuration, const std::wstring& name, TvProfile& profile)
+{
+    for (TvProfile& candidate : GetTvProfiles(configuration))
+    {
+        if (candidate.name == name)
+        {
+            profile = std::move(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t CompareTvProfiles(const TvProfile& previous, const TvProfile& current)
+{
+    uint32_t changes = ConfigurationChangeNone;
+    if (previous.tvIpAddress != current.tvIpAddress)
+    {
+        changes |= ConfigurationChangeTvIpAddress;
+    }
+    if (previous.tvMacAddress != current.tvMacAddress)
+    {
+        changes |= ConfigurationChangeTvMacAddress;
+    }
+    if (previous.deviceNameHint != current.deviceNameHint)
+    {
+        changes |= ConfigurationChangeDeviceNameHint;
+    }
+    if (previous.useSecureWebSocket != current.useSecureWebSocket)
+    {
+        changes |= ConfigurationChangeUseSecureWebSocket;
+    }
+    if (previous.tvPort != current.tvPort)
+    {
+        changes |= ConfigurationChangeTvPort;
+    }
+    return changes;
+}
+
+const wchar_t* GetTvProfileDisplayName(const TvProfile& profile)
+{
+    return profile.name.empty() ? L"Default" : profile.name.c_str();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Configuration.h"
+
+// One TV the app can control: where to reach it, which audio endpoint leads
+// to it and the name its client key is stored under.
+//
+// The top-level tv_ip, tv_mac, device_hint, tv_port and use_secure_websocket
+// settings form the default profile, which has an empty name. Each
+// tv_profile line adds a named one:
+//   tv_profile=<name>|<ip>|<mac>|<port>|<secure 0/1>|<device hint>
+// The hint is last and may itself contain '|'.
+struct TvProfile
+{
+    std::wstring name;
+    std::wstring tvIpAddress;
+    std::wstring tvMacAddress;
+    std::wstring deviceNameHint;
+    bool useSecureWebSocket = true;
+    unsigned short tvPort = 3001;
+};
+
+// Parses one tv_profile entry. Returns false for an empty name or a malformed
+// port or secure flag.
+bool ParseTvProfile(const std::wstring& entry, TvProfile& profile);
+
+// Formats a named profile as a tv_profile entry; the inverse of ParseTvProfile.
+std::wstring FormatTvProfile(const TvProfile& profile);
+
+// Writes a profile back into the configuration: the default profile into the
+// top-level settings, a named one over the entry GetTvProfiles reads it from,
+// or as a new entry. Returns false and leaves the configuration unchanged when
+// a named profile's name, IP or MAC address contains '|', which would not
+// read back as the same profile.
+bool StoreTvProfile(AppConfiguration& configuration, const TvProfile& profile);
+
+// Returns the configuration's profiles in the order endpoints are matched
+// against them: named profiles in file order, then the default profile.
+// Malformed entries and repeated names are skipped.
+std::vector<TvProfile> GetTvProfiles(const AppConfiguration& configuration);
+
+// Finds a profile by name; the empty name is the default profile.
+bool FindTvProfile(const AppConfiguration& configuration, const std::wstring& name, TvProfile& profile);
+
+// Returns the ConfigurationChange flags for the profile fields that differ.
+uint32_t CompareTvProfiles(const TvProfile& previous, const TvProfile& current);
+
+// Returns the name shown to the user.
+const wchar_t* GetTvProfileDisplayName(const TvProfile& profile);
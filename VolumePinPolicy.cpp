@@ -0,0 +1,97 @@
+#include "VolumePinPolicy.h"
+
+#include <cmath>
+
+VolumePinPolicy::VolumePinPolicy()
+    : VolumePinPolicy(Settings())
+{
+}
+
+VolumePinPolicy::VolumePinPolicy(const Settings& settingsValue)
+    : settings(settingsValue),
+    pinned(false),
+    pinnedLevel(1.0f),
+    windowStart(),
+    repinsInWindow(0),
+    notificationCount(0),
+    driftCount(0),
+    repinCount(0),
+    suppressedCount(0)
+{
+}
+
+void VolumePinPolicy::Pin(float level)
+{
+    pinned = true;
+    pinnedLevel = level;
+    repinsInWindow = 0;
+    windowStart = Clock::time_point();
+}
+
+void VolumePinPolicy::Unpin()
+{
+    pinned = false;
+}
+
+bool VolumePinPolicy::IsPinned() const
+{
+    return pinned;
+}
+
+float VolumePinPolicy::GetPinnedLevel() const
+{
+    return pinnedLevel;
+}
+
+bool VolumePinPolicy::OnVolumeChanged(float level, bool ownChange, Clock::time_point now)
+{
+    ++notificationCount;
+
+    if (!pinned || ownChange)
+    {
+        return false;
+    }
+
+    if (std::fabs(level - pinnedLevel) <= settings.tolerance)
+    {
+        return false;
+    }
+
+    ++driftCount;
+
+    if (repinsInWindow == 0 || now - windowStart >= settings.window)
+    {
+        windowStart = now;
+        repinsInWindow = 0;
+    }
+
+    if (repinsInWindow >= settings.maxRepinsPerWindow)
+    {
+        ++suppressedCount;
+        return false;
+    }
+
+    ++repinsInWindow;
+    ++repinCount;
+    return true;
+}
+
+uint64_t VolumePinPolicy::GetNotificationCount() const
+{
+    return notificationCount;
+}
+
+uint64_t VolumePinPolicy::GetDriftCount() const
+{
+    return driftCount;
+}
+
+uint64_t VolumePinPolicy::GetRepinCount() const
+{
+    return repinCount;
+}
+
+uint64_t VolumePinPolicy::GetSuppressedCount() const
+{
+    return suppressedCount;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Decides when a pinned endpoint volume has drifted and must be re-applied.
+//
+// The policy only sees volume notifications; it never touches the endpoint
+// itself. Our own changes are ignored, and re-pins are rate limited so an
+// application that keeps fighting over the volume cannot turn the pin into a
+// busy loop.
+class VolumePinPolicy
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings
+    {
+        float tolerance = 0.005f;
+        uint32_t maxRepinsPerWindow = 5;
+        Clock::duration window = std::chrono::seconds(2);
+    };
+
+    VolumePinPolicy();
+    explicit VolumePinPolicy(const Settings& settings);
+
+    // Starts holding the endpoint at the given level.
+    void Pin(float level);
+
+    // Stops holding the endpoint volume.
+    void Unpin();
+
+    // Returns true while a level is pinned.
+    bool IsPinned() const;
+
+    // Returns the pinned level; only meaningful while pinned.
+    float GetPinnedLevel() const;
+
+    // Handles a volume notification. ownChange is true for changes tagged
+    // with our event context. Returns true when the caller should re-pin.
+    bool OnVolumeChanged(float level, bool ownChange, Clock::time_point now);
+
+    uint64_t GetNotificationCount() const;
+    uint64_t GetDriftCount() const;
+    uint64_t GetRepinCount() const;
+    uint64_t GetSuppressedCount() const;
+
+private:
+    Settings settings;
+    bool pinned;
+    float pinnedLevel;
+
+    Clock::time_point windowStart;
+    uint32_t repinsInWindow;
+
+    uint64_t notificationCount;
+    uint64_t driftCount;
+    uint64_t repinCount;
+    uint64_t suppressedCount;
+};
@@ -0,0 +1,247 @@
+#include "WindowsKeyboardHookSource.h"
+
+#include "Logging.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+    // Thread messages handled by the hook's message loop.
+    constexpr UINT WM_UPDATECAPTURE = WM_APP + 1;
+    constexpr UINT WM_HOOKCALLBACKSLOW = WM_APP + 2;
+    constexpr UINT WM_UPDATEHOTKEYS = WM_APP + 3;
+
+    constexpr int ModifierKeys[] =
+    {
+        VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU,
+        VK_LSHIFT, VK_RSHIFT, VK_LWIN, VK_RWIN
+    };
+}
+
+WindowsKeyboardHookSource* WindowsKeyboardHookSource::activeSource = nullptr;
+
+WindowsKeyboardHookSource::WindowsKeyboardHookSource(IInputEventSink& sinkValue, CaptureQuery captureWantedValue)
+    : sink(sinkValue),
+    captureWanted(std::move(captureWantedValue)),
+    hookController(*this),
+    latency(SlowCallbackThreshold),
+    hook(nullptr),
+    threadId(0),
+    publishedHotkeys(),
+    hotkeys(),
+    heldModifierKeys(0),
+    swallowedKeys()
+{
+}
+
+bool WindowsKeyboardHookSource::Prepare()
+{
+    // Create the thread's message queue before anyone posts to it.
+    MSG msg;
+    PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+    threadId = GetCurrentThreadId();
+    TraceRecorder::SetThreadName("Keyboard hook");
+    LoadHotkeyMap();
+    hookController.Update(captureWanted());
+    return true;
+}
+
+void WindowsKeyboardHookSource::Run()
+{
+    MSG msg;
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0)
+    {
+        if (msg.hwnd != nullptr)
+        {
+            DispatchMessageW(&msg);
+            continue;
+        }
+
+        switch (msg.message)
+        {
+        case WM_UPDATECAPTURE:
+            hookController.Update(captureWanted());
+            break;
+        case WM_UPDATEHOTKEYS:
+            LoadHotkeyMap();
+            break;
+        case WM_HOOKCALLBACKSLOW:
+            LGTV_LOG_WARNING(Key, L"Slow keyboard hook callback: %llu us",
+                static_cast<unsigned long long>(msg.wParam));
+            break;
+        default:
+            break;
+        }
+    }
+
+    hookController.Shutdown();
+}
+
+void WindowsKeyboardHookSource::RequestStop()
+{
+    DWORD loopThreadId = threadId.exchange(0);
+    if (loopThreadId != 0)
+    {
+        PostThreadMessageW(loopThreadId, WM_QUIT, 0, 0);
+    }
+}
+
+void WindowsKeyboardHookSource::RequestCaptureUpdate()
+{
+    DWORD loopThreadId = threadId.load();
+    if (loopThreadId != 0)
+    {
+        PostThreadMessageW(loopThreadId, WM_UPDATECAPTURE, 0, 0);
+    }
+}
+
+void WindowsKeyboardHookSource::SetHotkeyMap(std::shared_ptr<const HotkeyMap> map)
+{
+    publishedHotkeys.Publish(std::move(map));
+
+    DWORD loopThreadId = threadId.load();
+    if (loopThreadId != 0)
+    {
+        PostThreadMessageW(loopThreadId, WM_UPDATEHOTKEYS, 0, 0);
+    }
+}
+
+const InputHookController& WindowsKeyboardHookSource::GetHookController() const
+{
+    return hookController;
+}
+
+const CallbackLatencyMonitor& WindowsKeyboardHookSource::GetLatencyMonitor() const
+{
+    return latency;
+}
+
+bool WindowsKeyboardHookSource::Install()
+{
+    // Modifiers pressed while the hook was not installed were not seen.
+    SyncModifierKeys();
+    swallowedKeys.reset();
+
+    activeSource = this;
+    hook = SetWindowsHookExW(WH_KEYBOARD_LL,
+        LowLevelKeyboardProc,
+        GetModuleHandleW(nullptr),
+        0);
+    if (!hook)
+    {
+        LGTV_LOG_DEBUG(Key, L"SetWindowsHookEx failed: %lu\n", GetLastError());
+        activeSource = nullptr;
+        return false;
+    }
+
+    LGTV_LOG_DEBUG(Key, L"Keyboard hook installed\n");
+    return true;
+}
+
+void WindowsKeyboardHookSource::Uninstall()
+{
+    if (hook)
+    {
+        UnhookWindowsHookEx(hook);
+        hook = nullptr;
+        LGTV_LOG_DEBUG(Key, L"Keyboard hook removed\n");
+    }
+    activeSource = nullptr;
+}
+
+LRESULT CALLBACK WindowsKeyboardHookSource::LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+{
+    WindowsKeyboardHookSource* source = activeSource;
+    if (!source)
+    {
+        return CallNextHookEx(nullptr, nCode, wParam, lParam);
+    }
+
+    TraceSpan span("Key", "LowLevelKeyboardProc");
+
+    // Every keystroke in the system waits for this callback, so its cost is
+    // tracked and slow calls are reported.
+    CallbackLatencyMonitor::Clock::time_point start = CallbackLatencyMonitor::Clock::now();
+    bool swallow = source->HandleKey(nCode, wParam, lParam);
+    CallbackLatencyMonitor::Clock::duration elapsed = CallbackLatencyMonitor::Clock::now() - start;
+
+    if (source->latency.Record(elapsed))
+    {
+        PostThreadMessageW(GetCurrentThreadId(), WM_HOOKCALLBACKSLOW,
+            static_cast<WPARAM>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()),
+            0);
+    }
+
+    if (swallow)
+    {
+        return 1;
+    }
+
+    return CallNextHookEx(source->hook, nCode, wParam, lParam);
+}
+
+bool WindowsKeyboardHookSource::HandleKey(int nCode, WPARAM wParam, LPARAM lParam)
+{
+    if (nCode < 0)
+    {
+        return false;
+    }
+
+    const KBDLLHOOKSTRUCT* pkb = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+    uint8_t virtualKey = static_cast<uint8_t>(pkb->vkCode);
+    bool keyDown = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+
+    uint8_t modifierBit = HotkeyMap::GetModifierKeyBit(virtualKey);
+    if (modifierBit != 0)
+    {
+        heldModifierKeys = keyDown
+            ? static_cast<uint8_t>(heldModifierKeys | modifierBit)
+            : static_cast<uint8_t>(heldModifierKeys & ~modifierBit);
+        return false;
+    }
+
+    if (!keyDown)
+    {
+        // Keep the release of a swallowed key away from the system as well.
+        bool swallowed = swallowedKeys.test(virtualKey);
+        swallowedKeys.reset(virtualKey);
+        return swallowed;
+    }
+
+    const HotkeyTarget* target = hotkeys->Find(virtualKey, HotkeyMap::FoldModifierKeys(heldModifierKeys));
+    if (!target)
+    {
+        return false;
+    }
+
+    TvVolumeEvent event;
+    event.action = target->action;
+    event.value = target->value;
+    event.timestamp = std::chrono::steady_clock::now();
+
+    bool swallow = sink.OnTvVolumeEvent(event);
+    swallowedKeys.set(virtualKey, swallow);
+    return swallow;
+}
+
+void WindowsKeyboardHookSource::LoadHotkeyMap()
+{
+    std::shared_ptr<const HotkeyMap> map = publishedHotkeys.Acquire();
+    if (!map)
+    {
+        map = std::make_shared<const HotkeyMap>(HotkeyMap::CreateDefault());
+    }
+    hotkeys = std::move(map);
+}
+
+void WindowsKeyboardHookSource::SyncModifierKeys()
+{
+    heldModifierKeys = 0;
+    for (int virtualKey : ModifierKeys)
+    {
+        if (GetAsyncKeyState(virtualKey) & 0x8000)
+        {
+            heldModifierKeys |= HotkeyMap::GetModifierKeyBit(static_cast<uint8_t>(virtualKey));
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "framework.h"
+
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <memory>
+
+#include "CallbackLatencyMonitor.h"
+#include "HotkeyMap.h"
+#include "InputHookController.h"
+#include "InputSource.h"
+#include "PublishedHandle.h"
+
+// Input source built on a WH_KEYBOARD_LL hook.
+//
+// Runs a message loop on its InputThread and installs the hook there only
+// while capture is wanted. Keys are looked up in a HotkeyMap using modifier
+// state tracked from the hook's own key events, so a keystroke costs the same
+// however many bindings exist. Hook callbacks are timed, and slow ones are
+// logged from the message loop rather than from inside the hook. Only one
+// instance can run at a time.
+class WindowsKeyboardHookSource : public IInputSource, private IInputHookBackend
+{
+public:
+    using CaptureQuery = std::function<bool()>;
+
+    // Callbacks slower than this are logged; Windows removes a hook that
+    // keeps the system waiting longer than LowLevelHooksTimeout.
+    static constexpr std::chrono::milliseconds SlowCallbackThreshold{ 20 };
+
+    WindowsKeyboardHookSource(IInputEventSink& sink, CaptureQuery captureWanted);
+
+    // IInputEventLoop
+    bool Prepare() override;
+    void Run() override;
+    void RequestStop() override;
+
+    // IInputSource
+    void RequestCaptureUpdate() override;
+
+    // Replaces the hotkey map. Safe to call from any thread; the hook picks
+    // the new map up on its own thread. Without a map the default one is used.
+    void SetHotkeyMap(std::shared_ptr<const HotkeyMap> map);
+
+    // Statistics; read them once the input thread has stopped.
+    const InputHookController& GetHookController() const;
+    const CallbackLatencyMonitor& GetLatencyMonitor() const;
+
+private:
+    // IInputHookBackend
+    bool Install() override;
+    void Uninstall() override;
+
+    static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+    bool HandleKey(int nCode, WPARAM wParam, LPARAM lParam);
+    void LoadHotkeyMap();
+    void SyncModifierKeys();
+
+    static WindowsKeyboardHookSource* activeSource;
+
+    IInputEventSink& sink;
+    CaptureQuery captureWanted;
+    InputHookController hookController;
+    CallbackLatencyMonitor latency;
+    HHOOK hook;
+    std::atomic<DWORD> threadId;
+
+    PublishedHandle<const HotkeyMap> publishedHotkeys;
+
+    // Only touched on the input thread.
+    std::shared_ptr<const HotkeyMap> hotkeys;
+    uint8_t heldModifierKeys;
+    std::bitset<HotkeyMap::KeyCount> swallowedKeys;
+};